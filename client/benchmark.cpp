@@ -6,7 +6,15 @@
 #include <cstring>
 #include <mutex>
 #include <unordered_map>
+#include <cstdlib>
+#include <map>
+#include <sstream>
+#include <future>
+#include <random>
+#include <memory>
+#include <iomanip>
 #include "ChatClient.h"
+#include "Workload.h"
 
 struct TestMessage {
     uint64_t message_id;
@@ -23,29 +31,53 @@ struct Stats {
     std::unordered_map<uint64_t, TestMessage> pending_messages;
 };
 
-// 속도 제어를 위한 RateLimiter 클래스 추가
+// 속도 제어: 고정 간격 또는 Pareto 켜짐/꺼짐 간격 (burst_alpha > 0, 평균 속도 유지)
 class RateLimiter {
 public:
-    explicit RateLimiter(uint32_t messages_per_second) 
-        : messages_per_second_(messages_per_second)
-        , interval_ms_(1000.0 / messages_per_second)
-        , last_send_time_(std::chrono::steady_clock::now()) {}
-
-    void wait() {
-        auto now = std::chrono::steady_clock::now();
-        auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(now - last_send_time_).count();
-        
-        if (elapsed < interval_ms_) {
-            std::this_thread::sleep_for(std::chrono::milliseconds(
-                static_cast<int64_t>(interval_ms_ - elapsed)));
+    RateLimiter(uint32_t messages_per_second, double burst_alpha, uint64_t seed)
+        : sender_(messages_per_second, burst_alpha)
+        , rng_(seed)
+        , next_send_time_(std::chrono::steady_clock::now()) {
+        if (burst_alpha > 0) {
+            advance();   // 켜짐/꺼짐 시작 위치를 클라이언트마다 흩음
+        }
+    }
+
+    // 다음 송신 시각까지 대기. 긴 꺼짐 구간에서도 stop_flag에 바로 반응
+    bool wait(const std::atomic<bool>& stop_flag) {
+        while (!stop_flag) {
+            auto now = std::chrono::steady_clock::now();
+            if (now >= next_send_time_) {
+                advance();
+                // 1초 이상 밀렸으면 따라잡기 폭주 대신 현재 시각부터 재개
+                if (next_send_time_ + std::chrono::seconds(1) < now) {
+                    next_send_time_ = now;
+                }
+                return true;
+            }
+            std::this_thread::sleep_for(std::min<std::chrono::steady_clock::duration>(
+                next_send_time_ - now, std::chrono::milliseconds(100)));
         }
-        last_send_time_ = std::chrono::steady_clock::now();
+        return false;
     }
 
 private:
-    uint32_t messages_per_second_;
-    double interval_ms_;
-    std::chrono::steady_clock::time_point last_send_time_;
+    void advance() {
+        next_send_time_ += std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+            std::chrono::duration<double>(sender_.nextGap(rng_)));
+    }
+
+    OnOffSender sender_;
+    std::mt19937_64 rng_;
+    std::chrono::steady_clock::time_point next_send_time_;
+};
+
+// 운영 형태 부하 설정 (기본값은 기존과 같은 균일 부하)
+struct WorkloadOptions {
+    uint32_t rooms{1};               // 방 1..rooms
+    double zipf{0.0};                // 방 인기도 Zipf 지수 (0이면 균등)
+    double burst{0.0};               // Pareto alpha (0이면 고정 간격)
+    std::shared_ptr<const SizeDistribution> sizes;   // 없으면 -s 고정 크기
 };
 
 void print_usage(const char* program) {
@@ -59,19 +91,164 @@ void print_usage(const char* program) {
               << "  -s, --size <크기>         메시지 크기 (기본값: 512)\n"
               << "  -d, --duration <시간>     테스트 시간(초) (기본값: 60)\n"
               << "  -r, --rate <속도>         클라이언트당 초당 메시지 수 (기본값: 2)\n"
+              << "      --rooms <개수>        방 1..N에 클라이언트 분산 (기본값: 1)\n"
+              << "      --zipf <지수>         방 인기도 Zipf 지수, 0이면 균등 (기본값: 0)\n"
+              << "      --burst <alpha>       Pareto 켜짐/꺼짐 송신, alpha > 1 (기본값: 고정 간격)\n"
+              << "      --sizes <파일>        캡처한 메시지 크기 분포 (\"크기 [개수]\" 줄 단위)\n"
+              << "      --baseline <주소>     같은 부하를 echo/sink 모드 서버에도 실행해 비교\n"
               << std::endl;
 }
 
+// 서버 "stats" 명령 응답 ("stats: key=value ...") 파싱
+using ServerStats = std::map<std::string, double>;
+
+ServerStats parse_server_stats(const std::string& reply) {
+    ServerStats result;
+    std::istringstream ss(reply.substr(reply.find(':') + 1));
+    std::string field;
+    while (ss >> field) {
+        size_t eq = field.find('=');
+        if (eq != std::string::npos) {
+            result[field.substr(0, eq)] = std::stod(field.substr(eq + 1));
+        }
+    }
+    return result;
+}
+
+// 별도 제어 연결로 서버 링 통계 조회
+class StatsProbe {
+public:
+    bool connect(const std::string& address, int port) {
+        client_.setBackgroundReceive(true);
+        client_.setMessageCallback([this](const std::string& msg) {
+            if (msg.rfind("stats:", 0) == 0) {
+                std::lock_guard<std::mutex> lock(mutex_);
+                if (pending_) {
+                    pending_->set_value(parse_server_stats(msg));
+                    pending_.reset();
+                }
+            }
+        });
+        return client_.connect(address, port);
+    }
+
+    bool query(ServerStats& out) {
+        std::future<ServerStats> reply;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            pending_ = std::make_unique<std::promise<ServerStats>>();
+            reply = pending_->get_future();
+        }
+        if (!client_.sendCommand("stats") ||
+            reply.wait_for(std::chrono::seconds(2)) != std::future_status::ready) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            pending_.reset();
+            return false;
+        }
+        out = reply.get();
+        return true;
+    }
+
+    void disconnect() { client_.disconnect(); }
+
+private:
+    ChatClient client_;
+    std::mutex mutex_;
+    std::unique_ptr<std::promise<ServerStats>> pending_;
+};
+
+ServerStats stats_delta(const ServerStats& before, const ServerStats& after) {
+    ServerStats delta;
+    for (const auto& [key, value] : after) {
+        auto b = before.find(key);
+        delta[key] = value - (b != before.end() ? b->second : 0.0);
+    }
+    return delta;
+}
+
+double stat_value(const ServerStats& stats, const char* key) {
+    auto it = stats.find(key);
+    return it != stats.end() ? it->second : 0.0;
+}
+
+// 프레임당 비용: 전달 프레임 기준, 아무것도 보내지 않는 sink 서버는 수신 프레임 기준
+double per_frame(const ServerStats& delta, const char* key) {
+    double frames = stat_value(delta, "delivered");
+    if (frames < stat_value(delta, "received")) {
+        frames = stat_value(delta, "received");
+    }
+    return frames > 0 ? stat_value(delta, key) / frames : 0.0;
+}
+
+void print_ring_efficiency(const ServerStats& delta) {
+    std::cout << "\n[서버 링 효율]\n"
+              << "  수신 프레임:          " << static_cast<uint64_t>(stat_value(delta, "received")) << "\n"
+              << "  전달된 프레임:        " << static_cast<uint64_t>(stat_value(delta, "delivered")) << "\n"
+              << "  기한 초과 폐기:       " << static_cast<uint64_t>(stat_value(delta, "skipped")) << "\n"
+              << "  io_uring_enter 호출:  " << static_cast<uint64_t>(stat_value(delta, "enters")) << "\n"
+              << "  제출 SQE:             " << static_cast<uint64_t>(stat_value(delta, "sqes")) << "\n"
+              << "  처리 CQE:             " << static_cast<uint64_t>(stat_value(delta, "cqes")) << "\n"
+              << "  루프 반복:            " << static_cast<uint64_t>(stat_value(delta, "loops")) << "\n"
+              << "  워커 정지 감지:       " << static_cast<uint64_t>(stat_value(delta, "stalls")) << "\n"
+              << "  발신자 조절:          " << static_cast<uint64_t>(stat_value(delta, "throttled")) << "\n"
+              << "  속도 제한 폐기:       " << static_cast<uint64_t>(stat_value(delta, "limited")) << "\n"
+              << "  스팸 폐기:            " << static_cast<uint64_t>(stat_value(delta, "spam")) << "\n"
+              << "  다른 링으로 넘김:     " << static_cast<uint64_t>(stat_value(delta, "routed")) << "\n"
+              << "  멀티캐스트 중복 제거: " << static_cast<uint64_t>(stat_value(delta, "deduped")) << "\n"
+              << "  JSON 직렬화:          " << static_cast<uint64_t>(stat_value(delta, "json")) << "\n"
+              << "  enter/메시지:         " << per_frame(delta, "enters") << "\n"
+              << "  SQE/메시지:           " << per_frame(delta, "sqes") << "\n"
+              << "  CQE/메시지:           " << per_frame(delta, "cqes") << std::endl;
+}
+
+// 서버 하나에 대한 측정 결과
+struct BenchmarkResult {
+    uint64_t sent;
+    uint64_t received;
+    double elapsed_sec;
+    double avg_latency_ms;
+    bool have_ring;
+    ServerStats ring;           // 측정 구간 동안의 서버 링 통계 변화량
+};
+
+// 채팅(방 팬아웃)과 기준 서버(echo/sink) 결과 나란히 출력
+void print_comparison(const BenchmarkResult& chat, const BenchmarkResult& baseline) {
+    auto throughput = [](const BenchmarkResult& r) { return r.elapsed_sec > 0 ? r.received / r.elapsed_sec : 0.0; };
+    auto row = [](const char* label, double a, double b) {
+        std::cout << "  " << std::left << std::setw(22) << label << std::right
+                  << std::setw(14) << a << std::setw(14) << b << std::setw(12)
+                  << (b > 0 ? a / b : 0.0) << "\n";
+    };
+
+    std::cout << "\n[채팅 vs 기준 서버]\n"
+              << "  " << std::left << std::setw(22) << "" << std::right
+              << std::setw(14) << "채팅" << std::setw(14) << "기준" << std::setw(12) << "비율" << "\n"
+              << std::fixed << std::setprecision(3);
+    row("수신 메시지", chat.received, baseline.received);
+    row("처리량 (msg/s)", throughput(chat), throughput(baseline));
+    row("평균 지연 (ms)", chat.avg_latency_ms, baseline.avg_latency_ms);
+    if (chat.have_ring && baseline.have_ring) {
+        row("enter/메시지", per_frame(chat.ring, "enters"), per_frame(baseline.ring, "enters"));
+        row("SQE/메시지", per_frame(chat.ring, "sqes"), per_frame(baseline.ring, "sqes"));
+        row("CQE/메시지", per_frame(chat.ring, "cqes"), per_frame(baseline.ring, "cqes"));
+    }
+    std::cout << std::defaultfloat << std::flush;
+}
+
 void run_client(const std::string& address, 
                int port,
+               int32_t room_id,
                size_t msg_size,
                uint32_t messages_per_second,
+               const WorkloadOptions& workload,
                std::atomic<bool>& stop_flag,
                Stats& stats,
                int client_id,
                int grace_period) {
     ChatClient client;
-    RateLimiter rate_limiter(messages_per_second);
+    client.setBackgroundReceive(true);
+    RateLimiter rate_limiter(messages_per_second, workload.burst, std::random_device{}());
+    std::mt19937_64 size_rng(std::random_device{}());
     bool session_joined = false;
     
     // 메시지 수신 콜백 설정
@@ -106,43 +283,39 @@ void run_client(const std::string& address,
         }
     });
 
-    // 서버 연결
-    if (!client.connect(address, port)) {
+    // 서버 연결과 동시에 배정된 방 참여 (서버 인증 사용 시 CHAT_AUTH_TOKEN)
+    const char* token = std::getenv("CHAT_AUTH_TOKEN");
+    if (!client.connectAndJoin(address, port, room_id, token ? token : "")) {
         std::cerr << "클라이언트 " << client_id << " 연결 실패" << std::endl;
         return;
     }
-
-    // 세션 참여
-    if (!client.joinSession(1)) {
-        std::cerr << "클라이언트 " << client_id << " 세션 참여 실패" << std::endl;
-        client.disconnect();
-        return;
-    }
     session_joined = true;
 
-    while (!stop_flag) {
-        rate_limiter.wait();
-        
+    while (rate_limiter.wait(stop_flag)) {
+        size_t size = workload.sizes ? workload.sizes->sample(size_rng) : msg_size;
+
         // 새 메시지 ID 생성
         uint64_t msg_id = ++stats.message_id_counter;
         
         // 메시지 생성 및 전송
         std::string message = "test_message_msg_id:" + std::to_string(msg_id) + 
                             ",client:" + std::to_string(client_id) + 
-                            ",data:" + std::string(msg_size - 50, 'a');
+                            ",data:" + std::string(size > 50 ? size - 50 : 0, 'a');
 
-        if (client.sendChat(message)) {
-            TestMessage test_msg{
+        // 서버가 빨라 에코가 sendChat 반환보다 먼저 올 수 있으므로 보내기 전에 등록
+        {
+            std::lock_guard<std::mutex> lock(stats.mutex);
+            stats.pending_messages[msg_id] = TestMessage{
                 msg_id,
                 std::chrono::steady_clock::now(),
                 static_cast<size_t>(client_id)
             };
-            
-            {
-                std::lock_guard<std::mutex> lock(stats.mutex);
-                stats.pending_messages[msg_id] = test_msg;
-            }
+        }
+        if (client.sendChat(message)) {
             stats.messages_sent++;
+        } else {
+            std::lock_guard<std::mutex> lock(stats.mutex);
+            stats.pending_messages.erase(msg_id);
         }
     }
 
@@ -159,37 +332,159 @@ void run_client(const std::string& address,
     client.disconnect();
 }
 
-int main(int argc, char** argv) {
-    if (argc != 3) {
-        std::cerr << "Usage: " << argv[0] << " <host> <port>" << std::endl;
-        return 1;
+// 같은 부하로 한 서버를 측정 (--baseline 시 채팅 서버와 기준 서버에 차례로 실행)
+BenchmarkResult run_benchmark(const std::string& host, int port, size_t num_clients, size_t msg_size,
+                              uint32_t rate, int duration, int grace_period, const WorkloadOptions& workload,
+                              const std::vector<int32_t>& client_rooms, const std::vector<size_t>& room_clients) {
+    StatsProbe probe;
+    ServerStats before, after;
+    bool have_stats = probe.connect(host, port) && probe.query(before);
+    if (!have_stats) {
+        std::cerr << "서버 통계 조회 실패: 링 효율은 출력되지 않습니다" << std::endl;
     }
 
-    const char* host = argv[1];
-    int port = std::stoi(argv[2]);
-    
-    try {
-        ChatClient client;
-        if (!client.connect(host, port)) {
-            std::cerr << "Failed to connect to server" << std::endl;
-            return 1;
+    Stats stats;
+    std::atomic<bool> stop_flag(false);
+    std::vector<std::thread> clients;
+    clients.reserve(num_clients);
+
+    std::cout << "벤치마크 시작: " << num_clients << " 클라이언트, " << duration << "초, "
+              << rate << " msg/s/client, "
+              << (workload.sizes ? "캡처 크기 분포 (평균 " + std::to_string(static_cast<int>(workload.sizes->mean())) + " bytes)"
+                                 : std::to_string(msg_size) + " bytes")
+              << (workload.burst > 0 ? ", Pareto 켜짐/꺼짐 송신" : "") << std::endl;
+    if (workload.rooms > 1) {
+        std::cout << "방 배정 (zipf=" << workload.zipf << "):";
+        for (size_t rank = 0; rank < room_clients.size() && rank < 10; ++rank) {
+            std::cout << " " << rank + 1 << "=" << room_clients[rank];
         }
+        std::cout << (room_clients.size() > 10 ? " ..." : "") << std::endl;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < num_clients; ++i) {
+        clients.emplace_back(run_client, host, port, client_rooms[i], msg_size, rate, std::cref(workload),
+                             std::ref(stop_flag),
+                             std::ref(stats), static_cast<int>(i), grace_period);
+    }
+
+    std::this_thread::sleep_for(std::chrono::seconds(duration));
+    stop_flag = true;
+    for (auto& t : clients) {
+        t.join();
+    }
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    uint64_t sent = stats.messages_sent.load();
+    uint64_t received = stats.messages_received.load();
+    std::cout << "\n[결과]\n"
+              << "  전송 메시지:   " << sent << "\n"
+              << "  수신 메시지:   " << received << "\n"
+              << "  처리량:        " << (elapsed > 0 ? received / elapsed : 0.0) << " msg/s\n"
+              << "  평균 지연:     " << (received ? static_cast<double>(stats.total_latency_ms) / received : 0.0)
+              << " ms" << std::endl;
 
-        // 세션 1에 조인
-        if (!client.joinSession(1)) {
-            std::cerr << "Failed to join session" << std::endl;
+    BenchmarkResult result{sent, received, elapsed,
+                           received ? static_cast<double>(stats.total_latency_ms) / received : 0.0, false, {}};
+    if (have_stats && probe.query(after)) {
+        result.ring = stats_delta(before, after);
+        result.have_ring = true;
+        print_ring_efficiency(result.ring);
+    }
+    probe.disconnect();
+    return result;
+}
+
+int main(int argc, char** argv) {
+    std::string host = "127.0.0.1";
+    int port = 8080;
+    size_t num_clients = 50;
+    size_t msg_size = 512;
+    int duration = 60;
+    uint32_t rate = 2;
+    const int grace_period = 1;
+    WorkloadOptions workload;
+    std::string baseline_host;
+    int baseline_port = 8081;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        auto next = [&]() -> std::string {
+            if (i + 1 >= argc) {
+                throw std::invalid_argument("missing value for " + arg);
+            }
+            return argv[++i];
+        };
+
+        try {
+            if (arg == "-h" || arg == "--help") {
+                print_usage(argv[0]);
+                return 0;
+            } else if (arg == "-a" || arg == "--address") {
+                std::string address = next();
+                size_t colon = address.rfind(':');
+                host = address.substr(0, colon);
+                if (colon != std::string::npos) {
+                    port = std::stoi(address.substr(colon + 1));
+                }
+            } else if (arg == "-c" || arg == "--clients") {
+                num_clients = std::stoul(next());
+            } else if (arg == "-s" || arg == "--size") {
+                msg_size = std::stoul(next());
+            } else if (arg == "-d" || arg == "--duration") {
+                duration = std::stoi(next());
+            } else if (arg == "-r" || arg == "--rate") {
+                rate = static_cast<uint32_t>(std::stoul(next()));
+            } else if (arg == "--baseline") {
+                std::string address = next();
+                size_t colon = address.rfind(':');
+                baseline_host = address.substr(0, colon);
+                if (colon != std::string::npos) {
+                    baseline_port = std::stoi(address.substr(colon + 1));
+                }
+            } else if (arg == "--rooms") {
+                workload.rooms = static_cast<uint32_t>(std::stoul(next()));
+            } else if (arg == "--zipf") {
+                workload.zipf = std::stod(next());
+            } else if (arg == "--burst") {
+                workload.burst = std::stod(next());
+            } else if (arg == "--sizes") {
+                workload.sizes = std::make_shared<const SizeDistribution>(
+                    SizeDistribution::load(next(), sizeof(ChatMessage::data)));
+            } else {
+                print_usage(argv[0]);
+                return 1;
+            }
+        } catch (const std::exception& e) {
+            std::cerr << "잘못된 옵션: " << arg << " (" << e.what() << ")" << std::endl;
             return 1;
         }
+    }
 
-        // 메시지 수신을 위한 루프
-        while (true) {
-            std::this_thread::sleep_for(std::chrono::milliseconds(100));
-        }
-        
-        return 0;
+    if (rate == 0 || msg_size > sizeof(ChatMessage::data)) {
+        std::cerr << "속도는 1 이상, 메시지 크기는 " << sizeof(ChatMessage::data) << " 이하여야 합니다" << std::endl;
+        return 1;
     }
-    catch (const std::exception& e) {
-        std::cerr << "Error: " << e.what() << std::endl;
+    if (workload.rooms == 0 || workload.zipf < 0 || (workload.burst != 0 && workload.burst <= 1.0)) {
+        std::cerr << "방 수는 1 이상, zipf는 0 이상, burst는 1보다 커야 합니다" << std::endl;
         return 1;
     }
-} 
\ No newline at end of file
+
+    // 클라이언트를 방 인기도(Zipf 순위 = 방 번호 순)대로 배정
+    std::vector<int32_t> client_rooms;
+    ZipfSampler popularity(workload.rooms, workload.zipf);
+    std::vector<size_t> room_clients = popularity.distribute(num_clients);
+    for (size_t rank = 0; rank < room_clients.size(); ++rank) {
+        client_rooms.insert(client_rooms.end(), room_clients[rank], static_cast<int32_t>(rank + 1));
+    }
+
+    BenchmarkResult chat = run_benchmark(host, port, num_clients, msg_size, rate, duration, grace_period,
+                                         workload, client_rooms, room_clients);
+    if (!baseline_host.empty()) {
+        std::cout << "\n===== 기준 서버 " << baseline_host << ":" << baseline_port << " =====" << std::endl;
+        BenchmarkResult baseline = run_benchmark(baseline_host, baseline_port, num_clients, msg_size, rate,
+                                                 duration, grace_period, workload, client_rooms, room_clients);
+        print_comparison(chat, baseline);
+    }
+    return 0;
+}
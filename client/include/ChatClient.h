@@ -1,7 +1,12 @@
 #pragma once
 #include "Context.h"
 #include <string>
+#include <vector>
 #include <functional>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <netinet/in.h>
 
 class ChatClient {
 public:
@@ -9,12 +14,30 @@ public:
     ~ChatClient();
 
     bool connect(const std::string& host, int port);
+    // 연결과 동시에 세션 참가 (fast open 사용 시 JOIN 프레임을 SYN에 실어 보냄)
+    bool connectAndJoin(const std::string& host, int port, int32_t sessionId, const std::string& token = "");
     void disconnect();
+
+    void setFastOpen(bool enable) { fastOpen_ = enable; }
+    // 수신 루프를 별도 쓰레드에서 실행 (stdin 미사용, 벤치마크용)
+    void setBackgroundReceive(bool enable) { background_ = enable; }
     
     // 기본 기능
-    bool joinSession(int32_t sessionId);
+    bool joinSession(int32_t sessionId, const std::string& token = "");
     bool leaveSession();
+    // 여러 방 참가: joinSession을 다시 부르면 방이 추가되고, 방을 지정해 보내거나 한 방만 떠난다
+    bool leaveRoom(int32_t roomId);
     bool sendChat(const std::string& message);
+    bool sendRoomChat(int32_t roomId, const std::string& message);
+    // 본문 하나를 여러 방과 사용자(토큰의 user_id)에게. 겹치는 수신자는 서버가 한 번만 보낸다
+    bool sendMulticast(const std::vector<int32_t>& roomIds, const std::vector<std::string>& users,
+                       const std::string& message);
+    bool sendCommand(const std::string& command);
+
+    // 첨부 파일 (한 번에 하나). 업로드는 서버의 "attach:ready" 응답을 받으면 수신 루프가 본문을 sendfile로 보내고,
+    // 다운로드는 SERVER_ATTACH 헤더 뒤에 오는 본문을 path에 저장한다
+    bool uploadAttachment(const std::string& path);
+    bool downloadAttachment(const std::string& digestHex, const std::string& path);
     
     // 콜백 설정
     using MessageCallback = std::function<void(const std::string&)>;
@@ -23,11 +46,30 @@ public:
 
 private:
     int socket_;
-    bool running_;
+    std::atomic<bool> running_;
+    bool fastOpen_{false};
+    bool background_{false};
+    std::thread receiveThread_;
  
     MessageCallback messageCallback_;
+
+    enum class AttachOp { NONE, UPLOAD, DOWNLOAD };
+    std::mutex attachMutex_;
+    AttachOp attachOp_{AttachOp::NONE};
+    int attachFd_{-1};
+    uint64_t attachSize_{0};
+    std::string attachPath_;
     
     void mainLoop();
+    void startLoop();
+    bool openSocket(const std::string& host, int port, sockaddr_in& serverAddr);
+    static bool buildMessage(ChatMessage& message, MessageType type, const void* data, size_t length);
+    static std::string buildJoinPayload(int32_t sessionId, const std::string& token);
     bool sendMessage(MessageType type, const void* data, size_t length);
     void handleMessage(const ChatMessage& message);
+    bool beginAttach(AttachOp op, int fd, uint64_t size, const std::string& path);
+    void finishAttach();
+    // 첨부 응답 처리 (수신 쓰레드). 본문을 주고받다 연결이 깨지면 false
+    bool handleAttachReply(const ChatMessage& message);
+    static bool parseDigest(const std::string& hex, uint8_t* digest);
 }; 
\ No newline at end of file
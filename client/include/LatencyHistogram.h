@@ -0,0 +1,62 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <algorithm>
+
+// 로그-선형 지연 히스토그램 (마이크로초, 2의 거듭제곱 구간마다 16등분, 상대 오차 ~6%)
+class LatencyHistogram {
+public:
+    static constexpr unsigned SUB_BUCKETS = 16;
+    static constexpr unsigned NUM_BUCKETS = SUB_BUCKETS + 60 * SUB_BUCKETS;
+
+    void record(uint64_t value_us) {
+        counts_[bucketOf(value_us)]++;
+        count_++;
+        sum_ += value_us;
+        max_ = std::max(max_, value_us);
+    }
+
+    void merge(const LatencyHistogram& other) {
+        for (unsigned i = 0; i < NUM_BUCKETS; ++i) counts_[i] += other.counts_[i];
+        count_ += other.count_;
+        sum_ += other.sum_;
+        max_ = std::max(max_, other.max_);
+    }
+
+    uint64_t count() const { return count_; }
+    uint64_t max() const { return max_; }
+    double mean() const { return count_ ? static_cast<double>(sum_) / count_ : 0.0; }
+
+    // q: 0.0 ~ 1.0
+    uint64_t percentile(double q) const {
+        if (count_ == 0) return 0;
+        uint64_t target = static_cast<uint64_t>(q * count_);
+        if (target >= count_) target = count_ - 1;
+        uint64_t seen = 0;
+        for (unsigned i = 0; i < NUM_BUCKETS; ++i) {
+            seen += counts_[i];
+            if (seen > target) return std::min(upperBoundOf(i), max_);
+        }
+        return max_;
+    }
+
+private:
+    static unsigned bucketOf(uint64_t v) {
+        if (v < SUB_BUCKETS) return static_cast<unsigned>(v);
+        unsigned exp = 63 - __builtin_clzll(v);                  // >= 4
+        unsigned sub = static_cast<unsigned>(v >> (exp - 4)) & (SUB_BUCKETS - 1);
+        return std::min(NUM_BUCKETS - 1, SUB_BUCKETS + (exp - 4) * SUB_BUCKETS + sub);
+    }
+
+    static uint64_t upperBoundOf(unsigned idx) {
+        if (idx < SUB_BUCKETS) return idx;
+        unsigned exp = (idx - SUB_BUCKETS) / SUB_BUCKETS + 4;
+        uint64_t sub = (idx - SUB_BUCKETS) % SUB_BUCKETS;
+        return ((SUB_BUCKETS + sub + 1) << (exp - 4)) - 1;
+    }
+
+    std::array<uint64_t, NUM_BUCKETS> counts_{};
+    uint64_t count_{0};
+    uint64_t sum_{0};
+    uint64_t max_{0};
+};
@@ -0,0 +1,109 @@
+#pragma once
+#include "Context.h"
+#include "Scenario.h"
+#include "LatencyHistogram.h"
+#include "Workload.h"
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <ostream>
+#include <queue>
+#include <random>
+#include <string>
+#include <vector>
+
+// phase 하나의 측정 결과
+struct PhaseReport {
+    std::string name;
+    double elapsed_sec{0.0};
+    size_t connections{0};        // phase 종료 시점의 연결 수
+    uint64_t sent{0};             // 보낸 채팅 프레임
+    uint64_t delivered{0};        // 받은 채팅 프레임 (브로드캐스트 팬아웃 포함)
+    uint64_t bytes_sent{0};
+    uint64_t bytes_delivered{0};
+    uint64_t joins{0};
+    uint64_t leaves{0};
+    uint64_t errors{0};           // 연결 실패/끊김
+    LatencyHistogram latency;     // 전송 → 수신 (마이크로초)
+
+    void print(std::ostream& out) const;
+};
+
+// 단일 쓰레드 epoll 부하 엔진: 연결 수천 개를 쓰레드 없이 구동한다.
+// 사용자마다 송신 시각을 미리 정해 두는 open-loop 방식이라 서버가 느려져도
+// 송신 간격이 밀리지 않는다 (지연이 과소 측정되지 않음).
+class LoadEngine {
+public:
+    static constexpr unsigned MAX_EVENTS = 256;
+    static constexpr size_t MAX_OUTBOUND = 64 * 1024;   // 이보다 밀리면 송신을 건너뜀
+
+    LoadEngine(const std::string& host, int port, const std::string& token = "");
+    ~LoadEngine();
+
+    // 방 인원을 phase 설정에 맞춘 뒤 duration 동안 부하를 건다
+    PhaseReport runPhase(const Phase& phase);
+    // 송신 없이 grace_sec 동안 남은 프레임을 받아 report에 합산
+    void drain(PhaseReport& report, double grace_sec);
+    void closeAll();
+
+    LoadEngine(const LoadEngine&) = delete;
+    LoadEngine& operator=(const LoadEngine&) = delete;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct User {
+        int fd{-1};
+        uint32_t generation{0};
+        int32_t room_id{0};
+        bool connected{false};
+        bool want_write{false};
+        std::string outbound;
+        size_t out_offset{0};
+        std::string inbound;
+        Clock::time_point next_send;
+        OnOffSender sender;          // 송신 간격 (고정 또는 Pareto 켜짐/꺼짐)
+    };
+
+    struct RoomState {
+        RoomLoad load;
+        std::vector<size_t> members;   // users_ 인덱스
+        double churn_credit{0.0};
+    };
+
+    struct SendSlot {
+        Clock::time_point when;
+        size_t user;
+        uint32_t generation;
+        bool operator>(const SendSlot& other) const { return when > other.when; }
+    };
+
+    void reconcile(const Phase& phase);
+    bool openUser(int32_t room_id);
+    void closeUser(size_t idx, bool graceful);
+    void startSending(size_t idx, const RoomLoad& load, Clock::time_point now);
+    void scheduleSend(size_t idx, Clock::time_point when);
+    void pump(Clock::time_point until, bool sending);
+    void sendDue(Clock::time_point now);
+    void applyChurn(double dt);
+    void onEvent(size_t idx, uint32_t events);
+    void onConnected(size_t idx);
+    void flush(size_t idx);
+    void receive(size_t idx);
+    void handleFrame(const ChatMessage& message);
+    void updateInterest(size_t idx);
+    void queueFrame(User& user, MessageType type, const void* data, size_t length);
+    size_t connectedCount() const;
+
+    std::string host_;
+    int port_;
+    std::string token_;
+    int epoll_fd_;
+
+    std::vector<User> users_;
+    std::vector<size_t> free_users_;
+    std::map<int32_t, RoomState> rooms_;
+    std::priority_queue<SendSlot, std::vector<SendSlot>, std::greater<SendSlot>> send_queue_;
+    std::mt19937_64 rng_;
+    PhaseReport* report_{nullptr};
+};
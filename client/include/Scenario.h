@@ -0,0 +1,51 @@
+#pragma once
+#include <cstdint>
+#include <istream>
+#include <memory>
+#include <string>
+#include <vector>
+#include "Workload.h"
+
+// 시나리오 파일 형식 (한 줄에 지시어 하나, '#' 이후는 주석)
+//
+//   server 127.0.0.1:8080
+//   phase warmup duration=5
+//     room 1 users=20 rate=1 size=64
+//   phase peak duration=30
+//     room 1 users=200 rate=4 size=256 churn=2
+//
+// phase는 지정한 시간 동안 유지되고, 다음 phase 시작 시 방 인원을 새 값으로 맞춘다
+// (phase에 없는 방의 사용자는 퇴장). churn은 방마다 초당 퇴장 후 재입장 횟수.
+//
+// 운영 형태 부하:
+//   rooms 1-50 users=2000 zipf=1.1 rate=1 burst=1.5 sizes=chat_sizes.txt
+// 방 1~50에 사용자 2000명을 Zipf(s=1.1) 인기도로 나눠 배치한다.
+// burst=<alpha>는 Pareto 켜짐/꺼짐 송신(평균 속도는 rate 유지),
+// sizes=<파일>은 캡처에서 뽑은 크기 분포 (상대 경로는 시나리오 파일 기준).
+
+struct RoomLoad {
+    int32_t room_id{0};
+    size_t users{0};
+    double rate{1.0};        // 사용자당 초당 메시지 수 (0이면 수신만)
+    size_t size{64};         // 메시지 크기 (바이트)
+    double churn{0.0};       // 초당 퇴장/재입장 횟수
+    double burst{0.0};       // Pareto alpha (0이면 고정 간격)
+    std::shared_ptr<const SizeDistribution> sizes;   // 없으면 size 고정
+};
+
+struct Phase {
+    std::string name;
+    double duration_sec{0.0};
+    std::vector<RoomLoad> rooms;
+};
+
+struct Scenario {
+    std::string host{"127.0.0.1"};
+    int port{8080};
+    std::vector<Phase> phases;
+
+    // 문법 오류 시 줄 번호를 포함한 std::runtime_error
+    // base_dir: sizes= 상대 경로의 기준 디렉토리
+    static Scenario parse(std::istream& in, const std::string& base_dir = "");
+    static Scenario load(const std::string& path);
+};
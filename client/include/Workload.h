@@ -0,0 +1,67 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+// 운영 트래픽 형태의 부하 모델: 인기 방 쏠림, 몰아치는 송신, 실제 메시지 크기 분포
+
+// 순위 k(0부터)를 1/(k+1)^s 비율로 뽑는 Zipf 샘플러
+class ZipfSampler {
+public:
+    ZipfSampler(size_t count, double exponent);
+
+    size_t sample(std::mt19937_64& rng) const;
+    double weight(size_t rank) const;   // 순위별 확률
+    size_t size() const { return cdf_.size(); }
+
+    // total을 순위별 확률대로 정수 분배 (최대 나머지 방식, 합계 보존)
+    std::vector<size_t> distribute(size_t total) const;
+
+private:
+    std::vector<double> cdf_;
+};
+
+// 켜짐/꺼짐 송신자: 켜짐 구간에는 빠르게 보내고 꺼짐 구간에는 쉰다.
+// 구간 길이는 Pareto 분포 (alpha가 작을수록 긴 폭주/긴 침묵이 잦음).
+// 장기 평균 송신 속도는 rate로 유지된다.
+class OnOffSender {
+public:
+    static constexpr double DEFAULT_MEAN_ON_SEC = 1.0;
+    static constexpr double DEFAULT_MEAN_OFF_SEC = 2.0;
+
+    OnOffSender() = default;
+    OnOffSender(double rate, double alpha,
+                double mean_on_sec = DEFAULT_MEAN_ON_SEC,
+                double mean_off_sec = DEFAULT_MEAN_OFF_SEC);
+
+    // 다음 송신까지 대기 시간(초). alpha가 0이면 1/rate 고정 간격
+    double nextGap(std::mt19937_64& rng);
+
+private:
+    double pareto(std::mt19937_64& rng, double scale) const;
+
+    double rate_{0.0};
+    double alpha_{0.0};
+    double on_scale_{0.0};
+    double off_scale_{0.0};
+    double peak_gap_{0.0};       // 켜짐 구간의 송신 간격
+    double remaining_on_{-1.0};  // 현재 켜짐 구간의 남은 시간 (<0: 아직 시작 전)
+};
+
+// 캡처에서 읽은 메시지 크기 경험 분포
+// 파일 형식: 한 줄에 "크기" 또는 "크기 개수", '#' 이후는 주석
+class SizeDistribution {
+public:
+    static SizeDistribution load(const std::string& path, size_t max_size);
+
+    size_t sample(std::mt19937_64& rng) const;
+    double mean() const { return mean_; }
+    bool empty() const { return sizes_.empty(); }
+
+private:
+    std::vector<size_t> sizes_;
+    std::vector<uint64_t> cumulative_;
+    double mean_{0.0};
+};
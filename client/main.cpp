@@ -7,13 +7,15 @@
 void printHelp() {
     std::cout << "\n사용 가능한 명령어:\n"
               << "/leave - 채팅방 나가기\n"
+              << "/upload <파일> - 첨부 파일 업로드 (저장되면 digest 출력)\n"
+              << "/download <digest> <파일> - 첨부 파일 다운로드\n"
               << "/quit - 프로그램 종료\n"
               << "/help - 도움말 보기\n" << std::endl;
 }
 
 int main(int argc, char* argv[]) {
-    if (argc != 3) {
-        std::cout << "사용법: " << argv[0] << " <서버IP> <포트>" << std::endl;
+    if (argc != 3 && argc != 4) {
+        std::cout << "사용법: " << argv[0] << " <서버IP> <포트> [세션ID (TCP Fast Open으로 즉시 참가)]" << std::endl;
         return 1;
     }
 
@@ -24,15 +26,18 @@ int main(int argc, char* argv[]) {
     ChatClient client;
     std::atomic<bool> running(true);
 
-    // 콜백 설정
-    client.setMessageCallback([](const std::string& msg) {
-        // 수신된 메시지를 즉시 출력 (버퍼링 없이)
-        std::cout << msg << std::flush;
-    });
+    // 수신은 별도 쓰레드에서 처리하고 이 쓰레드는 명령어 입력을 받는다
+    client.setBackgroundReceive(true);
 
-
-    // 서버 연결
-    if (!client.connect(argv[1], std::stoi(argv[2]))) {
+    // 서버 연결 (세션 ID가 주어지면 SYN에 JOIN을 실어 1-RTT 참가)
+    bool connected = false;
+    if (argc == 4) {
+        client.setFastOpen(true);
+        connected = client.connectAndJoin(argv[1], std::stoi(argv[2]), std::stoi(argv[3]));
+    } else {
+        connected = client.connect(argv[1], std::stoi(argv[2]));
+    }
+    if (!connected) {
         return 1;
     }
 
@@ -52,6 +57,17 @@ int main(int argc, char* argv[]) {
                 printHelp();
             } else if (cmd == "leave") {
                 client.leaveSession();
+            } else if (cmd.rfind("upload ", 0) == 0) {
+                if (!client.uploadAttachment(cmd.substr(7))) {
+                    std::cout << "업로드를 시작할 수 없습니다 (파일 확인, 진행 중인 전송 여부 확인)" << std::endl;
+                }
+            } else if (cmd.rfind("download ", 0) == 0) {
+                std::string args = cmd.substr(9);
+                size_t space = args.find(' ');
+                if (space == std::string::npos ||
+                    !client.downloadAttachment(args.substr(0, space), args.substr(space + 1))) {
+                    std::cout << "사용법: /download <64자리 hex digest> <저장할 파일>" << std::endl;
+                }
             } else {
                 std::cout << "알 수 없는 명령어입니다. /help를 입력하여 도움말을 확인하세요." << std::flush;
             }
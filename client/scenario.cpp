@@ -0,0 +1,75 @@
+#include <iostream>
+#include <cstdlib>
+#include <string>
+#include "Scenario.h"
+#include "LoadEngine.h"
+
+void print_usage(const char* program) {
+    std::cout << "시나리오 부하 실행기\n\n"
+              << "사용법:\n"
+              << "  " << program << " <시나리오 파일> [옵션들]\n\n"
+              << "옵션들:\n"
+              << "  -h, --help                도움말 출력\n"
+              << "  -a, --address <주소>      시나리오의 server 지시어 대신 사용할 주소\n"
+              << "  -g, --grace <시간>        마지막 phase 이후 수신 대기(초) (기본값: 1)\n\n"
+              << "서버 인증 사용 시 CHAT_AUTH_TOKEN 환경 변수의 토큰으로 입장합니다.\n"
+              << std::endl;
+}
+
+int main(int argc, char** argv) {
+    std::string path;
+    std::string address;
+    double grace = 1.0;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "-h" || arg == "--help") {
+            print_usage(argv[0]);
+            return 0;
+        } else if ((arg == "-a" || arg == "--address") && i + 1 < argc) {
+            address = argv[++i];
+        } else if ((arg == "-g" || arg == "--grace") && i + 1 < argc) {
+            grace = std::atof(argv[++i]);
+        } else if (path.empty() && arg[0] != '-') {
+            path = arg;
+        } else {
+            print_usage(argv[0]);
+            return 1;
+        }
+    }
+
+    if (path.empty()) {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    try {
+        Scenario scenario = Scenario::load(path);
+        if (!address.empty()) {
+            size_t colon = address.rfind(':');
+            scenario.host = address.substr(0, colon);
+            if (colon != std::string::npos) {
+                scenario.port = std::stoi(address.substr(colon + 1));
+            }
+        }
+
+        const char* token = std::getenv("CHAT_AUTH_TOKEN");
+        LoadEngine engine(scenario.host, scenario.port, token ? token : "");
+
+        std::cout << "시나리오 " << path << ": " << scenario.phases.size() << " phase, 서버 "
+                  << scenario.host << ":" << scenario.port << std::endl;
+
+        for (size_t i = 0; i < scenario.phases.size(); ++i) {
+            PhaseReport report = engine.runPhase(scenario.phases[i]);
+            if (i + 1 == scenario.phases.size() && grace > 0) {
+                engine.drain(report, grace);
+            }
+            report.print(std::cout);
+        }
+        engine.closeAll();
+    } catch (const std::exception& e) {
+        std::cerr << "오류: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -6,6 +6,10 @@
 #include <iostream>
 #include <cstring>
 #include <sys/select.h>
+#include <sys/sendfile.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <algorithm>
 
 ChatClient::ChatClient() : socket_(-1), running_(false) {}
 
@@ -13,18 +17,27 @@ ChatClient::~ChatClient() {
     disconnect();
 }
 
-bool ChatClient::connect(const std::string& host, int port) {
+bool ChatClient::openSocket(const std::string& host, int port, sockaddr_in& serverAddr) {
     socket_ = socket(AF_INET, SOCK_STREAM, 0);
     if (socket_ < 0) {
         return false;
     }
 
-    sockaddr_in serverAddr{};
+    serverAddr = sockaddr_in{};
     serverAddr.sin_family = AF_INET;
     serverAddr.sin_port = htons(port);
     
     if (inet_pton(AF_INET, host.c_str(), &serverAddr.sin_addr) <= 0) {
         close(socket_);
+        socket_ = -1;
+        return false;
+    }
+    return true;
+}
+
+bool ChatClient::connect(const std::string& host, int port) {
+    sockaddr_in serverAddr;
+    if (!openSocket(host, port, serverAddr)) {
         return false;
     }
 
@@ -36,13 +49,63 @@ bool ChatClient::connect(const std::string& host, int port) {
     running_ = true;
 
     // 메인 루프 시작
-    mainLoop();
+    startLoop();
     return true;
 }
 
+bool ChatClient::connectAndJoin(const std::string& host, int port, int32_t sessionId, const std::string& token) {
+    sockaddr_in serverAddr;
+    if (!openSocket(host, port, serverAddr)) {
+        return false;
+    }
+
+    std::string payload = buildJoinPayload(sessionId, token);
+    ChatMessage message{};
+    if (!buildMessage(message, MessageType::CLIENT_JOIN, payload.data(), payload.size())) {
+        close(socket_);
+        socket_ = -1;
+        return false;
+    }
+
+    if (fastOpen_) {
+        // SYN에 JOIN 프레임을 실어 보냄 (쿠키가 없으면 커널이 일반 3-way 후 전송)
+        ssize_t sent = sendto(socket_, &message, sizeof(message), MSG_FASTOPEN,
+                              reinterpret_cast<sockaddr*>(&serverAddr), sizeof(serverAddr));
+        if (sent != static_cast<ssize_t>(sizeof(message))) {
+            close(socket_);
+            socket_ = -1;
+            return false;
+        }
+    } else {
+        if (::connect(socket_, (struct sockaddr*)&serverAddr, sizeof(serverAddr)) < 0 ||
+            send(socket_, &message, sizeof(message), 0) != static_cast<ssize_t>(sizeof(message))) {
+            close(socket_);
+            socket_ = -1;
+            return false;
+        }
+    }
+
+    running_ = true;
+
+    // 메인 루프 시작
+    startLoop();
+    return true;
+}
+
+void ChatClient::startLoop() {
+    if (background_) {
+        receiveThread_ = std::thread(&ChatClient::mainLoop, this);
+    } else {
+        mainLoop();
+    }
+}
+
 void ChatClient::disconnect() {
+    running_ = false;
+    if (receiveThread_.joinable()) {
+        receiveThread_.join();
+    }
     if (socket_ >= 0) {
-        running_ = false;
         close(socket_);
         socket_ = -1;
     }
@@ -56,7 +119,9 @@ void ChatClient::mainLoop() {
     while (running_) {
         FD_ZERO(&readfds);
         FD_SET(socket_, &readfds);
-        FD_SET(STDIN_FILENO, &readfds);
+        if (!background_) {
+            FD_SET(STDIN_FILENO, &readfds);
+        }
 
         // timeout 설정 (100ms)
         tv.tv_sec = 0;
@@ -74,8 +139,9 @@ void ChatClient::mainLoop() {
 
         // 소켓으로부터 데이터 수신
         if (FD_ISSET(socket_, &readfds)) {
+            // 서버는 여러 프레임을 한 번에 보낼 수 있으므로 프레임 단위로 끊어 읽는다
             ChatMessage message;
-            ssize_t bytesRead = recv(socket_, &message, sizeof(message), 0);
+            ssize_t bytesRead = recv(socket_, &message, sizeof(message), MSG_WAITALL);
             if (bytesRead <= 0) {
                 break;
             }
@@ -90,12 +156,17 @@ void ChatClient::mainLoop() {
                     std::cerr << error_msg << std::endl;
                     continue;
                 }
-                handleMessage(message);
+                if (!handleAttachReply(message)) {
+                    break;
+                }
+                if (message.type != MessageType::SERVER_ATTACH) {
+                    handleMessage(message);
+                }
             }
         }
 
         // 표준 입력 처리 (필요한 경우)
-        if (FD_ISSET(STDIN_FILENO, &readfds)) {
+        if (!background_ && FD_ISSET(STDIN_FILENO, &readfds)) {
             if (fgets(buffer, sizeof(buffer), stdin) != nullptr) {
                 std::string input(buffer);
                 if (!input.empty()) {
@@ -110,24 +181,223 @@ void ChatClient::mainLoop() {
     running_ = false;
 }
 
-bool ChatClient::joinSession(int32_t sessionId) {
-    return sendMessage(MessageType::CLIENT_JOIN, &sessionId, sizeof(sessionId));
+std::string ChatClient::buildJoinPayload(int32_t sessionId, const std::string& token) {
+    // 세션 ID 뒤에 인증 토큰을 붙여 전송 (서버 인증 비활성화 시 무시됨)
+    std::string payload(reinterpret_cast<const char*>(&sessionId), sizeof(sessionId));
+    payload += token;
+    return payload;
+}
+
+bool ChatClient::joinSession(int32_t sessionId, const std::string& token) {
+    std::string payload = buildJoinPayload(sessionId, token);
+    return sendMessage(MessageType::CLIENT_JOIN, payload.data(), payload.size());
 }
 
 bool ChatClient::leaveSession() {
     return sendMessage(MessageType::CLIENT_LEAVE, nullptr, 0);
 }
 
+bool ChatClient::leaveRoom(int32_t roomId) {
+    return sendMessage(MessageType::CLIENT_LEAVE, &roomId, sizeof(roomId));
+}
+
 bool ChatClient::sendChat(const std::string& message) {
     return sendMessage(MessageType::CLIENT_CHAT, message.c_str(), message.length());
 }
 
+bool ChatClient::sendRoomChat(int32_t roomId, const std::string& message) {
+    // 방 ID 뒤에 본문
+    std::string payload(reinterpret_cast<const char*>(&roomId), sizeof(roomId));
+    payload += message;
+    return sendMessage(MessageType::CLIENT_ROOM_CHAT, payload.data(), payload.size());
+}
+
+bool ChatClient::sendCommand(const std::string& command) {
+    return sendMessage(MessageType::CLIENT_COMMAND, command.c_str(), command.length());
+}
+
+bool ChatClient::sendMulticast(const std::vector<int32_t>& roomIds, const std::vector<std::string>& users,
+                               const std::string& message) {
+    // u16 방 수 + 방 ID들, u16 길이 + 쉼표로 이은 사용자 ID, 본문 (server/schema/commands.schema의 Multicast)
+    std::string userList;
+    for (const std::string& user : users) {
+        if (!userList.empty()) {
+            userList += ',';
+        }
+        userList += user;
+    }
+    const uint16_t roomCount = static_cast<uint16_t>(roomIds.size());
+    const uint16_t userLength = static_cast<uint16_t>(userList.size());
+    std::string payload(reinterpret_cast<const char*>(&roomCount), sizeof(roomCount));
+    for (int32_t roomId : roomIds) {
+        payload.append(reinterpret_cast<const char*>(&roomId), sizeof(roomId));
+    }
+    payload.append(reinterpret_cast<const char*>(&userLength), sizeof(userLength));
+    payload += userList;
+    payload += message;
+    return sendMessage(MessageType::CLIENT_MULTICAST, payload.data(), payload.size());
+}
+
+bool ChatClient::uploadAttachment(const std::string& path) {
+    int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    struct stat st;
+    if (fd < 0 || fstat(fd, &st) < 0 || st.st_size <= 0) {
+        if (fd >= 0) {
+            close(fd);
+        }
+        return false;
+    }
+    if (!beginAttach(AttachOp::UPLOAD, fd, static_cast<uint64_t>(st.st_size), path)) {
+        return false;
+    }
+
+    // digest를 0으로 두면 서버가 받은 본문으로 계산해 "attach:stored <hex>"로 알려 준다
+    AttachmentHeader header{};
+    header.size = static_cast<uint64_t>(st.st_size);
+    if (!sendMessage(MessageType::CLIENT_ATTACH_PUT, &header, sizeof(header))) {
+        std::lock_guard<std::mutex> lock(attachMutex_);
+        finishAttach();
+        return false;
+    }
+    return true;
+}
+
+bool ChatClient::downloadAttachment(const std::string& digestHex, const std::string& path) {
+    AttachmentHeader header{};
+    if (!parseDigest(digestHex, header.digest)) {
+        return false;
+    }
+    int fd = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        return false;
+    }
+    if (!beginAttach(AttachOp::DOWNLOAD, fd, 0, path)) {
+        return false;
+    }
+    if (!sendMessage(MessageType::CLIENT_ATTACH_GET, &header, sizeof(header))) {
+        std::lock_guard<std::mutex> lock(attachMutex_);
+        finishAttach();
+        return false;
+    }
+    return true;
+}
+
+bool ChatClient::beginAttach(AttachOp op, int fd, uint64_t size, const std::string& path) {
+    std::lock_guard<std::mutex> lock(attachMutex_);
+    if (attachOp_ != AttachOp::NONE) {
+        close(fd);
+        return false;
+    }
+    attachOp_ = op;
+    attachFd_ = fd;
+    attachSize_ = size;
+    attachPath_ = path;
+    return true;
+}
+
+void ChatClient::finishAttach() {
+    if (attachFd_ >= 0) {
+        close(attachFd_);
+    }
+    attachOp_ = AttachOp::NONE;
+    attachFd_ = -1;
+    attachSize_ = 0;
+    attachPath_.clear();
+}
+
+bool ChatClient::handleAttachReply(const ChatMessage& message) {
+    std::lock_guard<std::mutex> lock(attachMutex_);
+
+    if (message.type == MessageType::SERVER_ATTACH) {
+        AttachmentHeader header{};
+        std::memcpy(&header, message.data, std::min<size_t>(message.length, sizeof(header)));
+
+        // 요청하지 않은 본문이라도 끝까지 읽어야 다음 프레임 경계가 맞는다
+        const int fd = attachOp_ == AttachOp::DOWNLOAD ? attachFd_ : -1;
+        bool written = true;
+        char chunk[64 * 1024];
+        uint64_t left = header.size;
+        while (left > 0) {
+            ssize_t n = recv(socket_, chunk, static_cast<size_t>(std::min<uint64_t>(left, sizeof(chunk))), 0);
+            if (n <= 0) {
+                finishAttach();
+                return false;
+            }
+            if (fd >= 0 && write(fd, chunk, static_cast<size_t>(n)) != n) {
+                written = false;
+            }
+            left -= static_cast<uint64_t>(n);
+        }
+
+        if (fd >= 0) {
+            std::cout << (written ? "attachment saved: " : "attachment write failed: ") << attachPath_
+                      << " (" << header.size << " bytes)" << std::endl;
+            finishAttach();
+        }
+        return true;
+    }
+
+    if (attachOp_ == AttachOp::NONE) {
+        return true;
+    }
+
+    std::string text(message.data, message.length);
+    if (message.type == MessageType::SERVER_ERROR && text.rfind("attach:", 0) == 0) {
+        finishAttach();
+    } else if (message.type == MessageType::SERVER_ACK && attachOp_ == AttachOp::UPLOAD) {
+        if (text.rfind("attach:ready", 0) == 0) {
+            off_t offset = 0;
+            while (offset < static_cast<off_t>(attachSize_)) {
+                if (sendfile(socket_, attachFd_, &offset, attachSize_ - static_cast<uint64_t>(offset)) <= 0) {
+                    finishAttach();
+                    return false;
+                }
+            }
+        } else if (text.rfind("attach:stored", 0) == 0 || text.rfind("attach:exists", 0) == 0) {
+            finishAttach();
+        }
+    }
+    return true;
+}
+
+bool ChatClient::parseDigest(const std::string& hex, uint8_t* digest) {
+    if (hex.size() != 64) {
+        return false;
+    }
+    for (size_t i = 0; i < 32; ++i) {
+        unsigned value = 0;
+        for (size_t j = 0; j < 2; ++j) {
+            char c = hex[i * 2 + j];
+            value <<= 4;
+            if (c >= '0' && c <= '9') value |= static_cast<unsigned>(c - '0');
+            else if (c >= 'a' && c <= 'f') value |= static_cast<unsigned>(c - 'a' + 10);
+            else if (c >= 'A' && c <= 'F') value |= static_cast<unsigned>(c - 'A' + 10);
+            else return false;
+        }
+        digest[i] = static_cast<uint8_t>(value);
+    }
+    return true;
+}
+
 bool ChatClient::sendMessage(MessageType type, const void* data, size_t length) {
     if (socket_ < 0 || !running_) {
         return false;
     }
 
     ChatMessage message{};
+    if (!buildMessage(message, type, data, length)) {
+        return false;
+    }
+
+    ssize_t bytesSent = send(socket_, &message, sizeof(message), 0);
+    if (bytesSent != sizeof(message)) {
+        return false;
+    }
+    
+    return true;
+}
+
+bool ChatClient::buildMessage(ChatMessage& message, MessageType type, const void* data, size_t length) {
     message.type = type;
     message.length = static_cast<uint16_t>(length);
     
@@ -137,17 +407,17 @@ bool ChatClient::sendMessage(MessageType type, const void* data, size_t length)
         }
         std::memcpy(message.data, data, length);
     }
-
-    ssize_t bytesSent = send(socket_, &message, sizeof(message), 0);
-    if (bytesSent != sizeof(message)) {
-        return false;
-    }
-    
     return true;
 }
 
 void ChatClient::handleMessage(const ChatMessage& message) {
     std::string messageData(message.data, message.length);
+
+    // 콜백이 설정되면 출력 대신 콜백으로 전달
+    if (messageCallback_) {
+        messageCallback_(messageData);
+        return;
+    }
     
     // 출력 버퍼링 비활성화
     std::cout.setf(std::ios::unitbuf);
@@ -159,6 +429,17 @@ void ChatClient::handleMessage(const ChatMessage& message) {
             break;
         }
             
+        case MessageType::SERVER_ROOM_CHAT: {
+            // 여러 방에 참가 중일 때: 앞 4바이트가 방 ID
+            if (message.length >= sizeof(int32_t)) {
+                int32_t roomId;
+                std::memcpy(&roomId, message.data, sizeof(roomId));
+                std::cout << "[room " << roomId << "] " << messageData.substr(sizeof(roomId)) << std::endl;
+                std::cout.flush();
+            }
+            break;
+        }
+            
         case MessageType::SERVER_NOTIFICATION: {
             // 세션 참여 메시지는 특별히 처리
             if (messageData.find("세션에 참여") != std::string::npos) {
@@ -186,6 +467,17 @@ void ChatClient::handleMessage(const ChatMessage& message) {
             break;
         }
             
+        case MessageType::SERVER_RECONNECT: {
+            // 서버 종료(드레인) 중: 곧 연결이 닫힌다
+            ReconnectHint hint{};
+            memcpy(&hint, message.data, std::min<size_t>(message.length, sizeof(hint)));
+            hint.address[sizeof(hint.address) - 1] = '\0';
+            std::cout << "서버 종료 예정: " << hint.retry_after_ms << "ms 후 "
+                      << (hint.address[0] ? hint.address : "같은 주소") << "로 재접속하세요" << std::endl;
+            std::cout.flush();
+            break;
+        }
+            
         default: {
             // 알 수 없는 메시지 타입일 경우 메시지 타입 번호도 출력
             std::string error_msg = "알 수 없는 메시지 타입: 0x" + 
@@ -0,0 +1,452 @@
+#include "LoadEngine.h"
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <iomanip>
+#include <stdexcept>
+
+namespace {
+    constexpr const char* TS_TAG = "ts:";
+
+    uint64_t toNanos(std::chrono::steady_clock::time_point tp) {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(tp.time_since_epoch()).count();
+    }
+
+    uint64_t eventKey(size_t idx, uint32_t generation) {
+        return (static_cast<uint64_t>(generation) << 32) | static_cast<uint32_t>(idx);
+    }
+}
+
+void PhaseReport::print(std::ostream& out) const {
+    const double secs = elapsed_sec > 0 ? elapsed_sec : 1.0;
+    out << std::fixed << std::setprecision(1)
+        << "\n[phase " << name << "] " << elapsed_sec << "s, 연결 " << connections
+        << " (입장 " << joins << " / 퇴장 " << leaves << " / 오류 " << errors << ")\n"
+        << "  송신:  " << sent << " msg (" << sent / secs << " msg/s, "
+        << std::setprecision(2) << bytes_sent / secs / (1024 * 1024) << " MB/s)\n"
+        << std::setprecision(1)
+        << "  수신:  " << delivered << " msg (" << delivered / secs << " msg/s, "
+        << std::setprecision(2) << bytes_delivered / secs / (1024 * 1024) << " MB/s)\n"
+        << "  지연:  p50=" << latency.percentile(0.50) << "us p90=" << latency.percentile(0.90)
+        << "us p99=" << latency.percentile(0.99) << "us max=" << latency.max()
+        << "us (평균 " << std::setprecision(1) << latency.mean() << "us, 표본 " << latency.count() << ")"
+        << std::endl;
+}
+
+LoadEngine::LoadEngine(const std::string& host, int port, const std::string& token)
+    : host_(host), port_(port), token_(token), rng_(std::random_device{}()) {
+    epoll_fd_ = epoll_create1(EPOLL_CLOEXEC);
+    if (epoll_fd_ < 0) {
+        throw std::runtime_error("epoll_create1 failed: " + std::string(strerror(errno)));
+    }
+}
+
+LoadEngine::~LoadEngine() {
+    closeAll();
+    close(epoll_fd_);
+}
+
+PhaseReport LoadEngine::runPhase(const Phase& phase) {
+    PhaseReport report;
+    report.name = phase.name;
+    report_ = &report;
+
+    auto start = Clock::now();
+    reconcile(phase);
+    pump(start + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(phase.duration_sec)), true);
+
+    report.elapsed_sec = std::chrono::duration<double>(Clock::now() - start).count();
+    report.connections = connectedCount();
+    report_ = nullptr;
+    return report;
+}
+
+void LoadEngine::drain(PhaseReport& report, double grace_sec) {
+    report_ = &report;
+    pump(Clock::now() + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(grace_sec)), false);
+    report_ = nullptr;
+}
+
+void LoadEngine::closeAll() {
+    for (size_t i = 0; i < users_.size(); ++i) {
+        if (users_[i].fd >= 0) closeUser(i, true);
+    }
+    rooms_.clear();
+    send_queue_ = {};
+}
+
+void LoadEngine::reconcile(const Phase& phase) {
+    // phase에 없는 방은 비움
+    for (auto it = rooms_.begin(); it != rooms_.end();) {
+        bool kept = std::any_of(phase.rooms.begin(), phase.rooms.end(),
+                                [&](const RoomLoad& r) { return r.room_id == it->first; });
+        if (!kept) {
+            while (!it->second.members.empty()) {
+                closeUser(it->second.members.back(), true);
+                report_->leaves++;
+            }
+            it = rooms_.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    for (const auto& load : phase.rooms) {
+        RoomState& room = rooms_[load.room_id];
+        room.load = load;
+        room.churn_credit = 0.0;
+        while (room.members.size() > load.users) {
+            closeUser(room.members.back(), true);
+            report_->leaves++;
+        }
+        while (room.members.size() < load.users) {
+            if (!openUser(load.room_id)) break;
+            report_->joins++;
+        }
+    }
+
+    // 새 송신 속도로 일정 재구성
+    send_queue_ = {};
+    auto now = Clock::now();
+    for (const auto& [room_id, room] : rooms_) {
+        for (size_t idx : room.members) {
+            startSending(idx, room.load, now);
+        }
+    }
+}
+
+void LoadEngine::startSending(size_t idx, const RoomLoad& load, Clock::time_point now) {
+    if (load.rate <= 0) return;
+
+    User& user = users_[idx];
+    user.sender = OnOffSender(load.rate, load.burst);
+
+    // 첫 송신은 한 주기 안에서 고르게 분산 (켜짐/꺼짐 송신자는 시작 위치가 이미 무작위)
+    double first = load.burst > 0
+        ? user.sender.nextGap(rng_)
+        : std::uniform_real_distribution<double>(0.0, 1.0 / load.rate)(rng_);
+    scheduleSend(idx, now + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(first)));
+}
+
+bool LoadEngine::openUser(int32_t room_id) {
+    int fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        report_->errors++;
+        return false;
+    }
+
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port_);
+    if (inet_pton(AF_INET, host_.c_str(), &addr.sin_addr) <= 0) {
+        close(fd);
+        throw std::runtime_error("invalid server address: " + host_);
+    }
+
+    int enable = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &enable, sizeof(enable));
+
+    if (::connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0 && errno != EINPROGRESS) {
+        close(fd);
+        report_->errors++;
+        return false;
+    }
+
+    size_t idx;
+    if (!free_users_.empty()) {
+        idx = free_users_.back();
+        free_users_.pop_back();
+    } else {
+        idx = users_.size();
+        users_.emplace_back();
+    }
+
+    User& user = users_[idx];
+    user.fd = fd;
+    user.room_id = room_id;
+    user.connected = false;
+    user.want_write = true;
+
+    // 연결되면 바로 나갈 JOIN 프레임 (Listener가 이 프레임을 보고 방을 배정)
+    std::string payload(reinterpret_cast<const char*>(&room_id), sizeof(room_id));
+    payload += token_;
+    queueFrame(user, MessageType::CLIENT_JOIN, payload.data(), payload.size());
+
+    epoll_event ev{};
+    ev.events = EPOLLIN | EPOLLOUT;
+    ev.data.u64 = eventKey(idx, user.generation);
+    if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &ev) < 0) {
+        close(fd);
+        user.fd = -1;
+        free_users_.push_back(idx);
+        report_->errors++;
+        return false;
+    }
+
+    rooms_[room_id].members.push_back(idx);
+    return true;
+}
+
+void LoadEngine::closeUser(size_t idx, bool graceful) {
+    User& user = users_[idx];
+    if (user.fd < 0) return;
+
+    if (graceful && user.connected) {
+        // 퇴장 통보는 best-effort (송신 버퍼가 차 있으면 생략)
+        ChatMessage message{};
+        message.type = MessageType::CLIENT_LEAVE;
+        send(user.fd, &message, sizeof(message), MSG_NOSIGNAL | MSG_DONTWAIT);
+    }
+
+    close(user.fd);
+    user.fd = -1;
+    user.generation++;       // 큐에 남은 송신 일정/epoll 이벤트 무효화
+    user.connected = false;
+    user.outbound.clear();
+    user.out_offset = 0;
+    user.inbound.clear();
+
+    auto room = rooms_.find(user.room_id);
+    if (room != rooms_.end()) {
+        auto& members = room->second.members;
+        auto it = std::find(members.begin(), members.end(), idx);
+        if (it != members.end()) {
+            *it = members.back();
+            members.pop_back();
+        }
+    }
+    free_users_.push_back(idx);
+}
+
+void LoadEngine::scheduleSend(size_t idx, Clock::time_point when) {
+    users_[idx].next_send = when;
+    send_queue_.push({when, idx, users_[idx].generation});
+}
+
+void LoadEngine::pump(Clock::time_point until, bool sending) {
+    epoll_event events[MAX_EVENTS];
+    auto last = Clock::now();
+
+    while (true) {
+        auto now = Clock::now();
+        if (now >= until) break;
+
+        if (sending) {
+            sendDue(now);
+            applyChurn(std::chrono::duration<double>(now - last).count());
+        }
+        last = now;
+
+        // 다음 송신 시각까지 대기 (churn 처리를 위해 최대 10ms)
+        auto wake = std::min(until, now + std::chrono::milliseconds(10));
+        if (sending && !send_queue_.empty()) wake = std::min(wake, send_queue_.top().when);
+        int timeout_ms = static_cast<int>(
+            std::chrono::duration_cast<std::chrono::milliseconds>(wake - now).count());
+
+        int n = epoll_wait(epoll_fd_, events, MAX_EVENTS, std::max(timeout_ms, 0));
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            throw std::runtime_error("epoll_wait failed: " + std::string(strerror(errno)));
+        }
+
+        for (int i = 0; i < n; ++i) {
+            size_t idx = static_cast<uint32_t>(events[i].data.u64);
+            uint32_t generation = static_cast<uint32_t>(events[i].data.u64 >> 32);
+            if (idx < users_.size() && users_[idx].fd >= 0 && users_[idx].generation == generation) {
+                onEvent(idx, events[i].events);
+            }
+        }
+    }
+}
+
+void LoadEngine::sendDue(Clock::time_point now) {
+    while (!send_queue_.empty() && send_queue_.top().when <= now) {
+        SendSlot slot = send_queue_.top();
+        send_queue_.pop();
+
+        User& user = users_[slot.user];
+        if (user.fd < 0 || user.generation != slot.generation) continue;
+
+        const RoomLoad& load = rooms_[user.room_id].load;
+        if (load.rate <= 0) continue;
+
+        // 서버가 밀려 송신 버퍼가 쌓이면 이번 차례는 건너뜀 (연결 전이면 대기)
+        if (user.connected && user.outbound.size() - user.out_offset < MAX_OUTBOUND) {
+            // 예정 시각을 타임스탬프로 사용: 송신이 늦어진 시간도 지연에 포함
+            std::string payload = "test_message_" + std::string(TS_TAG) + std::to_string(toNanos(slot.when)) +
+                                  ",room:" + std::to_string(user.room_id) + ",data:";
+            size_t size = load.sizes ? load.sizes->sample(rng_) : load.size;
+            if (payload.size() < size) payload.append(size - payload.size(), 'a');
+            if (payload.size() > sizeof(ChatMessage::data)) payload.resize(sizeof(ChatMessage::data));
+
+            queueFrame(user, MessageType::CLIENT_CHAT, payload.data(), payload.size());
+            report_->sent++;
+            report_->bytes_sent += payload.size();
+            flush(slot.user);
+        }
+
+        // 1초 이상 밀렸으면 따라잡기 폭주 대신 현재 시각부터 재개
+        auto next = slot.when + std::chrono::duration_cast<Clock::duration>(
+                                    std::chrono::duration<double>(users_[slot.user].sender.nextGap(rng_)));
+        if (next + std::chrono::seconds(1) < now) next = now;
+        if (users_[slot.user].generation == slot.generation) scheduleSend(slot.user, next);
+    }
+}
+
+void LoadEngine::applyChurn(double dt) {
+    for (auto& [room_id, room] : rooms_) {
+        if (room.load.churn <= 0) continue;
+        room.churn_credit += room.load.churn * dt;
+
+        while (room.churn_credit >= 1.0 && !room.members.empty()) {
+            room.churn_credit -= 1.0;
+            std::uniform_int_distribution<size_t> pick(0, room.members.size() - 1);
+            closeUser(room.members[pick(rng_)], true);
+            report_->leaves++;
+
+            if (openUser(room_id)) {
+                report_->joins++;
+                startSending(room.members.back(), room.load, Clock::now());
+            }
+        }
+        if (room.members.empty()) room.churn_credit = 0.0;
+    }
+}
+
+void LoadEngine::onEvent(size_t idx, uint32_t events) {
+    if (!users_[idx].connected) {
+        if (!(events & (EPOLLOUT | EPOLLERR | EPOLLHUP))) return;
+        onConnected(idx);
+        return;
+    }
+
+    if (events & EPOLLIN) {
+        receive(idx);
+        if (users_[idx].fd < 0) return;
+    }
+    if (events & (EPOLLERR | EPOLLHUP)) {
+        report_->errors++;
+        closeUser(idx, false);
+        return;
+    }
+    if (events & EPOLLOUT) {
+        flush(idx);
+    }
+}
+
+void LoadEngine::onConnected(size_t idx) {
+    User& user = users_[idx];
+    int err = 0;
+    socklen_t len = sizeof(err);
+    if (getsockopt(user.fd, SOL_SOCKET, SO_ERROR, &err, &len) < 0 || err != 0) {
+        report_->errors++;
+        closeUser(idx, false);
+        return;
+    }
+    user.connected = true;
+    flush(idx);
+}
+
+void LoadEngine::flush(size_t idx) {
+    User& user = users_[idx];
+    while (user.out_offset < user.outbound.size()) {
+        ssize_t n = send(user.fd, user.outbound.data() + user.out_offset,
+                         user.outbound.size() - user.out_offset, MSG_NOSIGNAL);
+        if (n < 0) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK) break;
+            if (errno == EINTR) continue;
+            report_->errors++;
+            closeUser(idx, false);
+            return;
+        }
+        user.out_offset += static_cast<size_t>(n);
+    }
+
+    if (user.out_offset == user.outbound.size()) {
+        user.outbound.clear();
+        user.out_offset = 0;
+    }
+    updateInterest(idx);
+}
+
+void LoadEngine::receive(size_t idx) {
+    char buffer[64 * 1024];
+    User& user = users_[idx];
+
+    while (true) {
+        ssize_t n = recv(user.fd, buffer, sizeof(buffer), 0);
+        if (n > 0) {
+            user.inbound.append(buffer, static_cast<size_t>(n));
+            continue;
+        }
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) break;
+        if (n < 0 && errno == EINTR) continue;
+
+        // 서버가 연결을 끊음
+        report_->errors++;
+        closeUser(idx, false);
+        return;
+    }
+
+    // 고정 크기 프레임 단위로 처리, 남은 조각은 다음 수신까지 보관
+    size_t consumed = 0;
+    while (user.inbound.size() - consumed >= sizeof(ChatMessage)) {
+        ChatMessage message;
+        std::memcpy(&message, user.inbound.data() + consumed, sizeof(message));
+        handleFrame(message);
+        consumed += sizeof(ChatMessage);
+    }
+    user.inbound.erase(0, consumed);
+}
+
+void LoadEngine::handleFrame(const ChatMessage& message) {
+    if (message.type != MessageType::SERVER_CHAT) return;
+
+    size_t length = std::min<size_t>(message.length, sizeof(message.data));
+    report_->delivered++;
+    report_->bytes_delivered += length;
+
+    std::string content(message.data, length);
+    size_t pos = content.find(TS_TAG);
+    if (pos == std::string::npos) return;
+
+    uint64_t sent_ns = std::strtoull(content.c_str() + pos + std::strlen(TS_TAG), nullptr, 10);
+    uint64_t now_ns = toNanos(Clock::now());
+    if (sent_ns > 0 && now_ns >= sent_ns) {
+        report_->latency.record((now_ns - sent_ns) / 1000);
+    }
+}
+
+void LoadEngine::updateInterest(size_t idx) {
+    User& user = users_[idx];
+    bool want_write = !user.outbound.empty();
+    if (want_write == user.want_write) return;
+
+    epoll_event ev{};
+    ev.events = want_write ? (EPOLLIN | EPOLLOUT) : EPOLLIN;
+    ev.data.u64 = eventKey(idx, user.generation);
+    if (epoll_ctl(epoll_fd_, EPOLL_CTL_MOD, user.fd, &ev) == 0) {
+        user.want_write = want_write;
+    }
+}
+
+void LoadEngine::queueFrame(User& user, MessageType type, const void* data, size_t length) {
+    ChatMessage message{};
+    message.type = type;
+    message.length = static_cast<uint16_t>(std::min(length, sizeof(message.data)));
+    if (data && message.length > 0) {
+        std::memcpy(message.data, data, message.length);
+    }
+    user.outbound.append(reinterpret_cast<const char*>(&message), sizeof(message));
+}
+
+size_t LoadEngine::connectedCount() const {
+    return std::count_if(users_.begin(), users_.end(),
+                         [](const User& user) { return user.fd >= 0 && user.connected; });
+}
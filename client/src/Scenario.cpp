@@ -0,0 +1,201 @@
+#include "Scenario.h"
+#include "Context.h"
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+namespace {
+    std::runtime_error parseError(size_t line_no, const std::string& what) {
+        return std::runtime_error("scenario line " + std::to_string(line_no) + ": " + what);
+    }
+
+    // "key=value" 토큰 분리
+    bool splitOption(const std::string& token, std::string& key, std::string& value) {
+        size_t eq = token.find('=');
+        if (eq == std::string::npos || eq == 0) return false;
+        key = token.substr(0, eq);
+        value = token.substr(eq + 1);
+        return true;
+    }
+
+    double toNumber(const std::string& value, size_t line_no, const std::string& key) {
+        try {
+            size_t used = 0;
+            double result = std::stod(value, &used);
+            if (used != value.size() || result < 0) throw std::invalid_argument(value);
+            return result;
+        } catch (const std::exception&) {
+            throw parseError(line_no, "invalid value for '" + key + "': " + value);
+        }
+    }
+
+    void parseServer(std::istringstream& ss, size_t line_no, Scenario& scenario) {
+        std::string address;
+        if (!(ss >> address)) throw parseError(line_no, "server requires host:port");
+        size_t colon = address.rfind(':');
+        if (colon == std::string::npos) throw parseError(line_no, "server requires host:port");
+        scenario.host = address.substr(0, colon);
+        scenario.port = static_cast<int>(toNumber(address.substr(colon + 1), line_no, "port"));
+    }
+
+    void parsePhase(std::istringstream& ss, size_t line_no, Scenario& scenario) {
+        Phase phase;
+        if (!(ss >> phase.name)) throw parseError(line_no, "phase requires a name");
+
+        std::string token, key, value;
+        while (ss >> token) {
+            if (!splitOption(token, key, value)) throw parseError(line_no, "expected key=value: " + token);
+            if (key == "duration") {
+                phase.duration_sec = toNumber(value, line_no, key);
+            } else {
+                throw parseError(line_no, "unknown phase option: " + key);
+            }
+        }
+        if (phase.duration_sec <= 0) throw parseError(line_no, "phase requires duration > 0");
+        scenario.phases.push_back(std::move(phase));
+    }
+
+    std::string resolvePath(const std::string& base_dir, const std::string& path) {
+        if (base_dir.empty() || path.empty() || path[0] == '/') return path;
+        return base_dir + "/" + path;
+    }
+
+    // room/rooms 공통 옵션. 처리한 키면 true
+    bool applyRoomOption(RoomLoad& room, const std::string& key, const std::string& value,
+                         size_t line_no, const std::string& base_dir) {
+        if (key == "sizes") {
+            try {
+                room.sizes = std::make_shared<const SizeDistribution>(
+                    SizeDistribution::load(resolvePath(base_dir, value), sizeof(ChatMessage::data)));
+            } catch (const std::exception& e) {
+                throw parseError(line_no, e.what());
+            }
+            return true;
+        }
+
+        double number = toNumber(value, line_no, key);
+        if (key == "users") {
+            room.users = static_cast<size_t>(number);
+        } else if (key == "rate") {
+            room.rate = number;
+        } else if (key == "size") {
+            room.size = static_cast<size_t>(number);
+        } else if (key == "churn") {
+            room.churn = number;
+        } else if (key == "burst") {
+            if (number != 0 && number <= 1.0) throw parseError(line_no, "burst (Pareto alpha) must be > 1");
+            room.burst = number;
+        } else {
+            return false;
+        }
+        return true;
+    }
+
+    void addRoom(Scenario& scenario, const RoomLoad& room, size_t line_no) {
+        if (room.size > sizeof(ChatMessage::data)) {
+            throw parseError(line_no, "size exceeds " + std::to_string(sizeof(ChatMessage::data)) + " bytes");
+        }
+        for (const auto& existing : scenario.phases.back().rooms) {
+            if (existing.room_id == room.room_id) {
+                throw parseError(line_no, "duplicate room " + std::to_string(room.room_id));
+            }
+        }
+        scenario.phases.back().rooms.push_back(room);
+    }
+
+    void parseRoom(std::istringstream& ss, size_t line_no, Scenario& scenario, const std::string& base_dir) {
+        if (scenario.phases.empty()) throw parseError(line_no, "room outside of a phase");
+
+        RoomLoad room;
+        std::string id;
+        if (!(ss >> id)) throw parseError(line_no, "room requires an id");
+        room.room_id = static_cast<int32_t>(toNumber(id, line_no, "room"));
+
+        std::string token, key, value;
+        while (ss >> token) {
+            if (!splitOption(token, key, value)) throw parseError(line_no, "expected key=value: " + token);
+            if (!applyRoomOption(room, key, value, line_no, base_dir)) {
+                throw parseError(line_no, "unknown room option: " + key);
+            }
+        }
+        addRoom(scenario, room, line_no);
+    }
+
+    // rooms <첫 방>-<마지막 방> users=<전체> zipf=<s> ...: 인기도 순위 = 방 번호 순
+    void parseRooms(std::istringstream& ss, size_t line_no, Scenario& scenario, const std::string& base_dir) {
+        if (scenario.phases.empty()) throw parseError(line_no, "rooms outside of a phase");
+
+        std::string range;
+        if (!(ss >> range)) throw parseError(line_no, "rooms requires a range (first-last)");
+        size_t dash = range.find('-', 1);
+        if (dash == std::string::npos) throw parseError(line_no, "rooms requires a range (first-last)");
+        int32_t first = static_cast<int32_t>(toNumber(range.substr(0, dash), line_no, "rooms"));
+        int32_t last = static_cast<int32_t>(toNumber(range.substr(dash + 1), line_no, "rooms"));
+        if (last < first) throw parseError(line_no, "empty room range: " + range);
+
+        RoomLoad shared;
+        double exponent = 1.0;
+        std::string token, key, value;
+        while (ss >> token) {
+            if (!splitOption(token, key, value)) throw parseError(line_no, "expected key=value: " + token);
+            if (key == "zipf") {
+                exponent = toNumber(value, line_no, key);
+            } else if (!applyRoomOption(shared, key, value, line_no, base_dir)) {
+                throw parseError(line_no, "unknown rooms option: " + key);
+            }
+        }
+
+        ZipfSampler zipf(static_cast<size_t>(last - first) + 1, exponent);
+        std::vector<size_t> users = zipf.distribute(shared.users);
+        for (size_t rank = 0; rank < users.size(); ++rank) {
+            RoomLoad room = shared;
+            room.room_id = first + static_cast<int32_t>(rank);
+            room.users = users[rank];
+            // churn은 전체 값을 인원 비율대로 나눔
+            room.churn = shared.churn * zipf.weight(rank);
+            addRoom(scenario, room, line_no);
+        }
+    }
+}
+
+Scenario Scenario::parse(std::istream& in, const std::string& base_dir) {
+    Scenario scenario;
+    std::string line;
+    size_t line_no = 0;
+
+    while (std::getline(in, line)) {
+        ++line_no;
+        size_t hash = line.find('#');
+        if (hash != std::string::npos) line.erase(hash);
+
+        std::istringstream ss(line);
+        std::string directive;
+        if (!(ss >> directive)) continue;
+
+        if (directive == "server") {
+            parseServer(ss, line_no, scenario);
+        } else if (directive == "phase") {
+            parsePhase(ss, line_no, scenario);
+        } else if (directive == "room") {
+            parseRoom(ss, line_no, scenario, base_dir);
+        } else if (directive == "rooms") {
+            parseRooms(ss, line_no, scenario, base_dir);
+        } else {
+            throw parseError(line_no, "unknown directive: " + directive);
+        }
+    }
+
+    if (scenario.phases.empty()) {
+        throw std::runtime_error("scenario has no phases");
+    }
+    return scenario;
+}
+
+Scenario Scenario::load(const std::string& path) {
+    std::ifstream file(path);
+    if (!file) {
+        throw std::runtime_error("cannot open scenario file: " + path);
+    }
+    size_t slash = path.rfind('/');
+    return parse(file, slash == std::string::npos ? "" : path.substr(0, slash));
+}
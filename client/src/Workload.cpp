@@ -0,0 +1,143 @@
+#include "Workload.h"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+
+ZipfSampler::ZipfSampler(size_t count, double exponent) {
+    if (count == 0) {
+        throw std::invalid_argument("zipf: count must be > 0");
+    }
+    cdf_.resize(count);
+    double sum = 0.0;
+    for (size_t k = 0; k < count; ++k) {
+        sum += 1.0 / std::pow(static_cast<double>(k + 1), exponent);
+        cdf_[k] = sum;
+    }
+    for (auto& value : cdf_) value /= sum;
+    cdf_.back() = 1.0;
+}
+
+size_t ZipfSampler::sample(std::mt19937_64& rng) const {
+    double u = std::uniform_real_distribution<double>(0.0, 1.0)(rng);
+    auto it = std::lower_bound(cdf_.begin(), cdf_.end(), u);
+    return std::min<size_t>(it - cdf_.begin(), cdf_.size() - 1);
+}
+
+double ZipfSampler::weight(size_t rank) const {
+    return rank == 0 ? cdf_[0] : cdf_[rank] - cdf_[rank - 1];
+}
+
+std::vector<size_t> ZipfSampler::distribute(size_t total) const {
+    std::vector<size_t> counts(cdf_.size());
+    std::vector<std::pair<double, size_t>> remainders;
+    size_t assigned = 0;
+
+    for (size_t k = 0; k < cdf_.size(); ++k) {
+        double exact = weight(k) * total;
+        counts[k] = static_cast<size_t>(exact);
+        assigned += counts[k];
+        remainders.emplace_back(exact - counts[k], k);
+    }
+
+    std::sort(remainders.begin(), remainders.end(),
+              [](const auto& a, const auto& b) { return a.first > b.first; });
+    for (size_t i = 0; assigned < total && i < remainders.size(); ++i, ++assigned) {
+        counts[remainders[i].second]++;
+    }
+    return counts;
+}
+
+OnOffSender::OnOffSender(double rate, double alpha, double mean_on_sec, double mean_off_sec)
+    : rate_(rate), alpha_(alpha) {
+    if (alpha_ > 0 && alpha_ <= 1.0) {
+        throw std::invalid_argument("burst: Pareto alpha must be > 1 (finite mean)");
+    }
+    // Pareto 평균 = alpha * scale / (alpha - 1)
+    if (alpha_ > 0) {
+        on_scale_ = mean_on_sec * (alpha_ - 1.0) / alpha_;
+        off_scale_ = mean_off_sec * (alpha_ - 1.0) / alpha_;
+        // 켜짐 비율만큼 속도를 올려 장기 평균을 rate로 맞춤
+        double peak_rate = rate_ * (mean_on_sec + mean_off_sec) / mean_on_sec;
+        peak_gap_ = peak_rate > 0 ? 1.0 / peak_rate : 0.0;
+    }
+}
+
+double OnOffSender::pareto(std::mt19937_64& rng, double scale) const {
+    double u = std::uniform_real_distribution<double>(0.0, 1.0)(rng);
+    return scale / std::pow(1.0 - u, 1.0 / alpha_);
+}
+
+double OnOffSender::nextGap(std::mt19937_64& rng) {
+    if (rate_ <= 0) return 0.0;
+    if (alpha_ <= 0) return 1.0 / rate_;
+
+    if (remaining_on_ < 0) {
+        // 시작 위치를 켜짐/꺼짐 구간 어디쯤으로 흩어 사용자 간 동기화 방지
+        remaining_on_ = pareto(rng, on_scale_) * std::uniform_real_distribution<double>(0.0, 1.0)(rng);
+    }
+
+    if (remaining_on_ >= peak_gap_) {
+        remaining_on_ -= peak_gap_;
+        return peak_gap_;
+    }
+
+    // 켜짐 구간 종료 → 쉬었다가 새 구간 시작
+    double gap = remaining_on_ + pareto(rng, off_scale_);
+    remaining_on_ = pareto(rng, on_scale_);
+    return gap;
+}
+
+SizeDistribution SizeDistribution::load(const std::string& path, size_t max_size) {
+    std::ifstream file(path);
+    if (!file) {
+        throw std::runtime_error("cannot open size capture: " + path);
+    }
+
+    std::map<size_t, uint64_t> histogram;
+    std::string line;
+    size_t line_no = 0;
+    while (std::getline(file, line)) {
+        ++line_no;
+        size_t hash = line.find('#');
+        if (hash != std::string::npos) line.erase(hash);
+
+        std::istringstream ss(line);
+        long long size;
+        if (!(ss >> size)) {
+            if (line.find_first_not_of(" \t\r") == std::string::npos) continue;
+            throw std::runtime_error(path + ":" + std::to_string(line_no) + ": expected a size");
+        }
+        long long count = 1;
+        if (!(ss >> count)) count = 1;
+        if (size <= 0 || count <= 0) {
+            throw std::runtime_error(path + ":" + std::to_string(line_no) + ": size and count must be > 0");
+        }
+        // 프레임 한 개에 담을 수 없는 크기는 최대값으로 절단
+        histogram[std::min<size_t>(size, max_size)] += count;
+    }
+
+    if (histogram.empty()) {
+        throw std::runtime_error("size capture is empty: " + path);
+    }
+
+    SizeDistribution dist;
+    uint64_t total = 0;
+    double weighted = 0.0;
+    for (const auto& [size, count] : histogram) {
+        total += count;
+        weighted += static_cast<double>(size) * count;
+        dist.sizes_.push_back(size);
+        dist.cumulative_.push_back(total);
+    }
+    dist.mean_ = weighted / total;
+    return dist;
+}
+
+size_t SizeDistribution::sample(std::mt19937_64& rng) const {
+    uint64_t pick = std::uniform_int_distribution<uint64_t>(0, cumulative_.back() - 1)(rng);
+    auto it = std::upper_bound(cumulative_.begin(), cumulative_.end(), pick);
+    return sizes_[it - cumulative_.begin()];
+}
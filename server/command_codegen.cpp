@@ -0,0 +1,636 @@
+// 명령 스키마(server/schema/commands.schema) → 헤더 전용 코덱(CommandCodec.h) 생성기.
+// 메시지마다 수신 버퍼 위에서 바로 읽는 View(parse에서 길이를 한 번 검사한 뒤 복사 없이 필드 접근)와
+// 송신 프레임(ChatMessage)에 바로 쓰는 Builder를 만든다. 빌드 중 CMake가 실행한다:
+//   chat_command_codegen <schema> <output.h>
+#include <cctype>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+    constexpr unsigned MAX_OPCODE = 0x1F;   // 0x20 이상은 텍스트 명령의 첫 글자
+
+    enum class FieldKind { INTEGER, BYTES, STRING, LIST, TAIL };
+
+    struct Field {
+        FieldKind kind;
+        std::string name;
+        std::string type;      // INTEGER: C++ 타입, LIST: struct 이름
+        size_t size{0};        // 고정 길이 필드의 바이트 수
+        size_t offset{0};      // 고정 길이 필드의 위치 (opcode 포함)
+        size_t var_index{0};   // 가변 필드 순번
+    };
+
+    enum class MessageKind { STRUCT, PAYLOAD, REQUEST, REPLY };
+
+    struct Message {
+        MessageKind kind;
+        std::string name;      // 생성되는 클래스 이름
+        int opcode{-1};
+        std::vector<Field> fields;
+        size_t fixed_size{0};
+        size_t var_count{0};
+        bool has_tail{false};
+    };
+
+    const std::map<std::string, std::pair<std::string, size_t>> INTEGER_TYPES = {
+        {"u8", {"uint8_t", 1}}, {"u16", {"uint16_t", 2}}, {"u32", {"uint32_t", 4}}, {"u64", {"uint64_t", 8}},
+        {"i8", {"int8_t", 1}}, {"i16", {"int16_t", 2}}, {"i32", {"int32_t", 4}}, {"i64", {"int64_t", 8}},
+    };
+
+    struct Token {
+        std::string text;
+        size_t line;
+    };
+
+    std::vector<Token> tokenize(std::istream& in) {
+        std::vector<Token> tokens;
+        std::string line;
+        size_t line_number = 0;
+        while (std::getline(in, line)) {
+            ++line_number;
+            line = line.substr(0, line.find('#'));
+            for (size_t i = 0; i < line.size();) {
+                const char c = line[i];
+                if (std::isspace(static_cast<unsigned char>(c))) {
+                    ++i;
+                } else if (std::isalnum(static_cast<unsigned char>(c)) || c == '_') {
+                    size_t end = i;
+                    while (end < line.size() && (std::isalnum(static_cast<unsigned char>(line[end])) || line[end] == '_')) {
+                        ++end;
+                    }
+                    tokens.push_back(Token{line.substr(i, end - i), line_number});
+                    i = end;
+                } else if (std::string("{};=<>[]").find(c) != std::string::npos) {
+                    tokens.push_back(Token{std::string(1, c), line_number});
+                    ++i;
+                } else {
+                    throw std::runtime_error("line " + std::to_string(line_number) + ": unexpected '" + c + "'");
+                }
+            }
+        }
+        return tokens;
+    }
+
+    class Parser {
+    public:
+        explicit Parser(std::vector<Token> tokens) : tokens_(std::move(tokens)) {}
+
+        std::vector<Message> parse() {
+            std::vector<Message> messages;
+            std::set<std::string> structs;
+            while (pos_ < tokens_.size()) {
+                messages.push_back(parseMessage(structs));
+            }
+            return messages;
+        }
+
+    private:
+        std::vector<Token> tokens_;
+        size_t pos_{0};
+
+        [[noreturn]] void fail(const std::string& what) const {
+            const size_t line = pos_ < tokens_.size() ? tokens_[pos_].line : (tokens_.empty() ? 0 : tokens_.back().line);
+            throw std::runtime_error("line " + std::to_string(line) + ": " + what);
+        }
+
+        const std::string& next() {
+            if (pos_ >= tokens_.size()) {
+                fail("unexpected end of schema");
+            }
+            return tokens_[pos_++].text;
+        }
+
+        const std::string& peek() const {
+            static const std::string END;
+            return pos_ < tokens_.size() ? tokens_[pos_].text : END;
+        }
+
+        void expect(const std::string& text) {
+            if (peek() != text) {
+                fail("expected '" + text + "', got '" + peek() + "'");
+            }
+            ++pos_;
+        }
+
+        Message parseMessage(std::set<std::string>& structs) {
+            Message message;
+            const std::string keyword = next();
+            const std::string name = next();
+            if (keyword == "struct") {
+                message.kind = MessageKind::STRUCT;
+                message.name = name;
+            } else if (keyword == "payload") {
+                message.kind = MessageKind::PAYLOAD;
+                message.name = name;
+            } else if (keyword == "request" || keyword == "reply") {
+                message.kind = keyword == "request" ? MessageKind::REQUEST : MessageKind::REPLY;
+                message.name = name + (keyword == "request" ? "Request" : "Reply");
+                expect("=");
+                const unsigned long opcode = std::stoul(next(), nullptr, 0);
+                if (opcode == 0 || opcode > MAX_OPCODE) {
+                    fail("opcode of " + name + " must be 0x01..0x1F");
+                }
+                message.opcode = static_cast<int>(opcode);
+                message.fixed_size = 1;
+            } else {
+                fail("unknown declaration '" + keyword + "'");
+            }
+
+            expect("{");
+            while (peek() != "}") {
+                message.fields.push_back(parseField(message, structs));
+                expect(";");
+            }
+            expect("}");
+
+            if (message.kind == MessageKind::STRUCT) {
+                structs.insert(message.name);
+            }
+            return message;
+        }
+
+        Field parseField(Message& message, const std::set<std::string>& structs) {
+            if (message.has_tail) {
+                fail("tail must be the last field of " + message.name);
+            }
+
+            Field field;
+            const std::string type = next();
+            if (INTEGER_TYPES.count(type)) {
+                field.kind = FieldKind::INTEGER;
+                field.type = INTEGER_TYPES.at(type).first;
+                field.size = INTEGER_TYPES.at(type).second;
+            } else if (type == "bytes") {
+                expect("[");
+                field.kind = FieldKind::BYTES;
+                field.size = std::stoul(next(), nullptr, 0);
+                expect("]");
+            } else if (type == "string" || type == "tail") {
+                field.kind = type == "string" ? FieldKind::STRING : FieldKind::TAIL;
+            } else if (type == "list") {
+                expect("<");
+                field.kind = FieldKind::LIST;
+                field.type = next();
+                if (!structs.count(field.type)) {
+                    fail("unknown struct '" + field.type + "'");
+                }
+                expect(">");
+            } else {
+                fail("unknown type '" + type + "'");
+            }
+            field.name = next();
+
+            const bool fixed = field.kind == FieldKind::INTEGER || field.kind == FieldKind::BYTES;
+            if (fixed) {
+                if (message.var_count > 0) {
+                    fail("fixed field " + field.name + " must come before variable fields");
+                }
+                field.offset = message.fixed_size;
+                message.fixed_size += field.size;
+            } else {
+                if (message.kind == MessageKind::STRUCT) {
+                    fail("struct " + message.name + " may only hold fixed fields");
+                }
+                field.var_index = message.var_count++;
+                message.has_tail = field.kind == FieldKind::TAIL;
+            }
+            return field;
+        }
+    };
+
+    const Message& findStruct(const std::vector<Message>& messages, const std::string& name) {
+        for (const Message& message : messages) {
+            if (message.kind == MessageKind::STRUCT && message.name == name) {
+                return message;
+            }
+        }
+        throw std::runtime_error("unknown struct " + name);
+    }
+
+    std::string hex(int value) {
+        std::ostringstream ss;
+        ss << "0x" << std::hex << (value < 16 ? "0" : "") << value;
+        return ss.str();
+    }
+
+    // 고정 길이 필드 목록 → "uint32_t a, uint64_t b" / 쓰기 문장
+    std::string fixedParams(const Message& message) {
+        std::string params;
+        for (const Field& field : message.fields) {
+            if (field.kind == FieldKind::INTEGER) {
+                params += (params.empty() ? "" : ", ") + field.type + " " + field.name;
+            } else if (field.kind == FieldKind::BYTES) {
+                params += (params.empty() ? "" : ", ") + std::string("const void* ") + field.name;
+            }
+        }
+        return params;
+    }
+
+    void emitFixedAccessors(std::ostream& out, const Message& message) {
+        for (const Field& field : message.fields) {
+            if (field.kind == FieldKind::INTEGER) {
+                out << "    " << field.type << " " << field.name << "() const { return detail::load<" << field.type
+                    << ">(data_ + " << field.offset << "); }\n";
+            } else if (field.kind == FieldKind::BYTES) {
+                out << "    std::string_view " << field.name << "() const { return std::string_view(data_ + "
+                    << field.offset << ", " << field.size << "); }\n";
+            }
+        }
+    }
+
+    void emitFixedStores(std::ostream& out, const Message& message, const std::string& base, const std::string& indent) {
+        for (const Field& field : message.fields) {
+            if (field.kind == FieldKind::INTEGER) {
+                out << indent << "detail::store(" << base << " + " << field.offset << ", " << field.name << ");\n";
+            } else if (field.kind == FieldKind::BYTES) {
+                out << indent << "memcpy(" << base << " + " << field.offset << ", " << field.name << ", "
+                    << field.size << ");\n";
+            }
+        }
+    }
+
+    void emitStruct(std::ostream& out, const Message& message) {
+        out << "// struct " << message.name << "\n"
+            << "class " << message.name << " {\n"
+            << "public:\n"
+            << "    static constexpr size_t SIZE = " << message.fixed_size << ";\n\n"
+            << "    explicit " << message.name << "(const char* data) : data_(data) {}\n\n";
+        emitFixedAccessors(out, message);
+        out << "\n    static void write(char* out" << (message.fields.empty() ? "" : ", ") << fixedParams(message) << ") {\n";
+        emitFixedStores(out, message, "out", "        ");
+        out << "    }\n\n"
+            << "private:\n"
+            << "    const char* data_;\n"
+            << "};\n\n";
+    }
+
+    void emitView(std::ostream& out, const Message& message, const std::vector<Message>& messages) {
+        const char* keyword = message.kind == MessageKind::PAYLOAD ? "payload"
+                            : message.kind == MessageKind::REQUEST ? "request" : "reply";
+        out << "// " << keyword << " " << message.name;
+        if (message.opcode >= 0) {
+            out << " = " << hex(message.opcode);
+        }
+        out << "\n"
+            << "class " << message.name << " {\n"
+            << "public:\n";
+        if (message.opcode >= 0) {
+            out << "    static constexpr uint8_t OPCODE = " << hex(message.opcode) << ";\n";
+        }
+        out << "    static constexpr size_t FIXED_SIZE = " << message.fixed_size << ";\n\n"
+            << "    // 본문 길이를 검사하고 필드 위치를 잡는다. 필드는 data를 그대로 가리키므로 버퍼를 돌려주기 전까지만 유효.\n"
+            << "    // 뒤에 남는 바이트는 무시한다 (끝에 필드를 더해도 이전 버전이 읽을 수 있게)\n"
+            << "    bool parse(const char* data, size_t length) {\n"
+            << "        if (length < FIXED_SIZE";
+        if (message.opcode >= 0) {
+            out << " || static_cast<uint8_t>(data[0]) != OPCODE";
+        }
+        out << ") {\n"
+            << "            return false;\n"
+            << "        }\n";
+        if (message.var_count > 0) {
+            out << "        const char* cursor = data + FIXED_SIZE;\n"
+                << "        const char* end = data + length;\n";
+            for (const Field& field : message.fields) {
+                if (field.kind == FieldKind::STRING) {
+                    out << "        if (!detail::readSpan(cursor, end, 1, var_[" << field.var_index << "])) {\n"
+                        << "            return false;\n"
+                        << "        }\n";
+                } else if (field.kind == FieldKind::LIST) {
+                    out << "        if (!detail::readSpan(cursor, end, " << field.type << "::SIZE, var_["
+                        << field.var_index << "])) {\n"
+                        << "            return false;\n"
+                        << "        }\n";
+                } else if (field.kind == FieldKind::TAIL) {
+                    out << "        var_[" << field.var_index << "] = detail::Span{cursor, static_cast<size_t>(end - cursor)};\n";
+                }
+            }
+        }
+        out << "        data_ = data;\n"
+            << "        return true;\n"
+            << "    }\n\n";
+
+        emitFixedAccessors(out, message);
+        for (const Field& field : message.fields) {
+            if (field.kind == FieldKind::STRING || field.kind == FieldKind::TAIL) {
+                out << "    std::string_view " << field.name << "() const { return std::string_view(var_["
+                    << field.var_index << "].data, var_[" << field.var_index << "].count); }\n";
+            } else if (field.kind == FieldKind::LIST) {
+                out << "    ListView<" << field.type << "> " << field.name << "() const { return ListView<" << field.type
+                    << ">(var_[" << field.var_index << "].data, var_[" << field.var_index << "].count); }\n";
+            }
+        }
+
+        out << "\nprivate:\n"
+            << "    const char* data_{nullptr};\n";
+        if (message.var_count > 0) {
+            out << "    detail::Span var_[" << message.var_count << "];\n";
+        }
+        out << "};\n\n";
+
+        // Builder: 고정 필드는 제자리에 쓰고, 가변 필드는 선언 순서대로 이어 붙인다
+        const std::string builder = message.name + "Builder";
+        const size_t prefixed = message.var_count - (message.has_tail ? 1 : 0);
+        out << "class " << builder << " : public detail::FrameWriter {\n"
+            << "public:\n"
+            << "    explicit " << builder << "(ChatMessage& frame";
+        if (message.kind == MessageKind::PAYLOAD) {
+            out << ", MessageType type";
+        } else {
+            out << ", MessageType type = MessageType::"
+                << (message.kind == MessageKind::REQUEST ? "CLIENT_COMMAND" : "SERVER_COMMAND");
+        }
+        out << ")\n"
+            << "        : FrameWriter(frame, type, " << message.opcode << ", " << message.name << "::FIXED_SIZE, "
+            << prefixed << ") {}\n\n";
+
+        for (const Field& field : message.fields) {
+            switch (field.kind) {
+                case FieldKind::INTEGER:
+                    out << "    " << builder << "& " << field.name << "(" << field.type << " value) {\n"
+                        << "        detail::store(fixed(" << field.offset << "), value);\n"
+                        << "        return *this;\n"
+                        << "    }\n";
+                    break;
+                case FieldKind::BYTES:
+                    out << "    " << builder << "& " << field.name << "(const void* value) {\n"
+                        << "        memcpy(fixed(" << field.offset << "), value, " << field.size << ");\n"
+                        << "        return *this;\n"
+                        << "    }\n";
+                    break;
+                case FieldKind::STRING:
+                    out << "    " << builder << "& " << field.name << "(std::string_view value) {\n"
+                        << "        putString(" << field.var_index << ", value.data(), value.size());\n"
+                        << "        return *this;\n"
+                        << "    }\n";
+                    break;
+                case FieldKind::TAIL:
+                    out << "    " << builder << "& " << field.name << "(std::string_view value) {\n"
+                        << "        putTail(" << field.var_index << ", value.data(), value.size());\n"
+                        << "        return *this;\n"
+                        << "    }\n";
+                    break;
+                case FieldKind::LIST: {
+                    const Message& record = findStruct(messages, field.type);
+                    std::string args;
+                    for (const Field& member : record.fields) {
+                        args += (args.empty() ? "" : ", ") + member.name;
+                    }
+                    out << "    " << builder << "& add_" << field.name << "(" << fixedParams(record) << ") {\n"
+                        << "        if (char* out = append(" << field.var_index << ", " << field.type << "::SIZE)) {\n"
+                        << "            " << field.type << "::write(out" << (args.empty() ? "" : ", ") << args << ");\n"
+                        << "        }\n"
+                        << "        return *this;\n"
+                        << "    }\n";
+                    break;
+                }
+            }
+        }
+        out << "};\n\n";
+    }
+
+    const char* PREAMBLE = R"(// 생성된 파일: 직접 고치지 말고 server/schema/commands.schema를 고친 뒤 다시 빌드한다 (chat_command_codegen)
+#pragma once
+#include "Context.h"
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+
+namespace command {
+
+// 첫 바이트가 0x20 미만이면 이진 하위 명령 (그 외는 텍스트 명령)
+inline bool isBinary(const char* data, size_t length) {
+    return length > 0 && static_cast<uint8_t>(data[0]) < 0x20;
+}
+
+inline int opcodeOf(const char* data, size_t length) {
+    return isBinary(data, length) ? static_cast<uint8_t>(data[0]) : -1;
+}
+
+namespace detail {
+    // 프레임 안의 필드는 정렬되어 있지 않다
+    template <typename T>
+    T load(const char* p) {
+        T value;
+        memcpy(&value, p, sizeof(value));
+        return value;
+    }
+
+    template <typename T>
+    void store(char* p, T value) {
+        memcpy(p, &value, sizeof(value));
+    }
+
+    struct Span {
+        const char* data{nullptr};
+        size_t count{0};
+    };
+
+    // u16 개수 + 개수 * unit 바이트
+    inline bool readSpan(const char*& cursor, const char* end, size_t unit, Span& span) {
+        if (end - cursor < 2) {
+            return false;
+        }
+        const uint16_t count = load<uint16_t>(cursor);
+        cursor += 2;
+        if (static_cast<size_t>(end - cursor) < count * unit) {
+            return false;
+        }
+        span = Span{cursor, count};
+        cursor += count * unit;
+        return true;
+    }
+
+    // 송신 프레임에 직접 쓰는 Builder 공통부. 자리가 모자라거나 가변 필드를 거꾸로 쓰면 finish()가 false
+    class FrameWriter {
+    public:
+        static constexpr size_t CAPACITY = sizeof(ChatMessage::data);
+
+        bool finish() {
+            while (!failed_ && next_var_ < prefixed_) {
+                openPrefix();
+                ++next_var_;
+            }
+            if (failed_) {
+                return false;
+            }
+            frame_.length = static_cast<uint16_t>(cursor_);
+            return true;
+        }
+
+    protected:
+        FrameWriter(ChatMessage& frame, MessageType type, int opcode, size_t fixed_size, size_t prefixed)
+            : frame_(frame), cursor_(fixed_size), prefixed_(prefixed) {
+            frame_.type = type;
+            memset(frame_.data, 0, fixed_size);
+            if (opcode >= 0) {
+                frame_.data[0] = static_cast<char>(opcode);
+            }
+        }
+
+        char* fixed(size_t offset) { return frame_.data + offset; }
+
+        char* append(size_t index, size_t record_size) {
+            if (open_list_ != index) {
+                if (!seek(index)) {
+                    return nullptr;
+                }
+                open_list_ = index;
+                list_count_at_ = cursor_;
+                openPrefix();
+                next_var_ = index + 1;
+            }
+            if (failed_ || cursor_ + record_size > CAPACITY) {
+                failed_ = true;
+                return nullptr;
+            }
+            const uint16_t count = load<uint16_t>(frame_.data + list_count_at_);
+            store(frame_.data + list_count_at_, static_cast<uint16_t>(count + 1));
+            char* out = frame_.data + cursor_;
+            cursor_ += record_size;
+            return out;
+        }
+
+        void putString(size_t index, const char* data, size_t length) {
+            if (!seek(index) || length > UINT16_MAX || cursor_ + 2 + length > CAPACITY) {
+                failed_ = true;
+                return;
+            }
+            store(frame_.data + cursor_, static_cast<uint16_t>(length));
+            memcpy(frame_.data + cursor_ + 2, data, length);
+            cursor_ += 2 + length;
+            next_var_ = index + 1;
+        }
+
+        void putTail(size_t index, const char* data, size_t length) {
+            if (!seek(index) || cursor_ + length > CAPACITY) {
+                failed_ = true;
+                return;
+            }
+            memcpy(frame_.data + cursor_, data, length);
+            cursor_ += length;
+            next_var_ = index + 1;
+        }
+
+    private:
+        static constexpr size_t NONE = SIZE_MAX;
+
+        ChatMessage& frame_;
+        size_t cursor_;
+        size_t prefixed_;            // u16 길이/개수가 붙는 가변 필드 수 (tail 제외)
+        size_t next_var_{0};
+        size_t open_list_{NONE};
+        size_t list_count_at_{0};
+        bool failed_{false};
+
+        // index번째 가변 필드 앞까지 안 쓴 필드를 빈 값으로 채운다
+        bool seek(size_t index) {
+            if (failed_ || index < next_var_) {
+                failed_ = true;
+                return false;
+            }
+            open_list_ = NONE;
+            while (next_var_ < index) {
+                openPrefix();
+                ++next_var_;
+            }
+            return !failed_;
+        }
+
+        void openPrefix() {
+            if (cursor_ + 2 > CAPACITY) {
+                failed_ = true;
+                return;
+            }
+            store(frame_.data + cursor_, uint16_t{0});
+            cursor_ += 2;
+        }
+    };
+}
+
+// list<Struct> 필드: 고정 길이 레코드 배열을 복사 없이 읽는다
+template <typename Record>
+class ListView {
+public:
+    class iterator {
+    public:
+        explicit iterator(const char* p) : p_(p) {}
+        Record operator*() const { return Record(p_); }
+        iterator& operator++() {
+            p_ += Record::SIZE;
+            return *this;
+        }
+        bool operator!=(const iterator& other) const { return p_ != other.p_; }
+
+    private:
+        const char* p_;
+    };
+
+    ListView(const char* data, size_t count) : data_(data), count_(count) {}
+
+    size_t size() const { return count_; }
+    bool empty() const { return count_ == 0; }
+    Record operator[](size_t i) const { return Record(data_ + i * Record::SIZE); }
+    iterator begin() const { return iterator(data_); }
+    iterator end() const { return iterator(data_ + count_ * Record::SIZE); }
+
+private:
+    const char* data_;
+    size_t count_;
+};
+
+)";
+
+    std::string generate(const std::vector<Message>& messages) {
+        std::ostringstream out;
+        out << PREAMBLE;
+        for (const Message& message : messages) {
+            if (message.kind == MessageKind::STRUCT) {
+                emitStruct(out, message);
+            } else {
+                emitView(out, message, messages);
+            }
+        }
+        out << "} // namespace command\n";
+        return out.str();
+    }
+}
+
+int main(int argc, char** argv) {
+    if (argc != 3) {
+        std::cerr << "usage: " << argv[0] << " <schema> <output.h>" << std::endl;
+        return 2;
+    }
+
+    try {
+        std::ifstream schema(argv[1]);
+        if (!schema) {
+            throw std::runtime_error("cannot open schema");
+        }
+        const std::string header = generate(Parser(tokenize(schema)).parse());
+
+        // 내용이 같으면 건드리지 않아 포함하는 파일이 다시 컴파일되지 않게
+        std::ifstream existing(argv[2]);
+        std::stringstream current;
+        current << existing.rdbuf();
+        if (existing && current.str() == header) {
+            return 0;
+        }
+        std::ofstream output(argv[2], std::ios::trunc);
+        output << header;
+        if (!output) {
+            throw std::runtime_error("cannot write output");
+        }
+    } catch (const std::exception& e) {
+        std::cerr << argv[1] << ": " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
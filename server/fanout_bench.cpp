@@ -0,0 +1,413 @@
+// 팬아웃 방식 마이크로벤치마크: 같은 payload를 N개 소켓에 보내는 비용을
+// write(SEND) / SEND_ZC / 파이프 tee+splice로 나눠 payload 크기 × 수신자 수별로 비교한다.
+// 서버와 같은 Reactor·PipeFanout 코드를 쓰며, 수신 측은 별도 쓰레드가 읽어 버린다.
+#include "Reactor.h"
+#include "PipeFanout.h"
+#include "Logger.h"
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <poll.h>
+#include <unistd.h>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+    constexpr unsigned RING_ENTRIES = 2048;
+    constexpr unsigned MAX_PAYLOAD = 60 * 1024;   // 기본 파이프 용량(64KB) 안에 들어가야 tee 가능
+
+    std::vector<size_t> parseList(const std::string& text) {
+        std::vector<size_t> values;
+        std::istringstream ss(text);
+        std::string item;
+        while (std::getline(ss, item, ',')) {
+            values.push_back(std::stoul(item));
+        }
+        return values;
+    }
+
+    double cpuSeconds(int who) {
+        rusage usage{};
+        getrusage(who, &usage);
+        return usage.ru_utime.tv_sec + usage.ru_stime.tv_sec +
+               (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1e6;
+    }
+
+    // 루프백 TCP 연결 N개: senders는 벤치마크가 쓰고 receivers는 수신 쓰레드가 비운다
+    struct Connections {
+        std::vector<int> senders;
+        std::vector<int> receivers;
+        std::vector<PipePair> pipes;   // 연결별 파이프 (splice 방식)
+
+        explicit Connections(size_t count) {
+            int listener = socket(AF_INET, SOCK_STREAM, 0);
+            sockaddr_in addr{};
+            addr.sin_family = AF_INET;
+            addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+            socklen_t len = sizeof(addr);
+            if (listener < 0 || bind(listener, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0 ||
+                listen(listener, static_cast<int>(count)) < 0 ||
+                getsockname(listener, reinterpret_cast<sockaddr*>(&addr), &len) < 0) {
+                throw std::runtime_error("loopback listener setup failed");
+            }
+
+            for (size_t i = 0; i < count; ++i) {
+                int client = socket(AF_INET, SOCK_STREAM, 0);
+                if (client < 0 || connect(client, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0) {
+                    throw std::runtime_error("loopback connect failed");
+                }
+                int server = accept(listener, nullptr, nullptr);
+                if (server < 0) {
+                    throw std::runtime_error("loopback accept failed");
+                }
+                int one = 1;
+                setsockopt(server, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+                senders.push_back(server);
+                receivers.push_back(client);
+                pipes.emplace_back();
+                if (!pipes.back().open()) {
+                    throw std::runtime_error("pipe creation failed");
+                }
+            }
+            close(listener);
+        }
+
+        ~Connections() {
+            for (int fd : senders) close(fd);
+            for (int fd : receivers) close(fd);
+        }
+    };
+
+    // 수신 측: 모든 연결을 epoll로 읽어 버리며 바이트 수와 CPU 시간을 센다
+    class Sink {
+    public:
+        explicit Sink(const std::vector<int>& fds) : epoll_fd_(epoll_create1(0)) {
+            for (int fd : fds) {
+                epoll_event ev{};
+                ev.events = EPOLLIN;
+                ev.data.fd = fd;
+                epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &ev);
+            }
+            thread_ = std::thread([this] { run(); });
+        }
+
+        ~Sink() {
+            stop_ = true;
+            thread_.join();
+            close(epoll_fd_);
+        }
+
+        uint64_t bytes() const { return bytes_.load(); }
+        double cpu() const { return cpu_.load(); }
+
+    private:
+        void run() {
+            std::vector<char> buffer(256 * 1024);
+            epoll_event events[64];
+            while (!stop_) {
+                int n = epoll_wait(epoll_fd_, events, 64, 10);
+                for (int i = 0; i < n; ++i) {
+                    ssize_t got = recv(events[i].data.fd, buffer.data(), buffer.size(), MSG_DONTWAIT);
+                    if (got > 0) bytes_ += static_cast<uint64_t>(got);
+                }
+                cpu_ = cpuSeconds(RUSAGE_THREAD);
+            }
+        }
+
+        int epoll_fd_;
+        std::atomic<bool> stop_{false};
+        std::atomic<uint64_t> bytes_{0};
+        std::atomic<double> cpu_{0.0};
+        std::thread thread_;
+    };
+
+    enum Step : uint8_t { STEP_SEND, STEP_TEE, STEP_POLL, STEP_SPLICE };
+
+    __u64 tag(size_t idx, Step step) { return (static_cast<__u64>(idx) << 8) | step; }
+
+    struct Result {
+        double elapsed_sec{0};
+        double cpu_sec{0};
+        uint64_t enters{0};
+    };
+
+    // 메시지 하나를 모든 수신자에게 보내고 전부 끝날 때까지 기다리는 것을 반복
+    class Runner {
+    public:
+        Runner(FanoutMode mode, Connections& conns) : mode_(mode), conns_(conns), reactor_(RING_ENTRIES) {}
+
+        bool supported() {
+            switch (mode_) {
+                case FanoutMode::SPLICE:
+                    return reactor_.supportsOpcode(IORING_OP_TEE) && reactor_.supportsOpcode(IORING_OP_SPLICE) &&
+                           reactor_.supportsOpcode(IORING_OP_POLL_ADD);
+                case FanoutMode::SEND_ZC:
+#ifdef IORING_CQE_F_NOTIF
+                    return reactor_.supportsOpcode(IORING_OP_SEND_ZC);
+#else
+                    return false;
+#endif
+                default:
+                    return true;
+            }
+        }
+
+        Result run(const std::vector<char>& payload, size_t messages) {
+            Result result;
+            auto start = std::chrono::steady_clock::now();
+            for (size_t m = 0; m < messages; ++m) {
+                fanOut(payload, result);
+            }
+            result.elapsed_sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            return result;
+        }
+
+    private:
+        io_uring_sqe* sqe(Result& result) {
+            io_uring_sqe* entry = reactor_.getSQE();
+            if (!entry) {
+                submit(result);
+                entry = reactor_.getSQE();
+                if (!entry) throw std::runtime_error("SQ full");
+            }
+            return entry;
+        }
+
+        void submit(Result& result) {
+            if (reactor_.sqReady() > 0) {
+                result.enters++;
+                reactor_.submit();
+            }
+        }
+
+        void fanOut(const std::vector<char>& payload, Result& result) {
+            const unsigned length = static_cast<unsigned>(payload.size());
+            std::shared_ptr<const PipeFrame> frame;
+            if (mode_ == FanoutMode::SPLICE) {
+                frame = fanout_.load(payload.data(), length);   // payload는 여기서 한 번만 복사
+                if (!frame) throw std::runtime_error("pipe load failed");
+            }
+
+            remaining_.assign(conns_.senders.size(), length);
+            notifs_.assign(conns_.senders.size(), 0);
+            size_t outstanding = 0;
+            for (size_t i = 0; i < conns_.senders.size(); ++i) {
+                if (reactor_.sqReady() + 3 > RING_ENTRIES) submit(result);
+                if (mode_ == FanoutMode::SPLICE) {
+                    io_uring_sqe* tee = sqe(result);
+                    PipeFanout::prepTee(tee, frame->readFd(), conns_.pipes[i].writeFd(), length);
+                    tee->user_data = tag(i, STEP_TEE);
+                    queueSplice(i, false, result);
+                } else {
+                    queueSend(payload, i, result);
+                }
+                outstanding++;
+            }
+
+            while (outstanding > 0) {
+                result.enters++;
+                reactor_.submitAndWait(1);
+                io_uring_cqe* cqes[256];
+                unsigned count = reactor_.peekBatch(cqes, 256);
+                for (unsigned c = 0; c < count; ++c) {
+                    if (complete(*cqes[c], payload, result)) outstanding--;
+                }
+                reactor_.advance(count);
+            }
+        }
+
+        void queueSend(const std::vector<char>& payload, size_t i, Result& result) {
+            io_uring_sqe* entry = sqe(result);
+            const char* data = payload.data() + (payload.size() - remaining_[i]);
+#ifdef IORING_CQE_F_NOTIF
+            if (mode_ == FanoutMode::SEND_ZC) {
+                io_uring_prep_send_zc(entry, conns_.senders[i], data, remaining_[i], MSG_NOSIGNAL, 0);
+            } else
+#endif
+            {
+                io_uring_prep_send(entry, conns_.senders[i], data, remaining_[i], MSG_NOSIGNAL);
+            }
+            entry->user_data = tag(i, STEP_SEND);
+        }
+
+        void queueSplice(size_t i, bool wait_writable, Result& result) {
+            if (wait_writable) {
+                io_uring_sqe* poll = sqe(result);
+                io_uring_prep_poll_add(poll, conns_.senders[i], POLLOUT);
+                poll->flags |= IOSQE_IO_LINK | IOSQE_CQE_SKIP_SUCCESS;
+                poll->user_data = tag(i, STEP_POLL);
+            }
+            io_uring_sqe* splice = sqe(result);
+            PipeFanout::prepSpliceToSocket(splice, conns_.pipes[i].readFd(), conns_.senders[i], remaining_[i]);
+            splice->user_data = tag(i, STEP_SPLICE);
+        }
+
+        // 수신자 하나의 전송이 끝났으면 true
+        bool complete(const io_uring_cqe& cqe, const std::vector<char>& payload, Result& result) {
+            const size_t i = static_cast<size_t>(cqe.user_data >> 8);
+            const Step step = static_cast<Step>(cqe.user_data & 0xff);
+
+            if (step == STEP_TEE || step == STEP_POLL) {
+                if (cqe.res < 0) throw std::runtime_error("tee/poll failed: " + std::to_string(cqe.res));
+                return false;
+            }
+#ifdef IORING_CQE_F_NOTIF
+            if (cqe.flags & IORING_CQE_F_NOTIF) {
+                return --notifs_[i] == 0 && remaining_[i] == 0;
+            }
+#endif
+            if (step == STEP_SPLICE && cqe.res == -EAGAIN) {
+                queueSplice(i, true, result);
+                return false;
+            }
+            if (cqe.res <= 0) {
+                // ZC 실패 결과에도 F_MORE가 붙으면 알림이 따로 오지만 벤치마크는 여기서 중단
+                throw std::runtime_error("send failed: " + std::to_string(cqe.res));
+            }
+
+            remaining_[i] -= std::min<unsigned>(remaining_[i], static_cast<unsigned>(cqe.res));
+            if (cqe.flags & IORING_CQE_F_MORE) {
+                notifs_[i]++;   // SEND_ZC: 버퍼 해제 알림이 따로 온다
+            }
+            if (remaining_[i] > 0) {
+                // 부분 전송 (ZC는 버퍼가 그대로라 알림을 기다리지 않고 이어서 보내도 된다)
+                if (step == STEP_SPLICE) {
+                    queueSplice(i, false, result);
+                } else {
+                    queueSend(payload, i, result);
+                }
+                return false;
+            }
+            return notifs_[i] == 0;
+        }
+
+        FanoutMode mode_;
+        Connections& conns_;
+        Reactor reactor_;
+        PipeFanout fanout_;
+        std::vector<unsigned> remaining_;   // 수신자별 미전송 바이트
+        std::vector<unsigned> notifs_;      // 수신자별 대기 중인 SEND_ZC 알림 수
+    };
+
+    void printUsage(const char* program) {
+        std::cout << "팬아웃 방식 비교 벤치마크 (write / zc / splice)\n\n"
+                  << "사용법:\n"
+                  << "  " << program << " [옵션들]\n\n"
+                  << "옵션들:\n"
+                  << "  -n, --messages <개수>     조합당 팬아웃 횟수 (기본값: 500)\n"
+                  << "  -p, --payloads <목록>     payload 크기, 쉼표 구분 (기본값: 512,2048,8192,32768)\n"
+                  << "  -r, --recipients <목록>   수신자 수, 쉼표 구분 (기본값: 8,64,256)\n"
+                  << "  -m, --modes <목록>        write,zc,splice 중 선택 (기본값: 전부)\n"
+                  << std::endl;
+    }
+}
+
+int main(int argc, char** argv) {
+    size_t messages = 500;
+    std::vector<size_t> payloads{512, 2048, 8192, 32768};
+    std::vector<size_t> recipients{8, 64, 256};
+    std::vector<FanoutMode> modes{FanoutMode::WRITE, FanoutMode::SEND_ZC, FanoutMode::SPLICE};
+
+    try {
+        for (int i = 1; i < argc; ++i) {
+            std::string arg = argv[i];
+            auto next = [&]() -> std::string {
+                if (i + 1 >= argc) throw std::invalid_argument("missing value for " + arg);
+                return argv[++i];
+            };
+            if (arg == "-h" || arg == "--help") {
+                printUsage(argv[0]);
+                return 0;
+            } else if (arg == "-n" || arg == "--messages") {
+                messages = std::stoul(next());
+            } else if (arg == "-p" || arg == "--payloads") {
+                payloads = parseList(next());
+            } else if (arg == "-r" || arg == "--recipients") {
+                recipients = parseList(next());
+            } else if (arg == "-m" || arg == "--modes") {
+                modes.clear();
+                std::istringstream ss(next());
+                std::string name;
+                while (std::getline(ss, name, ',')) modes.push_back(PipeFanout::parseMode(name));
+            } else {
+                printUsage(argv[0]);
+                return 1;
+            }
+        }
+        for (size_t size : payloads) {
+            if (size == 0 || size > MAX_PAYLOAD) {
+                throw std::invalid_argument("payload must be 1.." + std::to_string(MAX_PAYLOAD));
+            }
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "잘못된 옵션: " << e.what() << std::endl;
+        return 1;
+    }
+
+    Logger::getInstance().setLogLevel(LogLevel::WARN);
+    std::cout << "I/O backend: " << Reactor::NAME << ", 조합당 " << messages << "회 팬아웃\n\n"
+              << std::left << std::setw(8) << "mode" << std::right
+              << std::setw(10) << "payload" << std::setw(12) << "recipients"
+              << std::setw(14) << "fanouts/s" << std::setw(14) << "us/fanout"
+              << std::setw(16) << "cpu_us/fanout" << std::setw(16) << "enters/fanout"
+              << std::setw(10) << "Gbit/s" << std::endl;
+
+    try {
+        for (size_t count : recipients) {
+            Connections conns(count);
+            for (size_t size : payloads) {
+                std::vector<char> payload(size, 'x');
+                for (FanoutMode mode : modes) {
+                    Runner runner(mode, conns);
+                    std::cout << std::left << std::setw(8) << PipeFanout::modeName(mode) << std::right
+                              << std::setw(10) << size << std::setw(12) << count;
+                    if (!runner.supported()) {
+                        std::cout << std::setw(14) << "unsupported" << std::endl;
+                        continue;
+                    }
+
+                    double cpu_before = cpuSeconds(RUSAGE_SELF);
+                    Result result;
+                    double sink_cpu = 0.0;
+                    uint64_t bytes = 0;
+                    {
+                        Sink sink(conns.receivers);
+                        result = runner.run(payload, messages);
+                        // 마지막 바이트까지 받은 뒤 수신 쓰레드 CPU를 뺀다
+                        while (sink.bytes() < static_cast<uint64_t>(size) * count * messages) {
+                            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                        }
+                        bytes = sink.bytes();
+                        sink_cpu = sink.cpu();
+                    }
+                    result.cpu_sec = cpuSeconds(RUSAGE_SELF) - cpu_before - sink_cpu;
+
+                    const double fanouts = static_cast<double>(messages);
+                    std::cout << std::fixed << std::setprecision(1)
+                              << std::setw(14) << fanouts / result.elapsed_sec
+                              << std::setw(14) << result.elapsed_sec * 1e6 / fanouts
+                              << std::setw(16) << result.cpu_sec * 1e6 / fanouts
+                              << std::setprecision(2)
+                              << std::setw(16) << result.enters / fanouts
+                              << std::setw(10) << bytes * 8 / result.elapsed_sec / 1e9
+                              << std::defaultfloat << std::endl;
+                }
+            }
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "벤치마크 실패: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,119 @@
+#pragma once
+#include "Context.h"
+#include "PipeFanout.h"
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+struct evp_md_ctx_st;
+
+// 다운로드 중인 첨부 파일 (읽기 전용 fd, 마지막 참조가 사라지면 닫음)
+class AttachmentFile {
+public:
+    AttachmentFile(int fd, uint64_t size) : fd_(fd), size_(size) {}
+    ~AttachmentFile();
+
+    int fd() const { return fd_; }
+    uint64_t size() const { return size_; }
+
+    AttachmentFile(const AttachmentFile&) = delete;
+    AttachmentFile& operator=(const AttachmentFile&) = delete;
+
+private:
+    int fd_;
+    uint64_t size_;
+};
+
+// 진행 중인 업로드: 소켓 → 파이프 → 임시 파일로 splice된 구간을 이어서 해시한다.
+// 해시는 파일에 내려앉은 페이지 캐시를 mmap으로 읽으므로 원본을 사용자 버퍼로 복사하지 않는다
+class AttachmentUpload {
+public:
+    static constexpr unsigned CHUNK_SIZE = 64 * 1024;   // splice 한 번의 최대 크기 (기본 파이프 용량)
+
+    AttachmentUpload(const AttachmentHeader& header, int file_fd, std::string temp_path);
+    ~AttachmentUpload();
+
+    // 다음 소켓 → 파이프 splice 크기
+    unsigned nextChunk() const;
+    // 파일의 [stored, stored + bytes) 구간이 기록됨. 해시 갱신 실패 시 false
+    bool commitChunk(size_t bytes);
+    bool complete() const { return stored_ == header_.size; }
+    // 전체 해시 확정. 선언된 digest가 있으면 일치 여부 확인
+    bool finish();
+
+    const AttachmentHeader& header() const { return header_; }
+    const uint8_t* digest() const { return digest_; }
+    int fileFd() const { return file_fd_; }
+    uint64_t stored() const { return stored_; }
+    const std::string& tempPath() const { return temp_path_; }
+
+    std::string owner;          // 사용자별 한도에 잡힌 주인 (인증된 사용자, 없으면 발신 IP)
+    PipePair pipe;              // 소켓 → 파일 중계 파이프
+    unsigned in_pipe{0};        // 파이프에 들어와 아직 파일로 못 옮긴 바이트
+    bool in_flight{false};      // splice 진행 중 (완료 전 정리 금지)
+    bool abandoned{false};      // 진행 중 연결이 닫힘: 완료 시 정리만 한다
+
+    AttachmentUpload(const AttachmentUpload&) = delete;
+    AttachmentUpload& operator=(const AttachmentUpload&) = delete;
+
+private:
+    AttachmentHeader header_;
+    int file_fd_;
+    std::string temp_path_;
+    uint64_t stored_{0};
+    evp_md_ctx_st* hash_;
+    uint8_t digest_[32]{};
+};
+
+// 내용 주소 첨부 저장소 (CHAT_ATTACH_DIR/<sha256 hex>). 파일 시스템 연산만 하므로 여러 워커가 공유
+class AttachmentStore {
+public:
+    static constexpr uint64_t DEFAULT_MAX_BYTES = 64ull * 1024 * 1024;
+    static constexpr uint64_t DEFAULT_QUOTA_BYTES = 1024ull * 1024 * 1024;      // 저장소 전체 (CHAT_ATTACH_QUOTA_BYTES)
+    static constexpr uint64_t DEFAULT_USER_QUOTA_BYTES = 256ull * 1024 * 1024;  // 주인별 (CHAT_ATTACH_USER_QUOTA_BYTES)
+
+    static AttachmentStore& getInstance() {
+        static AttachmentStore instance;
+        return instance;
+    }
+
+    // 저장 디렉토리 생성. 실패하면 첨부 기능을 끈다
+    void initialize();
+    bool isEnabled() const { return enabled_; }
+    uint64_t getMaxBytes() const { return max_bytes_; }
+
+    bool contains(const uint8_t* digest) const;
+    // 다운로드용으로 연다. 없으면 nullptr
+    std::shared_ptr<const AttachmentFile> open(const uint8_t* digest) const;
+    // 선언된 크기를 전체/주인별 한도에 미리 잡고 업로드 임시 파일을 만든다.
+    // 한도를 넘으면 quota_exceeded를 세우고 nullptr, 파일을 못 만들어도 nullptr
+    std::unique_ptr<AttachmentUpload> beginUpload(const AttachmentHeader& header, const std::string& owner,
+                                                  bool& quota_exceeded);
+    // 검증된 업로드를 digest 이름으로 옮긴다 (같은 내용이 이미 있으면 임시 파일만 지우고 전체 한도에서 뺀다)
+    bool commit(const AttachmentUpload& upload);
+    // 업로드 취소: 임시 파일을 지우고 잡아 둔 한도를 돌려준다
+    void discard(const AttachmentUpload& upload);
+
+    static std::string toHex(const uint8_t* digest);
+    static bool isZero(const uint8_t* digest);
+
+private:
+    AttachmentStore();
+    std::string pathFor(const uint8_t* digest) const;
+    // 저장된 첨부 크기 합 (시작 시 한 번)
+    uint64_t scanUsage() const;
+    void release(const std::string& owner, uint64_t bytes, bool stored);
+
+    std::string dir_;
+    uint64_t max_bytes_{DEFAULT_MAX_BYTES};
+    uint64_t quota_bytes_{DEFAULT_QUOTA_BYTES};
+    uint64_t user_quota_bytes_{DEFAULT_USER_QUOTA_BYTES};
+    bool enabled_{false};
+
+    // 여러 워커가 업로드를 시작/끝내므로 한도 집계는 잠금으로 보호. 주인별 사용량은 이 프로세스가 받은 것만 센다
+    std::mutex quota_mutex_;
+    uint64_t used_bytes_{0};
+    std::unordered_map<std::string, uint64_t> owner_bytes_;
+};
@@ -0,0 +1,38 @@
+#pragma once
+#include "IOUring.h"
+#include "SocketManager.h"
+#include <atomic>
+#include <memory>
+#include <string>
+
+// 채팅 로직 없이 같은 링/버퍼/프레이밍 경로만 쓰는 기준 서버.
+// ECHO: 채팅 프레임을 보낸 연결로 그대로 돌려보냄, SINK: 받은 프레임을 버림.
+// 방 팬아웃 비용을 빼고 본 바닥값을 chat_benchmark --baseline으로 비교한다.
+class BaselineServer {
+public:
+    enum class Mode { ECHO, SINK };
+
+    BaselineServer(int port, Mode mode, SocketManager& socket_manager);
+    ~BaselineServer();
+
+    void start();
+    void processEvents();
+    void stop();
+    // processEvents 루프를 빠져나오게 한다 (시그널 핸들러에서 호출 가능)
+    void requestStop();
+
+    // "echo" / "sink" → Mode. 그 외에는 std::runtime_error
+    static Mode parseMode(const std::string& name);
+    static const char* modeName(Mode mode);
+
+private:
+    void handleFrame(int client_fd, const ChatMessage& message);
+    void handleClose(int client_fd);
+
+    int port_;
+    Mode mode_;
+    bool running_;
+    std::atomic<bool> stop_requested_{false};
+    std::unique_ptr<IOUring> io_ring_;
+    SocketManager& socket_manager_;
+};
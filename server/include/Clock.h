@@ -0,0 +1,129 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <ctime>
+#include <mutex>
+#include <thread>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+// 공용 단조 시계 (ns). invariant TSC를 쓸 수 있으면 시작 시 CLOCK_MONOTONIC에 맞춰 보정한 배율로
+// rdtsc를 ns로 바꾸고 (수 ns), 아니면 clock_gettime(CLOCK_MONOTONIC) (vDSO)로 읽는다.
+// CHAT_CLOCK=vdso로 TSC 사용을 끌 수 있다.
+// 20ms 보정의 배율 오차(수십 ppm)와 NTP가 CLOCK_MONOTONIC에 거는 보정은 시간이 갈수록 쌓이므로
+// 보정 쓰레드가 CHAT_CLOCK_RECALIBRATE_MS(기본 1000)마다 CLOCK_MONOTONIC과 비교해 배율을 고친다.
+// 값을 건너뛰지 않고 다음 주기 동안 오차를 따라잡도록 배율만 바꾸므로 시계는 계속 증가하고,
+// CLOCK_MONOTONIC과의 차이는 한 주기 동안 쌓이는 배율 오차 (1초 주기면 대략 수십 us) 이내로 유지된다.
+// 같은 쓰레드가 벽시계(CLOCK_REALTIME)와의 차이도 다시 재므로 벽시계 시각은 now()에 더하기 한 번으로 얻는다
+class Clock {
+public:
+    static Clock& getInstance() {
+        static Clock instance;
+        return instance;
+    }
+
+    int64_t now() const {
+#if defined(__x86_64__) || defined(__i386__)
+        if (use_tsc_) {
+            // 보정 쓰레드가 바꾸는 (기준 cycle, 기준 ns, 배율)을 seqlock으로 한 벌씩 읽는다 (쓰는 쪽은 초당 한 번)
+            uint64_t sequence, base_cycles, mult;
+            int64_t base_ns;
+            do {
+                sequence = sequence_.load(std::memory_order_acquire);
+                base_cycles = base_cycles_.load(std::memory_order_relaxed);
+                base_ns = base_ns_.load(std::memory_order_relaxed);
+                mult = mult_.load(std::memory_order_relaxed);
+                std::atomic_thread_fence(std::memory_order_acquire);
+            } while ((sequence & 1) || sequence != sequence_.load(std::memory_order_relaxed));
+            return toNanos(__rdtsc(), base_cycles, base_ns, mult);
+        }
+#endif
+        return monotonicNanos();
+    }
+
+    // 벽시계 시각 - now() (ns). 보정 주기마다 갱신되므로 NTP의 시각 조정은 한 주기 안에 따라간다
+    int64_t wallOffset() const { return wall_offset_ns_.load(std::memory_order_relaxed); }
+
+    // 보정 쓰레드 시작/정지 (CHAT_CLOCK_RECALIBRATE_MS=0이면 시작하지 않는다)
+    void startRecalibration();
+    void stopRecalibration();
+
+    bool usingTsc() const { return use_tsc_; }
+    const char* sourceName() const { return use_tsc_ ? "tsc" : "vdso"; }
+    // 보정된 TSC 주파수 (TSC 미사용 시 0)
+    double tscGhz() const { return tsc_ghz_; }
+
+    static int64_t monotonicNanos() {
+        timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return static_cast<int64_t>(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+    }
+    static int64_t realtimeNanos() {
+        timespec ts;
+        clock_gettime(CLOCK_REALTIME, &ts);
+        return static_cast<int64_t>(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+    }
+
+    Clock(const Clock&) = delete;
+    Clock& operator=(const Clock&) = delete;
+
+private:
+    static constexpr unsigned SHIFT = 32;                // mult_의 고정소수점 자리수
+    static constexpr int64_t CALIBRATION_NS = 20000000;  // 보정 구간 20ms
+    static constexpr int64_t DEFAULT_RECALIBRATE_MS = 1000;
+
+    Clock();
+    ~Clock();
+    bool calibrate();
+    void recalibrate();
+    void updateWallOffset();
+    void recalibrationThread();
+    static bool hasInvariantTsc();
+    static bool kernelTrustsTsc();
+    // rdtsc 한 번과 CLOCK_MONOTONIC 시각을 짝지은 표본
+    static void sample(uint64_t& cycles, int64_t& ns);
+
+    static int64_t toNanos(uint64_t cycles, uint64_t base_cycles, int64_t base_ns, uint64_t mult) {
+        // 다른 코어의 TSC가 기준 cycle보다 조금 뒤처져 있을 수 있어 부호 있는 차이로 계산
+        const __int128 delta = static_cast<int64_t>(cycles - base_cycles);
+        return base_ns + static_cast<int64_t>((delta * static_cast<__int128>(mult)) >> SHIFT);
+    }
+
+    bool use_tsc_{false};
+    std::atomic<uint64_t> sequence_{0};      // 홀수: 보정 쓰레드가 아래 세 값을 바꾸는 중
+    std::atomic<uint64_t> base_cycles_{0};
+    std::atomic<int64_t> base_ns_{0};
+    std::atomic<uint64_t> mult_{0};          // cycle당 ns (32.32 고정소수점)
+    double tsc_ghz_{0.0};                    // 시작 시 보정값 (로그용)
+    std::atomic<int64_t> wall_offset_ns_{0};
+
+    // 보정 쓰레드 전용: 마지막으로 맞춘 CLOCK_MONOTONIC 표본
+    uint64_t anchor_cycles_{0};
+    int64_t anchor_ns_{0};
+    int64_t recalibrate_ns_{DEFAULT_RECALIBRATE_MS * 1000000};
+
+    std::thread recalibrator_;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    bool should_stop_{false};
+};
+
+// 워커 루프가 CQE 배치를 꺼낼 때마다 갱신하는 쓰레드별 현재 시각.
+// 같은 배치의 처리(기한 계산, 버퍼 사용 시간 등)는 한 번 읽은 값을 공유한다
+class LoopClock {
+public:
+    static void tick() { now_ns_ = Clock::getInstance().now(); }
+    static int64_t now() {
+        if (now_ns_ == 0) {
+            tick();
+        }
+        return now_ns_;
+    }
+    // 같은 배치 시각의 벽시계 ms (기록 타임스탬프용, 시스템 콜 없음)
+    static int64_t wallMillis() { return (now() + Clock::getInstance().wallOffset()) / 1000000; }
+
+private:
+    static inline thread_local int64_t now_ns_{0};
+};
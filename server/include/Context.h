@@ -10,19 +10,41 @@ enum class MessageType : uint8_t {
     SERVER_ERROR = 0x02,         // 에러
     SERVER_CHAT = 0x03,          // 채팅 메시지
     SERVER_NOTIFICATION = 0x04,  // 시스템 알림
+    SERVER_ATTACH = 0x05,        // 첨부 파일 헤더 (AttachmentHeader), 바로 뒤에 size 바이트 원본이 이어짐
+    SERVER_RECONNECT = 0x06,     // 셧다운 드레인 재접속 안내 (ReconnectHint), 곧 서버가 연결을 닫음
+    SERVER_COMMAND = 0x07,       // 이진 명령 응답 (첫 바이트가 요청 opcode, 형식은 server/schema/commands.schema)
+    SERVER_ROOM_CHAT = 0x08,     // 방 태그 채팅 (RoomChat: 방 ID + 본문), 둘 이상의 방에 속한 연결이 받음
     
     // 클라이언트 메시지 (0x10 ~ 0x1F)
-    CLIENT_JOIN = 0x11,          // 세션 참가
-    CLIENT_LEAVE = 0x12,         // 세션 퇴장
+    CLIENT_JOIN = 0x11,          // 세션 참가 (이미 다른 방에 있으면 방을 추가, 연결의 I/O는 처음 방의 링에 남음)
+    CLIENT_LEAVE = 0x12,         // 세션 퇴장 (LeaveRequest면 그 방만, 본문이 없으면 모든 방)
     CLIENT_CHAT = 0x13,          // 채팅 메시지
-    CLIENT_COMMAND = 0x14        // 명령어 (상태변경, 귓속말 등)
+    CLIENT_COMMAND = 0x14,       // 명령어: 텍스트, 또는 첫 바이트 0x01..0x1F면 이진 하위 명령 (CommandCodec.h)
+    CLIENT_ATTACH_PUT = 0x15,    // 첨부 업로드 (AttachmentHeader), "attach:ready" 응답 후 size 바이트 원본 전송
+    CLIENT_ATTACH_GET = 0x16,    // 첨부 다운로드 (digest만 사용)
+    CLIENT_ROOM_CHAT = 0x17,     // 방 지정 채팅 (RoomChat), 참가한 방 중 하나로
+    CLIENT_MULTICAST = 0x18      // 본문 하나를 여러 방/사용자에게 (Multicast), 겹치는 수신자는 한 번만 받음
 };
 
 enum class OperationType : uint8_t {
     ACCEPT = 1,
     READ = 2,
     WRITE = 3,
-    CLOSE = 4
+    CLOSE = 4,
+    AUTH = 5,             // 토큰 검증 완료 알림 (eventfd)
+    TIMER = 6,            // 소켓 튜닝 샘플링 주기
+    SOCKOPT = 7,          // TCP_INFO 소켓 명령 완료
+    SPLICE = 8,           // 파이프 팬아웃 tee/poll/splice (buffer_idx 자리에 단계)
+    SEND_ZC = 9,          // zero-copy 송신 (결과 CQE + 버퍼 해제 알림 CQE)
+    UPLOAD = 10,          // 첨부 업로드 recv 취소/소켓→파이프/파이프→파일 splice (buffer_idx 자리에 단계)
+    DRAIN = 11,           // 제어 eventfd 알림/셧다운 드레인 웨이브 타이머 (buffer_idx 자리에 단계)
+    THROTTLE = 12         // 방 backlog가 상한을 넘어 발신자의 multishot recv 취소
+};
+
+// 연결의 전송 형식 (Listener 포트로 정해짐). JSON은 줄 단위 JSON 객체 (JsonCodec.h)
+enum class WireFormat : uint8_t {
+    BINARY = 0,
+    JSON = 1
 };
 
 // 서버 내부에서 사용하는 작업 컨텍스트
@@ -39,6 +61,20 @@ struct ChatMessage {
     char data[512];          // 512 bytes
 };
 
+// 첨부 파일 헤더 (CLIENT_ATTACH_PUT/GET, SERVER_ATTACH 프레임의 data)
+// digest는 원본의 SHA-256. 업로드 시 모두 0이면 서버가 계산한 값으로 저장
+struct AttachmentHeader {
+    uint64_t size;            // 8 bytes
+    uint8_t digest[32];       // 32 bytes
+};
+
+// 재접속 안내 (SERVER_RECONNECT 프레임의 data)
+// 클라이언트는 연결이 닫힌 뒤 retry_after_ms 만큼 기다렸다가 address(비었으면 같은 주소)로 재접속
+struct ReconnectHint {
+    uint32_t retry_after_ms;  // 4 bytes, 클라이언트마다 무작위로 흩어 재접속이 몰리지 않게
+    char address[64];         // 64 bytes, "host:port" (NUL 종료)
+};
+
 #pragma pack(pop)   // 정렬 설정 복원
 
 static constexpr size_t MAX_MESSAGE_SIZE = 4096;  // 4KB
\ No newline at end of file
@@ -0,0 +1,97 @@
+#pragma once
+#include <liburing.h>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+#include <thread>
+
+// epoll 백엔드: io_uring이 막힌 환경(seccomp 등)용.
+// liburing의 prep 헬퍼가 채운 SQE를 해석해 논블로킹 소켓 + epoll로 실행하고
+// 커널과 같은 형식의 CQE(res, IORING_CQE_F_BUFFER/F_MORE)를 만든다.
+// 지원: ACCEPT(multishot), RECV(multishot, 버퍼 링 선택), READ, WRITE/SEND, CLOSE, TIMEOUT, NOP
+class EpollReactor {
+public:
+    static constexpr const char* NAME = "epoll";
+    static constexpr unsigned MAX_EVENTS = 256;
+    static constexpr unsigned MAX_OPS_PER_WAKEUP = 16;   // fd당 한 번에 처리할 accept/recv 수
+
+    explicit EpollReactor(unsigned entries);
+    ~EpollReactor();
+
+    // SQE는 쓰레드별로 모아 두고 같은 쓰레드의 submit에서 실행한다
+    // (Listener 쓰레드가 세션 링에 준비 중인 SQE를 워커가 먼저 실행하지 않도록)
+    io_uring_sqe* getSQE();
+    unsigned sqReady();
+    int submit();
+    int submitAndWait(unsigned wait_nr);
+    unsigned peekBatch(io_uring_cqe** cqes, unsigned max);
+    void advance(unsigned count);
+
+    int registerBufRing(io_uring_buf_reg* reg);
+    // recv 취소만 흉내 낸다. 소켓 명령, tee/splice 등은 동기 경로 사용
+    bool supportsOpcode(int opcode) { return opcode == IORING_OP_ASYNC_CANCEL; }
+
+    EpollReactor(const EpollReactor&) = delete;
+    EpollReactor& operator=(const EpollReactor&) = delete;
+
+private:
+    struct PendingWrite {
+        __u64 user_data;
+        const uint8_t* buf;
+        size_t len;
+        size_t done;
+    };
+
+    struct FdState {
+        uint32_t events{0};          // 현재 epoll에 등록된 이벤트
+        bool accept{false};
+        bool accept_multishot{false};
+        __u64 accept_data{0};
+        sockaddr* accept_addr{nullptr};
+        socklen_t* accept_addrlen{nullptr};
+        bool recv{false};
+        bool recv_multishot{false};
+        bool recv_select{false};     // 버퍼 링에서 버퍼 선택
+        __u64 recv_data{0};
+        void* recv_buf{nullptr};
+        unsigned recv_len{0};
+        std::deque<PendingWrite> writes;
+    };
+
+    struct Timer {
+        std::chrono::steady_clock::time_point deadline;
+        __u64 user_data;
+    };
+
+    int submitLocked();
+    void processSQE(const io_uring_sqe& sqe);
+    void post(__u64 user_data, int32_t res, uint32_t flags = 0);
+    void updateInterest(int fd);
+    void onReadable(int fd);
+    void acceptReady(int fd, FdState& state);
+    void recvReady(int fd, FdState& state);
+    void flushWrites(int fd, FdState& state);
+    void closeFd(int fd, __u64 user_data);
+    void expireTimers();
+    int waitTimeoutMs() const;
+    bool takeBuffer(uint16_t& bid, void*& addr, unsigned& len);
+    void returnBuffer() { buf_head_--; }
+
+    int epoll_fd_;
+    int wake_fd_;                     // 다른 쓰레드의 제출로 생긴 완료를 알리는 eventfd
+    unsigned entries_;
+    bool waiting_{false};             // 워커가 epoll_wait 중 (mutex_로 보호)
+
+    std::mutex mutex_;
+    std::unordered_map<std::thread::id, std::deque<io_uring_sqe>> sq_;
+    std::deque<io_uring_cqe> cq_;     // deque: push_back 중에도 기존 CQE 포인터 유지
+    std::unordered_map<int, FdState> fds_;
+    std::vector<Timer> timers_;
+
+    io_uring_buf_ring* buf_ring_{nullptr};
+    unsigned buf_mask_{0};
+    uint16_t buf_head_{0};
+};
@@ -0,0 +1,56 @@
+#pragma once
+#include "Context.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+// 연결별 수신 스트림 → 고정 크기 ChatMessage 프레임 재조립.
+// recv 한 번에 여러 프레임이 오거나 프레임이 버퍼 경계에 걸쳐도 처리한다.
+// 버퍼 안에 온전히 든 프레임은 복사 없이 제자리에서 넘기고,
+// 경계에 걸친 프레임만 partial_에 모은다.
+class FrameAssembler {
+public:
+    static constexpr size_t FRAME_SIZE = sizeof(ChatMessage);
+
+    // 완성된 프레임마다 on_frame(const ChatMessage&) 호출. false를 반환하면 중단
+    // (프로토콜 오류 등). 반환값: 중단 없이 끝까지 소비했으면 true
+    template <typename OnFrame>
+    bool feed(const uint8_t* data, size_t len, OnFrame&& on_frame) {
+        if (partial_len_ > 0) {
+            size_t take = std::min(len, FRAME_SIZE - partial_len_);
+            memcpy(reinterpret_cast<uint8_t*>(&partial_) + partial_len_, data, take);
+            partial_len_ += take;
+            data += take;
+            len -= take;
+            if (partial_len_ < FRAME_SIZE) {
+                return true;
+            }
+            partial_len_ = 0;
+            if (!on_frame(static_cast<const ChatMessage&>(partial_))) {
+                return false;
+            }
+        }
+
+        // ChatMessage는 1바이트 정렬(packed)이라 임의 오프셋에서 바로 참조 가능
+        while (len >= FRAME_SIZE) {
+            if (!on_frame(*reinterpret_cast<const ChatMessage*>(data))) {
+                return false;
+            }
+            data += FRAME_SIZE;
+            len -= FRAME_SIZE;
+        }
+
+        if (len > 0) {
+            memcpy(&partial_, data, len);
+            partial_len_ = len;
+        }
+        return true;
+    }
+
+    void reset() { partial_len_ = 0; }
+    size_t buffered() const { return partial_len_; }
+
+private:
+    ChatMessage partial_;
+    size_t partial_len_{0};
+};
@@ -0,0 +1,124 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// 부하 집계 대상 키 종류와 가중치
+enum class LoadKey : uint8_t {
+    SENDER = 0,      // 발신 연결 (연결 번호: fd는 닫히면 다른 연결에 재사용된다)
+    ROOM = 1,        // 방 (세션 ID)
+    SOURCE_IP = 2,   // 발신 IPv4 주소 (호스트 바이트 순서)
+    COUNT
+};
+
+enum class LoadMetric : uint8_t {
+    MESSAGES = 0,    // 채팅 메시지 수
+    BYTES = 1,       // 메시지 본문 바이트
+    FANOUT = 2,      // 브로드캐스트로 수신자 큐에 넣은 프레임 수
+    COUNT
+};
+
+// 상위 키 하나: count는 과대 추정값, error는 그 중 오차 상한 (count - error <= 실제값 <= count)
+struct HeavyHitter {
+    uint64_t key{0};
+    uint64_t count{0};
+    uint64_t error{0};
+};
+
+// Count-Min sketch: 임의 키의 누적 가중치를 고정 메모리로 과대 추정 (행마다 다른 해시, 최솟값).
+// 쓰는 쓰레드는 하나뿐이라 칸은 relaxed load/store로 갱신하고 다른 쓰레드는 잠금 없이 읽는다
+class CountMinSketch {
+public:
+    static constexpr size_t DEPTH = 4;
+    static constexpr size_t WIDTH = 1024;   // 2의 거듭제곱
+
+    void add(uint64_t key, uint64_t weight);
+    uint64_t estimate(uint64_t key) const;
+    void decay(unsigned shift);   // 모든 칸을 2^shift로 나눈다
+
+private:
+    static size_t slot(uint64_t key, size_t row);
+
+    std::array<std::array<std::atomic<uint64_t>, WIDTH>, DEPTH> counts_{};
+};
+
+// SpaceSaving: 상위 키 후보를 최대 CAPACITY개만 유지. 자리가 없으면 가장 작은 항목을 새 키로 교체하고
+// 그 값을 새 키의 오차로 물려받는다 (CAPACITY가 작으므로 최솟값은 선형 탐색).
+// add/decay는 한 쓰레드만 부른다. 다른 쓰레드는 seqlock으로 찢어지지 않은 사본을 읽는다 (쓰는 쪽은 기다리지 않음)
+class SpaceSaving {
+public:
+    static constexpr size_t CAPACITY = 64;
+
+    void add(uint64_t key, uint64_t weight);
+    void decay(unsigned shift);
+    // 현재 후보 사본 (아무 쓰레드)
+    void snapshot(std::vector<HeavyHitter>& out) const;
+
+private:
+    struct Slot {
+        std::atomic<uint64_t> key{0};
+        std::atomic<uint64_t> count{0};
+        std::atomic<uint64_t> error{0};
+    };
+    void beginWrite();
+    void endWrite();
+
+    std::array<Slot, CAPACITY> slots_;
+    std::atomic<size_t> size_{0};
+    std::atomic<uint64_t> sequence_{0};            // 홀수: 쓰는 중
+    std::unordered_map<uint64_t, size_t> index_;   // key -> slots_ 위치 (쓰는 쓰레드 전용)
+};
+
+// 메시지 경로에서 갱신하는 워커별 부하 sketch (키 종류 x 가중치마다 SpaceSaving + Count-Min).
+// "지금" 부하를 보도록 DECAY_INTERVAL_MS마다 모든 값을 절반으로 줄인다
+// (일정한 부하에서 값은 초당 가중치의 1~2배 사이). 워커만 쓰고 통계/배치 요청 쓰레드는 잠금 없이 읽으므로
+// 메시지 경로가 조회를 기다리지 않는다. 감쇠 도중 읽으면 한 번 더 줄어든 값을 볼 수 있다 (과소 추정, 다음 조회에서 회복)
+class LoadSketch {
+public:
+    static constexpr int64_t DECAY_INTERVAL_MS = 1000;
+
+    // 채팅 메시지 하나의 부하
+    struct Sample {
+        uint64_t sender;      // 연결 번호
+        uint64_t room;
+        uint64_t source_ip;   // 0: 알 수 없음 (집계하지 않음)
+        uint64_t bytes;
+        uint64_t fanout;
+    };
+
+    void record(const Sample& sample, int64_t now_ns);
+    // 조회는 now_ns까지 밀린 감쇠를 반영한다 (기록이 멈춘 워커의 값도 시간이 지나면 줄어든다)
+    uint64_t estimate(LoadKey key_type, LoadMetric metric, uint64_t key, int64_t now_ns) const;
+    // 이 워커의 상위 후보를 merged에 합친다 (키별 합산)
+    void collectTop(LoadKey key_type, LoadMetric metric, int64_t now_ns,
+                    std::unordered_map<uint64_t, HeavyHitter>& merged) const;
+
+    // 여러 워커에서 모은 후보 중 상위 k개 (count 내림차순)
+    static std::vector<HeavyHitter> selectTop(const std::unordered_map<uint64_t, HeavyHitter>& merged, size_t k);
+    // CHAT_IP_MSG_RATE: 발신 IP별 초당 채팅 메시지 상한 (워커별 추정, 0이면 제한 없음)
+    static uint64_t ipMessageRateFromEnv();
+    static bool parseKey(const std::string& name, LoadKey& key_type);
+    static bool parseMetric(const std::string& name, LoadMetric& metric);
+    static std::string formatKey(LoadKey key_type, uint64_t key);
+
+private:
+    struct Table {
+        SpaceSaving top;
+        CountMinSketch counts;
+    };
+    static constexpr size_t NUM_KEYS = static_cast<size_t>(LoadKey::COUNT);
+    static constexpr size_t NUM_METRICS = static_cast<size_t>(LoadMetric::COUNT);
+
+    unsigned pendingDecays(int64_t now_ns) const;   // now_ns까지 밀린 감쇠 횟수
+    void decayIfDue(int64_t now_ns);
+    void add(LoadKey key_type, uint64_t key, const uint64_t (&weights)[NUM_METRICS]);
+    const Table& table(LoadKey key_type, LoadMetric metric) const {
+        return tables_[static_cast<size_t>(key_type)][static_cast<size_t>(metric)];
+    }
+
+    std::array<std::array<Table, NUM_METRICS>, NUM_KEYS> tables_;
+    std::atomic<int64_t> next_decay_ns_{0};
+};
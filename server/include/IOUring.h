@@ -2,16 +2,58 @@
 #include <liburing.h>
 #include <memory>
 #include <atomic>
+#include "Reactor.h"
 #include "UringBuffer.h"
 #include "Context.h"
+#include "TokenAuth.h"
+#include "SocketTuner.h"
+#include "RingStats.h"
+#include "OutboundQueue.h"
+#include "FrameAssembler.h"
+#include "JsonCodec.h"
+#include "PipeFanout.h"
+#include "AttachmentStore.h"
+#include "StallProbe.h"
+#include "HeavyHitters.h"
+#include <functional>
 #include <vector>
 #include <mutex>
+#include <unordered_map>
+
+struct RoomMember;
+class Session;
 
 class IOUring {
 public:
+    // 재조립된 수신 프레임 처리기 (설정 시 채팅 처리 대신 호출, 에코/싱크 기준 서버용)
+    using FrameHandler = std::function<void(int client_fd, const ChatMessage& message)>;
+    // 넘겨받은 연결의 recv를 건 직후 워커 쓰레드에서 호출 (세션의 연결 목록과 첫 알림)
+    using AdoptHandler = std::function<void(int client_fd, bool pending)>;
+
     static constexpr unsigned NUM_SUBMISSION_QUEUE_ENTRIES = 2048;
     static constexpr unsigned CQE_BATCH_SIZE = 256;
     static constexpr unsigned NUM_WAIT_ENTRIES = 1;
+
+    // OperationType::SPLICE 완료의 단계 (user_data의 buffer_idx 자리)
+    static constexpr uint16_t SPLICE_STEP_FILL = 0;     // 원본 파이프 tee 또는 첨부 파일 → 연결 파이프
+    static constexpr uint16_t SPLICE_STEP_POLL = 1;
+    static constexpr uint16_t SPLICE_STEP_SEND = 2;
+
+    // OperationType::UPLOAD 완료의 단계
+    static constexpr uint16_t UPLOAD_STEP_CANCEL = 0;   // multishot recv 취소 (수신 일시 정지)
+    static constexpr uint16_t UPLOAD_STEP_WAIT = 1;     // POLLIN 대기
+    static constexpr uint16_t UPLOAD_STEP_TIMEOUT = 2;  // POLLIN 대기에 연결된 유휴 타임아웃
+    static constexpr uint16_t UPLOAD_STEP_RECV = 3;     // 소켓 → 업로드 파이프
+    static constexpr uint16_t UPLOAD_STEP_STORE = 4;    // 업로드 파이프 → 임시 파일
+
+    // OperationType::DRAIN 완료의 단계
+    static constexpr uint16_t DRAIN_STEP_NOTIFY = 0;    // 제어 eventfd (다른 쓰레드/시그널 핸들러의 깨우기)
+    static constexpr uint16_t DRAIN_STEP_WAVE = 1;      // 다음 연결 종료 웨이브
+    static constexpr uint16_t DRAIN_STEP_GRACE = 2;     // 마지막 웨이브 후 유예 시간 만료
+
+    static constexpr unsigned ATTACH_CHUNK_SIZE = 64 * 1024;     // 다운로드 splice 한 번의 최대 크기
+    static constexpr unsigned UPLOAD_IDLE_TIMEOUT_SEC = 30;
+    static constexpr size_t DEFAULT_HISTORY_COUNT = 20;          // "history" 명령의 기본 건수
     IOUring();
     ~IOUring();
 
@@ -19,31 +61,116 @@ public:
     void prepareAccept(int socket_fd);
     void prepareRead(int client_fd);
     void prepareWrite(int client_fd, const void* buf, unsigned len, uint16_t bid);
+    void prepareSendZc(int client_fd, const void* buf, unsigned len);
     void prepareClose(int client_fd);
+    void prepareAuthRead();
+    void prepareTuningTimer();
+    void prepareTcpInfoSample(int client_fd);
+    void prepareDrainTimer(uint16_t step, uint32_t delay_ms);
     
     // IO 이벤트 처리 메서드
     void handleAccept(io_uring_cqe* cqe);
     void handleRead(io_uring_cqe* cqe, int client_fd);
     void handleWrite(io_uring_cqe* cqe, int client_fd, uint16_t buffer_idx);
+    void handleAuthComplete(io_uring_cqe* cqe);
+    void handleTuningTimer(io_uring_cqe* cqe);
+    void handleTcpInfo(io_uring_cqe* cqe, int client_fd);
+    void handleSplice(io_uring_cqe* cqe, int client_fd, uint16_t step);
+    void handleSendZc(io_uring_cqe* cqe, int client_fd);
+    void handleUpload(io_uring_cqe* cqe, int client_fd, uint16_t step);
+    void handleControl(io_uring_cqe* cqe);
+    void handleThrottle(io_uring_cqe* cqe, int client_fd);
+
+    // 다른 쓰레드나 시그널 핸들러에서 링 루프를 깨운다 (eventfd write, async-signal-safe).
+    // 루프는 DRAIN_STEP_NOTIFY 완료를 받고 자신의 정지/드레인 플래그를 확인한다
+    void notify();
+
+    // 여러 방 참가: 다른 링이 이 링에 I/O가 있는 연결로 보낼 방 프레임을 넘긴다 (아무 쓰레드).
+    // 링은 제어 eventfd 완료에서 받아 자기 송신 큐에 넣는다
+    struct RemoteTarget {
+        int32_t client_fd;
+        uint64_t connection_id;
+    };
+    struct RemoteDelivery {
+        std::vector<RemoteTarget> targets;
+        std::shared_ptr<const ChatMessage> frame;
+        int64_t deadline_ns;
+        RoomBacklog* room;
+    };
+    void postRemote(RemoteDelivery delivery);
+    // 이 링이 I/O를 맡은 연결 등록 (Listener/합성 클라이언트 쓰레드). 종료는 dropConnection.
+    // 링 준비(recv, 소켓 추적, AdoptHandler)는 제어 eventfd로 넘겨 워커가 한다.
+    // JSON 연결은 수신 줄을 프레임으로 바꾸고 송신 프레임을 JSON 한 줄로 보낸다.
+    // pending: 조인 전 연결 (AdoptHandler에 그대로 전달)
+    void adoptConnection(int client_fd, uint64_t connection_id, WireFormat format = WireFormat::BINARY,
+                         bool pending = false);
+    // adoptConnection 뒤 워커가 아직 넘겨받지 않은 연결 수 (아무 쓰레드, 세션 배치용)
+    size_t getAdoptingCount() const { return adopting_.load(std::memory_order_relaxed); }
+
+    // 첨부 업로드나 방 backlog 조절로 recv를 멈춘 연결인가 (취소된 recv의 -ECANCELED는 종료가 아님)
+    bool isReceivePaused(int client_fd) const;
+    // 멈춘 연결의 recv가 끝남 (취소 완료 포함). 조절이 이미 풀렸으면 다시 건다
+    void onReceiveStopped(int client_fd);
+
+    // 연결별 소켓 튜닝 추적 (워커 쓰레드). 배정된 연결은 adoptConnection이 넘겨 워커가 추적을 시작한다
+    void trackSocket(int client_fd);
+    void untrackSocket(int client_fd);
     
     // 메시지 처리 메서드
     void processMessage(int client_fd, const ChatMessage* message, uint16_t buffer_idx);
     void handleJoinSession(int client_fd, const ChatMessage* message, uint16_t buffer_idx);
     void handleLeaveSession(int client_fd, const ChatMessage* message, uint16_t buffer_idx);
+    // CLIENT_CHAT(연결의 기본 방)과 CLIENT_ROOM_CHAT(참가한 방 중 지정)
     void handleChatMessage(int client_fd, const ChatMessage* message, uint16_t buffer_idx);
+    // CLIENT_MULTICAST: 대상 방/사용자의 수신자를 한 번에 모아 겹치는 연결은 빼고 한 프레임을 나눠 쓴다
+    void handleMulticast(int client_fd, const ChatMessage* message, uint16_t buffer_idx);
+    void handleCommand(int client_fd, const ChatMessage* message, uint16_t buffer_idx);
+    // 이진 하위 명령 (CommandCodec.h): 수신 버퍼 위에서 바로 읽고 응답은 송신 프레임에 바로 쓴다
+    void handleBinaryCommand(int client_fd, const ChatMessage* message, uint16_t buffer_idx);
+    void sendCommandError(int client_fd, const std::string& text);
+    // 방 설정 변경 같은 운영 명령 권한: 인증이 켜져 있으면 CHAT_ADMIN_USERS, 꺼져 있으면 루프백 연결
+    bool isAdmin(int client_fd);
+    // 방 전달 기한 변경. 클러스터 디렉터리에 있는 방이면 Raft로 제안만 하고 false (커밋되면 반영)
+    bool changeDeadline(Session& session, uint32_t deadline_ms);
+    void handleAttachPut(int client_fd, const ChatMessage* message, uint16_t buffer_idx);
+    void handleAttachGet(int client_fd, const ChatMessage* message, uint16_t buffer_idx);
+    // user: 토큰으로 인증된 사용자 ID (멀티캐스트 주소 지정용, 인증이 꺼져 있으면 비어 있음)
+    void completeJoin(int client_fd, int32_t session_id, uint16_t buffer_idx, const std::string& user = std::string());
+    // 토큰 검증 실패: 아직 어느 방에도 참가하지 못한 연결은 오류를 보낸 뒤 닫는다
+    void rejectJoin(int client_fd, const std::string& reason, uint16_t buffer_idx);
     
-    // 메시지 전송 메서드
+    // 메시지 전송 메서드. 실패(본문 크기 초과 등)는 로그만 남기고 던지지 않으며, buffer_idx는 항상 여기서 반환
     void sendMessage(int client_fd, MessageType msg_type, const void* data, size_t length, uint16_t buffer_idx);
-    void broadcastToSession(int32_t session_id, MessageType msg_type, const void* data, size_t length, uint16_t buffer_idx, int32_t exclude_fd = -1);
+    // deadline_ms > 0: 대기열에서 이 시간이 지난 프레임은 전송하지 않고 건너뜀
+    void broadcastToSession(int32_t session_id, MessageType msg_type, const void* data, size_t length, uint16_t buffer_idx, int32_t exclude_fd = -1, uint32_t deadline_ms = 0);
+    // 연결 종료 시 송신 큐 정리
+    void dropOutbound(int client_fd);
+    // 연결 종료 시 수신 재조립 상태, 업로드와 송신 큐 정리
+    void dropConnection(int client_fd);
+    // 셧다운 드레인: 대기 중인 프레임(재접속 안내 포함)을 모두 보낸 뒤 송신 방향을 닫는다.
+    // 클라이언트가 FIN을 받고 끊으면 recv가 0으로 끝나 평소 종료 경로로 정리된다
+    void closeAfterFlush(int client_fd);
+
+    void setFrameHandler(FrameHandler handler) { frame_handler_ = std::move(handler); }
+    void setAdoptHandler(AdoptHandler handler) { adopt_handler_ = std::move(handler); }
+    FanoutMode getFanoutMode() const { return fanout_mode_; }
     
-    unsigned peekCQE(io_uring_cqe** cqes);
+    unsigned peekCQE(io_uring_cqe** cqes, unsigned max = CQE_BATCH_SIZE);
     void advanceCQ(unsigned count);
     int submitAndWait();
 
     // Non-blocking submit
-    int submit() {
-        return io_uring_submit(&ring_);
-    }
+    int submit();
+
+    // syscall 계측
+    void countLoopIteration() { RingStats::bump(stats_.loop_iterations); }
+    const RingStats& getStats() const { return stats_; }
+    // 발신자/방/발신 IP별 부하 sketch (통계 요청과 방 배치에서 읽음)
+    const LoadSketch& getLoadSketch() const { return load_sketch_; }
+
+    // 정지 감시: 처리하려는 완료를 flight recorder에 남긴다 (루프가 CQE마다 호출)
+    void recordEvent(const io_uring_cqe* cqe);
+    void setWorkerName(std::string name) { heartbeat_.setName(std::move(name)); }
 
     // Buffer management methods
     void incrementRefCount(uint16_t idx) { buffer_manager_->incrementRefCount(idx); }
@@ -60,19 +187,139 @@ public:
     void printBufferStatus(uint16_t highlight_idx = UINT16_MAX) { buffer_manager_->printBufferStatus(highlight_idx); }
     void printBufferStats() const { buffer_manager_->printBufferStats(); }
 
-    void handleWriteComplete(int32_t client_fd, uint16_t buffer_idx, int32_t bytes_written);
+    void handleWriteComplete(int32_t client_fd, int32_t bytes_written);
 
 private:
-    void initRing();
     io_uring_sqe* getSQE();
     void setContext(io_uring_sqe* sqe, OperationType type, int client_fd = -1, uint16_t buffer_idx = 0);
-    void logMessageStats() const;
+    static __u64 makeContext(OperationType type, int client_fd, uint16_t buffer_idx);
+    void logMessageStats();
+    void enqueueFrame(int client_fd, std::shared_ptr<const ChatMessage> message, int64_t deadline_ns,
+                      std::shared_ptr<const PipeFrame> pipe = nullptr, RoomBacklog* room = nullptr);
+    // 첨부 헤더 프레임과 파일 본문을 한 번에 넣는다 (사이에 다른 프레임이 끼지 않게)
+    void enqueueAttachment(int client_fd, std::shared_ptr<const ChatMessage> header,
+                           std::shared_ptr<const AttachmentFile> file);
+    void flushOutbound(int client_fd, OutboundQueue& queue);
+    void resumeOutbound(int client_fd, OutboundQueue& queue);
+    void completeWrite(int client_fd, int32_t bytes_written);
+    void prepareSend(int client_fd, const void* buf, unsigned len);
+    void prepareSplice(int client_fd, OutboundQueue& queue, bool fill, bool wait_writable);
+    void prepareControlRead();
+    void prepareUploadWait(int client_fd);
+    void prepareUploadRecv(int client_fd, AttachmentUpload& upload);
+    void prepareUploadStore(int client_fd, AttachmentUpload& upload);
+    // 일시 정지가 끝난 업로드에 "ready"를 보내고 본문 대기. 실패하면 업로드를 정리하고 false
+    bool startUpload(int client_fd, AttachmentUpload& upload);
+    void finishUpload(int client_fd, AttachmentUpload& upload);
+    // 업로드 중단. 본문을 받던 중이면 스트림 경계를 잃었으므로 연결을 끊는다
+    void failUpload(int client_fd, const std::string& reason);
+    // 방 backlog가 상한을 넘음: 발신자의 multishot recv를 취소하고 방이 풀릴 때까지 다시 걸지 않는다
+    void throttleSender(int client_fd, RoomBacklog* room);
+    void resumeSenders();
+    void sendAttachReply(int client_fd, MessageType msg_type, const std::string& text);
+    void releaseBufferRef(uint16_t buffer_idx);
+    bool dispatchFrame(int client_fd, const ChatMessage& message);
+    static std::shared_ptr<const ChatMessage> buildFrame(MessageType msg_type, const void* data, size_t length);
+    // 채팅 본문에서 제어 문자를 뺀다
+    static std::string filterChatText(const char* text, size_t length);
+    // 수신자마다 프레임 큐에 넣는다. 이 링의 연결은 바로, 다른 링의 연결은 링별로 모아 넘긴다.
+    // tagged_frame이 있으면 tagged 구성원은 그것을 받는다
+    void fanOut(const std::vector<RoomMember>& members, const std::shared_ptr<const ChatMessage>& frame,
+                const std::shared_ptr<const ChatMessage>& tagged_frame, const std::shared_ptr<const PipeFrame>& pipe,
+                int64_t deadline_ns, RoomBacklog* room);
+    static int64_t nowNanos();
 
-    io_uring ring_;
-    bool ring_initialized_;
+    Reactor reactor_;
     std::unique_ptr<UringBuffer> buffer_manager_;
     std::atomic<uint64_t> total_broadcasts_{0};
     std::atomic<uint64_t> total_messages_{0};
+    uint64_t last_logged_messages_{0};
+    RingStats stats_;
+    WorkerHeartbeat heartbeat_{stats_.worker_stalls};
+
+    // 조인 인증 (워커별 캐시 + 헬퍼 풀 완료 큐)
+    AuthCompletionQueue auth_queue_;
+    TokenCache token_cache_;
+    uint64_t auth_event_value_{0};
+    bool auth_read_armed_{false};
+    std::unordered_map<int, uint64_t> auth_inflight_;   // client_fd -> 검증 중인 연결 ID (연결마다 하나만)
+
+    // 메시지 경로 부하 집계와 발신 IP별 속도 제한 (CHAT_IP_MSG_RATE)
+    LoadSketch load_sketch_;
+    std::unordered_map<int, uint32_t> peer_ips_;   // client_fd -> IPv4 (호스트 바이트 순서), 워커가 trackSocket에서 채움
+    std::unordered_map<int, uint64_t> sender_ids_; // client_fd -> 연결 번호 (워커 전용, 첫 메시지에서 채우고 dropConnection이 지움)
+    uint64_t senderId(int client_fd);
+    uint64_t ip_message_rate_{0};
+
+    // 적응형 소켓 튜닝 (워커별). 비동기 TCP_INFO 샘플은 완료될 때까지 커널이 쓰므로
+    // 연결 정리와 무관하게 주소가 고정된 버퍼에 받는다 (fd당 하나만 진행)
+    struct TcpInfoSample {
+        tcp_info info{};
+        bool stale{false};      // 진행 중에 연결이 정리됨: 완료되면 버린다
+    };
+    std::unordered_map<int, std::unique_ptr<TcpInfoSample>> tcp_samples_;
+    SocketTuner socket_tuner_;
+    __kernel_timespec tuning_interval_{};
+    bool tuning_timer_armed_{false};
+    bool sockcmd_supported_{false};
+
+    // 브로드캐스트 전송 방식 (CHAT_FANOUT). 원본 파이프 풀은 송신 큐보다 오래 살아야 한다
+    FanoutMode fanout_mode_{FanoutMode::WRITE};
+    unsigned splice_min_payload_{PipeFanout::DEFAULT_MIN_PAYLOAD};
+    PipeFanout fanout_;
+
+    // 연결별 송신 큐 (Listener 쓰레드의 addClient와 워커가 함께 접근)
+    std::unordered_map<int, OutboundQueue> outbound_;
+    std::mutex outbound_mutex_;
+
+    // 연결별 수신 프레임 재조립 (워커 쓰레드 전용). JSON 연결은 줄 단위
+    std::unordered_map<int, FrameAssembler> assemblers_;
+    std::unordered_map<int, JsonLineAssembler> json_assemblers_;
+
+    // 마지막으로 JSON으로 바꾼 프레임 (outbound_mutex_). 브로드캐스트 대상끼리 같은 프레임을 넣으므로
+    // 한 번만 직렬화하고 줄을 공유한다. 프레임을 붙잡고 있어 주소 재사용과 헷갈리지 않는다
+    std::shared_ptr<const ChatMessage> json_frame_;
+    std::shared_ptr<const std::string> json_text_;
+
+    // 진행 중인 첨부 업로드 (워커 쓰레드 전용). 업로드 동안 해당 연결의 multishot recv는 멈춘다
+    std::unordered_map<int, std::unique_ptr<AttachmentUpload>> uploads_;
+    bool attachments_supported_{false};
+
+    // 방 backlog 조절로 recv를 멈춘 발신자 (워커 쓰레드 전용)
+    struct ThrottledSender {
+        RoomBacklog* room;
+        bool recv_stopped;    // 취소된 recv의 마지막 완료를 받음 (그 뒤에만 다시 걸 수 있음)
+    };
+    std::unordered_map<int, ThrottledSender> throttled_;
+    bool recv_cancel_supported_{false};
+    __kernel_timespec upload_idle_timeout_{};
+    FrameHandler frame_handler_;
+    AdoptHandler adopt_handler_;
+
+    // 다른 링이 넘긴 방 프레임과 이 링이 I/O를 맡은 연결 (fd -> 연결 번호, 재사용된 fd로 잘못 보내지 않게)
+    std::mutex remote_mutex_;
+    std::vector<RemoteDelivery> remote_inbox_;
+    struct AdoptedConnection {
+        uint64_t id;
+        WireFormat format;
+    };
+    std::unordered_map<int, AdoptedConnection> connections_;
+    struct AdoptedEntry {
+        int client_fd;
+        uint64_t connection_id;
+        bool pending;
+    };
+    std::vector<AdoptedEntry> adopted_inbox_;   // 워커가 recv를 걸고 추적을 시작할 새 연결
+    std::atomic<size_t> adopting_{0};
+    void deliverRemote();
+    void trackAdopted();
+    WireFormat wireFormat(int client_fd);
+    uint64_t connectionId(int client_fd);   // 이 링이 맡지 않은 fd면 0
+
+    // 제어 eventfd (항상 READ를 걸어 둠)와 드레인 타이머
+    int control_fd_{-1};
+    uint64_t control_value_{0};
+    __kernel_timespec drain_delay_{};
     
     void decrementBufferRefCount(uint16_t buffer_idx);
 }; 
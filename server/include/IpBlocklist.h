@@ -0,0 +1,133 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// IPv4 CIDR 범위 (addr은 호스트 바이트 순서, prefix 밖 비트는 0)
+struct Cidr {
+    uint32_t addr{0};
+    uint8_t length{0};
+
+    // "10.0.0.0/8", "192.0.2.1" (= /32)
+    static bool parse(const std::string& text, Cidr& cidr);
+    std::string toString() const;
+    // addr(호스트 바이트 순서)이 이 범위 안인가
+    bool contains(uint32_t host_addr) const {
+        return length == 0 || (host_addr >> (32 - length)) == (addr >> (32 - length));
+    }
+};
+
+// 차단 CIDR 목록의 최장 접두사 일치(LPM) 트라이 (poptrie 방식, 만든 뒤에는 읽기 전용).
+// 상위 16비트는 직접 인덱스, 나머지는 6비트 stride 노드로 내려간다. 노드는 자식/리프 위치를
+// 64비트 bitmap으로 갖고 popcount로 배열 위치를 구하며, 같은 값이 이어지는 리프는 하나로 합친다.
+// 조회는 최대 3번의 노드 방문 (수십 ns)
+class IpBlocklist {
+public:
+    static constexpr uint32_t NO_MATCH = 0;
+
+    // 범위 목록으로 트라이를 만든다 (겹치면 더 긴 접두사가 우선)
+    explicit IpBlocklist(std::vector<Cidr> ranges);
+    // 한 줄에 CIDR 하나, '#' 뒤는 주석. 형식이 틀린 줄이 있으면 std::runtime_error
+    static std::unique_ptr<IpBlocklist> loadFile(const std::string& path);
+
+    // addr(호스트 바이트 순서)에 가장 길게 일치하는 범위 번호 (1부터, 없으면 NO_MATCH)
+    uint32_t lookup(uint32_t addr) const;
+    const Cidr& getRange(uint32_t match) const { return ranges_[match - 1]; }
+    size_t getRangeCount() const { return ranges_.size(); }
+    size_t getMemoryBytes() const;
+
+    IpBlocklist(const IpBlocklist&) = delete;
+    IpBlocklist& operator=(const IpBlocklist&) = delete;
+
+private:
+    static constexpr unsigned DIRECT_BITS = 16;
+    static constexpr unsigned STRIDE = 6;
+    static constexpr uint32_t NODE_FLAG = 0x80000000u;   // direct_ 항목이 노드 번호임
+
+    struct Node {
+        uint64_t vector;    // 자식 노드가 있는 위치
+        uint64_t leafvec;   // 리프 값이 바뀌는 위치 (같은 값이 이어지는 리프는 하나)
+        uint32_t base0;     // leaves_ 시작
+        uint32_t base1;     // nodes_ 시작 (자식 노드는 연속 배치)
+    };
+
+    static uint32_t extract(uint32_t addr, unsigned offset) {
+        const unsigned bits = offset + STRIDE <= 32 ? STRIDE : 32 - offset;
+        return (addr >> (32 - offset - bits)) & ((1u << bits) - 1);
+    }
+
+    std::vector<Cidr> ranges_;
+    std::vector<uint32_t> direct_;   // 상위 16비트 -> 리프 값 또는 NODE_FLAG | 노드 번호
+    std::vector<Node> nodes_;
+    std::vector<uint32_t> leaves_;
+};
+
+// accept 시 검사하는 차단 목록 (CHAT_BLOCKLIST 파일). 목록은 원자 포인터로 통째로 교체한다.
+// 조회 쓰레드(Listener마다 하나)는 등록한 reader 칸에 배치 사이마다 현재 epoch를 알리고,
+// 교체된 이전 목록은 모든 reader가 교체 뒤의 epoch를 알린 다음에 해제한다
+class AcceptFilter {
+public:
+    static constexpr size_t MAX_READERS = 4;
+
+    static AcceptFilter& getInstance() {
+        static AcceptFilter instance;
+        return instance;
+    }
+
+    // CHAT_BLOCKLIST 파일을 (다시) 읽어 교체. 설정이 없으면 false, 읽기 실패는 std::runtime_error.
+    // 파일 읽기와 트라이 조립은 잠금 밖에서 하고 교체만 잠금 아래에서 한다
+    bool reload();
+    // 별도 쓰레드에서 reload (워커 쓰레드의 "blocklist reload"). 진행 중이면 끝난 뒤 한 번 더 읽는다.
+    // 설정이 없으면 false. 결과는 로그와 describe()로 확인
+    bool requestReload();
+
+    // 조회 쓰레드 등록/해제 (그 쓰레드의 루프 시작과 끝). 칸이 모자라면 std::runtime_error
+    size_t registerReader();
+    void unregisterReader(size_t reader);
+
+    // 차단 대상이면 일치한 범위를 range에 담고 true (등록한 조회 쓰레드)
+    bool isBlocked(uint32_t addr, Cidr& range) const;
+    // 이 reader가 조회 중인 목록이 없는 시점에 호출: 현재 epoch를 알리고,
+    // 모든 reader가 지나간 이전 목록을 해제
+    void reclaim(size_t reader);
+
+    // "blocklist" 명령 응답
+    std::string describe() const;
+
+    AcceptFilter(const AcceptFilter&) = delete;
+    AcceptFilter& operator=(const AcceptFilter&) = delete;
+
+private:
+    AcceptFilter() = default;
+    ~AcceptFilter();
+
+    bool configure();   // path_ 채우기 (mutex_ 아래)
+    void reloadThread();
+
+    std::atomic<const IpBlocklist*> current_{nullptr};
+    mutable std::atomic<uint64_t> blocked_{0};
+
+    struct Retired {
+        const IpBlocklist* list;
+        uint64_t epoch;         // 교체로 시작된 epoch: 모든 reader가 이 값 이상을 알리면 해제
+    };
+
+    std::atomic<uint64_t> epoch_{1};
+    std::array<std::atomic<uint64_t>, MAX_READERS> readers_{};   // reader가 마지막으로 알린 epoch (0 = 빈 칸)
+
+    mutable std::mutex mutex_;   // 교체, reader 등록과 이전 목록 보관
+    std::vector<Retired> retired_;
+    std::atomic<bool> has_retired_{false};
+    std::string path_;
+
+    // requestReload 쓰레드 (한 번에 하나, mutex_ 아래에서 상태 관리)
+    std::thread reloader_;
+    bool reloading_{false};
+    bool reload_again_{false};
+    std::string reload_error_;   // 마지막 백그라운드 reload 실패 이유 (성공하면 비움)
+};
@@ -0,0 +1,105 @@
+#pragma once
+#include "Context.h"
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// 줄 단위 JSON 프로토콜 (CHAT_JSON_PORT로 받은 연결). 한 줄에 객체 하나:
+//   {"type":"join","room":0,"token":"..."}        {"type":"leave"} / {"type":"leave","room":1}
+//   {"type":"chat","text":"..."}                  {"type":"chat","room":1,"text":"..."}
+//   {"type":"command","text":"stats"}             {"type":"multicast","rooms":[0,1],"users":["a"],"text":"..."}
+// 수신 줄은 같은 의미의 ChatMessage로 바꿔 기존 처리 경로에 넘기고,
+// 송신 프레임은 {"type":"chat"|"ack"|"error"|"notification"|"reconnect"|"command",...} 한 줄로 바꾼다
+namespace json {
+
+// 따옴표 밖의 구조 문자({ } [ ] : ,)와 문자열 경계(")의 위치. SSE2가 있으면 16바이트씩 비교해
+// 비트마스크로 모으고, 이스케이프된 따옴표와 문자열 안의 문자를 마스크 연산으로 걸러낸다
+class StructuralIndex {
+public:
+    // 닫히지 않은 문자열이 있으면 false
+    bool build(const char* data, size_t length);
+    const std::vector<uint32_t>& positions() const { return positions_; }
+
+private:
+    void addBlock(size_t offset, uint32_t quotes, uint32_t backslashes, uint32_t structurals);
+
+    std::vector<uint32_t> positions_;
+    bool in_string_{false};
+    bool escaped_{false};       // 앞 블록이 홀수 개의 역슬래시로 끝남
+};
+
+// JSON 한 줄 → 수신 프레임. 형식이 틀리거나 본문이 프레임에 들어가지 않으면 false (error에 이유)
+bool decode(const char* line, size_t length, ChatMessage& out, std::string& error);
+
+// 송신 프레임 → JSON 한 줄 ('\n' 포함)
+std::string encode(const ChatMessage& message);
+
+// JSON 문자열 이스케이프. 바꿀 필요 없는 구간은 16바이트씩 찾아 통째로 복사
+void appendEscaped(std::string& out, const char* data, size_t length);
+
+}  // namespace json
+
+// JSON 연결의 줄 재조립 (바이너리 연결의 FrameAssembler에 해당)
+class JsonLineAssembler {
+public:
+    static constexpr size_t MAX_LINE = 4096;   // 512바이트 본문을 \u 이스케이프해도 들어가는 길이
+
+    // 완성된 줄마다 on_frame(const ChatMessage&) 호출, false를 반환하면 중단. 해석할 수 없는 줄은
+    // on_error(이유)로 알리고 다음 줄로 넘어간다 (줄 경계는 잃지 않으므로). 줄이 MAX_LINE을 넘으면 false
+    template <typename OnFrame, typename OnError>
+    bool feed(const uint8_t* data, size_t len, OnFrame&& on_frame, OnError&& on_error) {
+        const char* cursor = reinterpret_cast<const char*>(data);
+        const char* end = cursor + len;
+        while (cursor < end) {
+            const char* newline = static_cast<const char*>(memchr(cursor, '\n', end - cursor));
+            if (!newline) {
+                if (partial_.size() + (end - cursor) > MAX_LINE) {
+                    return false;
+                }
+                partial_.append(cursor, end);
+                return true;
+            }
+
+            // 버퍼 안에 온전히 든 줄은 복사 없이 바로 해석
+            const char* line = cursor;
+            size_t line_len = newline - cursor;
+            if (!partial_.empty()) {
+                partial_.append(cursor, newline);
+                line = partial_.data();
+                line_len = partial_.size();
+            }
+            cursor = newline + 1;
+            if (line_len > MAX_LINE) {
+                return false;
+            }
+            if (line_len > 0 && line[line_len - 1] == '\r') {
+                --line_len;
+            }
+            if (line_len == 0) {
+                partial_.clear();
+                continue;   // 빈 줄(keep-alive)은 무시
+            }
+
+            ChatMessage message;
+            std::string error;
+            const bool valid = json::decode(line, line_len, message, error);
+            partial_.clear();
+            if (!valid) {
+                on_error(error);
+            } else if (!on_frame(static_cast<const ChatMessage&>(message))) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    void reset() { partial_.clear(); }
+    size_t buffered() const { return partial_.size(); }
+
+private:
+    std::string partial_;
+};
@@ -2,21 +2,35 @@
 #include "IOUring.h"
 #include "SocketManager.h"
 #include "SessionManager.h"
+#include <atomic>
 #include <memory>
 #include <unistd.h>  // for close()
 
 class Listener {
 public:
-    explicit Listener(int port, SocketManager& socket_manager);
+    // format: 이 포트로 받은 연결의 전송 형식 (CHAT_JSON_PORT는 WireFormat::JSON)
+    Listener(int port, SocketManager& socket_manager, WireFormat format = WireFormat::BINARY);
     ~Listener();
 
     void start();
     void processEvents();
     void stop();
+    // processEvents 루프를 빠져나오게 한다 (시그널 핸들러에서 호출 가능)
+    void requestStop();
+    // 연결을 세션에 배정 (accept 완료와 합성 클라이언트 등록이 같은 경로). 실패하면 fd를 닫고 false
+    bool admitClient(int client_fd);
 
 private:
+    // accept 완료 시 이미 도착한 CLIENT_JOIN 프레임(JSON 연결은 첫 줄)에서 요청 세션 확인
+    int32_t peekJoinSession(int client_fd);
+    // 연결 주소가 차단 목록(CHAT_BLOCKLIST)에 걸리는가
+    bool isBlockedPeer(int client_fd);
+
     int port_;
+    WireFormat format_;
     bool running_;
+    std::atomic<bool> stop_requested_{false};
     std::unique_ptr<IOUring> io_ring_;
     SocketManager& socket_manager_;
+    size_t blocklist_reader_{0};   // processEvents 동안 AcceptFilter에 등록한 reader 칸
 }; 
\ No newline at end of file
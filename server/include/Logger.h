@@ -4,6 +4,7 @@
 #include <string>
 #include <mutex>
 #include <atomic>
+#include "StallProbe.h"
 
 enum class LogLevel {
     TRACE = 0,   // 가장 상세한 디버깅 정보
@@ -32,7 +33,7 @@ public:
     template<typename... Args>
     void log(LogLevel level, const char* file, int line, Args... args) {
         if (level >= current_level_.load()) {
-            std::lock_guard<std::mutex> lock(mutex_);
+            ProbedLockGuard<std::mutex> lock(mutex_, "Logger");
             std::cout << "[" << getLevelString(level) << "] "
                      << "[" << file << ":" << line << "] ";
             (std::cout << ... << args) << std::endl;
@@ -0,0 +1,118 @@
+#pragma once
+#include "Context.h"
+#include "PipeFanout.h"
+#include "AttachmentStore.h"
+#include "RoomBacklog.h"
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <string>
+#include <vector>
+
+// 송신 대기 프레임. 브로드캐스트 대상끼리 같은 ChatMessage를 공유한다
+// (프레임이 내용을 소유하므로 수신 버퍼는 큐에 넣는 즉시 버퍼 링에 반환)
+struct OutboundFrame {
+    std::shared_ptr<const ChatMessage> message;
+    int64_t deadline_ns;      // 0: 기한 없음 (ACK/에러 등 제어 프레임)
+    std::shared_ptr<const PipeFrame> pipe;   // 있으면 write 대신 tee/splice로 전송
+    std::shared_ptr<const AttachmentFile> file;   // 있으면 프레임 대신 파일 본문을 splice로 전송
+    RoomBacklog* room;        // 방 브로드캐스트 프레임이면 대기 중인 동안 방 backlog에 잡힘
+    std::shared_ptr<const std::string> text;   // JSON 연결: message 대신 보낼 한 줄 (브로드캐스트 대상끼리 공유)
+};
+
+// splice 완료 후 다음 동작
+enum class SpliceProgress {
+    PARTIAL,      // 연결 파이프에 남은 바이트를 이어서 소켓으로
+    NEXT_CHUNK,   // 첨부 파일의 다음 chunk를 파이프로 채워야 함
+    DONE          // 파이프 프레임/첨부 파일 전송 완료
+};
+
+// 연결별 송신 큐: write는 한 번에 하나만 진행해 프레임 순서와 경계를 보장하고,
+// 대기 중 기한이 지난 실시간 프레임은 flush 시점에 건너뛴다
+// (밀린 클라이언트는 backlog를 재생하지 않고 바로 "현재"로 따라잡음)
+class OutboundQueue {
+public:
+    static constexpr size_t MAX_BATCH_FRAMES = 16;   // write 한 번에 모을 최대 프레임 수
+
+    OutboundQueue() = default;
+    ~OutboundQueue() { clearPending(); }
+    OutboundQueue(const OutboundQueue&) = delete;
+    OutboundQueue& operator=(const OutboundQueue&) = delete;
+
+    void push(OutboundFrame&& frame) {
+        if (frame.room) {
+            frame.room->add(sizeof(ChatMessage));
+        }
+        pending_.push_back(std::move(frame));
+    }
+    void clearPending() {
+        while (!pending_.empty()) {
+            popFront();
+        }
+    }
+
+    bool inFlight() const { return !staging_.empty() || splicing(); }
+    bool hasPending() const { return !pending_.empty(); }
+
+    // 기한 지난 프레임은 건너뛰고(skipped에 더함) 나머지를 최대 MAX_BATCH_FRAMES개 staging 버퍼에 복사.
+    // 파이프 프레임과 첨부 파일은 묶지 않고 맨 앞에 올 때 단독으로 splicing()에 올린다.
+    // 반환값: 이번에 write할 바이트 수 (0이면 보낼 것 없음, splicing()이면 splice 전송)
+    size_t stage(int64_t now_ns, size_t& skipped);
+
+    // 파이프 프레임 또는 첨부 파일을 splice로 전송 중인가
+    bool splicing() const { return splice_frame_ || splice_file_; }
+    const PipeFrame* spliceFrame() const { return splice_frame_.get(); }
+    const AttachmentFile* spliceFile() const { return splice_file_.get(); }
+    // 연결 파이프에 남은(아직 소켓으로 못 보낸) 바이트
+    unsigned spliceRemaining() const { return splice_remaining_; }
+    // 첨부 파일의 다음 chunk를 잡는다. 파일 오프셋을 offset에 담고 chunk 크기 반환
+    unsigned nextFileChunk(unsigned max_bytes, uint64_t& offset);
+    // 소켓으로 bytes만큼 splice됨
+    SpliceProgress completeSplice(size_t bytes);
+    // tee 실패 등으로 파이프 프레임/첨부 파일을 보내지 못하고 포기
+    void abortSplice();
+    // 종료된 연결의 미전송분 폐기 (같은 fd 번호의 새 연결로 새지 않게)
+    void resetInFlight();
+
+    // write 진행 중 앞쪽의 만료 프레임 제거 (소켓이 막힌 연결의 메모리 상한). 제거한 수 반환
+    size_t pruneExpired(int64_t now_ns);
+
+    // write 완료 처리. 끝까지 전송된 프레임 수를 frames_sent에 더하고, 남은 바이트 수 반환 (부분 전송 시 > 0)
+    size_t complete(size_t bytes, size_t& frames_sent);
+
+    // 현재 write 대상 (staging 버퍼 내 미전송 구간)
+    const uint8_t* data() const { return staging_.data() + offset_; }
+    size_t remaining() const { return staging_.size() - offset_; }
+
+    uint64_t getSkipped() const { return skipped_; }
+
+    bool closing{false};      // 연결 종료 후 진행 중인 write 완료를 기다리는 중
+    int32_t zc_result{0};     // SEND_ZC 결과. 버퍼 해제 알림(F_NOTIF)이 올 때 완료 처리
+    bool fill_failed{false};  // 연결된 splice가 -ECANCELED로 돌아올 때 원인 구분용 (tee/파일 읽기 실패)
+    bool close_after_flush{false};  // 셧다운 드레인: 남은 프레임을 다 보내면 송신 방향을 닫음
+    PipePair pipe;            // SPLICE 팬아웃/첨부 다운로드용 연결 파이프 (커널 쪽 송신 대기열)
+    bool json{false};         // JSON 연결: 프레임마다 text를 붙여 넣는다 (길이가 프레임마다 다름)
+
+private:
+    bool expired(const OutboundFrame& frame, int64_t now_ns) const {
+        return frame.deadline_ns != 0 && frame.deadline_ns < now_ns;
+    }
+    // 대기열에서 빼면서 방 backlog에서도 뺀다 (staging/splice로 넘어간 뒤는 연결별 상한으로 묶임)
+    void popFront() {
+        if (RoomBacklog* room = pending_.front().room) {
+            room->release(sizeof(ChatMessage));
+        }
+        pending_.pop_front();
+    }
+
+    std::deque<OutboundFrame> pending_;
+    std::vector<uint8_t> staging_;          // 전송 중인 프레임 복사본, write 완료 전까지 변경 금지
+    size_t offset_{0};                      // staging_ 중 전송 완료된 바이트
+    size_t frames_done_{0};                 // staging_ 중 전송 완료된 프레임
+    std::vector<size_t> frame_ends_;        // staging_ 안 프레임별 끝 위치 (JSON 줄은 길이가 제각각)
+    uint64_t skipped_{0};
+    std::shared_ptr<const PipeFrame> splice_frame_;
+    std::shared_ptr<const AttachmentFile> splice_file_;
+    uint64_t file_offset_{0};               // 다음 chunk의 파일 오프셋
+    unsigned splice_remaining_{0};
+};
@@ -0,0 +1,92 @@
+#pragma once
+#include <liburing.h>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// 브로드캐스트 전송 방식 (CHAT_FANOUT=write|splice|zc)
+//   WRITE:  연결마다 프레임을 staging 버퍼에 복사해 write
+//   SPLICE: 프레임을 파이프에 한 번만 쓰고, 수신자마다 tee로 복제해 소켓으로 splice
+//           (수신자별로 사용자 공간에서 payload를 건드리지 않음, 실험적)
+//   SEND_ZC: write 대신 IORING_OP_SEND_ZC (커널이 버퍼를 다 쓸 때까지 staging 유지)
+enum class FanoutMode { WRITE, SPLICE, SEND_ZC };
+
+// 파이프 fd 쌍 (이동만 가능, 소멸 시 닫음)
+class PipePair {
+public:
+    PipePair() = default;
+    ~PipePair() { reset(); }
+    PipePair(PipePair&& other) noexcept : read_fd_(other.read_fd_), write_fd_(other.write_fd_) {
+        other.read_fd_ = other.write_fd_ = -1;
+    }
+    PipePair& operator=(PipePair&& other) noexcept;
+    PipePair(const PipePair&) = delete;
+    PipePair& operator=(const PipePair&) = delete;
+
+    // 논블로킹 파이프 생성. 실패 시 false
+    bool open();
+    void reset();
+    bool isOpen() const { return read_fd_ >= 0; }
+    int readFd() const { return read_fd_; }
+    int writeFd() const { return write_fd_; }
+
+private:
+    int read_fd_{-1};
+    int write_fd_{-1};
+};
+
+class PipeFanout;
+
+// 파이프에 한 번 써 둔 프레임. 마지막 수신자의 splice가 끝나 참조가 사라지면 풀로 반환
+class PipeFrame {
+public:
+    PipeFrame(PipeFanout* owner, PipePair&& pipe, unsigned length)
+        : owner_(owner), pipe_(std::move(pipe)), length_(length) {}
+    ~PipeFrame();
+
+    int readFd() const { return pipe_.readFd(); }
+    unsigned length() const { return length_; }
+
+    PipeFrame(const PipeFrame&) = delete;
+    PipeFrame& operator=(const PipeFrame&) = delete;
+
+private:
+    PipeFanout* owner_;
+    PipePair pipe_;
+    unsigned length_;
+};
+
+// 원본 파이프 풀 + tee/splice SQE 준비. 풀은 여러 쓰레드에서 반환될 수 있어 잠금 사용
+class PipeFanout {
+public:
+    static constexpr size_t MAX_POOLED_PIPES = 64;
+    static constexpr unsigned DEFAULT_MIN_PAYLOAD = 256;   // 이보다 짧은 메시지는 write가 더 쌈
+
+    PipeFanout() = default;
+    PipeFanout(const PipeFanout&) = delete;
+    PipeFanout& operator=(const PipeFanout&) = delete;
+
+    // 프레임을 원본 파이프에 한 번 쓴다 (write 1회). 실패 시 nullptr → 호출자는 write 경로 사용
+    std::shared_ptr<const PipeFrame> load(const void* data, unsigned length);
+
+    // CHAT_FANOUT 환경 변수 해석 (없으면 WRITE). 알 수 없는 값은 std::runtime_error
+    static FanoutMode modeFromEnv();
+    static FanoutMode parseMode(const std::string& name);
+    static const char* modeName(FanoutMode mode);
+    // CHAT_FANOUT_MIN_PAYLOAD: splice 경로를 쓸 최소 payload 길이
+    static unsigned minPayloadFromEnv();
+
+    // 원본 파이프 → 연결 파이프 tee, 이어서 연결 파이프 → 소켓 splice (IOSQE_IO_LINK로 순서 보장).
+    // tee는 성공 시 CQE를 만들지 않는다
+    static void prepTee(io_uring_sqe* sqe, int src_pipe, int conn_pipe, unsigned length);
+    static void prepSpliceToSocket(io_uring_sqe* sqe, int conn_pipe, int socket_fd, unsigned length);
+
+private:
+    friend class PipeFrame;
+    void recycle(PipePair&& pipe, unsigned length);
+
+    std::mutex mutex_;
+    std::vector<PipePair> pool_;
+};
@@ -0,0 +1,45 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// RaftNode의 메모리 로그와 그 위의 규칙 (로그 일치 검사, 충돌 정리, 커밋 지점).
+// 네트워크와 디스크는 RaftNode가 맡는다. 인덱스는 1부터이고 0은 첫 항목 앞
+class RaftLog {
+public:
+    struct Entry {
+        uint64_t term{0};
+        std::string command;
+    };
+
+    // 리더가 보낸 항목을 맞춰 넣은 결과
+    struct MergeResult {
+        uint64_t last_index{0};     // 요청이 덮는 마지막 인덱스 (성공 응답의 match_index)
+        uint64_t first_new{0};      // 새로 붙은 첫 인덱스 (없으면 0)
+        bool truncated{false};      // 충돌한 뒤쪽을 버림: 로그 파일을 통째로 다시 써야 한다
+    };
+
+    uint64_t lastIndex() const { return entries_.size(); }
+    uint64_t termAt(uint64_t index) const { return index == 0 || index > entries_.size() ? 0 : entries_[index - 1].term; }
+    const Entry& at(uint64_t index) const { return entries_[index - 1]; }
+    const std::vector<Entry>& entries() const { return entries_; }
+
+    void append(uint64_t term, std::string command) { entries_.push_back(Entry{term, std::move(command)}); }
+    // last_index 뒤를 버린다
+    void truncate(uint64_t last_index);
+
+    // 투표 요청자의 로그가 이 로그보다 뒤처지지 않았는가 (Raft 5.4.1)
+    bool isUpToDate(uint64_t last_log_index, uint64_t last_log_term) const;
+    // prev_index 위치의 항목이 prev_term인가 (AppendEntries 일치 검사, 0은 항상 일치)
+    bool matches(uint64_t prev_index, uint64_t prev_term) const;
+    // matches를 통과한 뒤: prev_index 다음부터 entries를 맞춰 넣는다. 이미 같은 항목은 두고,
+    // 임기가 다른 항목을 만나면 그 뒤를 버린다 (순서가 바뀌어 늦게 온 요청도 로그를 줄이지 않는다)
+    MergeResult merge(uint64_t prev_index, std::vector<Entry> entries);
+    // 리더: 자기 포함 majority개 노드가 가진 현재 임기 항목 중 가장 뒤 인덱스 (Raft 5.4.2). 없으면 commit_index
+    uint64_t majorityCommit(uint64_t commit_index, uint64_t current_term, const std::vector<uint64_t>& peer_match,
+                            size_t majority) const;
+
+private:
+    std::vector<Entry> entries_;
+};
@@ -0,0 +1,200 @@
+#pragma once
+#include "RaftLog.h"
+#include "RoomDirectory.h"
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <netinet/in.h>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Raft 메시지 (UDP 데이터그램 하나에 하나, 리틀 엔디언). 유실/중복/순서 바뀜은 Raft가 견디므로
+// 노드 사이에 연결을 유지하지 않는다. CHAT_RAFT_SECRET이 있으면 끝에 HMAC-SHA256(RAFT_MAC_SIZE)이 붙는다
+enum class RaftMessageType : uint8_t {
+    VOTE_REQUEST = 0x01,
+    VOTE_REPLY = 0x02,
+    APPEND_REQUEST = 0x03,      // 하트비트 겸 로그 복제
+    APPEND_REPLY = 0x04,
+    PROPOSAL = 0x05,            // 팔로워가 받은 변경 요청을 리더로 전달
+    PROPOSAL_REPLY = 0x06       // 리더가 로그에 붙였는지 (거절이면 팔로워가 다시 보낸다)
+};
+
+constexpr size_t RAFT_MAC_SIZE = 32;
+
+#pragma pack(push, 1)
+struct RaftHeader {
+    RaftMessageType type;
+    uint32_t from;
+    uint64_t term;
+};
+
+struct RaftVoteRequest {
+    uint64_t last_log_index;
+    uint64_t last_log_term;
+};
+
+struct RaftVoteReply {
+    uint8_t granted;
+};
+
+struct RaftAppendRequest {
+    uint64_t prev_log_index;
+    uint64_t prev_log_term;
+    uint64_t leader_commit;
+    uint16_t count;             // 뒤따르는 RaftEntryHeader + 본문 수
+};
+
+struct RaftAppendReply {
+    uint8_t success;
+    uint64_t match_index;       // 성공: 일치한 마지막 인덱스, 실패: 팔로워 로그의 마지막 인덱스 (되감기 힌트)
+};
+
+struct RaftProposal {
+    uint64_t proposal_id;       // 보낸 노드 안에서만 유일. 뒤에 DirectoryCommand 본문
+};
+
+struct RaftProposalReply {
+    uint64_t proposal_id;
+    uint8_t accepted;
+};
+
+struct RaftEntryHeader {
+    uint64_t term;
+    uint16_t length;
+};
+#pragma pack(pop)
+
+// 방 디렉터리(방 → 소유 노드, 설정)만 복제하는 내장 Raft 노드. 메시지 경로에는 끼지 않고,
+// 커밋된 항목을 적용할 때마다 RoomDirectory에 새 불변 스냅샷을 publish한다.
+//   CHAT_RAFT_ID=1                                   이 노드 id (없으면 비활성)
+//   CHAT_RAFT_PEERS=1=127.0.0.1:9701,2=...:9702      자기 자신을 포함한 전체 구성. 자기 주소에 bind하고,
+//                                                    등록된 피어 주소:포트에서 온 메시지만 받는다
+//   CHAT_RAFT_SECRET=...                             노드 간 공유 비밀 (있으면 모든 메시지에 MAC을 붙이고 검사)
+//   CHAT_RAFT_DIR=/var/lib/chat                      임기/투표/로그 저장 위치 (없으면 메모리만: 재시작 시 안전하지 않음)
+//   CHAT_RAFT_ADVERTISE=host:port                    방 이동 안내에 쓸 이 노드의 클라이언트 주소
+// 변경은 드물다고 보고 리더가 TICK_MS마다 모아서 한 번에 보낸다. 로그 압축(스냅샷)은 하지 않는다
+class RaftNode {
+public:
+    static constexpr int TICK_MS = 10;
+    static constexpr int HEARTBEAT_MS = 50;
+    static constexpr int ELECTION_MIN_MS = 300;
+    static constexpr int ELECTION_MAX_MS = 600;
+    static constexpr size_t MAX_DATAGRAM = 60 * 1024;
+    static constexpr int PROPOSAL_TIMEOUT_MS = 1000;    // 전달한 제안의 응답을 기다리는 시간
+    static constexpr uint32_t MAX_PROPOSAL_ATTEMPTS = 5;
+
+    enum class Role : uint8_t { FOLLOWER, CANDIDATE, LEADER };
+
+    static RaftNode& getInstance() {
+        static RaftNode instance;
+        return instance;
+    }
+
+    // 설정을 읽고 UDP 소켓을 열어 Raft 쓰레드 시작 (메인 쓰레드). 설정이 없으면 아무것도 하지 않는다
+    void start(const std::string& default_advertise);
+    void stop();
+
+    bool isEnabled() const { return node_id_ != 0; }
+    // 디렉터리 변경 제안 (아무 쓰레드). 리더가 아니면 리더에게 전달하며, 커밋되면 스냅샷에 반영된다
+    bool propose(const DirectoryCommand& command, const std::string& address = std::string());
+
+    // "directory" 명령 응답
+    std::string describe();
+
+    RaftNode(const RaftNode&) = delete;
+    RaftNode& operator=(const RaftNode&) = delete;
+
+private:
+    RaftNode() = default;
+    ~RaftNode();
+
+    struct Peer {
+        uint32_t id{0};
+        sockaddr_in address{};
+        uint64_t next_index{1};
+        uint64_t match_index{0};
+        bool vote_granted{false};
+    };
+
+    // 리더에게 전달하고 응답을 기다리는 제안 (보낸 적 없으면 attempts 0)
+    struct ForwardedProposal {
+        uint64_t id{0};
+        std::string command;
+        int64_t sent_ms{0};
+        uint32_t attempts{0};
+    };
+
+    void run();
+    void tick(int64_t now_ms);
+    void receive(int64_t now_ms);
+    void handleVoteRequest(const RaftHeader& header, const char* body, size_t length, Peer& peer, int64_t now_ms);
+    void handleVoteReply(const RaftHeader& header, const char* body, size_t length, Peer& peer);
+    void handleAppendRequest(const RaftHeader& header, const char* body, size_t length, Peer& peer, int64_t now_ms);
+    void handleAppendReply(const RaftHeader& header, const char* body, size_t length, Peer& peer);
+    void handleProposal(const char* body, size_t length, Peer& peer);
+    void handleProposalReply(const char* body, size_t length);
+
+    void becomeFollower(uint64_t term, int64_t now_ms);
+    void becomeCandidate(int64_t now_ms);
+    void becomeLeader();
+    void sendAppend(Peer& peer);
+    void sendTo(const Peer& peer, std::string datagram);
+    std::string makeHeader(RaftMessageType type) const;
+    std::string computeMac(const char* data, size_t length) const;
+    // 로그에 붙이고 저장. 저장에 실패하면 되돌리고 false
+    bool appendLocal(std::string command);
+    void advanceCommit();
+    void applyCommitted();
+    void drainProposals(int64_t now_ms);
+    void forwardProposals(int64_t now_ms);
+    void resetElectionTimer(int64_t now_ms);
+
+    uint64_t lastIndex() const { return log_.lastIndex(); }
+    uint64_t termAt(uint64_t index) const { return log_.termAt(index); }
+    size_t majority() const { return (peers_.size() + 1) / 2 + 1; }
+
+    // CHAT_RAFT_DIR 아래 임기/투표 파일과 로그 파일. 실패하면 false (투표/성공 응답을 하지 않는다)
+    void loadState();
+    bool persistMeta();
+    bool persistAppend(uint64_t from_index);
+    bool persistRewrite();
+
+    uint32_t node_id_{0};
+    std::vector<Peer> peers_;           // 자기 자신 제외
+    std::string data_dir_;
+    std::string advertise_;
+    std::string secret_;
+    int socket_fd_{-1};
+    std::thread thread_;
+    std::atomic<bool> should_stop_{false};
+    std::mt19937 rng_{std::random_device{}()};
+
+    // Raft 쓰레드 전용 상태
+    Role role_{Role::FOLLOWER};
+    uint64_t current_term_{0};
+    uint32_t voted_for_{0};
+    uint32_t leader_id_{0};
+    RaftLog log_;
+    uint64_t commit_index_{0};
+    uint64_t last_applied_{0};
+    int64_t election_deadline_ms_{0};
+    int64_t last_heartbeat_ms_{0};
+    bool replicate_now_{false};         // 새 항목이 붙음: 하트비트를 기다리지 않고 이번 틱에 전송
+    int64_t last_advertise_ms_{0};
+    bool rewrite_log_{false};           // 덧붙이기가 실패해 파일 끝이 메모리와 다를 수 있음: 다음에 통째로 다시 쓴다
+    std::vector<ForwardedProposal> forwarded_;
+    uint64_t next_proposal_id_{1};
+    uint64_t proposals_failed_{0};      // 리더에 붙지 못하고 버린 제안
+    uint64_t messages_rejected_{0};     // 등록되지 않은 주소이거나 MAC이 맞지 않는 메시지
+    DirectorySnapshot state_;
+
+    // 다른 쓰레드의 제안 (TICK_MS마다 모아 처리)
+    std::mutex proposals_mutex_;
+    std::vector<std::string> proposals_;
+
+    // describe()용
+    mutable std::mutex status_mutex_;
+    std::string status_;
+};
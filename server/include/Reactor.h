@@ -0,0 +1,13 @@
+#pragma once
+
+// 컴파일 시 I/O 백엔드 선택 (CMake: -DCHAT_IO_BACKEND=epoll)
+// 두 백엔드 모두 SQE를 받아 CQE를 돌려주는 동일한 인터페이스를 제공한다:
+//   getSQE / sqReady / submit / submitAndWait / peekBatch / advance /
+//   registerBufRing / supportsOpcode
+#ifdef CHAT_IO_BACKEND_EPOLL
+#include "EpollReactor.h"
+using Reactor = EpollReactor;
+#else
+#include "UringReactor.h"
+using Reactor = UringReactor;
+#endif
@@ -0,0 +1,140 @@
+#pragma once
+#include "IpBlocklist.h"
+#include "RoomJournal.h"
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// 노드 간 복제 스트림 (TCP, 리틀 엔디언). 프라이머리가 BATCH를 연달아 보내고(응답을 기다리지 않음)
+// 백업은 적용한 배치마다 ACK를 돌려준다
+enum class ReplicaFrameType : uint8_t {
+    BATCH = 0x01,
+    ACK = 0x02
+};
+
+enum class ReplicaEntryKind : uint8_t {
+    RECORD = 0x01,      // seq 순번의 기록, 본문 length바이트가 뒤따름
+    RESET = 0x02        // 재동기화: 방 기록을 비우고 다음 순번을 seq로 (뒤이어 보관 중인 기록)
+};
+
+#pragma pack(push, 1)
+struct ReplicaFrameHeader {
+    ReplicaFrameType type;
+    uint64_t batch_id;
+    uint32_t length;            // 뒤따르는 엔트리 바이트 수 (ACK는 0)
+};
+
+struct ReplicaEntryHeader {
+    ReplicaEntryKind kind;
+    int32_t room_id;
+    uint64_t seq;
+    int64_t sent_at_ms;
+    uint16_t length;
+};
+#pragma pack(pop)
+
+// 방 기록의 primary/backup 복제.
+//   CHAT_REPLICA_BACKUP=host:port   이 노드가 프라이머리: 기록을 모아 백업으로 스트리밍
+//   CHAT_REPLICA_LISTEN=port        이 노드가 백업: 프라이머리의 스트림을 받아 자기 RoomHistory에 적용
+//   CHAT_REPLICA_PRIMARY=addr[,...] 백업이 받아들일 프라이머리 주소/CIDR (기본 루프백만).
+//                                   스트림은 방 기록을 덮어쓰므로 다른 주소의 연결은 받자마자 끊는다
+// 워커는 publish로 큐에 넣기만 하고, 묶기/전송/재접속은 복제 쓰레드가 CHAT_REPLICA_BATCH_MS마다 한다.
+// 접속(재접속)할 때마다 모든 방의 스냅샷을 먼저 보내므로 끊긴 동안 놓친 기록도 따라잡는다.
+// 장애 시 클라이언트가 백업으로 옮겨 가면 백업은 복제된 기록을 보여 주고 이어서 순번을 매긴다
+class Replication {
+public:
+    static constexpr uint32_t DEFAULT_BATCH_MS = 5;
+    static constexpr size_t MAX_BATCH_BYTES = 256 * 1024;           // 넘으면 배치를 나눈다
+    static constexpr size_t MAX_FRAME_BYTES = 16 * 1024 * 1024;     // 백업이 받아들이는 상한
+    static constexpr size_t DEFAULT_MAX_BUFFERED = 8 * 1024 * 1024; // 백업이 못 따라오면 끊고 재동기화
+    static constexpr int RECONNECT_MS = 1000;
+
+    struct Config {
+        std::string backup_host;        // 비어 있으면 프라이머리 비활성
+        uint16_t backup_port{0};
+        uint16_t listen_port{0};        // 0이면 백업 비활성
+        uint32_t batch_ms{DEFAULT_BATCH_MS};
+        size_t max_buffered{DEFAULT_MAX_BUFFERED};  // CHAT_REPLICA_MAX_BUFFERED
+        std::vector<Cidr> primaries;                // CHAT_REPLICA_PRIMARY
+
+        static Config fromEnv();
+    };
+
+    static Replication& getInstance() {
+        static Replication instance;
+        return instance;
+    }
+
+    // 복제 쓰레드 시작 (메인 쓰레드, 세션 시작 후). 설정이 없으면 아무것도 하지 않는다
+    void start();
+    // 남은 배치를 잠시 내보내 본 뒤 쓰레드 종료
+    void stop();
+
+    bool isPrimary() const { return primary_.load(std::memory_order_acquire); }
+    // 워커 쓰레드: 방금 기록한 항목을 다음 배치에 싣는다 (팬아웃 경로에서는 잠금 한 번).
+    // RoomJournal::append가 방 잠금 아래에서 불러 방마다 순번 순서로 쌓인다
+    void publish(JournalRecordPtr record);
+
+    // "replication" 명령 응답
+    std::string describe() const;
+
+    Replication(const Replication&) = delete;
+    Replication& operator=(const Replication&) = delete;
+
+private:
+    Replication() = default;
+    ~Replication();
+
+    void runPrimary();
+    void runBackup();
+    bool isAllowedPrimary(uint32_t addr) const;   // 호스트 바이트 순서 IPv4
+
+    int connectBackup();
+    // 대기열을 배치로 묶어 out_에 붙인다 (snapshot이면 대기열 대신 모든 방의 스냅샷)
+    void encodePending(bool snapshot);
+    void appendEntry(ReplicaEntryKind kind, int32_t room_id, uint64_t seq, int64_t sent_at_ms,
+                     const std::string& text);
+    void closeBatch();
+    bool flushOut(int fd);              // 보낼 수 있는 만큼 보냄. 연결이 끊겼으면 false
+    bool readAcks(int fd);
+
+    // 백업: 받은 바이트에서 완성된 프레임을 적용하고 ACK. 형식이 깨졌으면 false
+    bool applyFrames(int fd, std::string& buffer);
+    void applyEntries(const char* data, size_t length);
+
+    Config config_;
+    std::atomic<bool> primary_{false};
+    std::atomic<bool> should_stop_{false};
+    std::thread primary_thread_;
+    std::thread backup_thread_;
+    int listen_fd_{-1};
+
+    std::mutex pending_mutex_;
+    std::vector<JournalRecordPtr> pending_;
+
+    // 복제 쓰레드 전용
+    std::string out_;
+    size_t out_offset_{0};
+    size_t batch_start_{std::string::npos};   // 쓰는 중인 배치 머리의 위치
+    uint64_t next_batch_id_{1};
+    std::string ack_buffer_;
+
+    std::atomic<bool> connected_{false};
+    std::atomic<uint64_t> batches_sent_{0};
+    std::atomic<uint64_t> batches_acked_{0};    // 마지막으로 ACK된 배치 번호
+    std::atomic<uint64_t> last_batch_id_{0};
+    std::atomic<uint64_t> records_sent_{0};
+    std::atomic<uint64_t> bytes_sent_{0};
+    std::atomic<uint64_t> snapshots_{0};
+    std::atomic<uint64_t> resyncs_{0};          // 백업이 밀려 끊은 횟수
+    std::atomic<uint64_t> records_dropped_{0};  // 연결이 없을 때 버린 기록 (다음 스냅샷이 덮음)
+
+    std::atomic<bool> primary_attached_{false};
+    std::atomic<uint64_t> primaries_rejected_{0};   // 허용 목록 밖에서 온 연결
+    std::atomic<uint64_t> batches_applied_{0};
+    std::atomic<uint64_t> records_applied_{0};
+    std::atomic<uint64_t> records_duplicate_{0};
+};
@@ -0,0 +1,95 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <sstream>
+#include <iomanip>
+
+// 워커 링별 syscall/완료 카운터 (워커 쓰레드가 쓰고 통계 요청 쓰레드가 읽음)
+struct RingStats {
+    std::atomic<uint64_t> ring_enters{0};         // io_uring_enter 호출 수
+    std::atomic<uint64_t> sqes_submitted{0};      // 제출된 SQE 수
+    std::atomic<uint64_t> cqes_reaped{0};         // 처리한 CQE 수
+    std::atomic<uint64_t> loop_iterations{0};     // 워커 루프 반복 수
+    std::atomic<uint64_t> frames_received{0};     // 재조립된 수신 프레임 수
+    std::atomic<uint64_t> messages_delivered{0};  // 전송 완료된 프레임 수
+    std::atomic<uint64_t> frames_skipped{0};      // 전달 기한이 지나 건너뛴 프레임 수
+    std::atomic<uint64_t> frames_spliced{0};      // 파이프 tee/splice로 전송한 프레임 수
+    std::atomic<uint64_t> worker_stalls{0};       // watchdog이 감지한 루프 정지 수
+    std::atomic<uint64_t> senders_throttled{0};   // 방 backlog 상한으로 recv를 멈춘 발신자 수
+    std::atomic<uint64_t> frames_rate_limited{0}; // 발신 IP 속도 상한으로 버린 채팅 메시지 수
+    std::atomic<uint64_t> frames_spam_dropped{0}; // 거의 같은 메시지 반복으로 버린 채팅 메시지 수
+    std::atomic<uint64_t> frames_routed{0};       // 다른 링에 I/O가 있는 방 구성원에게 넘긴 프레임 수
+    std::atomic<uint64_t> multicast_deduped{0};   // 멀티캐스트 대상이 겹쳐 한 번만 보낸 수신자 수
+    std::atomic<uint64_t> json_encoded{0};        // JSON 연결용으로 직렬화한 프레임 수 (브로드캐스트는 링마다 한 번)
+
+    static void bump(std::atomic<uint64_t>& counter, uint64_t n = 1) {
+        counter.fetch_add(n, std::memory_order_relaxed);
+    }
+};
+
+// 여러 워커의 RingStats 합산 결과
+struct RingStatsSnapshot {
+    uint64_t ring_enters{0};
+    uint64_t sqes_submitted{0};
+    uint64_t cqes_reaped{0};
+    uint64_t loop_iterations{0};
+    uint64_t frames_received{0};
+    uint64_t messages_delivered{0};
+    uint64_t frames_skipped{0};
+    uint64_t frames_spliced{0};
+    uint64_t worker_stalls{0};
+    uint64_t senders_throttled{0};
+    uint64_t frames_rate_limited{0};
+    uint64_t frames_spam_dropped{0};
+    uint64_t frames_routed{0};
+    uint64_t multicast_deduped{0};
+    uint64_t json_encoded{0};
+
+    void add(const RingStats& stats) {
+        ring_enters += stats.ring_enters.load(std::memory_order_relaxed);
+        sqes_submitted += stats.sqes_submitted.load(std::memory_order_relaxed);
+        cqes_reaped += stats.cqes_reaped.load(std::memory_order_relaxed);
+        loop_iterations += stats.loop_iterations.load(std::memory_order_relaxed);
+        frames_received += stats.frames_received.load(std::memory_order_relaxed);
+        messages_delivered += stats.messages_delivered.load(std::memory_order_relaxed);
+        frames_skipped += stats.frames_skipped.load(std::memory_order_relaxed);
+        frames_spliced += stats.frames_spliced.load(std::memory_order_relaxed);
+        worker_stalls += stats.worker_stalls.load(std::memory_order_relaxed);
+        senders_throttled += stats.senders_throttled.load(std::memory_order_relaxed);
+        frames_rate_limited += stats.frames_rate_limited.load(std::memory_order_relaxed);
+        frames_spam_dropped += stats.frames_spam_dropped.load(std::memory_order_relaxed);
+        frames_routed += stats.frames_routed.load(std::memory_order_relaxed);
+        multicast_deduped += stats.multicast_deduped.load(std::memory_order_relaxed);
+        json_encoded += stats.json_encoded.load(std::memory_order_relaxed);
+    }
+
+    double perMessage(uint64_t value) const {
+        return messages_delivered ? static_cast<double>(value) / messages_delivered : 0.0;
+    }
+
+    // "key=value" 형식: chat_benchmark가 그대로 파싱
+    std::string toString() const {
+        std::ostringstream ss;
+        ss << std::fixed << std::setprecision(4)
+           << "enters=" << ring_enters
+           << " sqes=" << sqes_submitted
+           << " cqes=" << cqes_reaped
+           << " loops=" << loop_iterations
+           << " received=" << frames_received
+           << " delivered=" << messages_delivered
+           << " skipped=" << frames_skipped
+           << " spliced=" << frames_spliced
+           << " stalls=" << worker_stalls
+           << " throttled=" << senders_throttled
+           << " limited=" << frames_rate_limited
+           << " spam=" << frames_spam_dropped
+           << " routed=" << frames_routed
+           << " deduped=" << multicast_deduped
+           << " json=" << json_encoded
+           << " enters_per_msg=" << perMessage(ring_enters)
+           << " sqes_per_msg=" << perMessage(sqes_submitted)
+           << " cqes_per_msg=" << perMessage(cqes_reaped);
+        return ss.str();
+    }
+};
@@ -0,0 +1,74 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+class IOUring;
+
+// 방(세션) 하나의 송신 backlog: 방 브로드캐스트로 수신자 큐에 쌓였지만 아직 전송을 시작하지 않은 바이트.
+// 상한(high water)을 넘으면 조절 상태가 되어 발신자의 recv를 멈추고, 하한(low water) 아래로 내려가면
+// 발신자를 멈춘 링들을 깨운다. 큐를 가진 모든 링이 함께 갱신한다 (원자 변수)
+class RoomBacklog {
+public:
+    RoomBacklog(int32_t room_id, int64_t high_water, int64_t low_water)
+        : room_id_(room_id), high_water_(high_water), low_water_(low_water) {}
+
+    // 프레임이 수신자 큐에 들어감 / 큐에서 빠짐 (전송 시작, 기한 초과, 연결 종료)
+    void add(int64_t bytes);
+    void release(int64_t bytes);
+
+    bool isThrottled() const { return throttled_.load(std::memory_order_acquire); }
+    int64_t getPendingBytes() const { return pending_bytes_.load(std::memory_order_relaxed); }
+    int32_t getRoomId() const { return room_id_; }
+
+    // 발신자 recv를 멈춘 링을 등록 (조절이 풀리면 notify). 이미 풀렸으면 등록하지 않고 false
+    bool addWaiter(IOUring* ring);
+    void removeWaiter(IOUring* ring);
+
+    RoomBacklog(const RoomBacklog&) = delete;
+    RoomBacklog& operator=(const RoomBacklog&) = delete;
+
+private:
+    const int32_t room_id_;
+    const int64_t high_water_;
+    const int64_t low_water_;
+    std::atomic<int64_t> pending_bytes_{0};
+    std::atomic<bool> throttled_{false};
+
+    std::mutex waiters_mutex_;
+    std::vector<IOUring*> waiters_;
+};
+
+// 방별 backlog 등록부. CHAT_ROOM_HIGH_WATER(바이트, 0이면 비활성)와 CHAT_ROOM_LOW_WATER(기본 상한의 절반)
+class RoomFlowControl {
+public:
+    static constexpr int64_t DEFAULT_HIGH_WATER = 4 * 1024 * 1024;
+
+    static RoomFlowControl& getInstance() {
+        static RoomFlowControl instance;
+        return instance;
+    }
+
+    bool isEnabled() const { return high_water_ > 0; }
+    int64_t getHighWater() const { return high_water_; }
+    int64_t getLowWater() const { return low_water_; }
+
+    // 방의 backlog (없으면 생성, 프로세스 종료까지 유지). 비활성이면 nullptr
+    RoomBacklog* getRoom(int32_t room_id);
+    // 링이 사라질 때 모든 방의 대기 목록에서 제거
+    void forgetRing(IOUring* ring);
+
+    RoomFlowControl(const RoomFlowControl&) = delete;
+    RoomFlowControl& operator=(const RoomFlowControl&) = delete;
+
+private:
+    RoomFlowControl();
+
+    int64_t high_water_{DEFAULT_HIGH_WATER};
+    int64_t low_water_{DEFAULT_HIGH_WATER / 2};
+    std::mutex mutex_;
+    std::unordered_map<int32_t, std::unique_ptr<RoomBacklog>> rooms_;
+};
@@ -0,0 +1,83 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+// 방 디렉터리 변경 명령 (Raft 로그 항목 본문). 리틀 엔디언, 패딩 없음
+enum class DirectoryOp : uint8_t {
+    NOOP = 0x00,            // 새 리더가 이전 임기 항목을 커밋하려고 넣는 빈 항목
+    SET_ROOM = 0x01,        // 방 소유 노드와 설정
+    REMOVE_ROOM = 0x02,
+    SET_NODE = 0x03         // 노드의 클라이언트 접속 주소 (방 이동 안내용)
+};
+
+#pragma pack(push, 1)
+struct DirectoryCommand {
+    DirectoryOp op;
+    int32_t room_id;
+    uint32_t node_id;       // SET_ROOM: 소유 노드, SET_NODE: 주소를 등록하는 노드
+    uint32_t deadline_ms;   // SET_ROOM: 방 전달 기한 (ROOM_HAS_DEADLINE일 때만)
+    uint8_t flags;
+    // SET_NODE는 뒤에 "host:port"
+};
+#pragma pack(pop)
+
+struct RoomRecord {
+    static constexpr uint8_t HAS_DEADLINE = 0x01;
+
+    uint32_t owner_node{0};
+    uint32_t deadline_ms{0};
+    uint8_t flags{0};
+};
+
+// 커밋된 디렉터리의 불변 스냅샷. 적용할 때마다 새로 만들어 교체한다
+struct DirectorySnapshot {
+    uint64_t version{0};        // 반영된 마지막 로그 인덱스
+    std::map<int32_t, RoomRecord> rooms;
+    std::map<uint32_t, std::string> nodes;
+
+    const RoomRecord* findRoom(int32_t room_id) const {
+        auto it = rooms.find(room_id);
+        return it != rooms.end() ? &it->second : nullptr;
+    }
+    std::string nodeAddress(uint32_t node_id) const {
+        auto it = nodes.find(node_id);
+        return it != nodes.end() ? it->second : std::string();
+    }
+};
+
+// 클러스터 방 디렉터리의 로컬 사본. Raft 쓰레드만 publish하고, 워커는 current()로 쓰레드별 캐시를 읽는다.
+// 버전이 그대로면 원자 변수 하나만 읽으므로 메시지 경로에서 잠금이 없다
+class RoomDirectory {
+public:
+    static RoomDirectory& getInstance() {
+        static RoomDirectory instance;
+        return instance;
+    }
+
+    // 반환한 참조는 같은 쓰레드가 current()를 다시 부를 때까지 유효
+    const DirectorySnapshot& current();
+    void publish(std::shared_ptr<const DirectorySnapshot> snapshot);
+
+    // 이 노드의 id (0이면 클러스터 모드가 아님: 모든 방을 로컬에서 처리)
+    uint32_t getLocalNode() const { return local_node_.load(std::memory_order_relaxed); }
+    void setLocalNode(uint32_t node_id) { local_node_.store(node_id, std::memory_order_relaxed); }
+
+    // Raft 쓰레드의 작업 사본에 명령 적용 (형식이 깨졌으면 false). 배치를 다 적용한 뒤 사본을 publish
+    static bool apply(const std::string& command, DirectorySnapshot& state);
+    static std::string encode(const DirectoryCommand& command, const std::string& address = std::string());
+
+    RoomDirectory(const RoomDirectory&) = delete;
+    RoomDirectory& operator=(const RoomDirectory&) = delete;
+
+private:
+    RoomDirectory() : snapshot_(std::make_shared<DirectorySnapshot>()) {}
+
+    std::atomic<uint32_t> local_node_{0};
+    std::atomic<uint64_t> version_{0};
+    std::mutex mutex_;
+    std::shared_ptr<const DirectorySnapshot> snapshot_;
+};
@@ -0,0 +1,79 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// 방 기록 한 건. 순번은 방마다 1부터 증가하며 백업 노드로 복제되어도 그대로 유지된다
+struct JournalRecord {
+    int32_t room_id{0};
+    uint64_t seq{0};
+    int64_t sent_at_ms{0};      // 벽시계 (노드가 바뀌어도 의미가 같도록)
+    std::string text;
+};
+
+using JournalRecordPtr = std::shared_ptr<const JournalRecord>;
+
+// 방 하나의 순번 카운터와 최근 기록 링. 방의 워커(append)와 복제 쓰레드(스냅샷)/백업 수신(apply)이 함께 쓴다
+class RoomJournal {
+public:
+    RoomJournal(int32_t room_id, size_t capacity) : room_id_(room_id), capacity_(capacity) {}
+
+    // 새 순번을 매겨 기록 (오래된 기록은 밀려난다). replicate면 같은 잠금 아래에서 복제 큐에 싣는다:
+    // 여러 워커가 한 방에 쓰더라도 (멀티캐스트) 복제 스트림이 순번 순서를 지켜야 백업이 건너뛰지 않는다
+    JournalRecordPtr append(const char* text, size_t length, int64_t sent_at_ms, bool replicate = false);
+    // 복제된 기록 적용. 이미 가진 순번이면 무시하고, 빠진 구간은 건너뛴다
+    bool apply(const JournalRecordPtr& record);
+    // 복제 재동기화: 기록을 비우고 다음 순번을 맞춘다
+    void reset(uint64_t next_seq);
+
+    // 최근 기록 최대 count건 (오래된 것부터)
+    std::vector<JournalRecordPtr> recent(size_t count) const;
+    // 보관 중인 기록 전부와 다음 순번을 한 번에 (복제 스냅샷)
+    uint64_t snapshot(std::vector<JournalRecordPtr>& records) const;
+    uint64_t nextSeq() const;
+    int32_t getRoomId() const { return room_id_; }
+
+    RoomJournal(const RoomJournal&) = delete;
+    RoomJournal& operator=(const RoomJournal&) = delete;
+
+private:
+    void push(JournalRecordPtr record);
+
+    const int32_t room_id_;
+    const size_t capacity_;
+    mutable std::mutex mutex_;
+    std::deque<JournalRecordPtr> records_;
+    uint64_t next_seq_{1};
+};
+
+// 방별 기록 등록부. CHAT_HISTORY_SIZE(방마다 보관할 건수, 기본 256, 0이면 순번만 매김)
+class RoomHistory {
+public:
+    static constexpr size_t DEFAULT_CAPACITY = 256;
+
+    static RoomHistory& getInstance() {
+        static RoomHistory instance;
+        return instance;
+    }
+
+    // 방의 기록 (없으면 생성, 프로세스 종료까지 유지)
+    RoomJournal* getRoom(int32_t room_id);
+    // 복제 스냅샷용: 지금까지 만들어진 모든 방
+    std::vector<RoomJournal*> allRooms();
+    size_t getCapacity() const { return capacity_; }
+
+    RoomHistory(const RoomHistory&) = delete;
+    RoomHistory& operator=(const RoomHistory&) = delete;
+
+private:
+    RoomHistory();
+
+    size_t capacity_{DEFAULT_CAPACITY};
+    std::mutex mutex_;
+    std::unordered_map<int32_t, std::unique_ptr<RoomJournal>> rooms_;
+};
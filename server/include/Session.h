@@ -3,7 +3,37 @@
 #include <set>
 #include <memory>
 #include <thread>
+#include <atomic>
+#include <random>
+#include <string>
+#include <vector>
 #include "Context.h"
+#include "RoomJournal.h"
+
+// 셧다운 드레인 설정. 전체 종료 속도(CHAT_DRAIN_RATE)를 세션 수로 나눠 세션별 웨이브 크기를 정한다
+struct DrainPlan {
+    static constexpr uint32_t DEFAULT_RATE = 1000;       // 초당 끊을 연결 수 (서버 전체)
+    static constexpr uint32_t DEFAULT_WAVE_MS = 100;
+    static constexpr uint32_t DEFAULT_GRACE_MS = 3000;
+    static constexpr uint32_t DEFAULT_RETRY_MS = 5000;
+
+    uint32_t wave_interval_ms{DEFAULT_WAVE_MS};   // 웨이브 간격 (CHAT_DRAIN_WAVE_MS)
+    uint32_t wave_size{1};                        // 세션별 웨이브 한 번에 끊는 연결 수
+    uint32_t grace_ms{DEFAULT_GRACE_MS};          // 마지막 웨이브 후 클라이언트가 끊기를 기다리는 시간 (CHAT_DRAIN_GRACE_MS)
+    uint32_t retry_after_ms{DEFAULT_RETRY_MS};    // 재접속 안내 대기의 상한, 연결마다 무작위 (CHAT_DRAIN_RETRY_MS)
+    std::string redirect;                         // 재접속 안내 주소 (CHAT_DRAIN_REDIRECT, 비면 같은 주소)
+
+    static DrainPlan fromEnv(size_t num_sessions);
+};
+
+// 방 구성원 하나. 연결의 I/O는 처음 배정된 방(home)의 링이 맡으므로, 다른 링에서 온 방 브로드캐스트는
+// 그 링으로 넘겨 보낸다. connection_id는 fd 번호 재사용과 구별하기 위한 연결 번호
+struct RoomMember {
+    int32_t client_fd{-1};
+    uint64_t connection_id{0};
+    IOUring* home{nullptr};
+    bool tagged{false};         // 둘 이상의 방에 속함: 채팅을 SERVER_ROOM_CHAT(방 ID 포함)으로 받는다
+};
 
 class Session {
 public:
@@ -16,20 +46,62 @@ public:
     
     int32_t getSessionId() const { return session_id_; }
     IOUring* getIOUring() { return io_ring_.get(); }
+    // 이 세션 링이 I/O를 맡은 연결 (드레인 대상, 워커 쓰레드 전용)
     const std::set<int32_t>& getClients() const { return clients_; }
     
-    void addClient(int32_t client_fd);
-    void removeClient(int32_t client_fd) { clients_.erase(client_fd); }
-    size_t getClientCount() const { return clients_.size(); }
+    // 연결을 이 세션 링에 넘긴다 (Listener/합성 클라이언트 쓰레드). recv 걸기, 연결 목록 추가와
+    // "joined session" 알림은 워커가 넘겨받을 때 한다. pending(조인 전) 연결에는 알림을 보내지 않는다
+    void addClient(int32_t client_fd, uint64_t connection_id, WireFormat format = WireFormat::BINARY,
+                   bool pending = false);
+    void removeClient(int32_t client_fd);
+    // 아무 쓰레드 (세션 배치, 드레인 로그): 워커가 아직 넘겨받지 않은 연결 포함
+    size_t getClientCount() const {
+        return client_count_.load(std::memory_order_relaxed) + io_ring_->getAdoptingCount();
+    }
+
+    // 방 구성원 (다른 세션 링에 I/O가 있는 연결 포함). SessionManager 잠금 아래에서만 바꾸고 읽는다
+    const std::vector<RoomMember>& getMembers() const { return members_; }
+    void addMember(const RoomMember& member) { members_.push_back(member); }
+    void removeMember(int32_t client_fd);
+    void setMemberTagged(int32_t client_fd, bool tagged);
     
     void setListeningSocket(int socket_fd);
 
+    // 이 방의 기록 (생성 시 RoomHistory에서 한 번 찾아 둔다: 메시지마다 등록부 잠금을 잡지 않게)
+    RoomJournal* getJournal() const { return journal_; }
+
+    // 채팅 전달 기한 (ms, 0이면 비활성). 기본값은 CHAT_DELIVERY_DEADLINE_MS
+    uint32_t getDeliveryDeadline() const { return delivery_deadline_ms_.load(std::memory_order_relaxed); }
+    void setDeliveryDeadline(uint32_t ms) { delivery_deadline_ms_.store(ms, std::memory_order_relaxed); }
+
+    // 셧다운 드레인 요청 (메인 쓰레드). 워커가 제어 eventfd 완료에서 시작해
+    // 연결을 무작위 순서의 웨이브로 재접속 안내 후 닫고, 끝나면 SessionManager에 알린다
+    void requestDrain(const DrainPlan& plan);
+
 private:
     void handleRead(io_uring_cqe* cqe, const Operation& ctx);
     void handleWrite(io_uring_cqe* cqe, const Operation& ctx);
     void handleClose(int client_fd);
+    void handleAdopted(int client_fd, bool pending);
+    void handleDrain(io_uring_cqe* cqe, uint16_t step);
+    void startDrain();
+    void drainWave();
+    void finishDrain();
 
     int32_t session_id_;
     std::unique_ptr<IOUring> io_ring_;
+    RoomJournal* journal_;
     std::set<int32_t> clients_;
+    std::atomic<size_t> client_count_{0};   // clients_.size() (다른 쓰레드용)
+    std::vector<RoomMember> members_;
+    std::atomic<uint32_t> delivery_deadline_ms_{0};
+
+    // 셧다운 드레인 (drain_plan_은 drain_requested_ 설정 전에 기록, 이후 워커 쓰레드 전용)
+    DrainPlan drain_plan_;
+    std::atomic<bool> drain_requested_{false};
+    bool draining_{false};
+    bool drained_{false};
+    std::vector<int32_t> drain_order_;
+    size_t drain_next_{0};
+    std::mt19937 drain_rng_;
 }; 
\ No newline at end of file
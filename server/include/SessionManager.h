@@ -1,5 +1,6 @@
 #pragma once
 #include "Session.h"
+#include <string>
 #include <unordered_map>
 #include <memory>
 #include <mutex>
@@ -9,8 +10,20 @@
 #include <queue>
 #include <condition_variable>
 
+// 연결 하나의 방 참가 목록. home은 I/O를 맡은 세션 (처음 참가한 방, 방을 떠나도 바뀌지 않음)
+struct ClientRooms {
+    int32_t home{-1};
+    uint64_t connection_id{0};
+    std::vector<int32_t> rooms;     // 정렬, 보통 몇 개뿐이라 벡터로 둔다
+    std::string user;               // 토큰으로 인증된 사용자 ID (인증이 꺼져 있으면 비어 있음)
+    bool pending{false};            // I/O만 배정되고 JOIN(토큰 검증, 클러스터 안내)을 기다리는 중: 어느 방의 구성원도 아님
+};
+
 class SessionManager {
 public:
+    static constexpr uint32_t DRAIN_SLACK_MS = 2000;   // 드레인 예상 시간에 더하는 여유
+    static constexpr size_t MAX_ROOMS_PER_CONNECTION = 64;
+
     static SessionManager& getInstance() {
         static SessionManager instance;
         return instance;
@@ -21,13 +34,42 @@ public:
     void stop();
     
     int32_t getNextAvailableSession();
-    void joinSession(int32_t client_fd, int32_t session_id);
+    // 첫 참가는 연결을 그 세션 링에 배정하고(format은 이때만 쓰임), 이후 참가는 방 구성원으로만 추가한다
+    void joinSession(int32_t client_fd, int32_t session_id, WireFormat format = WireFormat::BINARY);
+    // 방 참가 없이 연결의 I/O만 세션 링에 배정 (토큰 인증이나 클러스터 모드의 accept 시점). 첫 joinSession이 참가시킨다
+    void assignSession(int32_t client_fd, int32_t session_id, WireFormat format = WireFormat::BINARY);
+    // 메시지마다 불리므로 대기 중인 연결이 하나도 없으면 잠그지 않는다
+    bool isPending(int32_t client_fd);
+    // 방 하나에서 퇴장 (I/O 배정은 유지). 참가하지 않은 방이면 false
+    bool leaveRoom(int32_t client_fd, int32_t session_id);
+    // 모든 방에서 퇴장하고 배정 해제 (연결 종료, 본문 없는 LEAVE)
     void removeSession(int32_t client_fd);
+    // 연결의 I/O를 맡은 세션
     std::shared_ptr<Session> getSession(int32_t client_fd);
+    // 연결이 참가한 방의 세션 (session_id < 0이면 home). 참가하지 않았으면 nullptr
+    std::shared_ptr<Session> getRoomForClient(int32_t client_fd, int32_t session_id);
+    bool isMember(int32_t client_fd, int32_t session_id);
+    std::vector<int32_t> getClientRooms(int32_t client_fd);
+    // 방 구성원 사본 (브로드캐스트용)
+    std::vector<RoomMember> getRoomMembers(int32_t session_id);
+    // 멀티캐스트 대상: 사용자 ID로 주소를 지정할 수 있게 인증된 연결을 등록
+    void setClientUser(int32_t client_fd, const std::string& user);
+    std::string getClientUser(int32_t client_fd);
+    // 방들의 구성원과 사용자들의 연결을 한 번의 잠금으로 모은다. 여러 대상에 겹치는 연결은 한 번만 (겹친 수는 duplicates)
+    std::vector<RoomMember> collectRecipients(const std::vector<int32_t>& rooms,
+                                              const std::vector<std::string>& users, size_t& duplicates);
     std::shared_ptr<Session> getSessionByIndex(size_t index);
-    const std::set<int32_t>& getSessionClients(int32_t session_id);
+    std::shared_ptr<Session> getSessionById(int32_t session_id);
     IOUring* getSessionIOUring(int32_t session_id);
     size_t getOptimalThreadCount() const;
+    RingStatsSnapshot collectStats();
+    // 모든 워커의 부하 sketch를 합친 상위 k개
+    std::vector<HeavyHitter> collectTopLoad(LoadKey key_type, LoadMetric metric, size_t k);
+
+    // 셧다운 드레인: 모든 세션에 드레인을 요청하고 끝날 때까지 기다린다 (Listener를 멈춘 뒤 호출).
+    // 예상 시간을 넘기면 false
+    bool drain();
+    void onSessionDrained(int32_t session_id);   // 세션 워커 쓰레드에서 호출
 
 private:
     SessionManager();
@@ -39,13 +81,21 @@ private:
     void distributeSessionsToThreads();
 
     std::unordered_map<int32_t, std::shared_ptr<Session>> sessions_;  // session_id -> Session
-    std::unordered_map<int32_t, int32_t> client_sessions_;           // client_fd -> session_id
+    std::unordered_map<int32_t, ClientRooms> client_rooms_;          // client_fd -> 참가한 방
+    std::unordered_map<std::string, std::vector<int32_t>> user_clients_;  // 사용자 ID -> 연결 (여러 기기)
+    uint64_t next_connection_id_{1};
+    std::atomic<size_t> pending_count_{0};
     
     // 쓰레드 관리
     std::vector<std::thread> worker_threads_;
     std::vector<std::vector<std::shared_ptr<Session>>> thread_sessions_;  // 각 쓰레드가 담당할 세션들
     std::mutex mutex_;
     std::atomic<bool> should_stop_{false};
+
+    // 드레인 완료 대기 (mutex_와 분리: 워커가 연결을 닫으며 mutex_를 잡는다)
+    std::mutex drain_mutex_;
+    std::condition_variable drain_cv_;
+    size_t drained_sessions_{0};
     size_t next_session_id_{0};
     size_t num_worker_threads_{0};
 };
\ No newline at end of file
@@ -5,11 +5,16 @@
 
 class SocketManager {
 public:
+    static constexpr int FAST_OPEN_QUEUE_LEN = 256;   // TFO 대기 큐 길이
+    static constexpr int DEFER_ACCEPT_SEC = 5;        // 첫 데이터 도착까지 accept 지연
+
     SocketManager();
     ~SocketManager();
     
     int createListeningSocket(int port);
     void closeSocket(int fd);
+    // 새 연결 수락 중단 (셧다운 드레인 시작)
+    void closeListeningSocket();
     int getListeningSocket() const { return listening_socket_; }
     
 private:
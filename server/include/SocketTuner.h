@@ -0,0 +1,56 @@
+#pragma once
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <cstdint>
+#include <unordered_map>
+
+// accept 시 적용하는 기본 소켓 프로파일
+struct SocketProfile {
+    bool no_delay{true};
+    int notsent_lowat{16 * 1024};   // 커널 미전송 큐 상한 (bytes)
+    int send_buffer{0};             // 0 = 커널 기본값 유지
+};
+
+// 연결별 TCP_INFO 샘플 및 현재 적용값
+struct ConnTuning {
+    tcp_info info{};
+    uint32_t rtt_us{0};
+    uint32_t cwnd{0};
+    uint32_t unacked{0};
+    int notsent_lowat{0};
+    int send_buffer{0};
+};
+
+// 워커별 소켓 튜너: TCP_INFO 샘플을 받아 SO_SNDBUF / TCP_NOTSENT_LOWAT 조정 (워커 쓰레드 전용)
+class SocketTuner {
+public:
+    static constexpr unsigned SAMPLE_INTERVAL_MS = 1000;
+    static constexpr int MIN_NOTSENT_LOWAT = 16 * 1024;
+    static constexpr int MAX_NOTSENT_LOWAT = 256 * 1024;
+    static constexpr int MIN_SEND_BUFFER = 64 * 1024;
+    static constexpr int MAX_SEND_BUFFER = 4 * 1024 * 1024;
+
+    // Listener에서 accept 직후 호출
+    static void applyProfile(int client_fd, const SocketProfile& profile = SocketProfile{});
+
+    void track(int client_fd);
+    void untrack(int client_fd) { connections_.erase(client_fd); }
+    ConnTuning* getTuning(int client_fd);
+
+    // 샘플 완료 후 호출: 변화가 충분히 클 때만 setsockopt
+    void onSample(int client_fd);
+    // io_uring 소켓 명령을 쓸 수 없을 때의 동기 경로
+    bool sampleSync(int client_fd);
+
+    template <typename Fn>
+    void forEach(Fn&& fn) {
+        for (auto& [fd, tuning] : connections_) fn(fd, tuning);
+    }
+
+    uint64_t getAdjustments() const { return adjustments_; }
+
+private:
+    std::unordered_map<int, ConnTuning> connections_;
+    uint64_t adjustments_{0};
+};
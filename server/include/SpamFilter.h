@@ -0,0 +1,55 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+
+// 거의 같은 메시지 반복(스팸 웨이브) 감지. 메시지마다 4바이트 shingle의 64비트 SimHash를 만들고,
+// 최근 지문을 8비트씩 8개 band로 나눈 LSH 표에서 해밍 거리 CHAT_SPAM_DISTANCE(기본 6, 최대 7) 이내의 지문을 찾는다
+// (거리 7 이하면 8개 band 중 하나는 반드시 같다). CHAT_SPAM_WINDOW_MS(기본 10초) 안에 같은 지문 무리가
+// CHAT_SPAM_THRESHOLD(0이면 비활성)번 넘게 보이면 팬아웃 전에 버린다. 모든 워커와 방이 표 하나를 공유하고,
+// 버킷이 차면 가장 오래 안 보인 지문부터 밀려난다
+class SpamFilter {
+public:
+    static constexpr size_t MIN_LENGTH = 24;        // 이보다 짧은 메시지("ok", "ㅋㅋ")는 검사하지 않음
+    static constexpr size_t SHINGLE_BYTES = 4;
+    static constexpr unsigned NUM_BANDS = 8;
+    static constexpr unsigned BAND_BITS = 64 / NUM_BANDS;
+    static constexpr size_t BUCKETS_PER_BAND = size_t{1} << BAND_BITS;   // band 값이 곧 버킷 번호
+    static constexpr size_t ENTRIES_PER_BUCKET = 16;
+    static constexpr size_t NUM_LOCKS = 256;         // 버킷 잠금 분할
+
+    static SpamFilter& getInstance() {
+        static SpamFilter instance;
+        return instance;
+    }
+
+    bool isEnabled() const { return threshold_ > 0; }
+
+    // 지문을 기록하고 같은 무리가 기준을 넘었으면 true (버릴 메시지)
+    bool isSpam(const char* data, size_t length, int64_t now_ns);
+
+    // 대소문자와 연속 공백을 정규화한 본문의 SimHash
+    static uint64_t fingerprint(const char* data, size_t length);
+
+    SpamFilter(const SpamFilter&) = delete;
+    SpamFilter& operator=(const SpamFilter&) = delete;
+
+private:
+    SpamFilter();
+
+    struct Entry {
+        uint64_t fingerprint{0};
+        int64_t last_seen_ns{0};   // 0: 빈 자리
+        uint32_t copies{0};        // 창 안에서 이 지문 무리로 본 메시지 수
+    };
+    using Bucket = std::array<Entry, ENTRIES_PER_BUCKET>;
+
+    uint32_t threshold_{0};
+    unsigned max_distance_{6};
+    int64_t window_ns_{10000 * 1000000LL};
+
+    std::unique_ptr<std::array<std::array<Bucket, BUCKETS_PER_BAND>, NUM_BANDS>> tables_;
+    std::array<std::mutex, NUM_LOCKS> locks_;
+};
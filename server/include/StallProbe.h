@@ -0,0 +1,100 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+// 워커 루프 heartbeat와 정지 진단 정보. 루프 쓰레드가 쓰고 watchdog 쓰레드가 읽는다 (모두 relaxed 원자 변수)
+class WorkerHeartbeat {
+public:
+    static constexpr size_t FLIGHT_RECORDER_SIZE = 64;   // 최근 처리한 완료 이벤트 수 (2의 거듭제곱)
+
+    // 최근 완료 이벤트 하나 (user_data를 푼 값)
+    struct FlightEvent {
+        std::atomic<int64_t> ns{0};
+        std::atomic<uint8_t> op{0};
+        std::atomic<int32_t> fd{-1};
+        std::atomic<int32_t> res{0};
+    };
+
+    explicit WorkerHeartbeat(std::atomic<uint64_t>& stall_counter) : stall_counter_(stall_counter) {}
+
+    // CQE 배치를 꺼냄 (루프가 진행 중)
+    void beat(int64_t now_ns) {
+        current_ = this;
+        last_beat_ns_.store(now_ns, std::memory_order_relaxed);
+        beats_.fetch_add(1, std::memory_order_relaxed);
+        idle_.store(false, std::memory_order_relaxed);
+    }
+    // 완료 대기에 들어감 (유휴 상태는 정지로 보지 않음)
+    void enterIdle() { idle_.store(true, std::memory_order_relaxed); }
+
+    // 처리하려는 완료 이벤트를 flight recorder에 남긴다 (마지막 기록 = 현재 처리 중인 작업)
+    void record(int64_t now_ns, uint8_t op, int32_t fd, int32_t res) {
+        const uint64_t slot = head_.load(std::memory_order_relaxed);
+        FlightEvent& event = events_[slot & (FLIGHT_RECORDER_SIZE - 1)];
+        event.ns.store(now_ns, std::memory_order_relaxed);
+        event.op.store(op, std::memory_order_relaxed);
+        event.fd.store(fd, std::memory_order_relaxed);
+        event.res.store(res, std::memory_order_relaxed);
+        head_.store(slot + 1, std::memory_order_release);
+    }
+
+    void setLockWait(const char* name) { lock_wait_.store(name, std::memory_order_relaxed); }
+    void setName(std::string name) { name_ = std::move(name); }
+
+    // 이 쓰레드가 마지막으로 돌린 루프의 heartbeat (워커가 아닌 쓰레드는 nullptr)
+    static WorkerHeartbeat* current() { return current_; }
+
+    // watchdog 쪽 읽기
+    const std::string& getName() const { return name_; }
+    bool isIdle() const { return idle_.load(std::memory_order_relaxed); }
+    int64_t getLastBeat() const { return last_beat_ns_.load(std::memory_order_relaxed); }
+    uint64_t getBeats() const { return beats_.load(std::memory_order_relaxed); }
+    const char* getLockWait() const { return lock_wait_.load(std::memory_order_relaxed); }
+    uint64_t getHead() const { return head_.load(std::memory_order_acquire); }
+    const FlightEvent& getEvent(uint64_t slot) const { return events_[slot & (FLIGHT_RECORDER_SIZE - 1)]; }
+    void countStall() { stall_counter_.fetch_add(1, std::memory_order_relaxed); }
+
+    // watchdog 쓰레드 전용: 이미 보고한 정지 구분
+    uint64_t reported_beats{UINT64_MAX};
+    int64_t stalled_since_ns{0};
+
+    WorkerHeartbeat(const WorkerHeartbeat&) = delete;
+    WorkerHeartbeat& operator=(const WorkerHeartbeat&) = delete;
+
+private:
+    static inline thread_local WorkerHeartbeat* current_{nullptr};
+
+    std::string name_{"ring"};
+    std::atomic<int64_t> last_beat_ns_{0};
+    std::atomic<uint64_t> beats_{0};
+    std::atomic<bool> idle_{true};
+    std::atomic<const char*> lock_wait_{nullptr};
+    std::atomic<uint64_t> head_{0};
+    std::array<FlightEvent, FLIGHT_RECORDER_SIZE> events_;
+    std::atomic<uint64_t>& stall_counter_;
+};
+
+// 잠금을 기다리는 동안 워커 heartbeat에 잠금 이름을 남기는 lock_guard (워커가 아닌 쓰레드에서는 그냥 잠금)
+template <typename Mutex>
+class ProbedLockGuard {
+public:
+    ProbedLockGuard(Mutex& mutex, const char* name) : mutex_(mutex) {
+        WorkerHeartbeat* heartbeat = WorkerHeartbeat::current();
+        if (heartbeat && !mutex_.try_lock()) {
+            heartbeat->setLockWait(name);
+            mutex_.lock();
+            heartbeat->setLockWait(nullptr);
+        } else if (!heartbeat) {
+            mutex_.lock();
+        }
+    }
+    ~ProbedLockGuard() { mutex_.unlock(); }
+
+    ProbedLockGuard(const ProbedLockGuard&) = delete;
+    ProbedLockGuard& operator=(const ProbedLockGuard&) = delete;
+
+private:
+    Mutex& mutex_;
+};
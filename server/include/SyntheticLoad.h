@@ -0,0 +1,90 @@
+#pragma once
+#include "FrameAssembler.h"
+#include "LatencyHistogram.h"
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// 프로세스 안 합성 클라이언트 (CHAT_SYNTHETIC_CLIENTS). socketpair 한쪽 끝에 JOIN 프레임을 먼저 써 두고
+// accept된 연결처럼 Listener 배정 경로로 등록한 뒤, 다른 끝은 드라이버 쓰레드가 채팅을 보내고 받은 프레임을 읽는다.
+// TCP/loopback과 외부 부하 생성기 없이 Session/IOUring 전체 경로를 높은 속도로 측정하기 위한 것.
+// 채팅 본문에 보낸 시각을 넣어 방 브로드캐스트가 돌아오기까지의 지연을 잰다
+class SyntheticLoad {
+public:
+    static constexpr size_t MIN_PAYLOAD = 41;   // "t=<보낸 시각 16자리> c=<발신자> s=<순번> " 머리
+    static constexpr int64_t MERGE_INTERVAL_NS = 1000000000;
+
+    struct Config {
+        size_t clients{0};          // CHAT_SYNTHETIC_CLIENTS (0이면 비활성)
+        uint32_t rate{10};          // CHAT_SYNTHETIC_RATE: 클라이언트당 초당 메시지 (0이면 쓸 수 있을 때마다)
+        size_t payload{64};         // CHAT_SYNTHETIC_SIZE: 채팅 본문 바이트
+        size_t threads{0};          // CHAT_SYNTHETIC_THREADS (0이면 min(4, clients))
+        size_t rooms{0};            // CHAT_SYNTHETIC_ROOMS: i번째 클라이언트는 방 i % rooms (0이면 서버가 배정)
+
+        static Config fromEnv();
+    };
+
+    static SyntheticLoad& getInstance() {
+        static SyntheticLoad instance;
+        return instance;
+    }
+
+    // 클라이언트를 만들어 admit(서버 쪽 fd)으로 등록하고 드라이버를 띄운다 (메인 쓰레드, Listener 루프 전)
+    void start(const std::function<bool(int)>& admit);
+    // 드라이버를 멈추고 클라이언트 쪽 끝을 닫는다. 서버는 평소 연결 종료처럼 정리
+    void stop();
+
+    bool isRunning() const { return running_.load(std::memory_order_acquire); }
+    // "synthetic" 명령 응답
+    std::string describe() const;
+
+    SyntheticLoad(const SyntheticLoad&) = delete;
+    SyntheticLoad& operator=(const SyntheticLoad&) = delete;
+
+private:
+    SyntheticLoad() = default;
+    ~SyntheticLoad();
+
+    struct Client {
+        int fd{-1};
+        uint32_t id{0};
+        uint64_t seq{0};
+        int64_t next_send_ns{0};
+        ChatMessage out{};          // 보내던 프레임 (소켓이 차서 일부만 나감)
+        size_t out_offset{0};
+        size_t out_length{0};
+        FrameAssembler assembler;
+    };
+
+    struct Driver {
+        std::vector<std::unique_ptr<Client>> clients;
+        std::thread thread;
+        LatencyHistogram local;     // 드라이버 쓰레드만 기록, 주기적으로 merged_에 합친다
+    };
+
+    void run(Driver& driver);
+    bool flush(Client& client);                        // 남은 프레임 전송. 다 보냈으면 true
+    void prepareChat(Client& client, int64_t now_ns);
+    void receive(Driver& driver, Client& client, char* buffer, size_t size);
+    void disconnect(Client& client);
+    void mergeLatency(Driver& driver);
+
+    Config config_;
+    std::vector<std::unique_ptr<Driver>> drivers_;
+    std::atomic<bool> should_stop_{false};
+    std::atomic<bool> running_{false};
+
+    std::atomic<uint64_t> sent_{0};
+    std::atomic<uint64_t> received_{0};
+    std::atomic<uint64_t> send_blocked_{0};    // 소켓이 차서 보낼 차례를 놓친 횟수
+    std::atomic<uint64_t> disconnected_{0};
+    int64_t started_ns_{0};
+
+    mutable std::mutex mutex_;
+    LatencyHistogram merged_;
+};
@@ -0,0 +1,123 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <unordered_map>
+#include <unordered_set>
+#include <chrono>
+
+// 토큰 형식: "<user_id>:<만료 unix 초>:<hex HMAC-SHA256(secret, "<user_id>:<만료>")>"
+struct ParsedToken {
+    std::string payload;      // "<user_id>:<만료>"
+    std::string user;         // user_id (멀티캐스트 주소)
+    std::string mac;          // hex 서명 (캐시 키로 사용)
+    int64_t expires_at{0};    // unix 초
+};
+
+// 검증 결과 (헬퍼 쓰레드 -> 워커 링)
+struct AuthResult {
+    int32_t client_fd;
+    uint64_t connection_id;   // 검증 중에 연결이 닫히고 fd가 재사용되면 결과를 버린다
+    int32_t session_id;
+    bool verified;
+    ParsedToken token;
+};
+
+// 워커별 완료 큐: 헬퍼 쓰레드가 결과를 넣고 eventfd로 워커 링을 깨운다
+class AuthCompletionQueue {
+public:
+    AuthCompletionQueue();
+    ~AuthCompletionQueue();
+
+    void push(AuthResult&& result);
+    std::vector<AuthResult> drain();
+    int getEventFd() const { return event_fd_; }
+
+    AuthCompletionQueue(const AuthCompletionQueue&) = delete;
+    AuthCompletionQueue& operator=(const AuthCompletionQueue&) = delete;
+
+private:
+    int event_fd_;
+    std::mutex mutex_;
+    std::vector<AuthResult> results_;
+};
+
+// 워커별 검증 완료 토큰 캐시 (워커 쓰레드 전용, 락 없음)
+class TokenCache {
+public:
+    static constexpr size_t MAX_ENTRIES = 65536;
+    static constexpr int64_t CACHE_TTL_SEC = 300;
+
+    bool lookup(const ParsedToken& token, int64_t now);
+    void insert(const ParsedToken& token, int64_t now);
+
+    uint64_t getHits() const { return hits_; }
+    uint64_t getMisses() const { return misses_; }
+
+private:
+    struct Entry {
+        std::string payload;
+        int64_t expires_at;
+    };
+
+    void evictExpired(int64_t now);
+
+    std::unordered_map<std::string, Entry> entries_;  // mac -> entry
+    uint64_t hits_{0};
+    uint64_t misses_{0};
+};
+
+class TokenAuth {
+public:
+    static constexpr size_t DEFAULT_HELPER_THREADS = 2;
+    static constexpr size_t DEFAULT_MAX_QUEUED = 4096;   // 헬퍼 풀에 쌓일 수 있는 검증 요청 (CHAT_AUTH_QUEUE)
+
+    static TokenAuth& getInstance() {
+        static TokenAuth instance;
+        return instance;
+    }
+
+    // CHAT_AUTH_SECRET 환경 변수가 없으면 인증 비활성화 (기존 동작 유지)
+    void initialize();
+    void stop();
+    bool isEnabled() const { return !secret_.empty(); }
+    // CHAT_ADMIN_USERS(쉼표 구분)에 있는 인증된 사용자: 방 설정 변경 같은 운영 명령을 쓸 수 있다
+    bool isAdmin(const std::string& user) const { return !user.empty() && admin_users_.count(user) > 0; }
+
+    static bool parse(const char* data, size_t length, ParsedToken& out);
+    static int64_t nowSeconds() {
+        return std::chrono::duration_cast<std::chrono::seconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+    }
+
+    // 헬퍼 풀에 서명 검증 요청 (결과는 target 큐로 전달). 대기 중인 요청이 한도에 차 있으면 false
+    bool submit(AuthResult&& request, AuthCompletionQueue* target);
+    bool verify(const ParsedToken& token) const;
+
+private:
+    TokenAuth() = default;
+    ~TokenAuth();
+    TokenAuth(const TokenAuth&) = delete;
+    TokenAuth& operator=(const TokenAuth&) = delete;
+
+    void helperThread();
+
+    struct Job {
+        AuthResult request;
+        AuthCompletionQueue* target;
+    };
+
+    std::string secret_;
+    std::unordered_set<std::string> admin_users_;
+    std::vector<std::thread> helpers_;
+    std::deque<Job> jobs_;
+    size_t max_queued_{DEFAULT_MAX_QUEUED};
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    bool should_stop_{false};
+};
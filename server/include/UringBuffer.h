@@ -4,17 +4,17 @@
 #include <cstdint>
 #include <liburing.h>
 #include <iostream>
-#include <chrono>
 #include <unordered_map>
 #include <fstream>
 #include <sstream>
 #include <mutex>
 #include <iomanip>
+#include "Reactor.h"
 
 struct BufferInfo {
     bool in_use{false};                    // 버퍼 사용 중 여부
     uint16_t client_fd{0};                // 버퍼를 사용 중인 클라이언트의 파일 디스크립터
-    std::chrono::steady_clock::time_point allocation_time{};  // 버퍼 할당 시간
+    int64_t allocation_ns{0};             // 버퍼 할당 시각 (LoopClock)
     uint64_t bytes_used{0};               // 현재 사용 중인 바이트 수
     uint64_t total_uses{0};               // 총 사용 횟수
     uint32_t ref_count{0};               // 레퍼런스 카운트
@@ -33,10 +33,12 @@ public:
     static constexpr unsigned IO_BUFFER_SIZE = 2048;
     // The number of IO buffers to pre-allocate
     static constexpr uint16_t NUM_IO_BUFFERS = 4096;
+    // 수신 버퍼에 묶이지 않은 메시지 (버퍼 관리 메서드는 무시)
+    static constexpr uint16_t NO_BUFFER = UINT16_MAX;
 
 
     // 생성자 및 소멸자
-    explicit UringBuffer(io_uring* ring);
+    explicit UringBuffer(Reactor* reactor);
     ~UringBuffer();
 
     // 버퍼 관리 메서드
@@ -78,7 +80,7 @@ private:
     
 
     // 멤버 변수
-    io_uring* ring_;                // io_uring 인스턴스 (소유권 없음)
+    Reactor* reactor_;              // I/O 백엔드 (소유권 없음)
     io_uring_buf_ring* buf_ring_;   // 버퍼 링
     uint8_t* buffer_base_addr_;     // 버퍼 메모리 시작 주소
     const unsigned ring_size_;      // 전체 버퍼 링 크기
@@ -0,0 +1,27 @@
+#pragma once
+#include <liburing.h>
+
+// io_uring 백엔드: liburing 링을 그대로 감싼다
+class UringReactor {
+public:
+    static constexpr const char* NAME = "io_uring";
+
+    explicit UringReactor(unsigned entries);
+    ~UringReactor();
+
+    io_uring_sqe* getSQE() { return io_uring_get_sqe(&ring_); }
+    unsigned sqReady() { return io_uring_sq_ready(&ring_); }
+    int submit() { return io_uring_submit(&ring_); }
+    int submitAndWait(unsigned wait_nr) { return io_uring_submit_and_wait(&ring_, wait_nr); }
+    unsigned peekBatch(io_uring_cqe** cqes, unsigned max) { return io_uring_peek_batch_cqe(&ring_, cqes, max); }
+    void advance(unsigned count) { io_uring_cq_advance(&ring_, count); }
+
+    int registerBufRing(io_uring_buf_reg* reg) { return io_uring_register_buf_ring(&ring_, reg, 0); }
+    bool supportsOpcode(int opcode);
+
+    UringReactor(const UringReactor&) = delete;
+    UringReactor& operator=(const UringReactor&) = delete;
+
+private:
+    io_uring ring_;
+};
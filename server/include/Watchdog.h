@@ -0,0 +1,50 @@
+#pragma once
+#include "StallProbe.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// 워커 루프 정지 감시: 각 링의 heartbeat가 기준 시간 넘게 멈추면(완료 대기 중 제외)
+// flight recorder 꼬리, 처리 중이던 작업, 기다리는 잠금을 stderr에 남기고 정지 수를 센다.
+// 진단은 Logger를 거치지 않는다 (Logger 잠금이 정지 원인일 수 있음)
+class Watchdog {
+public:
+    static constexpr int64_t DEFAULT_STALL_MS = 250;
+    static constexpr size_t REPORT_EVENTS = 16;   // 보고에 넣을 최근 이벤트 수
+
+    static Watchdog& getInstance() {
+        static Watchdog instance;
+        return instance;
+    }
+
+    // CHAT_STALL_MS (0이면 비활성)
+    void start();
+    void stop();
+
+    void watch(WorkerHeartbeat* heartbeat);
+    void unwatch(WorkerHeartbeat* heartbeat);
+
+    uint64_t getStalls() const { return stalls_.load(std::memory_order_relaxed); }
+
+private:
+    Watchdog() = default;
+    ~Watchdog();
+    Watchdog(const Watchdog&) = delete;
+    Watchdog& operator=(const Watchdog&) = delete;
+
+    void run();
+    void check(WorkerHeartbeat& heartbeat, int64_t now_ns);
+    std::string describe(const WorkerHeartbeat& heartbeat, int64_t now_ns, int64_t stalled_ns) const;
+
+    std::vector<WorkerHeartbeat*> workers_;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::thread thread_;
+    bool should_stop_{false};
+    int64_t threshold_ns_{DEFAULT_STALL_MS * 1000000};
+    std::atomic<uint64_t> stalls_{0};
+};
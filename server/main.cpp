@@ -1,60 +1,185 @@
 #include "Listener.h"
+#include "BaselineServer.h"
 #include "SessionManager.h"
 #include "SocketManager.h"
 #include "Utils.h"
 #include "Logger.h"
+#include "TokenAuth.h"
+#include "AttachmentStore.h"
+#include "Clock.h"
+#include "Watchdog.h"
+#include "IpBlocklist.h"
+#include "SyntheticLoad.h"
+#include "Replication.h"
+#include "RaftNode.h"
 #include <csignal>
+#include <cstdlib>
+#include <memory>
+#include <pthread.h>
 #include <thread>
+#include <unistd.h>
 
 std::atomic<bool> running(true);
 
+namespace {
+    // 시그널 핸들러가 멈출 이벤트 루프 (루프를 빠져나온 뒤에는 nullptr)
+    std::atomic<Listener*> active_listener{nullptr};
+    std::atomic<Listener*> active_json_listener{nullptr};
+    std::atomic<BaselineServer*> active_baseline{nullptr};
+
+    void handleShutdownSignal(int /* signo */) {
+        if (!running.exchange(false)) {
+            // 드레인 중 두 번째 신호: 기다리지 않고 종료
+            _exit(1);
+        }
+        if (Listener* listener = active_listener.load()) {
+            listener->requestStop();
+        }
+        if (Listener* listener = active_json_listener.load()) {
+            listener->requestStop();
+        }
+        if (BaselineServer* baseline = active_baseline.load()) {
+            baseline->requestStop();
+        }
+    }
+
+    // SIGTERM/SIGINT는 메인 쓰레드에서만 받는다 (이후 생성되는 쓰레드는 막힌 마스크를 물려받음)
+    void setShutdownSignalsBlocked(bool blocked) {
+        sigset_t signals;
+        sigemptyset(&signals);
+        sigaddset(&signals, SIGTERM);
+        sigaddset(&signals, SIGINT);
+        pthread_sigmask(blocked ? SIG_BLOCK : SIG_UNBLOCK, &signals, nullptr);
+    }
+
+    void installShutdownHandler() {
+        struct sigaction action{};
+        action.sa_handler = handleShutdownSignal;
+        sigemptyset(&action.sa_mask);
+        sigaction(SIGTERM, &action, nullptr);
+        sigaction(SIGINT, &action, nullptr);
+        setShutdownSignalsBlocked(true);
+    }
+}
+
 int main(int argc, char* argv[]) {
-    if (argc != 3) {
-        LOG_ERROR("Usage: ", argv[0], " <host> <port>");
+    if (argc != 3 && argc != 4) {
+        LOG_ERROR("Usage: ", argv[0], " <host> <port> [chat|echo|sink]");
         return 1;
     }
 
+    // 끊긴 소켓에 대한 write/splice가 프로세스를 죽이지 않도록 (EPIPE로 처리)
+    std::signal(SIGPIPE, SIG_IGN);
+    installShutdownHandler();
+
+    // 워커가 뜨기 전에 시계 소스 선택과 TSC 보정 (약 20ms). 이후 주기적으로 CLOCK_MONOTONIC에 다시 맞춘다
+    Clock::getInstance().startRecalibration();
+
+    // 워커 루프 정지 감시 (CHAT_STALL_MS)
+    Watchdog::getInstance().start();
+
     try {
         const char* host = argv[1];
         int port = std::stoi(argv[2]);
+        const std::string mode = argc == 4 ? argv[3] : "chat";
 
-        LOG_INFO("Starting server on ", host, ":", port);
+        LOG_INFO("Starting server on ", host, ":", port, " (", mode, " mode)");
         LOG_INFO("Hardware concurrency: ", std::thread::hardware_concurrency(), " cores");
+        LOG_INFO("I/O backend: ", Reactor::NAME);
 
         // 소켓 매니저 생성
         SocketManager socket_manager;
 
+        if (mode != "chat") {
+            // 기준 측정용: 세션/방 없이 같은 링·버퍼·프레이밍 경로만 실행
+            BaselineServer baseline(port, BaselineServer::parseMode(mode), socket_manager);
+            baseline.start();
+            LOG_INFO("Server started successfully");
+
+            active_baseline = &baseline;
+            setShutdownSignalsBlocked(false);
+            if (running) {
+                baseline.processEvents();
+            }
+            active_baseline = nullptr;
+
+            baseline.stop();
+            Watchdog::getInstance().stop();
+            Clock::getInstance().stopRecalibration();
+            LOG_INFO("Server shutdown complete");
+            return 0;
+        }
+
+        // 조인 토큰 검증 헬퍼 풀 (CHAT_AUTH_SECRET 설정 시)
+        TokenAuth::getInstance().initialize();
+
+        // 첨부 파일 저장소 (CHAT_ATTACH_DIR). 세션 링이 만들어지기 전에 준비
+        AttachmentStore::getInstance().initialize();
+
+        // accept 시 검사할 차단 CIDR 목록 (CHAT_BLOCKLIST, "blocklist reload"로 교체)
+        AcceptFilter::getInstance().reload();
+
         // 세션 매니저 초기화 및 시작
         auto& session_manager = SessionManager::getInstance();
         session_manager.initialize();  // CPU 코어 수에 맞춰 자동으로 세션 생성
         session_manager.start();
 
+        // 방 기록 복제 (CHAT_REPLICA_BACKUP / CHAT_REPLICA_LISTEN): 백업은 클라이언트보다 먼저 스트림을 받을 준비
+        Replication::getInstance().start();
+
+        // 클러스터 방 디렉터리 (CHAT_RAFT_ID/CHAT_RAFT_PEERS): 방 소유 노드와 설정을 Raft로 복제
+        RaftNode::getInstance().start(std::string(host) + ":" + std::to_string(port));
+
         // 리스너 생성 및 시작
         Listener listener(port, socket_manager);
         listener.start();
 
-        // 리스닝 소켓을 세션에 설정
-        int listening_socket = socket_manager.getListeningSocket();
-        for (size_t i = 0; i < session_manager.getOptimalThreadCount(); ++i) {
-            auto session = session_manager.getSessionByIndex(i);
-            if (session) {
-                session->setListeningSocket(listening_socket);
-            }
+        // accept는 Listener만 수행: 세션 링에도 multishot accept를 걸면 세션이 가로챈
+        // 연결은 배정 없이 버려진다 (Session은 ACCEPT 완료를 무시)
+
+        // 줄 단위 JSON 연결 (CHAT_JSON_PORT): 별도 포트의 Listener가 자기 쓰레드에서 accept하고,
+        // 배정된 뒤로는 같은 세션 링이 프레임과 JSON 줄을 변환해 처리한다
+        SocketManager json_socket_manager;
+        std::unique_ptr<Listener> json_listener;
+        std::thread json_thread;
+        if (const char* json_port = std::getenv("CHAT_JSON_PORT")) {
+            json_listener = std::make_unique<Listener>(std::stoi(json_port), json_socket_manager, WireFormat::JSON);
+            json_listener->start();
+            active_json_listener = json_listener.get();
+            json_thread = std::thread([&json_listener]() { json_listener->processEvents(); });
         }
 
+        // 프로세스 안 합성 클라이언트 (CHAT_SYNTHETIC_CLIENTS): socketpair 한쪽을 accept된 연결처럼 배정
+        SyntheticLoad::getInstance().start([&listener](int client_fd) { return listener.admitClient(client_fd); });
+
         LOG_INFO("Server started successfully");
 
-        // 메인 루프
-        while (running) {
+        // 메인 루프: SIGTERM/SIGINT가 올 때까지 accept 처리
+        active_listener = &listener;
+        setShutdownSignalsBlocked(false);
+        if (running) {
             listener.processEvents();
-            std::this_thread::sleep_for(std::chrono::milliseconds(10));
         }
+        active_listener = nullptr;
 
-        LOG_INFO("Shutting down server...");
+        LOG_INFO("Shutting down server, draining clients...");
         
-        // 정리
+        // 드레인: 새 연결 거부 → 연결별 송신 큐 flush 후 재접속 안내 → 무작위 순서의 웨이브로 종료
         listener.stop();
+        if (json_listener) {
+            json_listener->requestStop();
+            json_thread.join();
+            active_json_listener = nullptr;
+            json_listener->stop();
+        }
+        SyntheticLoad::getInstance().stop();
+        session_manager.drain();
         session_manager.stop();
+        Replication::getInstance().stop();
+        RaftNode::getInstance().stop();
+        TokenAuth::getInstance().stop();
+        Watchdog::getInstance().stop();
+        Clock::getInstance().stopRecalibration();
         
         LOG_INFO("Server shutdown complete");
         return 0;
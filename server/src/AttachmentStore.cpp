@@ -0,0 +1,221 @@
+#include "AttachmentStore.h"
+#include "Logger.h"
+#include <openssl/evp.h>
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+AttachmentFile::~AttachmentFile() {
+    close(fd_);
+}
+
+AttachmentUpload::AttachmentUpload(const AttachmentHeader& header, int file_fd, std::string temp_path)
+    : header_(header), file_fd_(file_fd), temp_path_(std::move(temp_path)), hash_(EVP_MD_CTX_new()) {
+    if (!hash_ || EVP_DigestInit_ex(hash_, EVP_sha256(), nullptr) != 1) {
+        EVP_MD_CTX_free(hash_);
+        hash_ = nullptr;
+    }
+}
+
+AttachmentUpload::~AttachmentUpload() {
+    EVP_MD_CTX_free(hash_);
+    close(file_fd_);
+}
+
+unsigned AttachmentUpload::nextChunk() const {
+    const uint64_t left = header_.size - stored_ - in_pipe;
+    return static_cast<unsigned>(std::min<uint64_t>(left, CHUNK_SIZE));
+}
+
+bool AttachmentUpload::commitChunk(size_t bytes) {
+    if (!hash_) {
+        return false;
+    }
+
+    // mmap 오프셋은 페이지 단위여야 하므로 앞쪽으로 내려 맞춘다
+    static const uint64_t page_mask = static_cast<uint64_t>(sysconf(_SC_PAGESIZE)) - 1;
+    const uint64_t map_offset = stored_ & ~page_mask;
+    const size_t lead = static_cast<size_t>(stored_ - map_offset);
+
+    void* mapped = mmap(nullptr, lead + bytes, PROT_READ, MAP_SHARED, file_fd_, static_cast<off_t>(map_offset));
+    if (mapped == MAP_FAILED) {
+        LOG_ERROR("Attachment mmap failed: ", strerror(errno));
+        return false;
+    }
+    const bool ok = EVP_DigestUpdate(hash_, static_cast<const uint8_t*>(mapped) + lead, bytes) == 1;
+    munmap(mapped, lead + bytes);
+
+    stored_ += bytes;
+    return ok;
+}
+
+bool AttachmentUpload::finish() {
+    unsigned int length = 0;
+    if (!hash_ || EVP_DigestFinal_ex(hash_, digest_, &length) != 1 || length != sizeof(digest_)) {
+        return false;
+    }
+    return AttachmentStore::isZero(header_.digest) ||
+           memcmp(header_.digest, digest_, sizeof(digest_)) == 0;
+}
+
+AttachmentStore::AttachmentStore() {
+    const char* dir = std::getenv("CHAT_ATTACH_DIR");
+    dir_ = dir && *dir ? dir : "attachments";
+    if (const char* max = std::getenv("CHAT_ATTACH_MAX_BYTES")) {
+        max_bytes_ = std::strtoull(max, nullptr, 10);
+    }
+    if (const char* quota = std::getenv("CHAT_ATTACH_QUOTA_BYTES")) {
+        quota_bytes_ = std::strtoull(quota, nullptr, 10);
+    }
+    if (const char* quota = std::getenv("CHAT_ATTACH_USER_QUOTA_BYTES")) {
+        user_quota_bytes_ = std::strtoull(quota, nullptr, 10);
+    }
+}
+
+void AttachmentStore::initialize() {
+    if (mkdir(dir_.c_str(), 0750) < 0 && errno != EEXIST) {
+        LOG_WARN("Attachment directory ", dir_, " unavailable (", strerror(errno), "), attachments disabled");
+        return;
+    }
+    enabled_ = max_bytes_ > 0 && quota_bytes_ > 0 && user_quota_bytes_ > 0;
+    used_bytes_ = scanUsage();
+    LOG_INFO("Attachment store: ", dir_, " (max ", max_bytes_, " bytes per file, ", used_bytes_, "/", quota_bytes_,
+             " bytes used, ", user_quota_bytes_, " bytes per user)");
+}
+
+uint64_t AttachmentStore::scanUsage() const {
+    DIR* dir = opendir(dir_.c_str());
+    if (!dir) {
+        return 0;
+    }
+    uint64_t total = 0;
+    while (dirent* entry = readdir(dir)) {
+        // 임시 업로드 파일(.upload-*)과 . / .. 은 세지 않는다
+        if (entry->d_name[0] == '.') {
+            continue;
+        }
+        struct stat st;
+        if (fstatat(dirfd(dir), entry->d_name, &st, 0) == 0 && S_ISREG(st.st_mode)) {
+            total += static_cast<uint64_t>(st.st_size);
+        }
+    }
+    closedir(dir);
+    return total;
+}
+
+std::string AttachmentStore::toHex(const uint8_t* digest) {
+    static const char hex[] = "0123456789abcdef";
+    std::string out(64, '0');
+    for (size_t i = 0; i < 32; ++i) {
+        out[i * 2] = hex[digest[i] >> 4];
+        out[i * 2 + 1] = hex[digest[i] & 0x0f];
+    }
+    return out;
+}
+
+bool AttachmentStore::isZero(const uint8_t* digest) {
+    for (size_t i = 0; i < 32; ++i) {
+        if (digest[i] != 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+std::string AttachmentStore::pathFor(const uint8_t* digest) const {
+    return dir_ + "/" + toHex(digest);
+}
+
+bool AttachmentStore::contains(const uint8_t* digest) const {
+    return access(pathFor(digest).c_str(), F_OK) == 0;
+}
+
+std::shared_ptr<const AttachmentFile> AttachmentStore::open(const uint8_t* digest) const {
+    int fd = ::open(pathFor(digest).c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return nullptr;
+    }
+    struct stat st;
+    if (fstat(fd, &st) < 0) {
+        close(fd);
+        return nullptr;
+    }
+    return std::make_shared<const AttachmentFile>(fd, static_cast<uint64_t>(st.st_size));
+}
+
+std::unique_ptr<AttachmentUpload> AttachmentStore::beginUpload(const AttachmentHeader& header, const std::string& owner,
+                                                              bool& quota_exceeded) {
+    quota_exceeded = false;
+    {
+        std::lock_guard<std::mutex> lock(quota_mutex_);
+        uint64_t& owned = owner_bytes_[owner];
+        if (used_bytes_ + header.size > quota_bytes_ || owned + header.size > user_quota_bytes_) {
+            if (owned == 0) {
+                owner_bytes_.erase(owner);
+            }
+            quota_exceeded = true;
+            return nullptr;
+        }
+        used_bytes_ += header.size;
+        owned += header.size;
+    }
+
+    static std::atomic<uint64_t> sequence{0};
+    std::string temp_path = dir_ + "/.upload-" + std::to_string(getpid()) + "-" + std::to_string(sequence++);
+
+    // 해시용 mmap을 위해 읽기/쓰기로 연다
+    int fd = ::open(temp_path.c_str(), O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC, 0640);
+    if (fd < 0) {
+        LOG_ERROR("Attachment temp file creation failed: ", strerror(errno));
+        release(owner, header.size, false);
+        return nullptr;
+    }
+    auto upload = std::make_unique<AttachmentUpload>(header, fd, std::move(temp_path));
+    upload->owner = owner;
+    return upload;
+}
+
+void AttachmentStore::release(const std::string& owner, uint64_t bytes, bool stored) {
+    std::lock_guard<std::mutex> lock(quota_mutex_);
+    // 저장된 업로드는 주인 몫으로 남기고 (중복 내용이라도 올린 만큼 센다) 전체 사용량만 되돌린다
+    used_bytes_ -= std::min(used_bytes_, bytes);
+    if (stored) {
+        return;
+    }
+    auto it = owner_bytes_.find(owner);
+    if (it != owner_bytes_.end()) {
+        it->second -= std::min(it->second, bytes);
+        if (it->second == 0) {
+            owner_bytes_.erase(it);
+        }
+    }
+}
+
+bool AttachmentStore::commit(const AttachmentUpload& upload) {
+    const std::string path = pathFor(upload.digest());
+    if (access(path.c_str(), F_OK) == 0) {
+        // 같은 내용이 먼저 저장됨: 디스크는 더 쓰지 않는다
+        unlink(upload.tempPath().c_str());
+        release(upload.owner, upload.header().size, true);
+        return true;
+    }
+    if (rename(upload.tempPath().c_str(), path.c_str()) < 0) {
+        LOG_ERROR("Attachment commit failed: ", strerror(errno));
+        unlink(upload.tempPath().c_str());
+        release(upload.owner, upload.header().size, false);
+        return false;
+    }
+    return true;
+}
+
+void AttachmentStore::discard(const AttachmentUpload& upload) {
+    unlink(upload.tempPath().c_str());
+    release(upload.owner, upload.header().size, false);
+}
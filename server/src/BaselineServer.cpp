@@ -0,0 +1,164 @@
+#include "BaselineServer.h"
+#include "Logger.h"
+#include <stdexcept>
+
+namespace {
+    Operation getContext(io_uring_cqe* cqe) {
+        Operation ctx{};
+        auto* buffer = reinterpret_cast<uint8_t*>(&cqe->user_data);
+        
+        ctx.client_fd = *(reinterpret_cast<int32_t*>(buffer));
+        buffer += 4;
+        ctx.op_type = static_cast<OperationType>(*buffer);
+        buffer += 1;
+        ctx.buffer_idx = *(reinterpret_cast<uint16_t*>(buffer));
+        
+        return ctx;
+    }
+}
+
+BaselineServer::BaselineServer(int port, Mode mode, SocketManager& socket_manager)
+    : port_(port), mode_(mode), running_(false), socket_manager_(socket_manager) {
+    io_ring_ = std::make_unique<IOUring>();
+    io_ring_->setWorkerName("baseline");
+    io_ring_->setFrameHandler([this](int client_fd, const ChatMessage& message) {
+        handleFrame(client_fd, message);
+    });
+    LOG_INFO("[Baseline] Created in ", modeName(mode_), " mode");
+}
+
+BaselineServer::~BaselineServer() {
+    stop();
+}
+
+BaselineServer::Mode BaselineServer::parseMode(const std::string& name) {
+    if (name == "echo") return Mode::ECHO;
+    if (name == "sink") return Mode::SINK;
+    throw std::runtime_error("unknown server mode: " + name);
+}
+
+const char* BaselineServer::modeName(Mode mode) {
+    return mode == Mode::ECHO ? "echo" : "sink";
+}
+
+void BaselineServer::start() {
+    if (running_) {
+        return;
+    }
+
+    int listening_socket = socket_manager_.createListeningSocket(port_);
+    if (listening_socket < 0) {
+        throw std::runtime_error("Failed to create listening socket");
+    }
+    LOG_INFO("[Baseline] Server listening on port ", port_);
+
+    running_ = true;
+    io_ring_->prepareAccept(listening_socket);
+}
+
+void BaselineServer::processEvents() {
+    while (running_ && !stop_requested_.load(std::memory_order_acquire)) {
+        io_ring_->countLoopIteration();
+        io_uring_cqe* cqes[IOUring::CQE_BATCH_SIZE];
+        unsigned num_cqes = io_ring_->peekCQE(cqes);
+        
+        if (num_cqes == 0) {
+            const int result = io_ring_->submitAndWait();
+            if (result == -EINTR) continue;
+            if (result < 0) {
+                LOG_ERROR("[Baseline] io_uring_submit_and_wait failed: ", result);
+                continue;
+            }
+            num_cqes = io_ring_->peekCQE(cqes);
+        }
+        
+        for (unsigned i = 0; i < num_cqes; ++i) {
+            io_uring_cqe* cqe = cqes[i];
+            const auto ctx = getContext(cqe);
+            io_ring_->recordEvent(cqe);
+            
+            switch (ctx.op_type) {
+                case OperationType::ACCEPT:
+                    if (cqe->res < 0) {
+                        LOG_ERROR("[Baseline] Accept failed with error: ", cqe->res);
+                        break;
+                    }
+                    SocketTuner::applyProfile(cqe->res);
+                    io_ring_->prepareRead(cqe->res);
+                    LOG_DEBUG("[Baseline] Accepted new connection: fd=", cqe->res);
+                    break;
+                    
+                case OperationType::READ:
+                    if (cqe->res <= 0) {
+                        handleClose(ctx.client_fd);
+                    } else {
+                        io_ring_->handleRead(cqe, ctx.client_fd);
+                    }
+                    break;
+                    
+                case OperationType::WRITE:
+                    io_ring_->handleWrite(cqe, ctx.client_fd, ctx.buffer_idx);
+                    break;
+                    
+                case OperationType::SEND_ZC:
+                    io_ring_->handleSendZc(cqe, ctx.client_fd);
+                    break;
+                    
+                case OperationType::DRAIN:
+                    io_ring_->handleControl(cqe);
+                    break;
+                    
+                default:
+                    break;
+            }
+        }
+        
+        if (num_cqes > 0) {
+            io_ring_->advanceCQ(num_cqes);
+        }
+    }
+}
+
+void BaselineServer::handleFrame(int client_fd, const ChatMessage& message) {
+    // 통계 조회는 두 모드 모두 응답 (chat_benchmark의 링 효율 비교용)
+    if (message.type == MessageType::CLIENT_COMMAND &&
+        std::string(message.data, message.length) == "stats") {
+        RingStatsSnapshot snapshot;
+        snapshot.add(io_ring_->getStats());
+        std::string reply = "stats: " + snapshot.toString();
+        io_ring_->sendMessage(client_fd, MessageType::SERVER_NOTIFICATION, reply.c_str(), reply.length(),
+                              UringBuffer::NO_BUFFER);
+        return;
+    }
+
+    if (mode_ == Mode::SINK) {
+        return;
+    }
+
+    if (message.type == MessageType::CLIENT_CHAT) {
+        io_ring_->sendMessage(client_fd, MessageType::SERVER_CHAT, message.data, message.length,
+                              UringBuffer::NO_BUFFER);
+    } else {
+        io_ring_->sendMessage(client_fd, MessageType::SERVER_ACK, nullptr, 0, UringBuffer::NO_BUFFER);
+    }
+}
+
+void BaselineServer::handleClose(int client_fd) {
+    io_ring_->dropConnection(client_fd);
+    io_ring_->prepareClose(client_fd);
+    LOG_DEBUG("[Baseline] Closed client ", client_fd);
+}
+
+void BaselineServer::requestStop() {
+    stop_requested_.store(true, std::memory_order_release);
+    io_ring_->notify();
+}
+
+void BaselineServer::stop() {
+    if (!running_) return;
+    running_ = false;
+    // 기준 서버는 드레인 없이 종료 (측정용이라 재접속 분산이 필요 없음)
+    io_ring_.reset();
+    socket_manager_.closeListeningSocket();
+    LOG_INFO("[Baseline] Server stopped");
+}
@@ -0,0 +1,190 @@
+#include "Clock.h"
+#include "Logger.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <string>
+#if defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#endif
+
+Clock::Clock() {
+    if (const char* env = std::getenv("CHAT_CLOCK_RECALIBRATE_MS")) {
+        recalibrate_ns_ = std::strtoll(env, nullptr, 10) * 1000000;
+    }
+
+    const char* source = std::getenv("CHAT_CLOCK");
+    if (source && std::strcmp(source, "vdso") == 0) {
+        LOG_INFO("Clock source: vdso (CHAT_CLOCK)");
+    } else if (!hasInvariantTsc()) {
+        LOG_INFO("Clock source: vdso (no invariant TSC)");
+    } else if (!kernelTrustsTsc()) {
+        LOG_INFO("Clock source: vdso (kernel clocksource is not tsc)");
+    } else if (!calibrate()) {
+        LOG_WARN("TSC calibration failed, clock source: vdso");
+    } else {
+        LOG_INFO("Clock source: tsc (", tsc_ghz_, " GHz)");
+    }
+    updateWallOffset();
+}
+
+Clock::~Clock() {
+    stopRecalibration();
+}
+
+bool Clock::hasInvariantTsc() {
+#if defined(__x86_64__) || defined(__i386__)
+    unsigned eax = 0, ebx = 0, ecx = 0, edx = 0;
+    if (!__get_cpuid(0x80000000, &eax, &ebx, &ecx, &edx) || eax < 0x80000007) {
+        return false;
+    }
+    __get_cpuid(0x80000007, &eax, &ebx, &ecx, &edx);
+    return (edx & (1u << 8)) != 0;   // 주파수 변경/절전 상태와 무관하게 일정한 속도
+#else
+    return false;
+#endif
+}
+
+bool Clock::kernelTrustsTsc() {
+    // 커널이 TSC를 불안정하다고 판단해 다른 clocksource로 바꿨다면 따른다
+    std::ifstream file("/sys/devices/system/clocksource/clocksource0/current_clocksource");
+    std::string current;
+    if (!(file >> current)) {
+        return true;   // 확인할 수 없으면 CPUID만 믿는다
+    }
+    return current == "tsc";
+}
+
+void Clock::sample(uint64_t& cycles, int64_t& ns) {
+#if defined(__x86_64__) || defined(__i386__)
+    // rdtsc를 두 번의 clock_gettime 사이에 두고 중간 시각과 짝짓는다
+    const int64_t before = monotonicNanos();
+    cycles = __rdtsc();
+    const int64_t after = monotonicNanos();
+    ns = before + (after - before) / 2;
+#else
+    cycles = 0;
+    ns = monotonicNanos();
+#endif
+}
+
+bool Clock::calibrate() {
+#if defined(__x86_64__) || defined(__i386__)
+    uint64_t start_cycles = 0, end_cycles = 0;
+    int64_t start_ns = 0, end_ns = 0;
+    sample(start_cycles, start_ns);
+    timespec pause{0, CALIBRATION_NS};
+    nanosleep(&pause, nullptr);
+    sample(end_cycles, end_ns);
+
+    const int64_t elapsed_ns = end_ns - start_ns;
+    const uint64_t elapsed_cycles = end_cycles - start_cycles;
+    if (elapsed_ns <= 0 || elapsed_cycles == 0) {
+        return false;
+    }
+
+    tsc_ghz_ = static_cast<double>(elapsed_cycles) / static_cast<double>(elapsed_ns);
+    if (tsc_ghz_ < 0.1 || tsc_ghz_ > 10.0) {
+        return false;   // 가상화 환경 등에서 비정상적인 값
+    }
+
+    // 워커가 뜨기 전 (생성자)이므로 seqlock 없이 쓴다
+    mult_.store(static_cast<uint64_t>((static_cast<unsigned __int128>(elapsed_ns) << SHIFT) / elapsed_cycles));
+    base_cycles_.store(end_cycles);
+    base_ns_.store(end_ns);
+    anchor_cycles_ = end_cycles;
+    anchor_ns_ = end_ns;
+    use_tsc_ = true;
+    return true;
+#else
+    return false;
+#endif
+}
+
+void Clock::updateWallOffset() {
+    // 두 번의 now() 사이에 읽은 벽시계와 짝짓는다
+    const int64_t before = now();
+    const int64_t wall = realtimeNanos();
+    const int64_t after = now();
+    wall_offset_ns_.store(wall - (before + (after - before) / 2), std::memory_order_relaxed);
+}
+
+void Clock::startRecalibration() {
+    if (recalibrate_ns_ <= 0 || recalibrator_.joinable()) {
+        return;
+    }
+    should_stop_ = false;
+    recalibrator_ = std::thread(&Clock::recalibrationThread, this);
+    if (use_tsc_) {
+        LOG_INFO("Clock: recalibrating TSC against CLOCK_MONOTONIC every ", recalibrate_ns_ / 1000000, "ms");
+    }
+}
+
+void Clock::stopRecalibration() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        should_stop_ = true;
+    }
+    cv_.notify_all();
+    if (recalibrator_.joinable()) {
+        recalibrator_.join();
+    }
+}
+
+void Clock::recalibrationThread() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (!should_stop_) {
+        cv_.wait_for(lock, std::chrono::nanoseconds(recalibrate_ns_), [this] { return should_stop_; });
+        if (should_stop_) {
+            break;
+        }
+        if (use_tsc_) {
+            recalibrate();
+        }
+        updateWallOffset();
+    }
+}
+
+void Clock::recalibrate() {
+    uint64_t cycles = 0;
+    int64_t mono_ns = 0;
+    sample(cycles, mono_ns);
+    const uint64_t elapsed_cycles = cycles - anchor_cycles_;
+    const int64_t elapsed_ns = mono_ns - anchor_ns_;
+    if (elapsed_ns <= 0 || elapsed_cycles == 0) {
+        return;
+    }
+
+    // 지난 주기 동안 CLOCK_MONOTONIC 기준으로 잰 실제 배율
+    const uint64_t measured = static_cast<uint64_t>(
+        (static_cast<unsigned __int128>(elapsed_ns) << SHIFT) / elapsed_cycles);
+    anchor_cycles_ = cycles;
+    anchor_ns_ = mono_ns;
+
+    // 지금 이 시계가 보여주는 값과의 차이를 다음 주기 동안 따라잡는 배율. 뒤로 가지 않도록
+    // 실제 배율의 1/2~2배로 제한한다 (한 주기에 못 따라잡은 차이는 다음 주기로 넘어간다)
+    const int64_t current_ns = toNanos(cycles, base_cycles_.load(std::memory_order_relaxed),
+                                       base_ns_.load(std::memory_order_relaxed),
+                                       mult_.load(std::memory_order_relaxed));
+    const int64_t drift_ns = mono_ns - current_ns;
+    const int64_t target_ns = std::max<int64_t>(recalibrate_ns_ + drift_ns, 0);
+    const unsigned __int128 interval_cycles = (static_cast<unsigned __int128>(recalibrate_ns_) << SHIFT) / measured;
+    uint64_t mult = interval_cycles == 0 ? measured :
+        static_cast<uint64_t>((static_cast<unsigned __int128>(target_ns) << SHIFT) / interval_cycles);
+    mult = std::min(std::max(mult, measured / 2), measured * 2);
+
+    sequence_.store(sequence_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    base_cycles_.store(cycles, std::memory_order_relaxed);
+    base_ns_.store(current_ns, std::memory_order_relaxed);
+    mult_.store(mult, std::memory_order_relaxed);
+    sequence_.store(sequence_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+
+    if (drift_ns > 1000000 || drift_ns < -1000000) {
+        LOG_WARN("Clock: TSC drifted ", drift_ns / 1000, "us from CLOCK_MONOTONIC, slewing");
+    } else {
+        LOG_DEBUG("Clock: TSC drift ", drift_ns, "ns");
+    }
+}
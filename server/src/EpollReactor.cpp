@@ -0,0 +1,439 @@
+#include "EpollReactor.h"
+#include "Logger.h"
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <algorithm>
+
+namespace {
+    void setNonBlocking(int fd) {
+        int flags = fcntl(fd, F_GETFL, 0);
+        if (flags >= 0 && !(flags & O_NONBLOCK)) {
+            fcntl(fd, F_SETFL, flags | O_NONBLOCK);
+        }
+    }
+}
+
+EpollReactor::EpollReactor(unsigned entries) : entries_(entries) {
+    epoll_fd_ = epoll_create1(EPOLL_CLOEXEC);
+    if (epoll_fd_ < 0) {
+        LOG_FATAL("Failed to create epoll instance: ", errno);
+        throw std::runtime_error("Failed to create epoll instance");
+    }
+
+    wake_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (wake_fd_ < 0) {
+        close(epoll_fd_);
+        throw std::runtime_error("Failed to create epoll wake eventfd");
+    }
+    epoll_event ev{};
+    ev.events = EPOLLIN;
+    ev.data.fd = wake_fd_;
+    epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, wake_fd_, &ev);
+
+    LOG_INFO("epoll reactor initialized successfully");
+}
+
+EpollReactor::~EpollReactor() {
+    close(wake_fd_);
+    close(epoll_fd_);
+}
+
+io_uring_sqe* EpollReactor::getSQE() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto& sq = sq_[std::this_thread::get_id()];
+    if (sq.size() >= entries_) {
+        return nullptr;  // SQ 가득 참: 호출자가 제출 후 재시도
+    }
+    sq.emplace_back();
+    io_uring_sqe* sqe = &sq.back();
+    memset(sqe, 0, sizeof(*sqe));
+    return sqe;
+}
+
+unsigned EpollReactor::sqReady() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = sq_.find(std::this_thread::get_id());
+    return it != sq_.end() ? static_cast<unsigned>(it->second.size()) : 0;
+}
+
+int EpollReactor::submit() {
+    int submitted;
+    bool notify;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        size_t before = cq_.size();
+        submitted = submitLocked();
+        notify = cq_.size() > before && waiting_;
+    }
+    // 대기 중인 워커가 새 완료를 보도록 깨움
+    if (notify) {
+        uint64_t one = 1;
+        if (write(wake_fd_, &one, sizeof(one)) < 0) {
+            LOG_ERROR("epoll wake write failed: ", errno);
+        }
+    }
+    return submitted;
+}
+
+int EpollReactor::submitLocked() {
+    auto it = sq_.find(std::this_thread::get_id());
+    if (it == sq_.end()) return 0;
+
+    int submitted = 0;
+    auto& sq = it->second;
+    while (!sq.empty()) {
+        io_uring_sqe sqe = sq.front();
+        sq.pop_front();
+        processSQE(sqe);
+        submitted++;
+    }
+    return submitted;
+}
+
+int EpollReactor::submitAndWait(unsigned wait_nr) {
+    int submitted = submit();
+    epoll_event events[MAX_EVENTS];
+
+    while (true) {
+        int timeout_ms;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (cq_.size() >= wait_nr) {
+                return submitted;
+            }
+            timeout_ms = waitTimeoutMs();
+            // 완료 큐가 비었다고 본 잠금 안에서 표시해야 그 사이 다른 쓰레드의 제출이 깨움을 빠뜨리지 않는다
+            waiting_ = true;
+        }
+
+        int n = epoll_wait(epoll_fd_, events, MAX_EVENTS, timeout_ms);
+        const int wait_errno = errno;
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        waiting_ = false;
+        if (n < 0) {
+            if (wait_errno == EINTR) return -EINTR;
+            return -wait_errno;
+        }
+
+        for (int i = 0; i < n; ++i) {
+            int fd = events[i].data.fd;
+            if (fd == wake_fd_) {
+                uint64_t value;
+                while (read(wake_fd_, &value, sizeof(value)) > 0) {}
+                continue;
+            }
+
+            auto it = fds_.find(fd);
+            if (it == fds_.end()) continue;
+            if (events[i].events & (EPOLLIN | EPOLLERR | EPOLLHUP)) {
+                onReadable(fd);
+            }
+            it = fds_.find(fd);
+            if (it != fds_.end() && (events[i].events & (EPOLLOUT | EPOLLERR | EPOLLHUP))) {
+                flushWrites(fd, it->second);
+            }
+            updateInterest(fd);
+        }
+        expireTimers();
+    }
+}
+
+unsigned EpollReactor::peekBatch(io_uring_cqe** cqes, unsigned max) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    unsigned count = static_cast<unsigned>(std::min<size_t>(max, cq_.size()));
+    for (unsigned i = 0; i < count; ++i) {
+        cqes[i] = &cq_[i];
+    }
+    return count;
+}
+
+void EpollReactor::advance(unsigned count) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    while (count-- > 0 && !cq_.empty()) {
+        cq_.pop_front();
+    }
+}
+
+int EpollReactor::registerBufRing(io_uring_buf_reg* reg) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    buf_ring_ = reinterpret_cast<io_uring_buf_ring*>(reg->ring_addr);
+    buf_mask_ = reg->ring_entries - 1;
+    buf_head_ = 0;
+    return 0;
+}
+
+bool EpollReactor::takeBuffer(uint16_t& bid, void*& addr, unsigned& len) {
+    if (!buf_ring_) return false;
+    uint16_t tail = __atomic_load_n(&buf_ring_->tail, __ATOMIC_ACQUIRE);
+    if (buf_head_ == tail) return false;
+
+    const io_uring_buf& buf = buf_ring_->bufs[buf_head_ & buf_mask_];
+    bid = buf.bid;
+    addr = reinterpret_cast<void*>(buf.addr);
+    len = buf.len;
+    buf_head_++;
+    return true;
+}
+
+void EpollReactor::post(__u64 user_data, int32_t res, uint32_t flags) {
+    io_uring_cqe cqe{};
+    cqe.user_data = user_data;
+    cqe.res = res;
+    cqe.flags = flags;
+    cq_.push_back(cqe);
+}
+
+void EpollReactor::processSQE(const io_uring_sqe& sqe) {
+    const int fd = sqe.fd;
+
+    switch (sqe.opcode) {
+        case IORING_OP_ACCEPT: {
+            setNonBlocking(fd);
+            FdState& state = fds_[fd];
+            state.accept = true;
+            state.accept_multishot = sqe.ioprio & IORING_ACCEPT_MULTISHOT;
+            state.accept_data = sqe.user_data;
+            state.accept_addr = reinterpret_cast<sockaddr*>(sqe.addr);
+            state.accept_addrlen = reinterpret_cast<socklen_t*>(sqe.addr2);
+            updateInterest(fd);
+            break;
+        }
+
+        case IORING_OP_RECV:
+        case IORING_OP_READ: {
+            setNonBlocking(fd);
+            FdState& state = fds_[fd];
+            state.recv = true;
+            state.recv_multishot = sqe.opcode == IORING_OP_RECV && (sqe.ioprio & IORING_RECV_MULTISHOT);
+            state.recv_select = sqe.flags & IOSQE_BUFFER_SELECT;
+            state.recv_data = sqe.user_data;
+            state.recv_buf = reinterpret_cast<void*>(sqe.addr);
+            state.recv_len = sqe.len;
+            updateInterest(fd);
+            break;
+        }
+
+        case IORING_OP_WRITE:
+        case IORING_OP_SEND: {
+            FdState& state = fds_[fd];
+            state.writes.push_back(PendingWrite{sqe.user_data, reinterpret_cast<const uint8_t*>(sqe.addr), sqe.len, 0});
+            if (state.writes.size() == 1) {
+                flushWrites(fd, state);
+            }
+            updateInterest(fd);
+            break;
+        }
+
+        case IORING_OP_CLOSE:
+            closeFd(fd, sqe.user_data);
+            break;
+
+        case IORING_OP_TIMEOUT: {
+            const auto* ts = reinterpret_cast<const __kernel_timespec*>(sqe.addr);
+            auto deadline = std::chrono::steady_clock::now() +
+                            std::chrono::seconds(ts->tv_sec) + std::chrono::nanoseconds(ts->tv_nsec);
+            timers_.push_back(Timer{deadline, sqe.user_data});
+            break;
+        }
+
+        case IORING_OP_NOP:
+            post(sqe.user_data, 0);
+            break;
+
+        case IORING_OP_ASYNC_CANCEL: {
+            // 걸려 있는 recv만 취소 대상 (발신자 조절의 recv 일시 정지)
+            int32_t res = -ENOENT;
+            for (auto& [target_fd, state] : fds_) {
+                if (state.recv && state.recv_data == sqe.addr) {
+                    state.recv = false;
+                    post(state.recv_data, -ECANCELED);
+                    updateInterest(target_fd);
+                    res = 0;
+                    break;
+                }
+            }
+            post(sqe.user_data, res);
+            break;
+        }
+
+        case IORING_OP_URING_CMD:
+            post(sqe.user_data, -EOPNOTSUPP);
+            break;
+
+        default:
+            LOG_WARN("epoll reactor: unsupported opcode ", static_cast<int>(sqe.opcode));
+            post(sqe.user_data, -EINVAL);
+            break;
+    }
+}
+
+void EpollReactor::onReadable(int fd) {
+    auto it = fds_.find(fd);
+    if (it == fds_.end()) return;
+    if (it->second.accept) acceptReady(fd, it->second);
+    if (it->second.recv) recvReady(fd, it->second);
+}
+
+void EpollReactor::acceptReady(int fd, FdState& state) {
+    for (unsigned i = 0; i < MAX_OPS_PER_WAKEUP && state.accept; ++i) {
+        int client_fd = accept4(fd, state.accept_addr, state.accept_addrlen, SOCK_CLOEXEC);
+        if (client_fd < 0) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK) return;
+            // multishot accept는 오류 시 종료된다
+            post(state.accept_data, -errno);
+            state.accept = false;
+            return;
+        }
+        post(state.accept_data, client_fd, state.accept_multishot ? IORING_CQE_F_MORE : 0);
+        if (!state.accept_multishot) {
+            state.accept = false;
+        }
+    }
+}
+
+void EpollReactor::recvReady(int fd, FdState& state) {
+    for (unsigned i = 0; i < MAX_OPS_PER_WAKEUP && state.recv; ++i) {
+        uint16_t bid = 0;
+        void* addr = state.recv_buf;
+        unsigned len = state.recv_len;
+
+        if (state.recv_select && !takeBuffer(bid, addr, len)) {
+            // 커널과 동일: 버퍼가 없으면 -ENOBUFS로 multishot 종료
+            post(state.recv_data, -ENOBUFS);
+            state.recv = false;
+            return;
+        }
+
+        ssize_t n = recv(fd, addr, len, 0);
+        if (n < 0 && errno == ENOTSOCK) {
+            n = read(fd, addr, len);
+        }
+
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            if (state.recv_select) returnBuffer();
+            return;
+        }
+
+        if (n <= 0) {
+            int32_t res = n < 0 ? -errno : 0;
+            if (state.recv_select) returnBuffer();
+            post(state.recv_data, res);
+            state.recv = false;
+            return;
+        }
+
+        uint32_t flags = 0;
+        if (state.recv_select) {
+            flags |= IORING_CQE_F_BUFFER | (static_cast<uint32_t>(bid) << IORING_CQE_BUFFER_SHIFT);
+        }
+        if (state.recv_multishot) {
+            flags |= IORING_CQE_F_MORE;
+        } else {
+            state.recv = false;
+        }
+        post(state.recv_data, static_cast<int32_t>(n), flags);
+    }
+}
+
+void EpollReactor::flushWrites(int fd, FdState& state) {
+    // 프레임 단위로 전송을 마친 뒤에 완료를 올린다 (부분 전송 없음)
+    while (!state.writes.empty()) {
+        PendingWrite& w = state.writes.front();
+        ssize_t n = send(fd, w.buf + w.done, w.len - w.done, MSG_NOSIGNAL | MSG_DONTWAIT);
+        if (n < 0 && errno == ENOTSOCK) {
+            n = write(fd, w.buf + w.done, w.len - w.done);
+        }
+
+        if (n < 0) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK) return;
+            post(w.user_data, -errno);
+            state.writes.pop_front();
+            continue;
+        }
+
+        w.done += static_cast<size_t>(n);
+        if (w.done == w.len) {
+            post(w.user_data, static_cast<int32_t>(w.len));
+            state.writes.pop_front();
+        }
+    }
+}
+
+void EpollReactor::closeFd(int fd, __u64 user_data) {
+    auto it = fds_.find(fd);
+    if (it != fds_.end()) {
+        for (const auto& w : it->second.writes) {
+            post(w.user_data, -ECANCELED);
+        }
+        if (it->second.events) {
+            epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, fd, nullptr);
+        }
+        fds_.erase(it);
+    }
+    post(user_data, close(fd) < 0 ? -errno : 0);
+}
+
+void EpollReactor::updateInterest(int fd) {
+    auto it = fds_.find(fd);
+    if (it == fds_.end()) return;
+    FdState& state = it->second;
+
+    uint32_t desired = 0;
+    if (state.accept || state.recv) desired |= EPOLLIN;
+    if (!state.writes.empty()) desired |= EPOLLOUT;
+
+    if (desired != state.events) {
+        epoll_event ev{};
+        ev.events = desired;
+        ev.data.fd = fd;
+
+        int ret = 0;
+        if (desired == 0) {
+            ret = epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, fd, nullptr);
+        } else if (state.events == 0) {
+            ret = epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &ev);
+            if (ret < 0 && errno == EEXIST) ret = epoll_ctl(epoll_fd_, EPOLL_CTL_MOD, fd, &ev);
+        } else {
+            ret = epoll_ctl(epoll_fd_, EPOLL_CTL_MOD, fd, &ev);
+            // 다른 경로로 닫혔다가 재사용된 fd
+            if (ret < 0 && errno == ENOENT) ret = epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &ev);
+        }
+        if (ret < 0 && desired != 0) {
+            LOG_ERROR("epoll_ctl failed for fd ", fd, ": ", errno);
+        }
+        state.events = desired;
+    }
+
+    if (state.events == 0 && !state.accept && !state.recv && state.writes.empty()) {
+        fds_.erase(it);
+    }
+}
+
+void EpollReactor::expireTimers() {
+    auto now = std::chrono::steady_clock::now();
+    for (auto it = timers_.begin(); it != timers_.end();) {
+        if (it->deadline <= now) {
+            post(it->user_data, -ETIME);
+            it = timers_.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+int EpollReactor::waitTimeoutMs() const {
+    if (timers_.empty()) return -1;
+
+    auto now = std::chrono::steady_clock::now();
+    auto nearest = std::min_element(timers_.begin(), timers_.end(),
+        [](const Timer& a, const Timer& b) { return a.deadline < b.deadline; })->deadline;
+    if (nearest <= now) return 0;
+    return static_cast<int>(std::chrono::duration_cast<std::chrono::milliseconds>(nearest - now).count()) + 1;
+}
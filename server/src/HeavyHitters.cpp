@@ -0,0 +1,256 @@
+#include "HeavyHitters.h"
+#include <algorithm>
+#include <arpa/inet.h>
+#include <cstdlib>
+#include <netinet/in.h>
+#include <thread>
+
+namespace {
+    // splitmix64 마무리 단계: 연속된 연결/세션 번호도 고르게 흩어지게
+    uint64_t mix(uint64_t x) {
+        x ^= x >> 30;
+        x *= 0xbf58476d1ce4e5b9ULL;
+        x ^= x >> 27;
+        x *= 0x94d049bb133111ebULL;
+        x ^= x >> 31;
+        return x;
+    }
+}
+
+size_t CountMinSketch::slot(uint64_t key, size_t row) {
+    return mix(key + 0x9e3779b97f4a7c15ULL * (row + 1)) & (WIDTH - 1);
+}
+
+void CountMinSketch::add(uint64_t key, uint64_t weight) {
+    for (size_t row = 0; row < DEPTH; ++row) {
+        std::atomic<uint64_t>& count = counts_[row][slot(key, row)];
+        count.store(count.load(std::memory_order_relaxed) + weight, std::memory_order_relaxed);
+    }
+}
+
+uint64_t CountMinSketch::estimate(uint64_t key) const {
+    uint64_t result = UINT64_MAX;
+    for (size_t row = 0; row < DEPTH; ++row) {
+        result = std::min(result, counts_[row][slot(key, row)].load(std::memory_order_relaxed));
+    }
+    return result;
+}
+
+void CountMinSketch::decay(unsigned shift) {
+    for (auto& row : counts_) {
+        for (std::atomic<uint64_t>& count : row) {
+            count.store(count.load(std::memory_order_relaxed) >> shift, std::memory_order_relaxed);
+        }
+    }
+}
+
+void SpaceSaving::beginWrite() {
+    sequence_.store(sequence_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+}
+
+void SpaceSaving::endWrite() {
+    sequence_.store(sequence_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
+
+void SpaceSaving::add(uint64_t key, uint64_t weight) {
+    auto it = index_.find(key);
+    if (it != index_.end()) {
+        Slot& entry = slots_[it->second];
+        beginWrite();
+        entry.count.store(entry.count.load(std::memory_order_relaxed) + weight, std::memory_order_relaxed);
+        endWrite();
+        return;
+    }
+
+    const size_t size = size_.load(std::memory_order_relaxed);
+    if (size < CAPACITY) {
+        index_.emplace(key, size);
+        beginWrite();
+        slots_[size].key.store(key, std::memory_order_relaxed);
+        slots_[size].count.store(weight, std::memory_order_relaxed);
+        slots_[size].error.store(0, std::memory_order_relaxed);
+        size_.store(size + 1, std::memory_order_relaxed);
+        endWrite();
+        return;
+    }
+
+    size_t victim = 0;
+    for (size_t i = 1; i < size; ++i) {
+        if (slots_[i].count.load(std::memory_order_relaxed) < slots_[victim].count.load(std::memory_order_relaxed)) {
+            victim = i;
+        }
+    }
+    Slot& entry = slots_[victim];
+    const uint64_t count = entry.count.load(std::memory_order_relaxed);
+    index_.erase(entry.key.load(std::memory_order_relaxed));
+    index_.emplace(key, victim);
+    beginWrite();
+    entry.key.store(key, std::memory_order_relaxed);
+    entry.error.store(count, std::memory_order_relaxed);
+    entry.count.store(count + weight, std::memory_order_relaxed);
+    endWrite();
+}
+
+void SpaceSaving::decay(unsigned shift) {
+    // 0이 된 항목은 비워서 새 키가 오차 없이 들어오게 한다
+    const size_t size = size_.load(std::memory_order_relaxed);
+    size_t kept = 0;
+    index_.clear();
+    beginWrite();
+    for (size_t i = 0; i < size; ++i) {
+        const uint64_t key = slots_[i].key.load(std::memory_order_relaxed);
+        const uint64_t count = slots_[i].count.load(std::memory_order_relaxed) >> shift;
+        const uint64_t error = slots_[i].error.load(std::memory_order_relaxed) >> shift;
+        if (count > 0) {
+            slots_[kept].key.store(key, std::memory_order_relaxed);
+            slots_[kept].count.store(count, std::memory_order_relaxed);
+            slots_[kept].error.store(error, std::memory_order_relaxed);
+            index_.emplace(key, kept);
+            ++kept;
+        }
+    }
+    size_.store(kept, std::memory_order_relaxed);
+    endWrite();
+}
+
+void SpaceSaving::snapshot(std::vector<HeavyHitter>& out) const {
+    while (true) {
+        const uint64_t before = sequence_.load(std::memory_order_acquire);
+        if (before & 1) {
+            // 워커가 쓰는 중 (몇 개 항목뿐이라 곧 끝난다)
+            std::this_thread::yield();
+            continue;
+        }
+        out.clear();
+        const size_t size = std::min(size_.load(std::memory_order_relaxed), CAPACITY);
+        for (size_t i = 0; i < size; ++i) {
+            out.push_back(HeavyHitter{slots_[i].key.load(std::memory_order_relaxed),
+                                      slots_[i].count.load(std::memory_order_relaxed),
+                                      slots_[i].error.load(std::memory_order_relaxed)});
+        }
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (sequence_.load(std::memory_order_relaxed) == before) {
+            return;
+        }
+    }
+}
+
+unsigned LoadSketch::pendingDecays(int64_t now_ns) const {
+    const int64_t next_decay_ns = next_decay_ns_.load(std::memory_order_relaxed);
+    if (next_decay_ns == 0 || now_ns < next_decay_ns) {
+        return 0;
+    }
+    const int64_t missed = (now_ns - next_decay_ns) / (DECAY_INTERVAL_MS * 1000000) + 1;
+    return static_cast<unsigned>(std::min<int64_t>(missed, 63));
+}
+
+void LoadSketch::decayIfDue(int64_t now_ns) {
+    if (now_ns < next_decay_ns_.load(std::memory_order_relaxed)) {
+        return;
+    }
+    if (const unsigned shift = pendingDecays(now_ns)) {
+        for (auto& tables : tables_) {
+            for (Table& entry : tables) {
+                entry.top.decay(shift);
+                entry.counts.decay(shift);
+            }
+        }
+    }
+    next_decay_ns_.store(now_ns + DECAY_INTERVAL_MS * 1000000, std::memory_order_relaxed);
+}
+
+void LoadSketch::record(const Sample& sample, int64_t now_ns) {
+    decayIfDue(now_ns);
+
+    const uint64_t weights[NUM_METRICS] = {1, sample.bytes, sample.fanout};
+    add(LoadKey::SENDER, sample.sender, weights);
+    add(LoadKey::ROOM, sample.room, weights);
+    if (sample.source_ip != 0) {
+        add(LoadKey::SOURCE_IP, sample.source_ip, weights);
+    }
+}
+
+void LoadSketch::add(LoadKey key_type, uint64_t key, const uint64_t (&weights)[NUM_METRICS]) {
+    auto& tables = tables_[static_cast<size_t>(key_type)];
+    for (size_t metric = 0; metric < NUM_METRICS; ++metric) {
+        tables[metric].top.add(key, weights[metric]);
+        tables[metric].counts.add(key, weights[metric]);
+    }
+}
+
+uint64_t LoadSketch::estimate(LoadKey key_type, LoadMetric metric, uint64_t key, int64_t now_ns) const {
+    return table(key_type, metric).counts.estimate(key) >> pendingDecays(now_ns);
+}
+
+void LoadSketch::collectTop(LoadKey key_type, LoadMetric metric, int64_t now_ns,
+                            std::unordered_map<uint64_t, HeavyHitter>& merged) const {
+    const unsigned shift = pendingDecays(now_ns);
+    std::vector<HeavyHitter> entries;
+    entries.reserve(SpaceSaving::CAPACITY);
+    table(key_type, metric).top.snapshot(entries);
+    for (const HeavyHitter& entry : entries) {
+        if ((entry.count >> shift) == 0) {
+            continue;
+        }
+        HeavyHitter& total = merged[entry.key];
+        total.key = entry.key;
+        total.count += entry.count >> shift;
+        total.error += entry.error >> shift;
+    }
+}
+
+std::vector<HeavyHitter> LoadSketch::selectTop(const std::unordered_map<uint64_t, HeavyHitter>& merged, size_t k) {
+    std::vector<HeavyHitter> result;
+    result.reserve(merged.size());
+    for (const auto& [key, entry] : merged) {
+        result.push_back(entry);
+    }
+    const size_t count = std::min(k, result.size());
+    std::partial_sort(result.begin(), result.begin() + count, result.end(),
+        [](const HeavyHitter& a, const HeavyHitter& b) { return a.count > b.count; });
+    result.resize(count);
+    return result;
+}
+
+uint64_t LoadSketch::ipMessageRateFromEnv() {
+    const char* value = std::getenv("CHAT_IP_MSG_RATE");
+    return value ? std::strtoull(value, nullptr, 10) : 0;
+}
+
+bool LoadSketch::parseKey(const std::string& name, LoadKey& key_type) {
+    if (name == "senders") {
+        key_type = LoadKey::SENDER;
+    } else if (name == "rooms") {
+        key_type = LoadKey::ROOM;
+    } else if (name == "ips") {
+        key_type = LoadKey::SOURCE_IP;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+bool LoadSketch::parseMetric(const std::string& name, LoadMetric& metric) {
+    if (name == "messages") {
+        metric = LoadMetric::MESSAGES;
+    } else if (name == "bytes") {
+        metric = LoadMetric::BYTES;
+    } else if (name == "fanout") {
+        metric = LoadMetric::FANOUT;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+std::string LoadSketch::formatKey(LoadKey key_type, uint64_t key) {
+    if (key_type == LoadKey::SOURCE_IP) {
+        in_addr addr{};
+        addr.s_addr = htonl(static_cast<uint32_t>(key));
+        char text[INET_ADDRSTRLEN] = {0};
+        inet_ntop(AF_INET, &addr, text, sizeof(text));
+        return text;
+    }
+    return std::to_string(key);
+}
@@ -4,37 +4,87 @@
 #include "SessionManager.h"
 #include "Logger.h"
 #include <string.h>
+#include <sys/socket.h>
+#include <arpa/inet.h>
+#include <poll.h>
+#include <fcntl.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
 #include <sstream>
 #include <iomanip>
+#include <algorithm>
+#include "Clock.h"
+#include "Watchdog.h"
+#include "IpBlocklist.h"
+#include "SpamFilter.h"
+#include "CommandCodec.h"
+#include "SyntheticLoad.h"
+#include "RoomJournal.h"
+#include "Replication.h"
+#include "RaftNode.h"
 
-IOUring::IOUring() : ring_initialized_(false) {
-    initRing();
-    buffer_manager_ = std::make_unique<UringBuffer>(&ring_);
-}
+IOUring::IOUring() : reactor_(NUM_SUBMISSION_QUEUE_ENTRIES) {
+    buffer_manager_ = std::make_unique<UringBuffer>(&reactor_);
 
-IOUring::~IOUring() {
-    if (ring_initialized_) {
-        io_uring_queue_exit(&ring_);
+#ifdef SOCKET_URING_OP_GETSOCKOPT
+    // TCP_INFO 비동기 샘플링은 IORING_OP_URING_CMD 지원 커널에서만 사용
+    sockcmd_supported_ = reactor_.supportsOpcode(IORING_OP_URING_CMD);
+#endif
+
+    fanout_mode_ = PipeFanout::modeFromEnv();
+    splice_min_payload_ = PipeFanout::minPayloadFromEnv();
+    if (fanout_mode_ == FanoutMode::SPLICE &&
+        !(reactor_.supportsOpcode(IORING_OP_TEE) && reactor_.supportsOpcode(IORING_OP_SPLICE) &&
+          reactor_.supportsOpcode(IORING_OP_POLL_ADD))) {
+        LOG_WARN("tee/splice not supported by ", Reactor::NAME, " backend, falling back to write fan-out");
+        fanout_mode_ = FanoutMode::WRITE;
+    }
+#ifdef IORING_CQE_F_NOTIF
+    const bool send_zc_supported = reactor_.supportsOpcode(IORING_OP_SEND_ZC);
+#else
+    const bool send_zc_supported = false;
+#endif
+    if (fanout_mode_ == FanoutMode::SEND_ZC && !send_zc_supported) {
+        LOG_WARN("SEND_ZC not supported by ", Reactor::NAME, " backend, falling back to write fan-out");
+        fanout_mode_ = FanoutMode::WRITE;
+    }
+    LOG_DEBUG("Fan-out mode: ", PipeFanout::modeName(fanout_mode_));
+
+    // 첨부 전송은 splice와 recv 일시 정지(취소), POLLIN 대기에 기댄다
+    attachments_supported_ = AttachmentStore::getInstance().isEnabled() &&
+        reactor_.supportsOpcode(IORING_OP_SPLICE) && reactor_.supportsOpcode(IORING_OP_POLL_ADD) &&
+        reactor_.supportsOpcode(IORING_OP_ASYNC_CANCEL) && reactor_.supportsOpcode(IORING_OP_LINK_TIMEOUT);
+    upload_idle_timeout_.tv_sec = UPLOAD_IDLE_TIMEOUT_SEC;
+
+    // 방 backlog 조절은 recv 취소로 발신자를 멈춘다
+    recv_cancel_supported_ = reactor_.supportsOpcode(IORING_OP_ASYNC_CANCEL);
+    ip_message_rate_ = LoadSketch::ipMessageRateFromEnv();
+
+    control_fd_ = eventfd(0, EFD_CLOEXEC);
+    if (control_fd_ < 0) {
+        throw std::runtime_error("Failed to create control eventfd");
     }
+    prepareControlRead();
+    // 워커 쓰레드가 루프를 돌기 전에도 알림을 받을 수 있게 바로 제출 (epoll 백엔드는 SQ가 쓰레드별)
+    submit();
+
+    Watchdog::getInstance().watch(&heartbeat_);
 }
 
-void IOUring::initRing() {
-    io_uring_params params{};
-    memset(&params, 0, sizeof(params));
-    int ret = io_uring_queue_init_params(NUM_SUBMISSION_QUEUE_ENTRIES, &ring_, &params);
-    if (ret < 0) {
-        LOG_FATAL("Failed to initialize io_uring: ", ret);
-        throw std::runtime_error("Failed to initialize io_uring");
+IOUring::~IOUring() {
+    Watchdog::getInstance().unwatch(&heartbeat_);
+    RoomFlowControl::getInstance().forgetRing(this);
+    if (control_fd_ >= 0) {
+        close(control_fd_);
     }
-    LOG_INFO("io_uring initialized successfully");
-    ring_initialized_ = true;
 }
 
 io_uring_sqe* IOUring::getSQE() {
-    io_uring_sqe* sqe = io_uring_get_sqe(&ring_);
+    io_uring_sqe* sqe = reactor_.getSQE();
     if (!sqe) {
-        io_uring_submit(&ring_);
-        sqe = io_uring_get_sqe(&ring_);
+        // SQ가 가득 찬 경우의 암묵적 제출
+        submit();
+        sqe = reactor_.getSQE();
         if (!sqe) {
             throw std::runtime_error("Failed to get SQE");
         }
@@ -42,8 +92,25 @@ io_uring_sqe* IOUring::getSQE() {
     return sqe;
 }
 
+int IOUring::submit() {
+    // SQPOLL 없이 io_uring_submit은 대기 중인 SQE가 있을 때만 커널에 진입
+    if (reactor_.sqReady() > 0) {
+        RingStats::bump(stats_.ring_enters);
+    }
+    int ret = reactor_.submit();
+    if (ret > 0) {
+        RingStats::bump(stats_.sqes_submitted, ret);
+    }
+    return ret;
+}
+
 int IOUring::submitAndWait() {
-    int ret = io_uring_submit_and_wait(&ring_, NUM_WAIT_ENTRIES);
+    heartbeat_.enterIdle();
+    RingStats::bump(stats_.ring_enters);
+    int ret = reactor_.submitAndWait(NUM_WAIT_ENTRIES);
+    if (ret > 0) {
+        RingStats::bump(stats_.sqes_submitted, ret);
+    }
     if (ret < 0 && ret != -EINTR) {
         LOG_ERROR("io_uring_submit_and_wait failed: ", ret);
         return ret;
@@ -52,9 +119,15 @@ int IOUring::submitAndWait() {
 }
 
 void IOUring::setContext(io_uring_sqe* sqe, OperationType type, int client_fd, uint16_t buffer_idx) {
+    sqe->user_data = makeContext(type, client_fd, buffer_idx);
+}
+
+__u64 IOUring::makeContext(OperationType type, int client_fd, uint16_t buffer_idx) {
     static_assert(8 == sizeof(__u64));  // user_data 크기 확인
 
-    auto* buffer = reinterpret_cast<uint8_t*>(&sqe->user_data);
+    // 남는 마지막 바이트도 0으로 채워 취소 요청이 같은 값으로 찾을 수 있게 한다
+    __u64 user_data = 0;
+    auto* buffer = reinterpret_cast<uint8_t*>(&user_data);
 
     // client_fd 쓰기 (4 bytes)
     *(reinterpret_cast<int32_t*>(buffer)) = client_fd;
@@ -64,7 +137,7 @@ void IOUring::setContext(io_uring_sqe* sqe, OperationType type, int client_fd, u
     buffer += 1;
     // buffer_idx 쓰기 (2 bytes)
     *(reinterpret_cast<uint16_t*>(buffer)) = buffer_idx;
-
+    return user_data;
 }
 
 void IOUring::prepareAccept(int socket_fd) {
@@ -92,12 +165,267 @@ void IOUring::prepareWrite(int client_fd, const void* buf, unsigned len, uint16_
 
 }
 
+void IOUring::prepareSendZc(int client_fd, const void* buf, unsigned len) {
+#ifdef IORING_CQE_F_NOTIF
+    io_uring_sqe* sqe = getSQE();
+    io_uring_prep_send_zc(sqe, client_fd, buf, len, MSG_NOSIGNAL, 0);
+    setContext(sqe, OperationType::SEND_ZC, client_fd);
+#else
+    prepareWrite(client_fd, buf, len, 0);
+#endif
+}
+
 void IOUring::prepareClose(int client_fd) {
     io_uring_sqe* sqe = getSQE();
     setContext(sqe, OperationType::CLOSE, client_fd);
     io_uring_prep_close(sqe, client_fd);
 }
 
+void IOUring::prepareAuthRead() {
+    io_uring_sqe* sqe = getSQE();
+    setContext(sqe, OperationType::AUTH);
+    io_uring_prep_read(sqe, auth_queue_.getEventFd(), &auth_event_value_, sizeof(auth_event_value_), 0);
+    auth_read_armed_ = true;
+}
+
+void IOUring::prepareTuningTimer() {
+    io_uring_sqe* sqe = getSQE();
+    setContext(sqe, OperationType::TIMER);
+    tuning_interval_.tv_sec = SocketTuner::SAMPLE_INTERVAL_MS / 1000;
+    tuning_interval_.tv_nsec = (SocketTuner::SAMPLE_INTERVAL_MS % 1000) * 1000000L;
+    io_uring_prep_timeout(sqe, &tuning_interval_, 0, 0);
+    tuning_timer_armed_ = true;
+}
+
+void IOUring::prepareControlRead() {
+    io_uring_sqe* sqe = getSQE();
+    setContext(sqe, OperationType::DRAIN, -1, DRAIN_STEP_NOTIFY);
+    io_uring_prep_read(sqe, control_fd_, &control_value_, sizeof(control_value_), 0);
+}
+
+void IOUring::prepareDrainTimer(uint16_t step, uint32_t delay_ms) {
+    io_uring_sqe* sqe = getSQE();
+    setContext(sqe, OperationType::DRAIN, -1, step);
+    drain_delay_.tv_sec = delay_ms / 1000;
+    drain_delay_.tv_nsec = (delay_ms % 1000) * 1000000L;
+    io_uring_prep_timeout(sqe, &drain_delay_, 0, 0);
+}
+
+void IOUring::notify() {
+    const uint64_t value = 1;
+    ssize_t written = write(control_fd_, &value, sizeof(value));
+    (void)written;   // 카운터가 이미 0이 아니면 깨우기는 보장됨
+}
+
+void IOUring::handleControl(io_uring_cqe* cqe) {
+    if (cqe->res < 0) {
+        LOG_ERROR("Control eventfd read failed: ", cqe->res);
+    }
+    prepareControlRead();
+    // Listener 쪽 쓰레드가 배정한 새 연결과 다른 링이 넘긴 방 프레임
+    trackAdopted();
+    deliverRemote();
+    // 방 backlog가 하한 아래로 내려가면 RoomBacklog이 깨운다
+    if (!throttled_.empty()) {
+        resumeSenders();
+    }
+}
+
+void IOUring::adoptConnection(int client_fd, uint64_t connection_id, WireFormat format, bool pending) {
+    {
+        std::lock_guard<std::mutex> lock(remote_mutex_);
+        connections_[client_fd] = AdoptedConnection{connection_id, format};
+        adopted_inbox_.push_back(AdoptedEntry{client_fd, connection_id, pending});
+        adopting_.fetch_add(1, std::memory_order_relaxed);
+    }
+    {
+        // 첫 알림(joined session)보다 먼저 송신 형식을 정한다
+        ProbedLockGuard<std::mutex> lock(outbound_mutex_, "outbound");
+        outbound_[client_fd].json = format == WireFormat::JSON;
+    }
+    // SQ와 소켓 튜너, 타이머는 워커 전용이므로 recv 걸기와 추적 시작은 제어 eventfd로 넘긴다
+    notify();
+}
+
+void IOUring::trackAdopted() {
+    std::vector<AdoptedEntry> adopted;
+    size_t received = 0;
+    {
+        std::lock_guard<std::mutex> lock(remote_mutex_);
+        if (adopted_inbox_.empty()) {
+            return;
+        }
+        adopted.swap(adopted_inbox_);
+        received = adopted.size();
+        // 넘겨받기 전에 닫혔거나 fd가 재사용된 연결은 건너뛴다 (재사용된 쪽은 자기 항목이 따로 있다)
+        adopted.erase(std::remove_if(adopted.begin(), adopted.end(),
+                                     [this](const AdoptedEntry& entry) {
+                                         auto it = connections_.find(entry.client_fd);
+                                         return it == connections_.end() || it->second.id != entry.connection_id;
+                                     }),
+                      adopted.end());
+    }
+    for (const AdoptedEntry& entry : adopted) {
+        trackSocket(entry.client_fd);
+        prepareRead(entry.client_fd);
+        if (adopt_handler_) {
+            adopt_handler_(entry.client_fd, entry.pending);
+        }
+    }
+    // 세션의 연결 목록에 들어간 뒤에 빼서 배치 쪽 집계가 잠깐 줄어들지 않게 한다
+    adopting_.fetch_sub(received, std::memory_order_relaxed);
+}
+
+WireFormat IOUring::wireFormat(int client_fd) {
+    std::lock_guard<std::mutex> lock(remote_mutex_);
+    auto it = connections_.find(client_fd);
+    return it != connections_.end() ? it->second.format : WireFormat::BINARY;
+}
+
+uint64_t IOUring::connectionId(int client_fd) {
+    std::lock_guard<std::mutex> lock(remote_mutex_);
+    auto it = connections_.find(client_fd);
+    return it != connections_.end() ? it->second.id : 0;
+}
+
+uint64_t IOUring::senderId(int client_fd) {
+    // 부하 집계 키: fd는 재사용되므로 연결 번호. 연결마다 한 번만 remote_mutex_를 잡는다
+    auto it = sender_ids_.find(client_fd);
+    if (it != sender_ids_.end()) {
+        return it->second;
+    }
+    const uint64_t id = connectionId(client_fd);
+    if (id != 0) {
+        sender_ids_.emplace(client_fd, id);
+    }
+    return id;
+}
+
+void IOUring::postRemote(RemoteDelivery delivery) {
+    bool wake;
+    {
+        std::lock_guard<std::mutex> lock(remote_mutex_);
+        wake = remote_inbox_.empty();
+        remote_inbox_.push_back(std::move(delivery));
+    }
+    // 이미 쌓인 것이 있으면 깨우기가 걸려 있다
+    if (wake) {
+        notify();
+    }
+}
+
+void IOUring::deliverRemote() {
+    std::vector<RemoteDelivery> deliveries;
+    std::vector<int32_t> live;
+    {
+        std::lock_guard<std::mutex> lock(remote_mutex_);
+        if (remote_inbox_.empty()) {
+            return;
+        }
+        deliveries.swap(remote_inbox_);
+    }
+
+    for (RemoteDelivery& delivery : deliveries) {
+        // 넘겨받는 사이 끊겼거나 fd가 다른 연결에 재사용된 대상은 건너뛴다
+        live.clear();
+        {
+            std::lock_guard<std::mutex> lock(remote_mutex_);
+            for (const RemoteTarget& target : delivery.targets) {
+                auto it = connections_.find(target.client_fd);
+                if (it != connections_.end() && it->second.id == target.connection_id) {
+                    live.push_back(target.client_fd);
+                }
+            }
+        }
+        for (int32_t client_fd : live) {
+            enqueueFrame(client_fd, delivery.frame, delivery.deadline_ns, nullptr, delivery.room);
+            total_messages_++;
+        }
+    }
+}
+
+void IOUring::prepareTcpInfoSample(int client_fd) {
+#ifdef SOCKET_URING_OP_GETSOCKOPT
+    if (sockcmd_supported_ && socket_tuner_.getTuning(client_fd)) {
+        std::unique_ptr<TcpInfoSample>& sample = tcp_samples_[client_fd];
+        if (sample) {
+            return;   // 이전 샘플이 아직 진행 중 (정리된 연결의 것이면 완료 후 다음 패스에서)
+        }
+        sample = std::make_unique<TcpInfoSample>();
+        io_uring_sqe* sqe = getSQE();
+        io_uring_prep_cmd_sock(sqe, SOCKET_URING_OP_GETSOCKOPT, client_fd, IPPROTO_TCP, TCP_INFO,
+                               &sample->info, sizeof(sample->info));
+        setContext(sqe, OperationType::SOCKOPT, client_fd);
+        return;
+    }
+#endif
+    socket_tuner_.sampleSync(client_fd);
+}
+
+void IOUring::trackSocket(int client_fd) {
+    sockaddr_storage addr{};
+    socklen_t addr_len = sizeof(addr);
+    if (getpeername(client_fd, reinterpret_cast<sockaddr*>(&addr), &addr_len) < 0 ||
+        (addr.ss_family != AF_INET && addr.ss_family != AF_INET6)) {
+        // 합성 클라이언트(socketpair)는 TCP가 아니다: TCP_INFO 샘플이 실패하면 링 전체가 동기 경로로 바뀐다
+        return;
+    }
+
+    socket_tuner_.track(client_fd);
+    if (!tuning_timer_armed_) {
+        prepareTuningTimer();
+    }
+
+    // 발신 IP별 부하 집계용 (IPv4만)
+    if (addr.ss_family == AF_INET) {
+        peer_ips_[client_fd] = ntohl(reinterpret_cast<const sockaddr_in&>(addr).sin_addr.s_addr);
+    }
+}
+
+void IOUring::untrackSocket(int client_fd) {
+    socket_tuner_.untrack(client_fd);
+    auto sample = tcp_samples_.find(client_fd);
+    if (sample != tcp_samples_.end()) {
+        sample->second->stale = true;
+    }
+    peer_ips_.erase(client_fd);
+}
+
+void IOUring::handleTuningTimer(io_uring_cqe* /* cqe */) {
+    tuning_timer_armed_ = false;
+    socket_tuner_.forEach([this](int client_fd, ConnTuning&) {
+        prepareTcpInfoSample(client_fd);
+    });
+    LOG_DEBUG("Socket tuning pass complete, total adjustments: ", socket_tuner_.getAdjustments());
+    prepareTuningTimer();
+}
+
+void IOUring::handleTcpInfo(io_uring_cqe* cqe, int client_fd) {
+    auto it = tcp_samples_.find(client_fd);
+    if (it == tcp_samples_.end()) {
+        return;
+    }
+    const std::unique_ptr<TcpInfoSample> sample = std::move(it->second);
+    tcp_samples_.erase(it);
+
+    if (cqe->res < 0) {
+        // 커널이 getsockopt 소켓 명령을 지원하지 않으면 동기 경로로 전환
+        if (cqe->res == -EOPNOTSUPP || cqe->res == -EINVAL) {
+            LOG_INFO("io_uring getsockopt unsupported, falling back to getsockopt(2)");
+            sockcmd_supported_ = false;
+            if (!sample->stale) {
+                socket_tuner_.sampleSync(client_fd);
+            }
+        }
+        return;
+    }
+    ConnTuning* tuning = sample->stale ? nullptr : socket_tuner_.getTuning(client_fd);
+    if (tuning) {
+        tuning->info = sample->info;
+        socket_tuner_.onSample(client_fd);
+    }
+}
+
 void IOUring::handleAccept(io_uring_cqe* cqe) {
     const int client_fd = cqe->res;
     if (client_fd >= 0) {
@@ -124,11 +452,8 @@ void IOUring::handleRead(io_uring_cqe* cqe, int client_fd) {
             SessionManager::getInstance().removeSession(client_fd);
         }
         
-        uint16_t buffer_idx = buffer_manager_->findClientBuffer(client_fd);
-        if (buffer_idx != UINT16_MAX) {
-            releaseBuffer(buffer_idx);
-        }
-        
+        assemblers_.erase(client_fd);
+        json_assemblers_.erase(client_fd);
         prepareClose(client_fd);
         closed = true;
         return;
@@ -142,45 +467,102 @@ void IOUring::handleRead(io_uring_cqe* cqe, int client_fd) {
         const uint16_t bid = cqe->flags >> 16;
         buffer_manager_->markBufferInUse(bid, client_fd);
         
-        uint8_t* buf = buffer_manager_->getBufferAddr(bid, buffer_manager_->getBaseAddr());
-        auto* message = reinterpret_cast<ChatMessage*>(buf);
-        
-        // 메시지 검증
-        uint8_t msg_type = static_cast<uint8_t>(message->type);
-        if (msg_type < 0x10 || msg_type > 0x14) {
-            std::cerr << "[ERROR] Invalid message type from client " << client_fd 
-                      << ": 0x" << std::hex << static_cast<int>(msg_type) << std::dec << std::endl;
-            releaseBuffer(bid);
-        } else if (message->length > sizeof(message->data)) {
-            std::cerr << "[ERROR] Message too long from client " << client_fd 
-                      << ": " << message->length << " bytes" << std::endl;
-            releaseBuffer(bid);
-        } else if (message->length == 0) {
-            std::cerr << "[ERROR] Empty message from client " << client_fd << std::endl;
-            releaseBuffer(bid);
+        // recv 하나에 프레임이 여러 개이거나 경계에 걸칠 수 있으므로 연결별로 재조립.
+        // 처리기는 프레임 내용을 복사해 가므로 버퍼는 전부 처리한 뒤 한 번만 반환
+        const uint8_t* buf = buffer_manager_->getBufferAddr(bid, buffer_manager_->getBaseAddr());
+        auto on_frame = [this, client_fd](const ChatMessage& message) {
+            return dispatchFrame(client_fd, message);
+        };
+
+        // 연결의 첫 수신에서 형식을 확인해 해당 재조립기를 만든다 (이후로는 잠금 없이 찾음)
+        auto json = json_assemblers_.find(client_fd);
+        if (json == json_assemblers_.end() && assemblers_.find(client_fd) == assemblers_.end() &&
+            wireFormat(client_fd) == WireFormat::JSON) {
+            json = json_assemblers_.emplace(client_fd, JsonLineAssembler()).first;
+        }
+        bool valid;
+        if (json != json_assemblers_.end()) {
+            // 해석할 수 없는 줄은 알리고 넘어간다 (줄 경계는 남아 있음)
+            valid = json->second.feed(buf, static_cast<size_t>(result), on_frame,
+                [this, client_fd](const std::string& error) {
+                    std::string error_message = "json: " + error;
+                    error_message.resize(std::min(error_message.size(), sizeof(ChatMessage::data)));
+                    sendMessage(client_fd, MessageType::SERVER_ERROR, error_message.c_str(), error_message.length(),
+                                UringBuffer::NO_BUFFER);
+                });
         } else {
-            processMessage(client_fd, message, bid);
+            valid = assemblers_[client_fd].feed(buf, static_cast<size_t>(result), on_frame);
+        }
+        releaseBuffer(bid);
+
+        if (!valid) {
+            // 프레임 경계를 잃었으므로 연결을 끊는다 (EOF 완료에서 정상 종료 경로로 정리)
+            assemblers_.erase(client_fd);
+            json_assemblers_.erase(client_fd);
+            shutdown(client_fd, SHUT_RDWR);
         }
     }
 
+    // 첨부 업로드로 수신을 멈춘 연결은 업로드가 끝날 때, 조절 중인 발신자는 방 backlog가 줄면 다시 건다
     if (!closed && !(cqe->flags & IORING_CQE_F_MORE)) {
-        prepareRead(client_fd);
+        if (isReceivePaused(client_fd)) {
+            onReceiveStopped(client_fd);
+        } else {
+            prepareRead(client_fd);
+        }
+    }
+}
+
+bool IOUring::dispatchFrame(int client_fd, const ChatMessage& message) {
+    RingStats::bump(stats_.frames_received);
+
+    // 메시지 검증
+    uint8_t msg_type = static_cast<uint8_t>(message.type);
+    if (msg_type < 0x10 || msg_type > 0x18) {
+        std::cerr << "[ERROR] Invalid message type from client " << client_fd 
+                  << ": 0x" << std::hex << static_cast<int>(msg_type) << std::dec << std::endl;
+        return false;
+    }
+    if (message.length > sizeof(message.data)) {
+        std::cerr << "[ERROR] Message too long from client " << client_fd 
+                  << ": " << message.length << " bytes" << std::endl;
+        return false;
+    }
+
+    // 프레임 하나의 처리 실패가 recv 완료 → 워커 루프까지 올라가 프로세스를 끝내지 않도록 여기서 막는다
+    try {
+        if (frame_handler_) {
+            frame_handler_(client_fd, message);
+        } else {
+            processMessage(client_fd, &message, UringBuffer::NO_BUFFER);
+        }
     }
+    catch (const std::exception& e) {
+        LOG_ERROR("Frame handling failed (client=", client_fd, ", type=", static_cast<int>(msg_type), "): ", e.what());
+    }
+    return true;
 }
 
-void IOUring::handleWrite(io_uring_cqe* cqe, int client_fd, uint16_t buffer_idx) {
+void IOUring::handleWrite(io_uring_cqe* cqe, int client_fd, uint16_t /* buffer_idx */) {
     const int bytes_written = cqe->res;
     
     if (bytes_written <= 0) {
         std::cerr << "Write error on fd " << client_fd << ": " << bytes_written << std::endl;
     }
     
-    handleWriteComplete(client_fd, buffer_idx, bytes_written);
+    handleWriteComplete(client_fd, bytes_written);
 }
 
 void IOUring::processMessage(int client_fd, const ChatMessage* message, uint16_t buffer_idx) {
     LOG_DEBUG("Processing message type ", static_cast<int>(message->type), 
               " from client ", client_fd);
+
+    // 토큰 검증을 기다리는 연결은 JOIN만 보낼 수 있다
+    if (message->type != MessageType::CLIENT_JOIN && SessionManager::getInstance().isPending(client_fd)) {
+        LOG_WARN("Client ", client_fd, " sent a frame before joining");
+        releaseBufferRef(buffer_idx);
+        return;
+    }
               
     switch (message->type) {
         case MessageType::CLIENT_JOIN:
@@ -190,11 +572,24 @@ void IOUring::processMessage(int client_fd, const ChatMessage* message, uint16_t
             handleLeaveSession(client_fd, message, buffer_idx);
             break;
         case MessageType::CLIENT_CHAT:
+        case MessageType::CLIENT_ROOM_CHAT:
             handleChatMessage(client_fd, message, buffer_idx);
             break;
+        case MessageType::CLIENT_MULTICAST:
+            handleMulticast(client_fd, message, buffer_idx);
+            break;
+        case MessageType::CLIENT_COMMAND:
+            handleCommand(client_fd, message, buffer_idx);
+            break;
+        case MessageType::CLIENT_ATTACH_PUT:
+            handleAttachPut(client_fd, message, buffer_idx);
+            break;
+        case MessageType::CLIENT_ATTACH_GET:
+            handleAttachGet(client_fd, message, buffer_idx);
+            break;
         default:
             LOG_ERROR("Unknown message type: ", static_cast<int>(message->type));
-            releaseBuffer(buffer_idx);
+            releaseBufferRef(buffer_idx);
             break;
     }
 }
@@ -202,19 +597,136 @@ void IOUring::processMessage(int client_fd, const ChatMessage* message, uint16_t
 void IOUring::handleJoinSession(int client_fd, const ChatMessage* message, uint16_t buffer_idx) {
     LOG_DEBUG("Processing JOIN request from client ", client_fd);
     
-    if (!message || message->length < sizeof(int32_t)) {
+    command::JoinRequest join;
+    if (!message || !join.parse(message->data, std::min<size_t>(message->length, sizeof(message->data)))) {
         LOG_ERROR("Invalid JOIN message format");
-        releaseBuffer(buffer_idx);
+        releaseBufferRef(buffer_idx);
         return;
     }
-
-    const int32_t* session_id_ptr = reinterpret_cast<const int32_t*>(message->data);
-    int32_t session_id = *session_id_ptr;
+    const int32_t session_id = join.session_id();
     
     LOG_DEBUG("Client ", client_fd, " requesting to join session ", session_id);
-    
+
+    auto& auth = TokenAuth::getInstance();
+    if (!auth.isEnabled()) {
+        completeJoin(client_fd, session_id, buffer_idx);
+        return;
+    }
+
+    // 세션 ID 뒤에 토큰이 붙어 온다
+    ParsedToken token;
+    if (!TokenAuth::parse(join.token().data(), join.token().size(), token)) {
+        LOG_WARN("Client ", client_fd, " sent JOIN without a valid token");
+        rejectJoin(client_fd, "missing or malformed token", buffer_idx);
+        return;
+    }
+
+    if (token_cache_.lookup(token, TokenAuth::nowSeconds())) {
+        LOG_TRACE("Token cache hit for client ", client_fd);
+        completeJoin(client_fd, session_id, buffer_idx, token.user);
+        return;
+    }
+
+    // 캐시 미스: 서명 검증은 헬퍼 풀에서 수행하고 결과는 eventfd로 돌아온다.
+    // JOIN을 쏟아내 헬퍼 큐를 채우지 못하도록 연결마다 검증은 하나만 진행한다
+    const uint64_t connection_id = connectionId(client_fd);
+    auto inflight = auth_inflight_.find(client_fd);
+    if (inflight != auth_inflight_.end() && inflight->second == connection_id) {
+        LOG_WARN("Client ", client_fd, " sent JOIN while another token is being verified");
+        rejectJoin(client_fd, "verification already in progress", buffer_idx);
+        return;
+    }
+    // 토큰 필드는 이미 복사했으므로 수신 버퍼는 헬퍼로 넘기기 전에 돌려준다
+    releaseBufferRef(buffer_idx);
+    if (!auth.submit(AuthResult{client_fd, connection_id, session_id, false, std::move(token)}, &auth_queue_)) {
+        LOG_WARN("Token verification queue full, rejecting client ", client_fd);
+        rejectJoin(client_fd, "server busy", UringBuffer::NO_BUFFER);
+        return;
+    }
+    auth_inflight_[client_fd] = connection_id;
+    if (!auth_read_armed_) {
+        prepareAuthRead();
+    }
+}
+
+void IOUring::handleAuthComplete(io_uring_cqe* cqe) {
+    auth_read_armed_ = false;
+    if (cqe->res < 0) {
+        LOG_ERROR("Auth eventfd read failed: ", cqe->res);
+    }
+
+    int64_t now = TokenAuth::nowSeconds();
+    for (auto& result : auth_queue_.drain()) {
+        if (result.verified) {
+            token_cache_.insert(result.token, now);
+        }
+        auto inflight = auth_inflight_.find(result.client_fd);
+        if (inflight != auth_inflight_.end() && inflight->second == result.connection_id) {
+            auth_inflight_.erase(inflight);
+        }
+        if (connectionId(result.client_fd) != result.connection_id) {
+            // 검증하는 동안 연결이 닫혔고 fd가 다른 연결에 재사용되었을 수 있다
+            LOG_DEBUG("Dropping auth result for closed connection (client=", result.client_fd, ")");
+            continue;
+        }
+        if (result.verified) {
+            completeJoin(result.client_fd, result.session_id, UringBuffer::NO_BUFFER, result.token.user);
+        } else {
+            LOG_WARN("Client ", result.client_fd, " failed token verification");
+            rejectJoin(result.client_fd, "invalid token", UringBuffer::NO_BUFFER);
+        }
+    }
+
+    LOG_DEBUG("Token cache stats - hits: ", token_cache_.getHits(), ", misses: ", token_cache_.getMisses());
+    prepareAuthRead();
+}
+
+void IOUring::rejectJoin(int client_fd, const std::string& reason, uint16_t buffer_idx) {
+    std::string error_message = "Failed to join session: " + reason;
+    sendMessage(client_fd, MessageType::SERVER_ERROR, error_message.c_str(), error_message.length(), buffer_idx);
+    // 이미 인증되어 방에 있는 연결이 방을 하나 더 추가하다 실패한 경우는 연결을 유지
+    if (SessionManager::getInstance().isPending(client_fd)) {
+        closeAfterFlush(client_fd);
+    }
+}
+
+void IOUring::completeJoin(int client_fd, int32_t session_id, uint16_t buffer_idx, const std::string& user) {
+    // 클러스터 모드: 디렉터리상 다른 노드가 소유한 방이면 그 노드로 안내하고 연결을 닫는다
+    const uint32_t local_node = RoomDirectory::getInstance().getLocalNode();
+    if (local_node != 0) {
+        const DirectorySnapshot& directory = RoomDirectory::getInstance().current();
+        const RoomRecord* room = directory.findRoom(session_id);
+        if (room && room->owner_node != local_node) {
+            const std::string address = directory.nodeAddress(room->owner_node);
+            if (address.empty()) {
+                std::string error_message = "Failed to join session: room " + std::to_string(session_id) +
+                                            " is owned by node " + std::to_string(room->owner_node);
+                sendMessage(client_fd, MessageType::SERVER_ERROR, error_message.c_str(), error_message.length(), buffer_idx);
+                return;
+            }
+            // 이미 이 노드의 다른 방에 있는 연결은 옮길 수 없다 (여러 방 참가는 같은 노드 안에서만).
+            // accept 시 I/O만 배정된 연결은 아직 어느 방에도 없으므로 안내한다
+            if (!SessionManager::getInstance().getClientRooms(client_fd).empty()) {
+                std::string error_message = "Failed to join session: room " + std::to_string(session_id) +
+                                            " is served by another node (" + address + ")";
+                sendMessage(client_fd, MessageType::SERVER_ERROR, error_message.c_str(), error_message.length(), buffer_idx);
+                return;
+            }
+            ReconnectHint hint{};
+            strncpy(hint.address, address.c_str(), sizeof(hint.address) - 1);
+            LOG_DEBUG("Redirecting client ", client_fd, " to node ", room->owner_node, " (", address, ")");
+            sendMessage(client_fd, MessageType::SERVER_RECONNECT, &hint, sizeof(hint), buffer_idx);
+            closeAfterFlush(client_fd);
+            return;
+        }
+    }
+
     try {
-        SessionManager::getInstance().joinSession(client_fd, session_id);
+        // accept 시점에 JOIN 프레임으로 이미 배정된 경우 ACK만 보낸다. 그 밖의 JOIN은 방을 하나 더 추가
+        if (!SessionManager::getInstance().isMember(client_fd, session_id)) {
+            SessionManager::getInstance().joinSession(client_fd, session_id);
+        }
+        SessionManager::getInstance().setClientUser(client_fd, user);
         
         std::string join_message = "Successfully joined session " + std::to_string(session_id);
         sendMessage(client_fd, MessageType::SERVER_ACK, join_message.c_str(), join_message.length(), buffer_idx);
@@ -229,146 +741,1343 @@ void IOUring::handleJoinSession(int client_fd, const ChatMessage* message, uint1
     }
 }
 
-void IOUring::handleLeaveSession(int client_fd, const ChatMessage* /* message */, uint16_t /* buffer_idx */) {
+void IOUring::handleLeaveSession(int client_fd, const ChatMessage* message, uint16_t buffer_idx) {
+    // 방 ID가 있으면 그 방만 떠나고 연결과 다른 방 참가는 유지
+    command::LeaveRequest leave;
+    if (message->length > 0 && leave.parse(message->data, std::min<size_t>(message->length, sizeof(message->data)))) {
+        if (!SessionManager::getInstance().leaveRoom(client_fd, leave.room_id())) {
+            std::string error_message = "Not in room " + std::to_string(leave.room_id());
+            sendMessage(client_fd, MessageType::SERVER_ERROR, error_message.c_str(), error_message.length(), buffer_idx);
+            return;
+        }
+        std::string reply = "Left room " + std::to_string(leave.room_id());
+        sendMessage(client_fd, MessageType::SERVER_ACK, reply.c_str(), reply.length(), buffer_idx);
+        return;
+    }
+
     auto session = SessionManager::getInstance().getSession(client_fd);
     if (session) {
         SessionManager::getInstance().removeSession(client_fd);
         LOG_INFO("Client ", client_fd, " left session ", session->getSessionId());
     }
+    releaseBufferRef(buffer_idx);
 }
 
 void IOUring::handleChatMessage(int client_fd, const ChatMessage* message, uint16_t buffer_idx) {
-    auto session = SessionManager::getInstance().getSession(client_fd);
-    if (!session || session->getSessionId() < 0) {
-        LOG_WARN("Client ", client_fd, " not in any session");
-        decrementBufferRefCount(buffer_idx);
-        return;
-    }
-    
     if (!message || message->length == 0 || message->length > MAX_MESSAGE_SIZE) {
         LOG_WARN("Invalid message length from client ", client_fd);
         decrementBufferRefCount(buffer_idx);
         return;
     }
 
-    std::string filtered_data;
-    filtered_data.reserve(message->length);
-
-    for (size_t i = 0; i < message->length; ++i) {
-        char c = message->data[i];
-        if ((c >= 32 && c <= 126) || c == '\n' || c == '\r' || c == '\t' || 
-            static_cast<unsigned char>(c) >= 128) {
-            filtered_data += c;
+    // 방 지정 채팅은 본문 앞의 방 ID로, 일반 채팅은 연결의 기본 방으로 보낸다
+    int32_t room_id = -1;
+    const char* text = message->data;
+    size_t text_length = message->length;
+    if (message->type == MessageType::CLIENT_ROOM_CHAT) {
+        command::RoomChat chat;
+        if (!chat.parse(message->data, std::min<size_t>(message->length, sizeof(message->data)))) {
+            LOG_WARN("Malformed room chat from client ", client_fd);
+            decrementBufferRefCount(buffer_idx);
+            return;
         }
+        room_id = chat.room_id();
+        text = chat.text().data();
+        text_length = chat.text().size();
+    }
+
+    auto session = SessionManager::getInstance().getRoomForClient(client_fd, room_id);
+    if (!session || session->getSessionId() < 0) {
+        LOG_WARN("Client ", client_fd, " not in ", room_id < 0 ? "any session" : "room " + std::to_string(room_id));
+        decrementBufferRefCount(buffer_idx);
+        return;
     }
 
+    std::string filtered_data = filterChatText(text, text_length);
     if (filtered_data.empty()) {
         LOG_ERROR("Invalid message content from client ", client_fd);
         decrementBufferRefCount(buffer_idx);
         return;
     }
     
-    auto clients = SessionManager::getInstance().getSessionClients(session->getSessionId());
-    if (clients.empty()) {
+    const size_t clients = SessionManager::getInstance().getRoomMembers(session->getSessionId()).size();
+    if (clients == 0) {
         LOG_DEBUG("No clients in session ", session->getSessionId());
         decrementBufferRefCount(buffer_idx);
         return;
     }
 
-    LOG_TRACE("Broadcasting to ", clients.size(), " clients in session ", session->getSessionId());
+    // 발신 IP의 최근 메시지 수가 상한을 넘으면 버린다. 감쇠 직전 값은 초당 수의 최대 2배까지 오른다
+    auto peer = peer_ips_.find(client_fd);
+    const uint32_t source_ip = peer != peer_ips_.end() ? peer->second : 0;
+    if (ip_message_rate_ > 0 && source_ip != 0 &&
+        load_sketch_.estimate(LoadKey::SOURCE_IP, LoadMetric::MESSAGES, source_ip, LoopClock::now()) >=
+            2 * ip_message_rate_) {
+        RingStats::bump(stats_.frames_rate_limited);
+        LOG_DEBUG("Rate limited message from client ", client_fd);
+        decrementBufferRefCount(buffer_idx);
+        return;
+    }
+    // 여러 방/연결에 같은 문구를 조금씩 바꿔 뿌리는 스팸 웨이브는 팬아웃 전에 버린다
+    if (SpamFilter::getInstance().isSpam(filtered_data.data(), filtered_data.length(), LoopClock::now())) {
+        RingStats::bump(stats_.frames_spam_dropped);
+        LOG_DEBUG("Dropped near-duplicate message from client ", client_fd);
+        decrementBufferRefCount(buffer_idx);
+        return;
+    }
+    load_sketch_.record(LoadSketch::Sample{senderId(client_fd),
+                                           static_cast<uint64_t>(session->getSessionId()),
+                                           source_ip, filtered_data.length(), clients},
+                        LoopClock::now());
+
+    // 방 순번을 매겨 기록하고, 프라이머리면 복제 큐에 싣는다 (묶기/전송은 복제 쓰레드)
+    session->getJournal()->append(filtered_data.data(), filtered_data.length(), LoopClock::wallMillis(),
+                                  Replication::getInstance().isPrimary());
+
+    LOG_TRACE("Broadcasting to ", clients, " clients in session ", session->getSessionId());
     broadcastToSession(session->getSessionId(), MessageType::SERVER_CHAT, 
-                      filtered_data.c_str(), filtered_data.length(), buffer_idx, client_fd);
+                      filtered_data.c_str(), filtered_data.length(), buffer_idx, client_fd,
+                      session->getDeliveryDeadline());
+
+    // 방 수신자들이 밀려 있으면 발신자의 수신을 멈춘다 (이미 받은 프레임은 그대로 전달)
+    RoomBacklog* room = RoomFlowControl::getInstance().getRoom(session->getSessionId());
+    if (room && room->isThrottled()) {
+        throttleSender(client_fd, room);
+    }
 }
 
-void IOUring::sendMessage(int client_fd, MessageType msg_type, const void* data, size_t length, uint16_t buffer_idx) {
-    try {
-        ChatMessage message{};
-        message.type = msg_type;
-        message.length = static_cast<uint16_t>(length);
-        
-        if (data && length > 0) {
-            if (length > sizeof(message.data)) {
-                decrementBufferRefCount(buffer_idx);
-                throw std::runtime_error("메시지 크기 초과");
-            }
-            memcpy(message.data, data, std::min(length, sizeof(message.data)));
+std::string IOUring::filterChatText(const char* text, size_t length) {
+    std::string filtered;
+    filtered.reserve(length);
+
+    for (size_t i = 0; i < length; ++i) {
+        char c = text[i];
+        if ((c >= 32 && c <= 126) || c == '\n' || c == '\r' || c == '\t' || 
+            static_cast<unsigned char>(c) >= 128) {
+            filtered += c;
         }
-        
-        prepareWrite(client_fd, &message, sizeof(ChatMessage), buffer_idx);
-        total_messages_++;
     }
-    catch (const std::exception& e) {
-        std::cerr << "[ERROR] Send failed: " << e.what() << std::endl;
+    return filtered;
+}
+
+void IOUring::handleMulticast(int client_fd, const ChatMessage* message, uint16_t buffer_idx) {
+    // 주소 지정 권한은 일반 채팅과 같이 참가한 연결에만 (방 구성원일 필요는 없다: 공지/봇)
+    auto session = SessionManager::getInstance().getSession(client_fd);
+    if (!session || SessionManager::getInstance().isPending(client_fd)) {
+        LOG_WARN("Client ", client_fd, " not in any session");
         decrementBufferRefCount(buffer_idx);
-        throw;
+        return;
     }
-}
 
-void IOUring::broadcastToSession(int32_t session_id, MessageType msg_type, const void* data, size_t length, uint16_t buffer_idx, int32_t /* exclude_fd */) {
-    try {
-        auto clients = SessionManager::getInstance().getSessionClients(session_id);
-        
-        if (clients.empty()) {
-            decrementBufferRefCount(buffer_idx);
-            return;
-        }
-        
-        size_t broadcast_count = clients.size();
-        for (size_t i = 0; i < broadcast_count; i++) {
-            buffer_manager_->incrementRefCount(buffer_idx);
+    command::Multicast multicast;
+    if (!message || !multicast.parse(message->data, std::min<size_t>(message->length, sizeof(message->data)))) {
+        LOG_WARN("Malformed multicast from client ", client_fd);
+        std::string error_message = "multicast: malformed frame";
+        sendMessage(client_fd, MessageType::SERVER_ERROR, error_message.c_str(), error_message.length(), buffer_idx);
+        return;
+    }
+
+    std::vector<int32_t> rooms;
+    rooms.reserve(multicast.rooms().size());
+    for (const auto target : multicast.rooms()) {
+        rooms.push_back(target.room_id());
+    }
+    std::sort(rooms.begin(), rooms.end());
+    rooms.erase(std::unique(rooms.begin(), rooms.end()), rooms.end());
+
+    std::vector<std::string> users;
+    const std::string_view user_list = multicast.users();
+    for (size_t begin = 0; begin < user_list.size();) {
+        size_t end = user_list.find(',', begin);
+        if (end == std::string_view::npos) {
+            end = user_list.size();
         }
-        
-        for (int32_t target_fd : clients) {
-            try {
-                sendMessage(target_fd, msg_type, data, length, buffer_idx);
-            } catch (const std::exception& e) {
-                decrementBufferRefCount(buffer_idx);
-                broadcast_count--;
-            }
+        if (end > begin) {
+            users.emplace_back(user_list.substr(begin, end - begin));
         }
-        
-        total_broadcasts_++;
+        begin = end + 1;
     }
-    catch (const std::exception& e) {
-        LOG_ERROR("Broadcast failed: ", e.what());
+
+    std::string filtered_data = filterChatText(multicast.text().data(), multicast.text().size());
+    if (filtered_data.empty() || (rooms.empty() && users.empty())) {
+        std::string error_message = "multicast: needs text and at least one room or user";
+        sendMessage(client_fd, MessageType::SERVER_ERROR, error_message.c_str(), error_message.length(), buffer_idx);
+        return;
+    }
+
+    // 속도 상한과 스팸 검사는 일반 채팅과 같이 한 번 (대상 수와 무관)
+    auto peer = peer_ips_.find(client_fd);
+    const uint32_t source_ip = peer != peer_ips_.end() ? peer->second : 0;
+    if (ip_message_rate_ > 0 && source_ip != 0 &&
+        load_sketch_.estimate(LoadKey::SOURCE_IP, LoadMetric::MESSAGES, source_ip, LoopClock::now()) >=
+            2 * ip_message_rate_) {
+        RingStats::bump(stats_.frames_rate_limited);
+        LOG_DEBUG("Rate limited multicast from client ", client_fd);
         decrementBufferRefCount(buffer_idx);
+        return;
+    }
+    if (SpamFilter::getInstance().isSpam(filtered_data.data(), filtered_data.length(), LoopClock::now())) {
+        RingStats::bump(stats_.frames_spam_dropped);
+        LOG_DEBUG("Dropped near-duplicate multicast from client ", client_fd);
+        decrementBufferRefCount(buffer_idx);
+        return;
     }
-}
 
-void IOUring::decrementBufferRefCount(uint16_t buffer_idx) {
-    buffer_manager_->decrementRefCount(buffer_idx);
-}
+    size_t duplicates = 0;
+    auto recipients = SessionManager::getInstance().collectRecipients(rooms, users, duplicates);
+    RingStats::bump(stats_.multicast_deduped, duplicates);
+    load_sketch_.record(LoadSketch::Sample{senderId(client_fd),
+                                           static_cast<uint64_t>(session->getSessionId()),
+                                           source_ip, filtered_data.length(), recipients.size()},
+                        LoopClock::now());
 
-void IOUring::handleWriteComplete(int32_t client_fd, uint16_t buffer_idx, int32_t bytes_written) {
-    if (bytes_written < 0) {
-        std::cerr << "[ERROR] Write failed for client " << client_fd << ": " << bytes_written << std::endl;
+    // 대상 방마다 기록은 남긴다 (history/복제는 방 단위). 대상 방의 워커도 같은 방에 기록하므로
+    // 순번 매기기와 복제 큐 싣기는 방 잠금 하나 아래에서 한다
+    const int64_t sent_at_ms = LoopClock::wallMillis();
+    const bool replicate = Replication::getInstance().isPrimary();
+    for (int32_t room_id : rooms) {
+        auto room = SessionManager::getInstance().getSessionById(room_id);
+        if (!room) {
+            continue;
+        }
+        room->getJournal()->append(filtered_data.data(), filtered_data.length(), sent_at_ms, replicate);
     }
 
-    decrementBufferRefCount(buffer_idx);
-    
-    if (buffer_manager_->getRefCount(buffer_idx) == 0) {
-        releaseBuffer(buffer_idx);
+    if (!recipients.empty()) {
+        // 수신자가 여러 방에 걸쳐 있으므로 방 태그 없이 한 프레임, 기한은 발신자 방 기준
+        auto frame = buildFrame(MessageType::SERVER_CHAT, filtered_data.data(), filtered_data.length());
+        const uint32_t deadline_ms = session->getDeliveryDeadline();
+        const int64_t deadline_ns = deadline_ms > 0 ? nowNanos() + static_cast<int64_t>(deadline_ms) * 1000000 : 0;
+        std::shared_ptr<const PipeFrame> pipe;
+        if (fanout_mode_ == FanoutMode::SPLICE && filtered_data.length() >= splice_min_payload_ && recipients.size() > 1) {
+            pipe = fanout_.load(frame.get(), sizeof(ChatMessage));
+        }
+        fanOut(recipients, frame, nullptr, pipe, deadline_ns, nullptr);
+        total_broadcasts_++;
+        logMessageStats();
+    }
+
+    LOG_TRACE("Multicast from client ", client_fd, " to ", recipients.size(), " recipients (",
+              rooms.size(), " rooms, ", users.size(), " users, ", duplicates, " duplicates)");
+    std::string reply = "multicast: " + std::to_string(recipients.size()) + " recipients, " +
+                        std::to_string(duplicates) + " duplicates";
+    sendMessage(client_fd, MessageType::SERVER_ACK, reply.c_str(), reply.length(), buffer_idx);
+}
+
+void IOUring::handleCommand(int client_fd, const ChatMessage* message, uint16_t buffer_idx) {
+    if (command::isBinary(message->data, message->length)) {
+        handleBinaryCommand(client_fd, message, buffer_idx);
+        return;
+    }
+
+    std::string command(message->data, message->length);
+    LOG_DEBUG("Command from client ", client_fd, ": ", command);
+
+    if (command == "stats") {
+        std::string reply = "stats: " + SessionManager::getInstance().collectStats().toString();
+        sendMessage(client_fd, MessageType::SERVER_NOTIFICATION, reply.c_str(), reply.length(), buffer_idx);
+        return;
+    }
+
+    // "top <senders|rooms|ips> [messages|bytes|fanout] [k]": 최근 부하 상위 키 (모든 워커 합산)
+    if (command == "top" || command.rfind("top ", 0) == 0) {
+        std::istringstream args(command.substr(3));
+        std::string key_name;
+        std::string metric_name = "messages";
+        size_t k = 10;
+        args >> key_name >> metric_name >> k;
+
+        LoadKey key_type;
+        LoadMetric metric;
+        if (!LoadSketch::parseKey(key_name, key_type) || !LoadSketch::parseMetric(metric_name, metric) || k == 0) {
+            std::string error_message = "usage: top <senders|rooms|ips> [messages|bytes|fanout] [k]";
+            sendMessage(client_fd, MessageType::SERVER_ERROR, error_message.c_str(), error_message.length(), buffer_idx);
+            return;
+        }
+
+        // 워커마다 후보를 CAPACITY개만 두므로 그 이상은 의미가 없다. 응답은 프레임 하나에 들어가는 만큼만
+        k = std::min(k, SpaceSaving::CAPACITY);
+        std::string text = "top " + key_name + " by " + metric_name + ":";
+        for (const HeavyHitter& entry : SessionManager::getInstance().collectTopLoad(key_type, metric, k)) {
+            std::ostringstream item;
+            item << " " << LoadSketch::formatKey(key_type, entry.key) << "=" << entry.count;
+            if (entry.error > 0) {
+                item << "(+-" << entry.error << ")";
+            }
+            if (text.size() + item.str().size() > sizeof(ChatMessage::data)) {
+                break;
+            }
+            text += item.str();
+        }
+        sendMessage(client_fd, MessageType::SERVER_NOTIFICATION, text.c_str(), text.length(), buffer_idx);
+        return;
+    }
+
+    // "blocklist [reload]": accept 차단 목록 상태 / 파일을 다시 읽어 교체 (운영자만, 읽기와 트라이 조립은 별도 쓰레드)
+    if (command == "blocklist" || command == "blocklist reload") {
+        auto& filter = AcceptFilter::getInstance();
+        if (command == "blocklist reload") {
+            if (!isAdmin(client_fd)) {
+                std::string error_message = "blocklist: admin only";
+                sendMessage(client_fd, MessageType::SERVER_ERROR, error_message.c_str(), error_message.length(), buffer_idx);
+                return;
+            }
+            if (!filter.requestReload()) {
+                std::string error_message = "blocklist: CHAT_BLOCKLIST not set";
+                sendMessage(client_fd, MessageType::SERVER_ERROR, error_message.c_str(), error_message.length(), buffer_idx);
+                return;
+            }
+        }
+        std::string reply = filter.describe();
+        sendMessage(client_fd, MessageType::SERVER_NOTIFICATION, reply.c_str(), reply.length(), buffer_idx);
+        return;
+    }
+
+    // "synthetic": 프로세스 안 합성 클라이언트 송수신 수와 왕복 지연
+    if (command == "synthetic") {
+        std::string reply = SyntheticLoad::getInstance().describe();
+        sendMessage(client_fd, MessageType::SERVER_NOTIFICATION, reply.c_str(), reply.length(), buffer_idx);
+        return;
+    }
+
+    // "rooms": 이 연결의 기본 방(I/O를 처리하는 링)과 참가 중인 방 목록
+    if (command == "rooms") {
+        auto home = SessionManager::getInstance().getSession(client_fd);
+        std::ostringstream reply;
+        reply << "rooms: home=" << (home ? home->getSessionId() : -1) << " member=";
+        const char* separator = "";
+        for (int32_t room_id : SessionManager::getInstance().getClientRooms(client_fd)) {
+            reply << separator << room_id;
+            separator = ",";
+        }
+        std::string text = reply.str();
+        sendMessage(client_fd, MessageType::SERVER_NOTIFICATION, text.c_str(), text.length(), buffer_idx);
+        return;
+    }
+
+    // "replication": 복제 역할과 배치/ACK/적용 수
+    if (command == "replication") {
+        std::string reply = Replication::getInstance().describe();
+        sendMessage(client_fd, MessageType::SERVER_NOTIFICATION, reply.c_str(), reply.length(), buffer_idx);
+        return;
+    }
+
+    // "directory", "directory set <room> <owner> [deadline_ms]", "directory remove <room>": 클러스터 방 디렉터리 (Raft).
+    // 조회는 누구나, 변경은 관리자만
+    if (command == "directory" || command.rfind("directory ", 0) == 0) {
+        std::istringstream args(command.substr(9));
+        std::string action;
+        args >> action;
+        if (!action.empty()) {
+            DirectoryCommand change{action == "set" ? DirectoryOp::SET_ROOM : DirectoryOp::REMOVE_ROOM, 0, 0, 0, 0};
+            uint32_t deadline_ms = 0;
+            bool valid = (action == "set" || action == "remove") && static_cast<bool>(args >> change.room_id);
+            if (valid && action == "set") {
+                valid = static_cast<bool>(args >> change.node_id) && change.node_id != 0;
+                if (valid && args >> deadline_ms) {
+                    change.deadline_ms = deadline_ms;
+                    change.flags = RoomRecord::HAS_DEADLINE;
+                }
+            }
+            if (!valid) {
+                std::string error_message = "usage: directory [set <room> <owner> [deadline_ms] | remove <room>]";
+                sendMessage(client_fd, MessageType::SERVER_ERROR, error_message.c_str(), error_message.length(), buffer_idx);
+                return;
+            }
+            // 방 소유를 옮기면 클러스터 전체의 라우팅이 바뀐다
+            if (!isAdmin(client_fd)) {
+                std::string error_message = "directory: admin only";
+                sendMessage(client_fd, MessageType::SERVER_ERROR, error_message.c_str(), error_message.length(), buffer_idx);
+                return;
+            }
+            if (!RaftNode::getInstance().propose(change)) {
+                std::string error_message = "directory: cluster mode disabled (CHAT_RAFT_ID)";
+                sendMessage(client_fd, MessageType::SERVER_ERROR, error_message.c_str(), error_message.length(), buffer_idx);
+                return;
+            }
+        }
+        std::string reply = RaftNode::getInstance().describe();
+        if (!action.empty()) {
+            reply = "directory: proposed " + action + ", " + reply.substr(11);
+            reply.resize(std::min(reply.size(), sizeof(ChatMessage::data)));
+        }
+        sendMessage(client_fd, MessageType::SERVER_NOTIFICATION, reply.c_str(), reply.length(), buffer_idx);
+        return;
+    }
+
+    // "history [n]": 현재 방의 최근 기록 n건 (기본 20). 요약 한 줄 뒤에 기록마다 "#순번 본문"
+    // 방 명령은 기본 방의 구성원에게만 (기본 방을 떠났으면 거절)
+    if (command == "history" || command.rfind("history ", 0) == 0) {
+        auto session = SessionManager::getInstance().getRoomForClient(client_fd, -1);
+        size_t count = DEFAULT_HISTORY_COUNT;
+        if (command.size() > 8) {
+            try {
+                count = std::stoul(command.substr(8));
+            } catch (const std::exception&) {
+                count = 0;
+            }
+        }
+        if (!session || count == 0) {
+            std::string error_message = session ? "usage: history [n]" : "history: not a member";
+            sendMessage(client_fd, MessageType::SERVER_ERROR, error_message.c_str(), error_message.length(), buffer_idx);
+            return;
+        }
+
+        RoomJournal* journal = session->getJournal();
+        auto records = journal->recent(count);
+        std::string reply = "history: room " + std::to_string(session->getSessionId()) +
+                            " next_seq=" + std::to_string(journal->nextSeq()) +
+                            " count=" + std::to_string(records.size());
+        sendMessage(client_fd, MessageType::SERVER_NOTIFICATION, reply.c_str(), reply.length(), buffer_idx);
+        for (const auto& record : records) {
+            std::string line = "#" + std::to_string(record->seq) + " " + record->text;
+            line.resize(std::min(line.size(), sizeof(ChatMessage::data)));
+            sendMessage(client_fd, MessageType::SERVER_NOTIFICATION, line.c_str(), line.length(), UringBuffer::NO_BUFFER);
+        }
+        return;
+    }
+
+    // "deadline [ms]": 현재 방의 전달 기한 조회/변경 (0이면 비활성)
+    if (command == "deadline" || command.rfind("deadline ", 0) == 0) {
+        auto session = SessionManager::getInstance().getRoomForClient(client_fd, -1);
+        if (!session) {
+            std::string error_message = "deadline: not a member";
+            sendMessage(client_fd, MessageType::SERVER_ERROR, error_message.c_str(), error_message.length(), buffer_idx);
+            return;
+        }
+        std::string reply;
+        if (command.size() > 9) {
+            uint32_t deadline_ms = 0;
+            try {
+                unsigned long value = std::stoul(command.substr(9));
+                deadline_ms = static_cast<uint32_t>(std::min<unsigned long>(value, UINT32_MAX));
+            } catch (const std::exception&) {
+                std::string error_message = "deadline: invalid value";
+                sendMessage(client_fd, MessageType::SERVER_ERROR, error_message.c_str(), error_message.length(), buffer_idx);
+                return;
+            }
+            if (!isAdmin(client_fd)) {
+                std::string error_message = "deadline: admin only";
+                sendMessage(client_fd, MessageType::SERVER_ERROR, error_message.c_str(), error_message.length(), buffer_idx);
+                return;
+            }
+            if (!changeDeadline(*session, deadline_ms)) {
+                reply = "deadline: proposed " + std::to_string(deadline_ms) + "ms, current ";
+            }
+        }
+        if (reply.empty()) {
+            reply = "deadline: ";
+        }
+        reply += std::to_string(session->getDeliveryDeadline()) + "ms";
+        sendMessage(client_fd, MessageType::SERVER_NOTIFICATION, reply.c_str(), reply.length(), buffer_idx);
+        return;
+    }
+
+    // 명령 자체가 본문 크기까지 올 수 있으므로 되돌려 보내는 부분은 프레임에 맞게 자른다
+    std::string error_message = "Unknown command: " + command;
+    error_message.resize(std::min(error_message.size(), sizeof(ChatMessage::data)));
+    sendMessage(client_fd, MessageType::SERVER_ERROR, error_message.c_str(), error_message.length(), buffer_idx);
+}
+
+bool IOUring::isAdmin(int client_fd) {
+    auto& auth = TokenAuth::getInstance();
+    if (auth.isEnabled()) {
+        return auth.isAdmin(SessionManager::getInstance().getClientUser(client_fd));
+    }
+    // 인증이 꺼져 있으면 사용자를 알 수 없으므로 같은 호스트(루프백)에서 온 연결만
+    sockaddr_storage addr{};
+    socklen_t addr_len = sizeof(addr);
+    if (getpeername(client_fd, reinterpret_cast<sockaddr*>(&addr), &addr_len) < 0) {
+        return false;
+    }
+    if (addr.ss_family == AF_INET) {
+        return (ntohl(reinterpret_cast<const sockaddr_in&>(addr).sin_addr.s_addr) >> 24) == 127;
+    }
+    if (addr.ss_family == AF_INET6) {
+        const in6_addr& ip = reinterpret_cast<const sockaddr_in6&>(addr).sin6_addr;
+        return IN6_IS_ADDR_LOOPBACK(&ip) || (IN6_IS_ADDR_V4MAPPED(&ip) && ip.s6_addr[12] == 127);
+    }
+    return false;
+}
+
+bool IOUring::changeDeadline(Session& session, uint32_t deadline_ms) {
+    // 클러스터 모드에서 디렉터리에 있는 방은 설정이 디렉터리에 있으므로 직접 바꾸지 않고 제안한다.
+    // 커밋되면 소유 노드가 세션에 반영한다 (디렉터리에 없는 방은 노드마다 따로 서비스하므로 로컬 설정)
+    if (RoomDirectory::getInstance().getLocalNode() != 0) {
+        const RoomRecord* room = RoomDirectory::getInstance().current().findRoom(session.getSessionId());
+        if (room) {
+            DirectoryCommand change{DirectoryOp::SET_ROOM, session.getSessionId(), room->owner_node, deadline_ms,
+                                    static_cast<uint8_t>(room->flags | RoomRecord::HAS_DEADLINE)};
+            RaftNode::getInstance().propose(change);
+            return false;
+        }
+    }
+    session.setDeliveryDeadline(deadline_ms);
+    return true;
+}
+
+void IOUring::sendCommandError(int client_fd, const std::string& text) {
+    sendMessage(client_fd, MessageType::SERVER_ERROR, text.c_str(), text.length(), UringBuffer::NO_BUFFER);
+}
+
+void IOUring::handleBinaryCommand(int client_fd, const ChatMessage* message, uint16_t buffer_idx) {
+    // 요청 보기는 수신 버퍼를 가리키므로 필드를 다 읽은 뒤에 버퍼를 돌려준다
+    const char* data = message->data;
+    const size_t length = std::min<size_t>(message->length, sizeof(message->data));
+    const int opcode = command::opcodeOf(data, length);
+    auto frame = std::make_shared<ChatMessage>();
+    bool built = false;
+
+    switch (opcode) {
+        case command::RoomInfoRequest::OPCODE: {
+            command::RoomInfoRequest request;
+            auto session = SessionManager::getInstance().getRoomForClient(client_fd, -1);
+            if (!request.parse(data, length) || !session) {
+                releaseBufferRef(buffer_idx);
+                sendCommandError(client_fd, "room: not a member");
+                return;
+            }
+            RoomBacklog* room = RoomFlowControl::getInstance().getRoom(session->getSessionId());
+            built = command::RoomInfoReplyBuilder(*frame)
+                .session_id(session->getSessionId())
+                .clients(static_cast<uint32_t>(SessionManager::getInstance().getRoomMembers(session->getSessionId()).size()))
+                .deadline_ms(session->getDeliveryDeadline())
+                .throttled(room && room->isThrottled() ? 1 : 0)
+                .finish();
+            break;
+        }
+
+        case command::DeadlineRequest::OPCODE: {
+            command::DeadlineRequest request;
+            auto session = SessionManager::getInstance().getRoomForClient(client_fd, -1);
+            if (!request.parse(data, length) || !session) {
+                releaseBufferRef(buffer_idx);
+                sendCommandError(client_fd, "deadline: not a member");
+                return;
+            }
+            if (request.set()) {
+                if (!isAdmin(client_fd)) {
+                    releaseBufferRef(buffer_idx);
+                    sendCommandError(client_fd, "deadline: admin only");
+                    return;
+                }
+                // 클러스터 모드에서 제안만 된 경우 응답은 커밋 전의 현재 값
+                changeDeadline(*session, request.deadline_ms());
+            }
+            built = command::DeadlineReplyBuilder(*frame)
+                .session_id(session->getSessionId())
+                .deadline_ms(session->getDeliveryDeadline())
+                .finish();
+            break;
+        }
+
+        case command::TopRequest::OPCODE: {
+            command::TopRequest request;
+            if (!request.parse(data, length) ||
+                request.key_type() >= static_cast<uint8_t>(LoadKey::COUNT) ||
+                request.metric() >= static_cast<uint8_t>(LoadMetric::COUNT) || request.k() == 0) {
+                releaseBufferRef(buffer_idx);
+                sendCommandError(client_fd, "top: malformed request");
+                return;
+            }
+            const auto key_type = static_cast<LoadKey>(request.key_type());
+            const auto metric = static_cast<LoadMetric>(request.metric());
+            command::TopReplyBuilder reply(*frame);
+            reply.key_type(request.key_type()).metric(request.metric());
+            for (const HeavyHitter& entry : SessionManager::getInstance().collectTopLoad(key_type, metric, request.k())) {
+                reply.add_entries(entry.key, entry.count, entry.error);
+            }
+            built = reply.finish();
+            break;
+        }
+
+        case command::StatsRequest::OPCODE: {
+            const RingStatsSnapshot stats = SessionManager::getInstance().collectStats();
+            built = command::StatsReplyBuilder(*frame)
+                .received(stats.frames_received)
+                .delivered(stats.messages_delivered)
+                .skipped(stats.frames_skipped)
+                .throttled(stats.senders_throttled)
+                .rate_limited(stats.frames_rate_limited)
+                .spam_dropped(stats.frames_spam_dropped)
+                .ring_enters(stats.ring_enters)
+                .sqes(stats.sqes_submitted)
+                .finish();
+            break;
+        }
+
+        default:
+            break;
+    }
+    releaseBufferRef(buffer_idx);
+
+    if (!built) {
+        sendCommandError(client_fd, "Unknown or malformed binary command " + std::to_string(opcode));
+        return;
+    }
+    enqueueFrame(client_fd, std::move(frame), 0);
+    total_messages_++;
+}
+
+void IOUring::sendAttachReply(int client_fd, MessageType msg_type, const std::string& text) {
+    sendMessage(client_fd, msg_type, text.c_str(), text.length(), UringBuffer::NO_BUFFER);
+}
+
+void IOUring::handleAttachPut(int client_fd, const ChatMessage* message, uint16_t buffer_idx) {
+    releaseBufferRef(buffer_idx);
+
+    if (!attachments_supported_) {
+        sendAttachReply(client_fd, MessageType::SERVER_ERROR, "attach: not supported");
+        return;
+    }
+    if (message->length != sizeof(AttachmentHeader)) {
+        sendAttachReply(client_fd, MessageType::SERVER_ERROR, "attach: malformed header");
+        return;
+    }
+    if (uploads_.count(client_fd)) {
+        sendAttachReply(client_fd, MessageType::SERVER_ERROR, "attach: upload already in progress");
+        return;
+    }
+    // 첨부는 현재 방 채팅으로 공유하므로 그 방의 구성원만 올릴 수 있다
+    if (!SessionManager::getInstance().getRoomForClient(client_fd, -1)) {
+        sendAttachReply(client_fd, MessageType::SERVER_ERROR, "attach: not a member");
+        return;
+    }
+
+    AttachmentHeader header;
+    memcpy(&header, message->data, sizeof(header));
+    auto& store = AttachmentStore::getInstance();
+    if (header.size == 0 || header.size > store.getMaxBytes()) {
+        sendAttachReply(client_fd, MessageType::SERVER_ERROR,
+                        "attach: size must be 1.." + std::to_string(store.getMaxBytes()) + " bytes");
+        return;
+    }
+
+    // 같은 내용이 이미 있으면 본문을 받지 않는다
+    if (!AttachmentStore::isZero(header.digest) && store.contains(header.digest)) {
+        sendAttachReply(client_fd, MessageType::SERVER_ACK, "attach:exists " + AttachmentStore::toHex(header.digest));
+        return;
+    }
+
+    // 주인별 한도: 인증된 사용자, 인증이 꺼져 있으면 발신 IP
+    std::string owner = SessionManager::getInstance().getClientUser(client_fd);
+    auto peer = peer_ips_.find(client_fd);
+    if (owner.empty() && peer != peer_ips_.end()) {
+        in_addr ip{htonl(peer->second)};
+        char text[INET_ADDRSTRLEN] = {};
+        inet_ntop(AF_INET, &ip, text, sizeof(text));
+        owner = std::string("ip:") + text;
+    }
+
+    bool quota_exceeded = false;
+    auto upload = store.beginUpload(header, owner, quota_exceeded);
+    if (!upload || !upload->pipe.open()) {
+        if (upload) {
+            store.discard(*upload);
+        }
+        sendAttachReply(client_fd, MessageType::SERVER_ERROR,
+                        quota_exceeded ? "attach: storage quota exceeded" : "attach: server storage unavailable");
+        return;
+    }
+
+    // 본문이 버퍼 링을 거치지 않도록 multishot recv를 먼저 멈춘다. 취소가 끝나면 "ready"를 보낸다
+    upload->in_flight = true;
+    uploads_[client_fd] = std::move(upload);
+    throttled_.erase(client_fd);   // 업로드가 recv 일시 정지를 넘겨받음
+    io_uring_sqe* sqe = getSQE();
+    io_uring_prep_cancel64(sqe, makeContext(OperationType::READ, client_fd, 0), 0);
+    setContext(sqe, OperationType::UPLOAD, client_fd, UPLOAD_STEP_CANCEL);
+}
+
+void IOUring::handleAttachGet(int client_fd, const ChatMessage* message, uint16_t buffer_idx) {
+    releaseBufferRef(buffer_idx);
+
+    if (!attachments_supported_) {
+        sendAttachReply(client_fd, MessageType::SERVER_ERROR, "attach: not supported");
+        return;
+    }
+    if (message->length != sizeof(AttachmentHeader)) {
+        sendAttachReply(client_fd, MessageType::SERVER_ERROR, "attach: malformed header");
+        return;
+    }
+
+    AttachmentHeader header;
+    memcpy(&header, message->data, sizeof(header));
+    auto file = AttachmentStore::getInstance().open(header.digest);
+    if (!file) {
+        sendAttachReply(client_fd, MessageType::SERVER_ERROR, "attach: not found " + AttachmentStore::toHex(header.digest));
+        return;
+    }
+
+    // 헤더 프레임 뒤에 본문을 파일 → 연결 파이프 → 소켓 splice로 이어 보낸다
+    header.size = file->size();
+    enqueueAttachment(client_fd, buildFrame(MessageType::SERVER_ATTACH, &header, sizeof(header)), std::move(file));
+}
+
+bool IOUring::isReceivePaused(int client_fd) const {
+    if (throttled_.count(client_fd) > 0) {
+        return true;
+    }
+    auto it = uploads_.find(client_fd);
+    return it != uploads_.end() && !it->second->abandoned;
+}
+
+void IOUring::throttleSender(int client_fd, RoomBacklog* room) {
+    if (!recv_cancel_supported_ || isReceivePaused(client_fd)) {
+        return;
+    }
+    if (!room->addWaiter(this)) {
+        return;   // 그 사이 조절이 풀림
+    }
+
+    throttled_[client_fd] = ThrottledSender{room, false};
+    RingStats::bump(stats_.senders_throttled);
+    io_uring_sqe* sqe = getSQE();
+    io_uring_prep_cancel64(sqe, makeContext(OperationType::READ, client_fd, 0), 0);
+    setContext(sqe, OperationType::THROTTLE, client_fd);
+    LOG_DEBUG("Throttling client ", client_fd, " (room ", room->getRoomId(), " backlog ",
+              room->getPendingBytes(), " bytes)");
+}
+
+void IOUring::handleThrottle(io_uring_cqe* cqe, int client_fd) {
+    // 0: 걸려 있던 recv를 취소함 (-ECANCELED 완료가 따로 옴), -ENOENT/-EALREADY: 이미 끝나는 중
+    const int result = cqe->res;
+    if (result != 0 && result != -ENOENT && result != -EALREADY) {
+        LOG_WARN("Could not pause receive for client ", client_fd, ": ", result);
+        throttled_.erase(client_fd);
+    }
+}
+
+void IOUring::onReceiveStopped(int client_fd) {
+    auto it = throttled_.find(client_fd);
+    if (it == throttled_.end()) {
+        return;
+    }
+    it->second.recv_stopped = true;
+    if (!it->second.room->isThrottled()) {
+        throttled_.erase(it);
+        prepareRead(client_fd);
+    }
+}
+
+void IOUring::resumeSenders() {
+    for (auto it = throttled_.begin(); it != throttled_.end();) {
+        ThrottledSender& sender = it->second;
+        // 다시 조절 상태가 된 방은 다음 해제 때 깨워 달라고 등록 (그 사이 풀렸으면 재개)
+        if (sender.room->isThrottled() && sender.room->addWaiter(this)) {
+            ++it;
+            continue;
+        }
+        if (!sender.recv_stopped) {
+            // 취소된 recv의 마지막 완료를 받으면 onReceiveStopped에서 다시 건다
+            ++it;
+            continue;
+        }
+        LOG_DEBUG("Resuming throttled client ", it->first);
+        prepareRead(it->first);
+        it = throttled_.erase(it);
+    }
+}
+
+void IOUring::prepareUploadWait(int client_fd) {
+    // 연결된 SQE 사이에 암묵적 제출이 끼면 링크가 끊기므로 자리를 먼저 확보
+    if (reactor_.sqReady() + 2 > NUM_SUBMISSION_QUEUE_ENTRIES) {
+        submit();
+    }
+
+    // 본문이 올 때까지 io-wq 쓰레드를 붙잡지 않고 POLLIN으로 기다린다. 유휴 시간이 지나면 -ECANCELED
+    io_uring_sqe* sqe = getSQE();
+    io_uring_prep_poll_add(sqe, client_fd, POLLIN);
+    sqe->flags |= IOSQE_IO_LINK;
+    setContext(sqe, OperationType::UPLOAD, client_fd, UPLOAD_STEP_WAIT);
+
+    sqe = getSQE();
+    io_uring_prep_link_timeout(sqe, &upload_idle_timeout_, 0);
+    setContext(sqe, OperationType::UPLOAD, client_fd, UPLOAD_STEP_TIMEOUT);
+}
+
+void IOUring::prepareUploadRecv(int client_fd, AttachmentUpload& upload) {
+    io_uring_sqe* sqe = getSQE();
+    io_uring_prep_splice(sqe, client_fd, -1, upload.pipe.writeFd(), -1, upload.nextChunk(), SPLICE_F_NONBLOCK);
+    setContext(sqe, OperationType::UPLOAD, client_fd, UPLOAD_STEP_RECV);
+}
+
+void IOUring::prepareUploadStore(int client_fd, AttachmentUpload& upload) {
+    io_uring_sqe* sqe = getSQE();
+    io_uring_prep_splice(sqe, upload.pipe.readFd(), -1, upload.fileFd(), static_cast<int64_t>(upload.stored()),
+                         upload.in_pipe, 0);
+    setContext(sqe, OperationType::UPLOAD, client_fd, UPLOAD_STEP_STORE);
+}
+
+bool IOUring::startUpload(int client_fd, AttachmentUpload& upload) {
+    auto assembler = assemblers_.find(client_fd);
+    if (assembler != assemblers_.end() && assembler->second.buffered() > 0) {
+        // PUT 뒤에 프레임 조각이 붙어 왔다: "ready" 전에 본문을 보낸 클라이언트
+        failUpload(client_fd, "attach: body sent before ready");
+        return false;
+    }
+
+    const std::string hex = AttachmentStore::isZero(upload.header().digest)
+        ? "-" : AttachmentStore::toHex(upload.header().digest);
+    sendAttachReply(client_fd, MessageType::SERVER_ACK, "attach:ready " + hex);
+    prepareUploadWait(client_fd);
+    return true;
+}
+
+void IOUring::finishUpload(int client_fd, AttachmentUpload& upload) {
+    auto& store = AttachmentStore::getInstance();
+    if (!upload.finish()) {
+        store.discard(upload);
+        sendAttachReply(client_fd, MessageType::SERVER_ERROR, "attach: digest mismatch");
+    } else if (!store.commit(upload)) {
+        sendAttachReply(client_fd, MessageType::SERVER_ERROR, "attach: server storage unavailable");
+    } else {
+        const std::string hex = AttachmentStore::toHex(upload.digest());
+        LOG_INFO("Client ", client_fd, " stored attachment ", hex, " (", upload.stored(), " bytes)");
+        sendAttachReply(client_fd, MessageType::SERVER_ACK, "attach:stored " + hex);
+    }
+
+    uploads_.erase(client_fd);
+    prepareRead(client_fd);
+}
+
+void IOUring::failUpload(int client_fd, const std::string& reason) {
+    auto it = uploads_.find(client_fd);
+    if (it == uploads_.end()) {
+        return;
+    }
+    AttachmentUpload& upload = *it->second;
+    const bool mid_body = upload.stored() + upload.in_pipe > 0;
+    LOG_WARN("Upload from client ", client_fd, " failed: ", reason);
+    AttachmentStore::getInstance().discard(upload);
+    uploads_.erase(it);
+
+    if (mid_body) {
+        shutdown(client_fd, SHUT_RDWR);
+    } else {
+        sendAttachReply(client_fd, MessageType::SERVER_ERROR, reason);
+    }
+    // 끊긴 연결은 다시 건 recv의 EOF로 정상 종료 경로를 탄다
+    prepareRead(client_fd);
+}
+
+void IOUring::handleUpload(io_uring_cqe* cqe, int client_fd, uint16_t step) {
+    if (step == UPLOAD_STEP_TIMEOUT) {
+        return;   // POLLIN 대기 결과로 처리
+    }
+
+    auto it = uploads_.find(client_fd);
+    if (it == uploads_.end()) {
+        return;
+    }
+    AttachmentUpload& upload = *it->second;
+    upload.in_flight = false;
+    if (upload.abandoned) {
+        uploads_.erase(it);
+        return;
+    }
+
+    const int result = cqe->res;
+    switch (step) {
+        case UPLOAD_STEP_CANCEL:
+            // 0: 걸려 있던 recv를 취소함, -ENOENT: 이미 끝나 다시 걸지 않은 상태
+            if (result != 0 && result != -ENOENT) {
+                failUpload(client_fd, "attach: could not pause receive");
+                return;
+            }
+            if (!startUpload(client_fd, upload)) {
+                return;
+            }
+            break;
+
+        case UPLOAD_STEP_WAIT:
+            if (result < 0) {
+                failUpload(client_fd, result == -ECANCELED ? "attach: upload timed out" : "attach: connection error");
+                return;
+            }
+            prepareUploadRecv(client_fd, upload);
+            break;
+
+        case UPLOAD_STEP_RECV:
+            if (result == -EAGAIN) {
+                prepareUploadWait(client_fd);
+                break;
+            }
+            if (result <= 0) {
+                failUpload(client_fd, "attach: connection closed during upload");
+                return;
+            }
+            upload.in_pipe = static_cast<unsigned>(result);
+            prepareUploadStore(client_fd, upload);
+            break;
+
+        case UPLOAD_STEP_STORE:
+            if (result <= 0) {
+                failUpload(client_fd, "attach: server storage unavailable");
+                return;
+            }
+            upload.in_pipe -= static_cast<unsigned>(result);
+            if (!upload.commitChunk(static_cast<size_t>(result))) {
+                failUpload(client_fd, "attach: server storage unavailable");
+                return;
+            }
+            if (upload.in_pipe > 0) {
+                prepareUploadStore(client_fd, upload);
+            } else if (!upload.complete()) {
+                prepareUploadRecv(client_fd, upload);
+            } else {
+                finishUpload(client_fd, upload);
+                return;
+            }
+            break;
+
+        default:
+            break;
+    }
+    upload.in_flight = true;
+}
+
+std::shared_ptr<const ChatMessage> IOUring::buildFrame(MessageType msg_type, const void* data, size_t length) {
+    if (length > sizeof(ChatMessage::data)) {
+        throw std::runtime_error("메시지 크기 초과");
+    }
+
+    auto message = std::make_shared<ChatMessage>();
+    message->type = msg_type;
+    message->length = static_cast<uint16_t>(length);
+    if (data && length > 0) {
+        memcpy(message->data, data, length);
+    }
+    return message;
+}
+
+int64_t IOUring::nowNanos() {
+    // 배치 시작 시각으로 충분 (전달 기한은 ms 단위)
+    return LoopClock::now();
+}
+
+void IOUring::sendMessage(int client_fd, MessageType msg_type, const void* data, size_t length, uint16_t buffer_idx) {
+    try {
+        enqueueFrame(client_fd, buildFrame(msg_type, data, length), 0);
+        total_messages_++;
+        logMessageStats();
+    }
+    catch (const std::exception& e) {
+        // 응답 하나를 못 보냈다고 워커를 멈추지 않는다 (호출자는 다시 보내거나 버퍼를 돌려주지 않는다)
+        LOG_ERROR("Send failed (client=", client_fd, "): ", e.what());
+    }
+    // 프레임이 내용을 복사해 가졌으므로 수신 버퍼는 성공/실패와 무관하게 여기서 반환
+    releaseBufferRef(buffer_idx);
+}
+
+void IOUring::broadcastToSession(int32_t session_id, MessageType msg_type, const void* data, size_t length, uint16_t buffer_idx, int32_t /* exclude_fd */, uint32_t deadline_ms) {
+    try {
+        auto members = SessionManager::getInstance().getRoomMembers(session_id);
+        
+        if (!members.empty()) {
+            // 프레임은 한 번만 만들어 모든 대상 큐가 공유
+            auto frame = buildFrame(msg_type, data, length);
+            const int64_t deadline_ns = deadline_ms > 0 ? nowNanos() + static_cast<int64_t>(deadline_ms) * 1000000 : 0;
+
+            // 여러 방에 속한 연결은 방 ID가 붙은 채팅을 받는다
+            std::shared_ptr<const ChatMessage> tagged_frame;
+            if (msg_type == MessageType::SERVER_CHAT &&
+                std::any_of(members.begin(), members.end(), [](const RoomMember& member) { return member.tagged; })) {
+                auto tagged = std::make_shared<ChatMessage>();
+                command::RoomChatBuilder(*tagged, MessageType::SERVER_ROOM_CHAT)
+                    .room_id(session_id)
+                    .text(std::string_view(static_cast<const char*>(data), length))
+                    .finish();
+                tagged_frame = std::move(tagged);
+            }
+
+            // SPLICE: 파이프에 한 번 쓰고 수신자마다 tee (실패하면 write 경로)
+            std::shared_ptr<const PipeFrame> pipe;
+            if (fanout_mode_ == FanoutMode::SPLICE && length >= splice_min_payload_ && members.size() > 1) {
+                pipe = fanout_.load(frame.get(), sizeof(ChatMessage));
+            }
+
+            // 수신자 큐에 쌓인 동안 방 backlog로 잡아 발신자 조절에 쓴다
+            fanOut(members, frame, tagged_frame, pipe, deadline_ns, RoomFlowControl::getInstance().getRoom(session_id));
+            total_broadcasts_++;
+            logMessageStats();
+        }
+    }
+    catch (const std::exception& e) {
+        LOG_ERROR("Broadcast failed: ", e.what());
+    }
+    releaseBufferRef(buffer_idx);
+}
+
+void IOUring::fanOut(const std::vector<RoomMember>& members, const std::shared_ptr<const ChatMessage>& frame,
+                     const std::shared_ptr<const ChatMessage>& tagged_frame, const std::shared_ptr<const PipeFrame>& pipe,
+                     int64_t deadline_ns, RoomBacklog* room) {
+    // I/O가 다른 링에 있는 구성원은 (링, 프레임)별로 모아 한 번에 넘긴다
+    std::vector<std::pair<IOUring*, RemoteDelivery>> remote;
+    for (const RoomMember& member : members) {
+        const bool use_tagged = member.tagged && tagged_frame;
+        const auto& target_frame = use_tagged ? tagged_frame : frame;
+        if (member.home == this) {
+            enqueueFrame(member.client_fd, target_frame, deadline_ns, use_tagged ? nullptr : pipe, room);
+            total_messages_++;
+            continue;
+        }
+        auto group = std::find_if(remote.begin(), remote.end(), [&](const auto& entry) {
+            return entry.first == member.home && entry.second.frame == target_frame;
+        });
+        if (group == remote.end()) {
+            remote.emplace_back(member.home, RemoteDelivery{{}, target_frame, deadline_ns, room});
+            group = remote.end() - 1;
+        }
+        group->second.targets.push_back(RemoteTarget{member.client_fd, member.connection_id});
+    }
+    for (auto& [home, delivery] : remote) {
+        RingStats::bump(stats_.frames_routed, delivery.targets.size());
+        home->postRemote(std::move(delivery));
+    }
+}
+
+void IOUring::enqueueFrame(int client_fd, std::shared_ptr<const ChatMessage> message, int64_t deadline_ns,
+                           std::shared_ptr<const PipeFrame> pipe, RoomBacklog* room) {
+    ProbedLockGuard<std::mutex> lock(outbound_mutex_, "outbound");
+    OutboundQueue& queue = outbound_[client_fd];
+    if (queue.close_after_flush) {
+        // 드레인 중인 연결: 재접속 안내 뒤로는 보내지 않고 종료를 기다린다
+        return;
+    }
+    OutboundFrame frame{std::move(message), deadline_ns, std::move(pipe), nullptr, room, nullptr};
+    if (queue.json) {
+        // JSON 연결은 파이프(바이너리 프레임) 대신 공유된 JSON 줄을 보낸다
+        if (json_frame_ != frame.message) {
+            json_text_ = std::make_shared<const std::string>(json::encode(*frame.message));
+            json_frame_ = frame.message;
+            RingStats::bump(stats_.json_encoded);
+        }
+        frame.text = json_text_;
+        frame.pipe.reset();
+    }
+    queue.push(std::move(frame));
+
+    if (!queue.inFlight()) {
+        flushOutbound(client_fd, queue);
+    } else if (deadline_ns != 0) {
+        // 소켓이 막혀 write가 끝나지 않는 연결도 만료 프레임이 쌓이지 않게
+        size_t pruned = queue.pruneExpired(nowNanos());
+        if (pruned > 0) {
+            RingStats::bump(stats_.frames_skipped, pruned);
+        }
+    }
+}
+
+void IOUring::flushOutbound(int client_fd, OutboundQueue& queue) {
+    size_t skipped = 0;
+    size_t bytes = queue.stage(nowNanos(), skipped);
+
+    if (skipped > 0) {
+        RingStats::bump(stats_.frames_skipped, skipped);
+        LOG_TRACE("Skipped ", skipped, " stale frames for client ", client_fd);
+    }
+    if (bytes > 0) {
+        prepareSend(client_fd, queue.data(), static_cast<unsigned>(bytes));
+    } else if (queue.splicing()) {
+        prepareSplice(client_fd, queue, true, false);
+    }
+}
+
+void IOUring::enqueueAttachment(int client_fd, std::shared_ptr<const ChatMessage> header,
+                                std::shared_ptr<const AttachmentFile> file) {
+    ProbedLockGuard<std::mutex> lock(outbound_mutex_, "outbound");
+    OutboundQueue& queue = outbound_[client_fd];
+    queue.push(OutboundFrame{std::move(header), 0, nullptr, nullptr, nullptr, nullptr});
+    if (file->size() > 0) {
+        queue.push(OutboundFrame{nullptr, 0, nullptr, std::move(file), nullptr, nullptr});
+    }
+
+    if (!queue.inFlight()) {
+        flushOutbound(client_fd, queue);
+    }
+}
+
+void IOUring::prepareSend(int client_fd, const void* buf, unsigned len) {
+    if (fanout_mode_ == FanoutMode::SEND_ZC) {
+        prepareSendZc(client_fd, buf, len);
+    } else {
+        prepareWrite(client_fd, buf, len, 0);
+    }
+}
+
+void IOUring::prepareSplice(int client_fd, OutboundQueue& queue, bool fill, bool wait_writable) {
+    if (!queue.pipe.isOpen() && !queue.pipe.open()) {
+        LOG_WARN("Connection pipe creation failed for client ", client_fd, ", dropping spliced frame");
+        if (queue.spliceFile()) {
+            // 헤더는 이미 나갔으므로 본문 없이 계속하면 스트림이 어긋난다
+            shutdown(client_fd, SHUT_RDWR);
+        }
+        queue.abortSplice();
+        RingStats::bump(stats_.frames_skipped);
+        if (queue.hasPending()) {
+            flushOutbound(client_fd, queue);
+        }
+        return;
+    }
+
+    // 연결된 SQE 사이에 암묵적 제출이 끼면 링크가 끊기므로 자리를 먼저 확보
+    if (reactor_.sqReady() + 3 > NUM_SUBMISSION_QUEUE_ENTRIES) {
+        submit();
+    }
+
+    if (fill) {
+        io_uring_sqe* sqe = getSQE();
+        if (const PipeFrame* frame = queue.spliceFrame()) {
+            PipeFanout::prepTee(sqe, frame->readFd(), queue.pipe.writeFd(), queue.spliceRemaining());
+        } else {
+            // 첨부 파일의 다음 chunk를 페이지 캐시에서 연결 파이프로 (사용자 공간을 거치지 않음)
+            uint64_t offset = 0;
+            unsigned length = queue.nextFileChunk(ATTACH_CHUNK_SIZE, offset);
+            io_uring_prep_splice(sqe, queue.spliceFile()->fd(), static_cast<int64_t>(offset),
+                                 queue.pipe.writeFd(), -1, length, 0);
+            sqe->flags |= IOSQE_IO_LINK | IOSQE_CQE_SKIP_SUCCESS;
+        }
+        setContext(sqe, OperationType::SPLICE, client_fd, SPLICE_STEP_FILL);
+    }
+    if (wait_writable) {
+        io_uring_sqe* sqe = getSQE();
+        io_uring_prep_poll_add(sqe, client_fd, POLLOUT);
+        sqe->flags |= IOSQE_IO_LINK | IOSQE_CQE_SKIP_SUCCESS;
+        setContext(sqe, OperationType::SPLICE, client_fd, SPLICE_STEP_POLL);
+    }
+    io_uring_sqe* sqe = getSQE();
+    PipeFanout::prepSpliceToSocket(sqe, queue.pipe.readFd(), client_fd, queue.spliceRemaining());
+    setContext(sqe, OperationType::SPLICE, client_fd, SPLICE_STEP_SEND);
+}
+
+void IOUring::releaseBufferRef(uint16_t buffer_idx) {
+    if (buffer_idx == UringBuffer::NO_BUFFER) {
+        return;
+    }
+    decrementBufferRefCount(buffer_idx);
+    if (buffer_manager_->getRefCount(buffer_idx) == 0) {
+        releaseBuffer(buffer_idx);
+    }
+}
+
+void IOUring::dropOutbound(int client_fd) {
+    ProbedLockGuard<std::mutex> lock(outbound_mutex_, "outbound");
+    auto it = outbound_.find(client_fd);
+    if (it == outbound_.end()) {
+        return;
+    }
+
+    if (it->second.getSkipped() > 0) {
+        LOG_DEBUG("Client ", client_fd, " skipped ", it->second.getSkipped(), " stale frames");
+    }
+
+    // 진행 중인 write가 staging 버퍼를 참조하므로 완료 시 제거
+    it->second.clearPending();
+    if (it->second.inFlight()) {
+        it->second.closing = true;
+    } else {
+        outbound_.erase(it);
+    }
+}
+
+void IOUring::closeAfterFlush(int client_fd) {
+    ProbedLockGuard<std::mutex> lock(outbound_mutex_, "outbound");
+    OutboundQueue& queue = outbound_[client_fd];
+    if (queue.inFlight() || queue.hasPending()) {
+        queue.close_after_flush = true;
+        return;
+    }
+    outbound_.erase(client_fd);
+    shutdown(client_fd, SHUT_WR);
+}
+
+void IOUring::dropConnection(int client_fd) {
+    {
+        std::lock_guard<std::mutex> lock(remote_mutex_);
+        connections_.erase(client_fd);
+    }
+    assemblers_.erase(client_fd);
+    json_assemblers_.erase(client_fd);
+    throttled_.erase(client_fd);
+    sender_ids_.erase(client_fd);
+    auto it = uploads_.find(client_fd);
+    if (it != uploads_.end()) {
+        AttachmentStore::getInstance().discard(*it->second);
+        if (it->second->in_flight) {
+            // 진행 중인 splice가 업로드 파이프와 파일을 참조하므로 완료 시 제거
+            it->second->abandoned = true;
+        } else {
+            uploads_.erase(it);
+        }
+    }
+    dropOutbound(client_fd);
+}
+
+void IOUring::decrementBufferRefCount(uint16_t buffer_idx) {
+    buffer_manager_->decrementRefCount(buffer_idx);
+}
+
+void IOUring::handleWriteComplete(int32_t client_fd, int32_t bytes_written) {
+    ProbedLockGuard<std::mutex> lock(outbound_mutex_, "outbound");
+    completeWrite(client_fd, bytes_written);
+}
+
+void IOUring::completeWrite(int client_fd, int32_t bytes_written) {
+    auto it = outbound_.find(client_fd);
+    if (it == outbound_.end()) {
+        return;
+    }
+    OutboundQueue& queue = it->second;
+
+    if (bytes_written <= 0) {
+        // 연결이 깨졌으므로 남은 프레임은 보내지 않는다
+        std::cerr << "[ERROR] Write failed for client " << client_fd << ": " << bytes_written << std::endl;
+        outbound_.erase(it);
+        return;
+    }
+
+    size_t frames_sent = 0;
+    queue.complete(static_cast<size_t>(bytes_written), frames_sent);
+    RingStats::bump(stats_.messages_delivered, frames_sent);
+    resumeOutbound(client_fd, queue);
+}
+
+void IOUring::resumeOutbound(int client_fd, OutboundQueue& queue) {
+    if (queue.closing) {
+        // 종료된 연결의 미전송분은 버린다
+        queue.resetInFlight();
+        if (!queue.hasPending()) {
+            outbound_.erase(client_fd);
+            return;
+        }
+        // 종료 대기 중 같은 fd 번호로 새 연결이 들어와 프레임이 쌓인 경우
+        queue.closing = false;
+    }
+
+    if (queue.remaining() > 0) {
+        // 부분 전송: 나머지 바이트부터 이어서 전송
+        prepareSend(client_fd, queue.data(), static_cast<unsigned>(queue.remaining()));
+    } else if (queue.splicing()) {
+        // 연결 파이프에 남은 바이트만 이어서 splice. 비었으면 첨부 파일의 다음 chunk부터
+        prepareSplice(client_fd, queue, queue.spliceRemaining() == 0, false);
+    } else if (queue.hasPending()) {
+        flushOutbound(client_fd, queue);
+    }
+
+    if (queue.close_after_flush && !queue.inFlight() && !queue.hasPending()) {
+        // 재접속 안내까지 모두 나갔으므로 FIN을 보내 클라이언트가 스스로 끊게 한다
+        queue.close_after_flush = false;
+        shutdown(client_fd, SHUT_WR);
+    }
+}
+
+void IOUring::handleSendZc(io_uring_cqe* cqe, int client_fd) {
+#ifdef IORING_CQE_F_NOTIF
+    ProbedLockGuard<std::mutex> lock(outbound_mutex_, "outbound");
+    auto it = outbound_.find(client_fd);
+    if (it == outbound_.end()) {
+        return;
+    }
+
+    if (cqe->flags & IORING_CQE_F_NOTIF) {
+        // 커널이 staging 버퍼를 다 썼으므로 이제 완료 처리
+        completeWrite(client_fd, it->second.zc_result);
+    } else if (cqe->flags & IORING_CQE_F_MORE) {
+        it->second.zc_result = cqe->res;
+    } else {
+        completeWrite(client_fd, cqe->res);
+    }
+#else
+    handleWriteComplete(client_fd, cqe->res);
+#endif
+}
+
+void IOUring::handleSplice(io_uring_cqe* cqe, int client_fd, uint16_t step) {
+    ProbedLockGuard<std::mutex> lock(outbound_mutex_, "outbound");
+    auto it = outbound_.find(client_fd);
+    if (it == outbound_.end()) {
+        return;
+    }
+    OutboundQueue& queue = it->second;
+    const int result = cqe->res;
+
+    if (step == SPLICE_STEP_FILL || step == SPLICE_STEP_POLL) {
+        // 성공 CQE는 생략되지만 CQE_SKIP_SUCCESS 미지원 커널에서는 올 수 있다.
+        // 실패하면(파일 splice는 짧게 끝나도 실패) 연결된 splice가 -ECANCELED로 따로 돌아온다
+        if (step == SPLICE_STEP_FILL &&
+            (result < 0 || (queue.spliceFile() && static_cast<unsigned>(result) < queue.spliceRemaining()))) {
+            LOG_DEBUG("Splice fill failed for client ", client_fd, ": ", result);
+            queue.fill_failed = true;
+        }
+        return;
+    }
+
+    if (result > 0) {
+        const bool file = queue.spliceFile() != nullptr;
+        if (queue.completeSplice(static_cast<size_t>(result)) == SpliceProgress::DONE) {
+            if (file) {
+                LOG_DEBUG("Attachment sent to client ", client_fd);
+            } else {
+                RingStats::bump(stats_.messages_delivered);
+                RingStats::bump(stats_.frames_spliced);
+            }
+        }
+        resumeOutbound(client_fd, queue);
+    } else if (result == -EAGAIN && !queue.closing) {
+        // 소켓 송신 버퍼가 가득 참: 쓸 수 있게 되면 나머지를 다시 splice
+        prepareSplice(client_fd, queue, false, true);
+    } else if (result == -ECANCELED && queue.fill_failed) {
+        queue.fill_failed = false;
+        if (queue.spliceFile()) {
+            // 첨부 본문이 중간에 끊기면 클라이언트가 프레임 경계를 잃으므로 연결을 끊는다
+            LOG_ERROR("Attachment read failed for client ", client_fd);
+            shutdown(client_fd, SHUT_RDWR);
+        }
+        queue.abortSplice();
+        RingStats::bump(stats_.frames_skipped);
+        resumeOutbound(client_fd, queue);
+    } else if (queue.closing) {
+        resumeOutbound(client_fd, queue);
+    } else {
+        std::cerr << "[ERROR] Splice failed for client " << client_fd << ": " << result << std::endl;
+        outbound_.erase(it);
     }
 }
 
 // 주기적인 통계 로깅을 위한 상수 추가
 static constexpr uint64_t LOG_INTERVAL = 1000;  // 1000개 메시지마다 로깅
 
-void IOUring::logMessageStats() const {
-    static uint64_t last_log_messages = 0;
+void IOUring::logMessageStats() {
     uint64_t current_messages = total_messages_.load();
     uint64_t current_broadcasts = total_broadcasts_.load();
     
-    if (current_messages / LOG_INTERVAL > last_log_messages / LOG_INTERVAL) {
-        LOG_INFO("Stats - Messages: ", current_messages, ", Broadcasts: ", current_broadcasts);
-        last_log_messages = current_messages;
+    if (current_messages / LOG_INTERVAL > last_logged_messages_ / LOG_INTERVAL) {
+        RingStatsSnapshot snapshot;
+        snapshot.add(stats_);
+        LOG_INFO("Stats - Messages: ", current_messages, ", Broadcasts: ", current_broadcasts,
+                 ", Ring: ", snapshot.toString());
+        last_logged_messages_ = current_messages;
+    }
+}
+
+unsigned IOUring::peekCQE(io_uring_cqe** cqes, unsigned max) {
+    unsigned count = reactor_.peekBatch(cqes, max);
+    if (count > 0) {
+        LoopClock::tick();
+        heartbeat_.beat(LoopClock::now());
     }
+    return count;
 }
 
-unsigned IOUring::peekCQE(io_uring_cqe** cqes) {
-    return io_uring_peek_batch_cqe(&ring_, cqes, CQE_BATCH_SIZE);
+void IOUring::recordEvent(const io_uring_cqe* cqe) {
+    const auto* buffer = reinterpret_cast<const uint8_t*>(&cqe->user_data);
+    int32_t client_fd;
+    memcpy(&client_fd, buffer, sizeof(client_fd));
+    heartbeat_.record(LoopClock::now(), buffer[4], client_fd, cqe->res);
 }
 
 void IOUring::advanceCQ(unsigned count) {
-    io_uring_cq_advance(&ring_, count);
+    RingStats::bump(stats_.cqes_reaped, count);
+    reactor_.advance(count);
 }
\ No newline at end of file
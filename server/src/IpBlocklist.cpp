@@ -0,0 +1,382 @@
+#include "IpBlocklist.h"
+#include "Clock.h"
+#include "Logger.h"
+#include <algorithm>
+#include <arpa/inet.h>
+#include <array>
+#include <cstdlib>
+#include <fstream>
+#include <queue>
+#include <sstream>
+#include <stdexcept>
+
+namespace {
+    uint32_t prefixMask(uint8_t length) {
+        return length == 0 ? 0 : ~0u << (32 - length);
+    }
+
+    // 트라이 조립용 노드 (압축 전): 위치마다 리프 값과 자식 번호
+    struct BuildNode {
+        std::array<uint32_t, 64> value{};
+        std::array<int32_t, 64> child;
+
+        explicit BuildNode(uint32_t inherited) {
+            value.fill(inherited);
+            child.fill(-1);
+        }
+    };
+
+    // 위치와 그 아래 자식 전체를 값으로 덮는다
+    void fillSlot(std::vector<BuildNode>& build, int32_t node, size_t slot, uint32_t match) {
+        build[node].value[slot] = match;
+        const int32_t child = build[node].child[slot];
+        if (child >= 0) {
+            for (size_t i = 0; i < 64; ++i) {
+                fillSlot(build, child, i, match);
+            }
+        }
+    }
+
+    std::string trim(const std::string& text) {
+        const size_t begin = text.find_first_not_of(" \t\r");
+        if (begin == std::string::npos) {
+            return "";
+        }
+        const size_t end = text.find_last_not_of(" \t\r");
+        return text.substr(begin, end - begin + 1);
+    }
+}
+
+bool Cidr::parse(const std::string& text, Cidr& cidr) {
+    const size_t slash = text.find('/');
+    const std::string address = text.substr(0, slash);
+
+    in_addr parsed{};
+    if (inet_pton(AF_INET, address.c_str(), &parsed) != 1) {
+        return false;
+    }
+
+    unsigned long length = 32;
+    if (slash != std::string::npos) {
+        const std::string suffix = text.substr(slash + 1);
+        char* end = nullptr;
+        length = std::strtoul(suffix.c_str(), &end, 10);
+        if (suffix.empty() || *end != '\0' || length > 32) {
+            return false;
+        }
+    }
+
+    cidr.length = static_cast<uint8_t>(length);
+    cidr.addr = ntohl(parsed.s_addr) & prefixMask(cidr.length);
+    return true;
+}
+
+std::string Cidr::toString() const {
+    in_addr raw{};
+    raw.s_addr = htonl(addr);
+    char text[INET_ADDRSTRLEN] = {0};
+    inet_ntop(AF_INET, &raw, text, sizeof(text));
+    return std::string(text) + "/" + std::to_string(length);
+}
+
+IpBlocklist::IpBlocklist(std::vector<Cidr> ranges) : ranges_(std::move(ranges)) {
+    // 짧은 접두사부터 채우고 긴 접두사가 덮어쓴다 (범위 번호는 정렬된 순서)
+    std::stable_sort(ranges_.begin(), ranges_.end(),
+        [](const Cidr& a, const Cidr& b) { return a.length < b.length; });
+
+    std::vector<uint32_t> direct_value(1u << DIRECT_BITS, NO_MATCH);
+    std::vector<int32_t> direct_child(1u << DIRECT_BITS, -1);
+    std::vector<BuildNode> build;
+
+    for (size_t i = 0; i < ranges_.size(); ++i) {
+        const Cidr& range = ranges_[i];
+        const uint32_t match = static_cast<uint32_t>(i + 1);
+
+        if (range.length <= DIRECT_BITS) {
+            const uint32_t first = range.addr >> (32 - DIRECT_BITS);
+            const uint32_t count = 1u << (DIRECT_BITS - range.length);
+            for (uint32_t slot = first; slot < first + count; ++slot) {
+                direct_value[slot] = match;
+                if (direct_child[slot] >= 0) {
+                    for (size_t j = 0; j < 64; ++j) {
+                        fillSlot(build, direct_child[slot], j, match);
+                    }
+                }
+            }
+            continue;
+        }
+
+        const uint32_t top = range.addr >> (32 - DIRECT_BITS);
+        if (direct_child[top] < 0) {
+            direct_child[top] = static_cast<int32_t>(build.size());
+            build.emplace_back(direct_value[top]);
+        }
+        int32_t node = direct_child[top];
+        for (unsigned offset = DIRECT_BITS;; offset += STRIDE) {
+            const unsigned bits = std::min(STRIDE, 32 - offset);
+            const uint32_t index = extract(range.addr, offset);
+            const unsigned remaining = range.length - offset;
+            if (remaining <= bits) {
+                // 이 노드 안에서 끝나는 접두사: 해당하는 위치들로 펼친다
+                const uint32_t span = 1u << (bits - remaining);
+                const uint32_t first = index & ~(span - 1);
+                for (uint32_t slot = first; slot < first + span; ++slot) {
+                    fillSlot(build, node, slot, match);
+                }
+                break;
+            }
+            if (build[node].child[index] < 0) {
+                const int32_t child = static_cast<int32_t>(build.size());
+                build.emplace_back(build[node].value[index]);
+                build[node].child[index] = child;
+            }
+            node = build[node].child[index];
+        }
+    }
+
+    // 압축: 형제 노드를 연속 배치하도록 너비 우선으로 옮긴다
+    direct_.resize(1u << DIRECT_BITS);
+    struct Pending {
+        int32_t build;
+        uint32_t out;
+        unsigned offset;
+    };
+    std::queue<Pending> queue;
+    for (uint32_t slot = 0; slot < direct_.size(); ++slot) {
+        if (direct_child[slot] < 0) {
+            direct_[slot] = direct_value[slot];
+            continue;
+        }
+        const uint32_t out = static_cast<uint32_t>(nodes_.size());
+        nodes_.push_back(Node{});
+        direct_[slot] = NODE_FLAG | out;
+        queue.push(Pending{direct_child[slot], out, DIRECT_BITS});
+    }
+
+    while (!queue.empty()) {
+        const Pending pending = queue.front();
+        queue.pop();
+        const BuildNode& source = build[pending.build];
+        const size_t slots = size_t{1} << std::min(STRIDE, 32 - pending.offset);
+
+        Node node{0, 0, static_cast<uint32_t>(leaves_.size()), static_cast<uint32_t>(nodes_.size())};
+        bool has_leaf = false;
+        uint32_t last_leaf = NO_MATCH;
+        for (size_t slot = 0; slot < slots; ++slot) {
+            if (source.child[slot] >= 0) {
+                node.vector |= uint64_t{1} << slot;
+                queue.push(Pending{source.child[slot], static_cast<uint32_t>(nodes_.size()), pending.offset + STRIDE});
+                nodes_.push_back(Node{});
+            } else if (!has_leaf || source.value[slot] != last_leaf) {
+                node.leafvec |= uint64_t{1} << slot;
+                leaves_.push_back(source.value[slot]);
+                last_leaf = source.value[slot];
+                has_leaf = true;
+            }
+        }
+        nodes_[pending.out] = node;
+    }
+}
+
+uint32_t IpBlocklist::lookup(uint32_t addr) const {
+    const uint32_t entry = direct_[addr >> (32 - DIRECT_BITS)];
+    if (!(entry & NODE_FLAG)) {
+        return entry;
+    }
+
+    const Node* node = &nodes_[entry & ~NODE_FLAG];
+    for (unsigned offset = DIRECT_BITS;; offset += STRIDE) {
+        const uint64_t bit = uint64_t{1} << extract(addr, offset);
+        if (node->vector & bit) {
+            node = &nodes_[node->base1 + __builtin_popcountll(node->vector & (bit - 1))];
+            continue;
+        }
+        return leaves_[node->base0 + __builtin_popcountll(node->leafvec & (bit | (bit - 1))) - 1];
+    }
+}
+
+size_t IpBlocklist::getMemoryBytes() const {
+    return direct_.size() * sizeof(uint32_t) + nodes_.size() * sizeof(Node) + leaves_.size() * sizeof(uint32_t);
+}
+
+std::unique_ptr<IpBlocklist> IpBlocklist::loadFile(const std::string& path) {
+    std::ifstream file(path);
+    if (!file) {
+        throw std::runtime_error("Failed to open blocklist " + path);
+    }
+
+    std::vector<Cidr> ranges;
+    std::string line;
+    size_t line_number = 0;
+    while (std::getline(file, line)) {
+        ++line_number;
+        line = trim(line.substr(0, line.find('#')));
+        if (line.empty()) {
+            continue;
+        }
+        Cidr cidr;
+        if (!Cidr::parse(line, cidr)) {
+            throw std::runtime_error("Invalid CIDR at " + path + ":" + std::to_string(line_number) + ": " + line);
+        }
+        ranges.push_back(cidr);
+    }
+    return std::make_unique<IpBlocklist>(std::move(ranges));
+}
+
+AcceptFilter::~AcceptFilter() {
+    if (reloader_.joinable()) {
+        reloader_.join();
+    }
+    delete current_.load();
+    for (const Retired& retired : retired_) {
+        delete retired.list;
+    }
+}
+
+bool AcceptFilter::configure() {
+    if (path_.empty()) {
+        const char* path = std::getenv("CHAT_BLOCKLIST");
+        if (!path || !*path) {
+            return false;
+        }
+        path_ = path;
+    }
+    return true;
+}
+
+bool AcceptFilter::reload() {
+    std::string path;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!configure()) {
+            return false;
+        }
+        path = path_;
+    }
+
+    // 큰 목록은 읽고 조립하는 데 수백 ms가 걸릴 수 있다: 그동안 Listener의 reclaim과 describe를 막지 않는다
+    const int64_t started_ns = Clock::getInstance().now();
+    std::unique_ptr<IpBlocklist> list = IpBlocklist::loadFile(path);
+    const int64_t elapsed_us = (Clock::getInstance().now() - started_ns) / 1000;
+    LOG_INFO("[Blocklist] Loaded ", list->getRangeCount(), " ranges from ", path, " (",
+             list->getMemoryBytes() / 1024, " KiB, built in ", elapsed_us, "us)");
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (const IpBlocklist* old = current_.exchange(list.release())) {
+        // 이 epoch를 알린 reader는 교체 뒤에 목록을 다시 읽으므로 이전 목록을 들고 있지 않다
+        retired_.push_back(Retired{old, epoch_.fetch_add(1) + 1});
+        has_retired_.store(true);
+    }
+    return true;
+}
+
+bool AcceptFilter::requestReload() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!configure()) {
+        return false;
+    }
+    if (reloading_) {
+        // 진행 중인 읽기가 이 요청 전의 파일을 봤을 수 있다
+        reload_again_ = true;
+        return true;
+    }
+    if (reloader_.joinable()) {
+        reloader_.join();   // 이전 쓰레드는 reloading_을 내리고 곧바로 끝난다
+    }
+    reloading_ = true;
+    reloader_ = std::thread(&AcceptFilter::reloadThread, this);
+    return true;
+}
+
+void AcceptFilter::reloadThread() {
+    while (true) {
+        std::string error;
+        try {
+            reload();
+        } catch (const std::exception& e) {
+            LOG_ERROR("[Blocklist] Reload failed: ", e.what());
+            error = e.what();
+        }
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        reload_error_ = error;
+        if (!reload_again_) {
+            reloading_ = false;
+            return;
+        }
+        reload_again_ = false;
+    }
+}
+
+size_t AcceptFilter::registerReader() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (size_t reader = 0; reader < MAX_READERS; ++reader) {
+        if (readers_[reader].load() == 0) {
+            readers_[reader].store(epoch_.load());
+            return reader;
+        }
+    }
+    throw std::runtime_error("Too many blocklist readers");
+}
+
+void AcceptFilter::unregisterReader(size_t reader) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    readers_[reader].store(0);
+}
+
+bool AcceptFilter::isBlocked(uint32_t addr, Cidr& range) const {
+    const IpBlocklist* list = current_.load(std::memory_order_acquire);
+    if (!list) {
+        return false;
+    }
+    const uint32_t match = list->lookup(addr);
+    if (match == IpBlocklist::NO_MATCH) {
+        return false;
+    }
+    range = list->getRange(match);
+    blocked_.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+void AcceptFilter::reclaim(size_t reader) {
+    readers_[reader].store(epoch_.load());
+    if (!has_retired_.load()) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    uint64_t oldest = UINT64_MAX;
+    for (const auto& announced : readers_) {
+        const uint64_t epoch = announced.load();
+        if (epoch != 0) {
+            oldest = std::min(oldest, epoch);
+        }
+    }
+    auto released = std::remove_if(retired_.begin(), retired_.end(), [oldest](const Retired& retired) {
+        if (retired.epoch > oldest) {
+            return false;   // 교체 전에 읽은 목록을 아직 들고 있을 수 있는 reader가 있다
+        }
+        delete retired.list;
+        return true;
+    });
+    retired_.erase(released, retired_.end());
+    has_retired_.store(!retired_.empty());
+}
+
+std::string AcceptFilter::describe() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    const IpBlocklist* list = current_.load(std::memory_order_acquire);
+    std::ostringstream ss;
+    if (!list) {
+        ss << "blocklist: disabled";
+    } else {
+        ss << "blocklist: " << list->getRangeCount() << " ranges, " << list->getMemoryBytes() / 1024
+           << " KiB, blocked=" << blocked_.load(std::memory_order_relaxed);
+    }
+    if (reloading_) {
+        ss << ", reloading";
+    } else if (!reload_error_.empty()) {
+        ss << ", last reload failed: " << reload_error_;
+    }
+    return ss.str();
+}
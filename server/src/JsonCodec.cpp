@@ -0,0 +1,615 @@
+#include "JsonCodec.h"
+#include "CommandCodec.h"
+#include <algorithm>
+#include <cstring>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace {
+    constexpr size_t BLOCK = 16;
+
+    bool isSpace(char c) {
+        return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+    }
+
+    bool onlySpace(const char* begin, const char* end) {
+        return std::all_of(begin, end, isSpace);
+    }
+
+    // 오류 문구에 넣는 키 이름 (클라이언트가 보낸 값이므로 짧게 자른다)
+    constexpr size_t MAX_ERROR_KEY = 32;
+
+    std::string quotedKey(const std::string& key) {
+        if (key.size() <= MAX_ERROR_KEY) {
+            return "\"" + key + "\"";
+        }
+        size_t cut = MAX_ERROR_KEY;
+        while (cut > 0 && (static_cast<uint8_t>(key[cut]) & 0xC0) == 0x80) {
+            --cut;   // UTF-8 문자 중간에서 자르지 않는다
+        }
+        return "\"" + key.substr(0, cut) + "...\"";
+    }
+
+    // 블록 하나의 따옴표/역슬래시/구조 문자 비트마스크 (비트 i = 블록의 i번째 바이트)
+    struct BlockMasks {
+        uint32_t quotes;
+        uint32_t backslashes;
+        uint32_t structurals;
+    };
+
+    BlockMasks classify(const char* block) {
+#if defined(__SSE2__)
+        const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(block));
+        // { } [ ]는 0x20 비트만 다르다 ('[' 0x5B / '{' 0x7B, ']' 0x5D / '}' 0x7D)
+        const __m128i folded = _mm_or_si128(bytes, _mm_set1_epi8(0x20));
+        const __m128i brackets = _mm_or_si128(_mm_cmpeq_epi8(folded, _mm_set1_epi8('{')),
+                                              _mm_cmpeq_epi8(folded, _mm_set1_epi8('}')));
+        const __m128i separators = _mm_or_si128(_mm_cmpeq_epi8(bytes, _mm_set1_epi8(':')),
+                                                _mm_cmpeq_epi8(bytes, _mm_set1_epi8(',')));
+        return BlockMasks{
+            static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(bytes, _mm_set1_epi8('"')))),
+            static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(bytes, _mm_set1_epi8('\\')))),
+            static_cast<uint32_t>(_mm_movemask_epi8(_mm_or_si128(brackets, separators)))};
+#else
+        BlockMasks masks{0, 0, 0};
+        for (size_t i = 0; i < BLOCK; ++i) {
+            const char c = block[i];
+            masks.quotes |= static_cast<uint32_t>(c == '"') << i;
+            masks.backslashes |= static_cast<uint32_t>(c == '\\') << i;
+            masks.structurals |= static_cast<uint32_t>(c == '{' || c == '}' || c == '[' || c == ']' ||
+                                                       c == ':' || c == ',') << i;
+        }
+        return masks;
+#endif
+    }
+
+    // 이스케이프가 필요한 첫 바이트 (", \, 제어 문자). 없으면 length
+    size_t findEscape(const char* data, size_t length) {
+        size_t i = 0;
+#if defined(__SSE2__)
+        const __m128i quote = _mm_set1_epi8('"');
+        const __m128i backslash = _mm_set1_epi8('\\');
+        const __m128i control_max = _mm_set1_epi8(0x1F);
+        for (; i + BLOCK <= length; i += BLOCK) {
+            const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+            // 부호 없는 비교: min(b, 0x1F) == b 이면 b <= 0x1F
+            const __m128i special = _mm_or_si128(
+                _mm_or_si128(_mm_cmpeq_epi8(bytes, quote), _mm_cmpeq_epi8(bytes, backslash)),
+                _mm_cmpeq_epi8(_mm_min_epu8(bytes, control_max), bytes));
+            const int mask = _mm_movemask_epi8(special);
+            if (mask != 0) {
+                return i + __builtin_ctz(static_cast<unsigned>(mask));
+            }
+        }
+#endif
+        for (; i < length; ++i) {
+            const unsigned char c = static_cast<unsigned char>(data[i]);
+            if (c == '"' || c == '\\' || c < 0x20) {
+                return i;
+            }
+        }
+        return length;
+    }
+
+    void appendHex(std::string& out, const char* data, size_t length) {
+        static const char DIGITS[] = "0123456789abcdef";
+        for (size_t i = 0; i < length; ++i) {
+            const unsigned char c = static_cast<unsigned char>(data[i]);
+            out += DIGITS[c >> 4];
+            out += DIGITS[c & 0x0F];
+        }
+    }
+
+    void appendUtf8(std::string& out, uint32_t code) {
+        if (code < 0x80) {
+            out += static_cast<char>(code);
+        } else if (code < 0x800) {
+            out += static_cast<char>(0xC0 | (code >> 6));
+            out += static_cast<char>(0x80 | (code & 0x3F));
+        } else if (code < 0x10000) {
+            out += static_cast<char>(0xE0 | (code >> 12));
+            out += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+            out += static_cast<char>(0x80 | (code & 0x3F));
+        } else {
+            out += static_cast<char>(0xF0 | (code >> 18));
+            out += static_cast<char>(0x80 | ((code >> 12) & 0x3F));
+            out += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+            out += static_cast<char>(0x80 | (code & 0x3F));
+        }
+    }
+
+    bool parseHex4(const char* p, const char* end, uint32_t& value) {
+        if (end - p < 4) {
+            return false;
+        }
+        value = 0;
+        for (int i = 0; i < 4; ++i) {
+            const char c = p[i];
+            value <<= 4;
+            if (c >= '0' && c <= '9') {
+                value |= c - '0';
+            } else if ((c | 0x20) >= 'a' && (c | 0x20) <= 'f') {
+                value |= (c | 0x20) - 'a' + 10;
+            } else {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // 따옴표 안쪽 [begin, end)를 풀어 out에. 이스케이프가 없으면 한 번에 복사
+    bool unescape(const char* begin, const char* end, std::string& out) {
+        out.clear();
+        while (begin < end) {
+            const char* backslash = static_cast<const char*>(memchr(begin, '\\', end - begin));
+            if (!backslash) {
+                out.append(begin, end);
+                return true;
+            }
+            out.append(begin, backslash);
+            const char* p = backslash + 1;
+            if (p >= end) {
+                return false;
+            }
+            switch (*p) {
+                case '"': out += '"'; break;
+                case '\\': out += '\\'; break;
+                case '/': out += '/'; break;
+                case 'b': out += '\b'; break;
+                case 'f': out += '\f'; break;
+                case 'n': out += '\n'; break;
+                case 'r': out += '\r'; break;
+                case 't': out += '\t'; break;
+                case 'u': {
+                    uint32_t code;
+                    if (!parseHex4(p + 1, end, code)) {
+                        return false;
+                    }
+                    p += 4;
+                    // 서로게이트 쌍
+                    if (code >= 0xD800 && code < 0xDC00) {
+                        uint32_t low;
+                        if (end - p < 7 || p[1] != '\\' || p[2] != 'u' || !parseHex4(p + 3, end, low) ||
+                            low < 0xDC00 || low >= 0xE000) {
+                            return false;
+                        }
+                        code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+                        p += 6;
+                    }
+                    appendUtf8(out, code);
+                    break;
+                }
+                default:
+                    return false;
+            }
+            begin = p + 1;
+        }
+        return true;
+    }
+
+    bool parseInt(const char* begin, const char* end, int32_t& value) {
+        while (begin < end && isSpace(*begin)) ++begin;
+        while (end > begin && isSpace(end[-1])) --end;
+        if (begin == end) {
+            return false;
+        }
+        const bool negative = *begin == '-';
+        if (negative && ++begin == end) {
+            return false;
+        }
+        int64_t result = 0;
+        for (const char* p = begin; p < end; ++p) {
+            if (*p < '0' || *p > '9' || result > INT32_MAX) {
+                return false;
+            }
+            result = result * 10 + (*p - '0');
+        }
+        result = negative ? -result : result;
+        if (result < INT32_MIN || result > INT32_MAX) {
+            return false;
+        }
+        value = static_cast<int32_t>(result);
+        return true;
+    }
+
+    // 구조 문자 위치를 따라가며 평평한 객체 하나를 읽는다. 아는 키만 꺼내고 나머지 값은 건너뛴다
+    struct Request {
+        std::string type;
+        std::string text;
+        std::string token;
+        bool has_room{false};
+        bool has_text{false};
+        int32_t room{0};
+        std::vector<int32_t> rooms;
+        std::vector<std::string> users;
+    };
+
+    class Parser {
+    public:
+        Parser(const char* data, size_t length, const std::vector<uint32_t>& positions)
+            : data_(data), length_(length), pos_(positions) {}
+
+        bool parse(Request& request, std::string& error) {
+            if (pos_.empty() || data_[pos_[0]] != '{' || !onlySpace(data_, data_ + pos_[0])) {
+                error = "expected an object";
+                return false;
+            }
+            next_ = 1;
+            if (peek() == '}') {
+                return finish(error);
+            }
+            std::string key;
+            std::string scratch;
+            while (true) {
+                if (!readString(key)) {
+                    error = "expected a key";
+                    return false;
+                }
+                if (take() != ':') {
+                    error = "expected ':' after " + quotedKey(key);
+                    return false;
+                }
+                const uint32_t value_begin = pos_[next_ - 1] + 1;
+                bool ok;
+                if (key == "type") {
+                    ok = readString(request.type);
+                } else if (key == "text") {
+                    ok = readString(request.text);
+                    request.has_text = ok;
+                } else if (key == "token") {
+                    ok = readString(request.token);
+                } else if (key == "room") {
+                    ok = readInt(value_begin, request.room);
+                    request.has_room = ok;
+                } else if (key == "rooms") {
+                    ok = readArray([&](uint32_t begin) {
+                        int32_t room;
+                        if (!readInt(begin, room)) {
+                            return false;
+                        }
+                        request.rooms.push_back(room);
+                        return true;
+                    });
+                } else if (key == "users") {
+                    ok = readArray([&](uint32_t) {
+                        if (!readString(scratch)) {
+                            return false;
+                        }
+                        request.users.push_back(scratch);
+                        return true;
+                    });
+                } else {
+                    ok = skipValue();
+                }
+                if (!ok) {
+                    error = "bad value for " + quotedKey(key);
+                    return false;
+                }
+                const char separator = take();
+                if (separator == '}') {
+                    return finish(error);
+                }
+                if (separator != ',') {
+                    error = "expected ',' or '}'";
+                    return false;
+                }
+            }
+        }
+
+    private:
+        char peek() const { return next_ < pos_.size() ? data_[pos_[next_]] : '\0'; }
+        char take() { return next_ < pos_.size() ? data_[pos_[next_++]] : '\0'; }
+
+        bool finish(std::string& error) {
+            if (next_ != pos_.size() || !onlySpace(data_ + pos_[next_ - 1] + 1, data_ + length_)) {
+                error = "trailing data after object";
+                return false;
+            }
+            return true;
+        }
+
+        // 다음 두 위치가 여는/닫는 따옴표이고 앞뒤에는 공백뿐이어야 한다
+        bool readString(std::string& out) {
+            if (next_ + 1 >= pos_.size() || data_[pos_[next_]] != '"' ||
+                !onlySpace(data_ + (next_ > 0 ? pos_[next_ - 1] + 1 : 0), data_ + pos_[next_])) {
+                return false;
+            }
+            const char* begin = data_ + pos_[next_] + 1;
+            const char* end = data_ + pos_[next_ + 1];
+            next_ += 2;
+            return spaceUntilNext(end + 1) && unescape(begin, end, out);
+        }
+
+        // 값 뒤에서 다음 구조 문자(없으면 줄 끝)까지
+        bool spaceUntilNext(const char* from) const {
+            return onlySpace(from, next_ < pos_.size() ? data_ + pos_[next_] : data_ + length_);
+        }
+
+        // 숫자 같은 스칼라: 앞 구조 문자와 다음 구조 문자 사이
+        bool readInt(uint32_t begin, int32_t& value) {
+            if (next_ >= pos_.size() || data_[pos_[next_]] == '"') {
+                return false;
+            }
+            return parseInt(data_ + begin, data_ + pos_[next_], value);
+        }
+
+        template <typename OnElement>
+        bool readArray(OnElement&& on_element) {
+            if (take() != '[') {
+                return false;
+            }
+            if (peek() == ']' && onlySpace(data_ + pos_[next_ - 1] + 1, data_ + pos_[next_])) {
+                ++next_;
+                return spaceUntilNext(data_ + pos_[next_ - 1] + 1);
+            }
+            while (true) {
+                if (!on_element(pos_[next_ - 1] + 1)) {
+                    return false;
+                }
+                const char separator = take();
+                if (separator == ']') {
+                    return spaceUntilNext(data_ + pos_[next_ - 1] + 1);
+                }
+                if (separator != ',') {
+                    return false;
+                }
+            }
+        }
+
+        // 모르는 키의 값: 중첩된 객체/배열은 짝이 맞을 때까지, 문자열은 따옴표 두 개를 건너뛴다
+        bool skipValue() {
+            int depth = 0;
+            while (next_ < pos_.size()) {
+                const char c = data_[pos_[next_]];
+                if (depth == 0 && (c == ',' || c == '}')) {
+                    return true;
+                }
+                ++next_;
+                if (c == '"') {
+                    ++next_;
+                } else if (c == '{' || c == '[') {
+                    ++depth;
+                } else if (c == '}' || c == ']') {
+                    if (--depth < 0) {
+                        return false;
+                    }
+                }
+            }
+            return false;
+        }
+
+        const char* data_;
+        size_t length_;
+        const std::vector<uint32_t>& pos_;
+        size_t next_{0};
+    };
+
+    bool fail(std::string& error, const char* reason) {
+        error = reason;
+        return false;
+    }
+
+    void appendField(std::string& out, const char* name, const char* data, size_t length) {
+        out += ",\"";
+        out += name;
+        out += "\":\"";
+        json::appendEscaped(out, data, length);
+        out += '"';
+    }
+}
+
+namespace json {
+
+bool StructuralIndex::build(const char* data, size_t length) {
+    positions_.clear();
+    in_string_ = false;
+    escaped_ = false;
+
+    size_t offset = 0;
+    for (; offset + BLOCK <= length; offset += BLOCK) {
+        const BlockMasks masks = classify(data + offset);
+        addBlock(offset, masks.quotes, masks.backslashes, masks.structurals);
+    }
+    if (offset < length) {
+        // 마지막 조각은 공백으로 채운 블록으로 (공백은 어떤 마스크에도 걸리지 않음)
+        char tail[BLOCK];
+        memset(tail, ' ', BLOCK);
+        memcpy(tail, data + offset, length - offset);
+        const BlockMasks masks = classify(tail);
+        addBlock(offset, masks.quotes, masks.backslashes, masks.structurals);
+    }
+    return !in_string_;
+}
+
+void StructuralIndex::addBlock(size_t offset, uint32_t quotes, uint32_t backslashes, uint32_t structurals) {
+    // 역슬래시 바로 다음 바이트는 이스케이프됨 (역슬래시가 연속되면 짝수 번째는 이스케이프를 시작하지 않는다).
+    // 역슬래시가 있는 블록에서만 비트 단위로 따라간다
+    if (backslashes != 0 || escaped_) {
+        uint32_t escaped_bits = 0;
+        bool carry = escaped_;
+        for (unsigned i = 0; i < BLOCK; ++i) {
+            if (carry) {
+                escaped_bits |= 1u << i;
+                carry = false;
+            } else if (backslashes & (1u << i)) {
+                carry = true;
+            }
+        }
+        escaped_ = carry;
+        quotes &= ~escaped_bits;
+    }
+
+    // 따옴표의 누적 XOR: 문자열 안(여는 따옴표 포함, 닫는 따옴표 제외)이면 1
+    uint32_t inside = quotes;
+    inside ^= inside << 1;
+    inside ^= inside << 2;
+    inside ^= inside << 4;
+    inside ^= inside << 8;
+    if (in_string_) {
+        inside = ~inside;
+    }
+    inside &= 0xFFFF;
+    in_string_ = (__builtin_popcount(quotes) & 1) ? !in_string_ : in_string_;
+
+    uint32_t marks = (structurals & ~inside) | quotes;
+    while (marks != 0) {
+        positions_.push_back(static_cast<uint32_t>(offset + __builtin_ctz(marks)));
+        marks &= marks - 1;
+    }
+}
+
+bool decode(const char* line, size_t length, ChatMessage& out, std::string& error) {
+    StructuralIndex index;
+    if (!index.build(line, length)) {
+        return fail(error, "unterminated string");
+    }
+    Request request;
+    if (!Parser(line, length, index.positions()).parse(request, error)) {
+        return false;
+    }
+
+    const std::string& type = request.type;
+    if (type == "join") {
+        if (!request.has_room) {
+            return fail(error, "join needs \"room\"");
+        }
+        if (!command::JoinRequestBuilder(out, MessageType::CLIENT_JOIN)
+                 .session_id(request.room).token(request.token).finish()) {
+            return fail(error, "token too long");
+        }
+        return true;
+    }
+    if (type == "leave") {
+        if (!request.has_room) {
+            out.type = MessageType::CLIENT_LEAVE;
+            out.length = 0;
+            return true;
+        }
+        return command::LeaveRequestBuilder(out, MessageType::CLIENT_LEAVE).room_id(request.room).finish();
+    }
+    if (type == "chat" || type == "command") {
+        if (!request.has_text || request.text.empty()) {
+            return fail(error, "missing \"text\"");
+        }
+        if (type == "chat" && request.has_room) {
+            if (!command::RoomChatBuilder(out, MessageType::CLIENT_ROOM_CHAT)
+                     .room_id(request.room).text(request.text).finish()) {
+                return fail(error, "text too long");
+            }
+            return true;
+        }
+        // 첫 바이트가 0x01..0x1F인 명령은 이진 하위 명령이므로 JSON으로는 받지 않는다
+        if (type == "command" && command::isBinary(request.text.data(), request.text.size())) {
+            return fail(error, "binary commands are not available over JSON");
+        }
+        if (request.text.size() > sizeof(out.data)) {
+            return fail(error, "text too long");
+        }
+        out.type = type == "chat" ? MessageType::CLIENT_CHAT : MessageType::CLIENT_COMMAND;
+        out.length = static_cast<uint16_t>(request.text.size());
+        memcpy(out.data, request.text.data(), request.text.size());
+        return true;
+    }
+    if (type == "multicast") {
+        std::string users;
+        for (const std::string& user : request.users) {
+            if (user.empty() || user.find(',') != std::string::npos) {
+                return fail(error, "bad user id");
+            }
+            users += users.empty() ? "" : ",";
+            users += user;
+        }
+        command::MulticastBuilder builder(out, MessageType::CLIENT_MULTICAST);
+        for (int32_t room : request.rooms) {
+            builder.add_rooms(room);
+        }
+        if (!builder.users(users).text(request.text).finish()) {
+            return fail(error, "multicast too long");
+        }
+        return true;
+    }
+    return fail(error, type.empty() ? "missing \"type\"" : "unknown type");
+}
+
+void appendEscaped(std::string& out, const char* data, size_t length) {
+    static const char DIGITS[] = "0123456789abcdef";
+    while (length > 0) {
+        const size_t plain = findEscape(data, length);
+        out.append(data, plain);
+        if (plain == length) {
+            return;
+        }
+        const unsigned char c = static_cast<unsigned char>(data[plain]);
+        switch (c) {
+            case '"': out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\n': out += "\\n"; break;
+            case '\r': out += "\\r"; break;
+            case '\t': out += "\\t"; break;
+            default:
+                out += "\\u00";
+                out += DIGITS[c >> 4];
+                out += DIGITS[c & 0x0F];
+                break;
+        }
+        data += plain + 1;
+        length -= plain + 1;
+    }
+}
+
+std::string encode(const ChatMessage& message) {
+    const size_t length = std::min<size_t>(message.length, sizeof(message.data));
+    std::string out;
+    out.reserve(length + 48);
+
+    switch (message.type) {
+        case MessageType::SERVER_CHAT:
+            out += "{\"type\":\"chat\"";
+            appendField(out, "text", message.data, length);
+            break;
+
+        case MessageType::SERVER_ROOM_CHAT: {
+            command::RoomChat chat;
+            if (chat.parse(message.data, length)) {
+                out += "{\"type\":\"chat\",\"room\":" + std::to_string(chat.room_id());
+                appendField(out, "text", chat.text().data(), chat.text().size());
+            } else {
+                out += "{\"type\":\"chat\"";
+                appendField(out, "text", message.data, length);
+            }
+            break;
+        }
+
+        case MessageType::SERVER_ACK:
+        case MessageType::SERVER_ERROR:
+        case MessageType::SERVER_NOTIFICATION:
+            out += message.type == MessageType::SERVER_ACK ? "{\"type\":\"ack\""
+                 : message.type == MessageType::SERVER_ERROR ? "{\"type\":\"error\""
+                 : "{\"type\":\"notification\"";
+            appendField(out, "text", message.data, length);
+            break;
+
+        case MessageType::SERVER_RECONNECT: {
+            ReconnectHint hint{};
+            memcpy(&hint, message.data, std::min(length, sizeof(hint)));
+            out += "{\"type\":\"reconnect\"";
+            appendField(out, "address", hint.address, strnlen(hint.address, sizeof(hint.address)));
+            out += ",\"retry_after_ms\":" + std::to_string(hint.retry_after_ms);
+            break;
+        }
+
+        default:
+            // 이진 응답(SERVER_COMMAND 등)은 본문을 hex로
+            out += message.type == MessageType::SERVER_COMMAND ? "{\"type\":\"command\""
+                 : "{\"type\":\"frame\",\"code\":" + std::to_string(static_cast<int>(message.type));
+            out += ",\"data\":\"";
+            appendHex(out, message.data, length);
+            out += '"';
+            break;
+    }
+    out += "}\n";
+    return out;
+}
+
+}  // namespace json
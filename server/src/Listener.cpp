@@ -1,8 +1,17 @@
 #include "Listener.h"
 #include "SessionManager.h"
+#include "TokenAuth.h"
+#include "RoomDirectory.h"
 #include "Logger.h"
 #include <stdexcept>
 #include "Context.h"
+#include "IpBlocklist.h"
+#include "CommandCodec.h"
+#include "JsonCodec.h"
+#include <algorithm>
+#include <arpa/inet.h>
+#include <sys/socket.h>
+#include <cstring>
 
 namespace {
     Operation getContext(io_uring_cqe* cqe) {
@@ -19,9 +28,81 @@ namespace {
     }
 }
 
-Listener::Listener(int port, SocketManager& socket_manager)
-    : port_(port), running_(false), socket_manager_(socket_manager) {
+int32_t Listener::peekJoinSession(int client_fd) {
+    ChatMessage message{};
+    ssize_t n;
+    if (format_ == WireFormat::JSON) {
+        // 첫 줄이 join이면 같은 의미의 프레임으로 바꿔 본다
+        char line[JsonLineAssembler::MAX_LINE];
+        n = recv(client_fd, line, sizeof(line), MSG_PEEK | MSG_DONTWAIT);
+        const char* newline = n > 0 ? static_cast<const char*>(memchr(line, '\n', n)) : nullptr;
+        std::string error;
+        if (!newline || !json::decode(line, newline - line, message, error)) {
+            return -1;
+        }
+        n = sizeof(message);
+    } else {
+        n = recv(client_fd, &message, sizeof(message), MSG_PEEK | MSG_DONTWAIT);
+    }
+    command::JoinRequest join;
+    if (n != static_cast<ssize_t>(sizeof(message)) || message.type != MessageType::CLIENT_JOIN ||
+        !join.parse(message.data, std::min<size_t>(message.length, sizeof(message.data)))) {
+        return -1;
+    }
+
+    // 프레임은 소비하지 않는다: 세션 링이 그대로 읽어 인증/ACK 처리
+    return join.session_id();
+}
+
+bool Listener::admitClient(int client_fd) {
+    try {
+        // SYN/첫 세그먼트에 JOIN이 실려 왔으면 요청 세션에, 아니면 가장 한가한 세션에 할당
+        int32_t session_id = peekJoinSession(client_fd);
+        if (session_id < 0 || !SessionManager::getInstance().getSessionIOUring(session_id)) {
+            session_id = SessionManager::getInstance().getNextAvailableSession();
+        }
+        LOG_DEBUG("[Listener] Selected session ", session_id, " for client ", client_fd);
+
+        // 클라이언트를 세션에 추가. 인증이 켜져 있으면 I/O만 배정하고 방 참가는 토큰 검증 뒤에.
+        // 클러스터 모드도 마찬가지: 다른 노드가 소유한 방의 JOIN은 이 노드의 방에 넣지 않고 안내해야 한다
+        if (TokenAuth::getInstance().isEnabled() || RoomDirectory::getInstance().getLocalNode() != 0) {
+            SessionManager::getInstance().assignSession(client_fd, session_id, format_);
+        } else {
+            SessionManager::getInstance().joinSession(client_fd, session_id, format_);
+        }
+
+        LOG_INFO("[Listener] Successfully assigned client ", client_fd, " to session ", session_id);
+        return true;
+    }
+    catch (const std::exception& e) {
+        LOG_ERROR("[Listener] Failed to assign client to session: ", e.what());
+        close(client_fd);  // 세션 할당 실패 시 연결 종료
+        return false;
+    }
+}
+
+bool Listener::isBlockedPeer(int client_fd) {
+    // multishot accept는 주소 버퍼 하나를 모든 완료가 덮어쓰므로 배치 처리 중에는 연결별로 조회
+    sockaddr_in addr{};
+    socklen_t addr_len = sizeof(addr);
+    if (getpeername(client_fd, reinterpret_cast<sockaddr*>(&addr), &addr_len) < 0 || addr.sin_family != AF_INET) {
+        return false;
+    }
+
+    Cidr range;
+    if (!AcceptFilter::getInstance().isBlocked(ntohl(addr.sin_addr.s_addr), range)) {
+        return false;
+    }
+    char text[INET_ADDRSTRLEN] = {0};
+    inet_ntop(AF_INET, &addr.sin_addr, text, sizeof(text));
+    LOG_DEBUG("[Listener] Rejected ", text, " (blocklist ", range.toString(), ")");
+    return true;
+}
+
+Listener::Listener(int port, SocketManager& socket_manager, WireFormat format)
+    : port_(port), format_(format), running_(false), socket_manager_(socket_manager) {
     io_ring_ = std::make_unique<IOUring>();
+    io_ring_->setWorkerName(format == WireFormat::JSON ? "json listener" : "listener");
     LOG_INFO("[Listener] Created with dedicated IOUring");
 }
 
@@ -42,10 +123,15 @@ void Listener::start() {
 
     running_ = true;
     io_ring_->prepareAccept(listening_socket);
+    // processEvents가 다른 쓰레드에서 돌 수도 있으므로 (JSON 리스너) accept는 여기서 바로 제출
+    io_ring_->submit();
 }
 
 void Listener::processEvents() {
-    while (running_) {
+    // 리스너마다 자기 쓰레드에서 차단 목록을 조회하므로 각자 reader로 등록한다
+    blocklist_reader_ = AcceptFilter::getInstance().registerReader();
+    while (running_ && !stop_requested_.load(std::memory_order_acquire)) {
+        io_ring_->countLoopIteration();
         io_uring_cqe* cqes[IOUring::CQE_BATCH_SIZE];
         unsigned num_cqes = io_ring_->peekCQE(cqes);
         
@@ -62,6 +148,7 @@ void Listener::processEvents() {
         for (unsigned i = 0; i < num_cqes; ++i) {
             io_uring_cqe* cqe = cqes[i];
             const auto ctx = getContext(cqe);
+            io_ring_->recordEvent(cqe);
             
             LOG_TRACE("[Listener] Processing event type: ", static_cast<int>(ctx.op_type));
             
@@ -73,21 +160,14 @@ void Listener::processEvents() {
                 }
                 
                 LOG_DEBUG("[Listener] Accepted new connection: fd=", client_fd);
-                
-                try {
-                    // 항상 세션 1에 할당
-                    int32_t session_id = SessionManager::getInstance().getNextAvailableSession();
-                    LOG_DEBUG("[Listener] Selected session ", session_id, " for client ", client_fd);
-                    
-                    // 클라이언트를 세션에 추가
-                    SessionManager::getInstance().joinSession(client_fd, session_id);
-                    
-                    LOG_INFO("[Listener] Successfully assigned client ", client_fd, " to session ", session_id);
-                }
-                catch (const std::exception& e) {
-                    LOG_ERROR("[Listener] Failed to assign client to session: ", e.what());
-                    close(client_fd);  // 세션 할당 실패 시 연결 종료
+                if (isBlockedPeer(client_fd)) {
+                    close(client_fd);
+                    continue;
                 }
+                SocketTuner::applyProfile(client_fd);
+                admitClient(client_fd);
+            } else if (ctx.op_type == OperationType::DRAIN) {
+                io_ring_->handleControl(cqe);
             } else {
                 LOG_DEBUG("[Listener] Ignoring non-accept event type: ", static_cast<int>(ctx.op_type));
             }
@@ -97,12 +177,22 @@ void Listener::processEvents() {
             io_ring_->advanceCQ(num_cqes);
             LOG_TRACE("[Listener] Processed ", num_cqes, " events");
         }
+        // 배치 사이에는 이 쓰레드가 잡고 있는 목록이 없다: epoch를 알리고 모두 지나간 이전 목록을 해제
+        AcceptFilter::getInstance().reclaim(blocklist_reader_);
     }
+    AcceptFilter::getInstance().unregisterReader(blocklist_reader_);
+}
+
+void Listener::requestStop() {
+    stop_requested_.store(true, std::memory_order_release);
+    io_ring_->notify();
 }
 
 void Listener::stop() {
     if (!running_) return;
     running_ = false;
+    // 링을 먼저 정리해 걸려 있던 multishot accept를 놓은 뒤 소켓을 닫는다 (이후 접속은 거부됨)
     io_ring_.reset();
+    socket_manager_.closeListeningSocket();
     LOG_INFO("[Listener] Server stopped");
 } 
\ No newline at end of file
@@ -0,0 +1,114 @@
+#include "OutboundQueue.h"
+#include <algorithm>
+
+size_t OutboundQueue::stage(int64_t now_ns, size_t& skipped) {
+    if (inFlight()) {
+        return 0;
+    }
+
+    offset_ = 0;
+    frames_done_ = 0;
+    frame_ends_.clear();
+
+    size_t staged = 0;
+    while (!pending_.empty() && staged < MAX_BATCH_FRAMES) {
+        OutboundFrame& frame = pending_.front();
+        if (expired(frame, now_ns)) {
+            skipped++;
+            skipped_++;
+        } else if (frame.pipe || frame.file) {
+            if (staged > 0) {
+                break;   // 앞의 프레임들을 먼저 write
+            }
+            if (frame.pipe) {
+                splice_frame_ = std::move(frame.pipe);
+                splice_remaining_ = splice_frame_->length();
+            } else {
+                splice_file_ = std::move(frame.file);
+                file_offset_ = 0;
+                splice_remaining_ = 0;   // nextFileChunk에서 채움
+            }
+            popFront();
+            break;
+        } else if (frame.text) {
+            staging_.insert(staging_.end(), frame.text->begin(), frame.text->end());
+            frame_ends_.push_back(staging_.size());
+            staged++;
+        } else {
+            const auto* bytes = reinterpret_cast<const uint8_t*>(frame.message.get());
+            staging_.insert(staging_.end(), bytes, bytes + sizeof(ChatMessage));
+            frame_ends_.push_back(staging_.size());
+            staged++;
+        }
+        popFront();
+    }
+    return staging_.size();
+}
+
+size_t OutboundQueue::pruneExpired(int64_t now_ns) {
+    size_t pruned = 0;
+    while (!pending_.empty() && expired(pending_.front(), now_ns)) {
+        popFront();
+        pruned++;
+    }
+    skipped_ += pruned;
+    return pruned;
+}
+
+size_t OutboundQueue::complete(size_t bytes, size_t& frames_sent) {
+    offset_ += bytes;
+    if (offset_ > staging_.size()) {
+        offset_ = staging_.size();
+    }
+
+    while (frames_done_ < frame_ends_.size() && frame_ends_[frames_done_] <= offset_) {
+        frames_done_++;
+        frames_sent++;
+    }
+
+    if (offset_ == staging_.size()) {
+        staging_.clear();
+        frame_ends_.clear();
+        offset_ = 0;
+        frames_done_ = 0;
+    }
+    return remaining();
+}
+
+unsigned OutboundQueue::nextFileChunk(unsigned max_bytes, uint64_t& offset) {
+    offset = file_offset_;
+    const uint64_t left = splice_file_ ? splice_file_->size() - file_offset_ : 0;
+    splice_remaining_ = static_cast<unsigned>(std::min<uint64_t>(left, max_bytes));
+    file_offset_ += splice_remaining_;
+    return splice_remaining_;
+}
+
+SpliceProgress OutboundQueue::completeSplice(size_t bytes) {
+    splice_remaining_ -= static_cast<unsigned>(std::min<size_t>(bytes, splice_remaining_));
+    if (splice_remaining_ > 0) {
+        return SpliceProgress::PARTIAL;
+    }
+    if (splice_file_ && file_offset_ < splice_file_->size()) {
+        return SpliceProgress::NEXT_CHUNK;
+    }
+    abortSplice();
+    return SpliceProgress::DONE;
+}
+
+void OutboundQueue::abortSplice() {
+    splice_frame_.reset();
+    splice_file_.reset();
+    file_offset_ = 0;
+    splice_remaining_ = 0;
+}
+
+void OutboundQueue::resetInFlight() {
+    staging_.clear();
+    frame_ends_.clear();
+    offset_ = 0;
+    frames_done_ = 0;
+    abortSplice();
+    zc_result = 0;
+    fill_failed = false;
+    pipe.reset();   // 연결 파이프에 남은 바이트도 함께 버림
+}
@@ -0,0 +1,117 @@
+#include "PipeFanout.h"
+#include "Logger.h"
+#include <fcntl.h>
+#include <algorithm>
+#include <unistd.h>
+#include <cstdlib>
+#include <stdexcept>
+
+PipePair& PipePair::operator=(PipePair&& other) noexcept {
+    if (this != &other) {
+        reset();
+        read_fd_ = other.read_fd_;
+        write_fd_ = other.write_fd_;
+        other.read_fd_ = other.write_fd_ = -1;
+    }
+    return *this;
+}
+
+bool PipePair::open() {
+    int fds[2];
+    if (pipe2(fds, O_NONBLOCK | O_CLOEXEC) < 0) {
+        return false;
+    }
+    reset();
+    read_fd_ = fds[0];
+    write_fd_ = fds[1];
+    return true;
+}
+
+void PipePair::reset() {
+    if (read_fd_ >= 0) close(read_fd_);
+    if (write_fd_ >= 0) close(write_fd_);
+    read_fd_ = write_fd_ = -1;
+}
+
+PipeFrame::~PipeFrame() {
+    owner_->recycle(std::move(pipe_), length_);
+}
+
+std::shared_ptr<const PipeFrame> PipeFanout::load(const void* data, unsigned length) {
+    PipePair pipe;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!pool_.empty()) {
+            pipe = std::move(pool_.back());
+            pool_.pop_back();
+        }
+    }
+    if (!pipe.isOpen() && !pipe.open()) {
+        LOG_WARN("Fan-out pipe creation failed, falling back to write");
+        return nullptr;
+    }
+
+    ssize_t written = write(pipe.writeFd(), data, length);
+    if (written != static_cast<ssize_t>(length)) {
+        // 부분 쓰기된 파이프는 재사용하지 않는다
+        return nullptr;
+    }
+    return std::make_shared<const PipeFrame>(this, std::move(pipe), length);
+}
+
+void PipeFanout::recycle(PipePair&& pipe, unsigned length) {
+    if (!pipe.isOpen()) {
+        return;
+    }
+
+    // tee는 원본을 소비하지 않으므로 비우고 나서 풀에 넣는다
+    char scratch[4096];
+    size_t left = length;
+    while (left > 0) {
+        ssize_t n = read(pipe.readFd(), scratch, std::min(left, sizeof(scratch)));
+        if (n <= 0) {
+            return;   // 비우지 못한 파이프는 닫는다 (PipePair 소멸)
+        }
+        left -= static_cast<size_t>(n);
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (pool_.size() < MAX_POOLED_PIPES) {
+        pool_.push_back(std::move(pipe));
+    }
+}
+
+FanoutMode PipeFanout::modeFromEnv() {
+    const char* value = std::getenv("CHAT_FANOUT");
+    return value ? parseMode(value) : FanoutMode::WRITE;
+}
+
+FanoutMode PipeFanout::parseMode(const std::string& name) {
+    if (name == "write") return FanoutMode::WRITE;
+    if (name == "splice") return FanoutMode::SPLICE;
+    if (name == "zc") return FanoutMode::SEND_ZC;
+    throw std::runtime_error("unknown fan-out mode: " + name);
+}
+
+const char* PipeFanout::modeName(FanoutMode mode) {
+    switch (mode) {
+        case FanoutMode::SPLICE: return "splice";
+        case FanoutMode::SEND_ZC: return "zc";
+        default: return "write";
+    }
+}
+
+unsigned PipeFanout::minPayloadFromEnv() {
+    const char* value = std::getenv("CHAT_FANOUT_MIN_PAYLOAD");
+    return value ? static_cast<unsigned>(std::strtoul(value, nullptr, 10)) : DEFAULT_MIN_PAYLOAD;
+}
+
+void PipeFanout::prepTee(io_uring_sqe* sqe, int src_pipe, int conn_pipe, unsigned length) {
+    io_uring_prep_tee(sqe, src_pipe, conn_pipe, length, SPLICE_F_NONBLOCK);
+    sqe->flags |= IOSQE_IO_LINK | IOSQE_CQE_SKIP_SUCCESS;
+}
+
+void PipeFanout::prepSpliceToSocket(io_uring_sqe* sqe, int conn_pipe, int socket_fd, unsigned length) {
+    // 소켓이 가득 차면 -EAGAIN으로 돌아와 POLLOUT 후 재시도 (io-wq 쓰레드를 붙잡지 않음)
+    io_uring_prep_splice(sqe, conn_pipe, -1, socket_fd, -1, length, SPLICE_F_NONBLOCK | SPLICE_F_MOVE);
+}
@@ -0,0 +1,54 @@
+#include "RaftLog.h"
+#include <algorithm>
+
+void RaftLog::truncate(uint64_t last_index) {
+    if (last_index < lastIndex()) {
+        entries_.resize(last_index);
+    }
+}
+
+bool RaftLog::isUpToDate(uint64_t last_log_index, uint64_t last_log_term) const {
+    const uint64_t last_term = termAt(lastIndex());
+    return last_log_term > last_term || (last_log_term == last_term && last_log_index >= lastIndex());
+}
+
+bool RaftLog::matches(uint64_t prev_index, uint64_t prev_term) const {
+    return prev_index <= lastIndex() && termAt(prev_index) == prev_term;
+}
+
+RaftLog::MergeResult RaftLog::merge(uint64_t prev_index, std::vector<Entry> entries) {
+    MergeResult result;
+    uint64_t index = prev_index;
+    for (Entry& entry : entries) {
+        ++index;
+        if (index <= lastIndex() && termAt(index) != entry.term) {
+            // 충돌한 항목부터 뒤를 버린다 (커밋된 항목은 충돌하지 않는다)
+            entries_.resize(index - 1);
+            result.truncated = true;
+        }
+        if (index > lastIndex()) {
+            entries_.push_back(std::move(entry));
+            if (result.first_new == 0) {
+                result.first_new = index;
+            }
+        }
+    }
+    result.last_index = index;
+    return result;
+}
+
+uint64_t RaftLog::majorityCommit(uint64_t commit_index, uint64_t current_term, const std::vector<uint64_t>& peer_match,
+                                 size_t majority) const {
+    for (uint64_t index = lastIndex(); index > commit_index; --index) {
+        // 이전 임기 항목은 복제 수로 커밋하지 않는다: 현재 임기 항목이 커밋될 때 함께 커밋된다
+        if (termAt(index) != current_term) {
+            break;
+        }
+        const size_t replicas = 1 + static_cast<size_t>(std::count_if(peer_match.begin(), peer_match.end(),
+            [index](uint64_t match) { return match >= index; }));
+        if (replicas >= majority) {
+            return index;
+        }
+    }
+    return commit_index;
+}
@@ -0,0 +1,747 @@
+#include "RaftNode.h"
+#include "Logger.h"
+#include "SessionManager.h"
+#include <algorithm>
+#include <arpa/inet.h>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <openssl/crypto.h>
+#include <openssl/evp.h>
+#include <openssl/hmac.h>
+#include <poll.h>
+#include <sstream>
+#include <stdexcept>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace {
+    constexpr int ADVERTISE_RETRY_MS = 1000;    // 주소 등록이 커밋되지 않았으면 다시 제안
+    constexpr size_t MAX_DESCRIBED_ROOMS = 16;
+    constexpr size_t MAX_DESCRIBE_LENGTH = 512;     // 알림 프레임 한 개
+
+    int64_t steadyMillis() {
+        return std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    bool parseAddress(const std::string& spec, sockaddr_in& address) {
+        const size_t colon = spec.rfind(':');
+        if (colon == std::string::npos) {
+            return false;
+        }
+        const unsigned long port = std::strtoul(spec.c_str() + colon + 1, nullptr, 10);
+        address = sockaddr_in{};
+        address.sin_family = AF_INET;
+        address.sin_port = htons(static_cast<uint16_t>(port));
+        return port != 0 && port <= UINT16_MAX &&
+               inet_pton(AF_INET, spec.substr(0, colon).c_str(), &address.sin_addr) == 1;
+    }
+
+    const char* roleName(RaftNode::Role role) {
+        switch (role) {
+            case RaftNode::Role::FOLLOWER: return "follower";
+            case RaftNode::Role::CANDIDATE: return "candidate";
+            case RaftNode::Role::LEADER: return "leader";
+        }
+        return "unknown";
+    }
+
+    // 임시 파일에 쓰고 fsync 후 교체 (중간에 죽어도 이전 내용이 남는다)
+    bool writeFileAtomically(const std::string& path, const std::string& contents) {
+        const std::string temp_path = path + ".tmp";
+        FILE* file = fopen(temp_path.c_str(), "wb");
+        if (!file) {
+            return false;
+        }
+        const bool written = fwrite(contents.data(), 1, contents.size(), file) == contents.size() &&
+                             fflush(file) == 0 && fsync(fileno(file)) == 0;
+        fclose(file);
+        return written && rename(temp_path.c_str(), path.c_str()) == 0;
+    }
+
+    void appendEntryBytes(std::string& out, uint64_t term, const std::string& command) {
+        RaftEntryHeader entry{term, static_cast<uint16_t>(std::min<size_t>(command.size(), UINT16_MAX))};
+        out.append(reinterpret_cast<const char*>(&entry), sizeof(entry));
+        out.append(command.data(), entry.length);
+    }
+}
+
+RaftNode::~RaftNode() {
+    stop();
+}
+
+void RaftNode::start(const std::string& default_advertise) {
+    const char* id = std::getenv("CHAT_RAFT_ID");
+    const char* peers = std::getenv("CHAT_RAFT_PEERS");
+    if (!id || !peers) {
+        return;
+    }
+    node_id_ = static_cast<uint32_t>(std::strtoul(id, nullptr, 10));
+    if (node_id_ == 0) {
+        throw std::runtime_error("CHAT_RAFT_ID must be a positive node id");
+    }
+
+    sockaddr_in bind_address{};
+    bool found_self = false;
+    std::istringstream list(peers);
+    std::string spec;
+    while (std::getline(list, spec, ',')) {
+        const size_t equals = spec.find('=');
+        Peer peer;
+        peer.id = equals == std::string::npos ? 0 : static_cast<uint32_t>(std::strtoul(spec.c_str(), nullptr, 10));
+        if (peer.id == 0 || !parseAddress(spec.substr(equals + 1), peer.address)) {
+            throw std::runtime_error("CHAT_RAFT_PEERS entry must be id=ip:port, got '" + spec + "'");
+        }
+        if (peer.id == node_id_) {
+            bind_address = peer.address;
+            found_self = true;
+        } else {
+            peers_.push_back(peer);
+        }
+    }
+    if (!found_self) {
+        throw std::runtime_error("CHAT_RAFT_PEERS does not list this node (" + std::to_string(node_id_) + ")");
+    }
+
+    const char* advertise = std::getenv("CHAT_RAFT_ADVERTISE");
+    advertise_ = advertise ? advertise : default_advertise;
+    if (const char* secret = std::getenv("CHAT_RAFT_SECRET")) {
+        secret_ = secret;
+    }
+    if (const char* dir = std::getenv("CHAT_RAFT_DIR")) {
+        data_dir_ = dir;
+    } else {
+        LOG_WARN("[Raft] CHAT_RAFT_DIR not set, term/vote/log kept in memory only");
+    }
+    loadState();
+
+    // 피어들이 보낸 쪽 주소:포트로 이 노드를 확인하므로 설정된 주소 그대로 bind한다
+    socket_fd_ = socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (socket_fd_ < 0 || bind(socket_fd_, reinterpret_cast<sockaddr*>(&bind_address), sizeof(bind_address)) < 0) {
+        const std::string reason = strerror(errno);
+        if (socket_fd_ >= 0) {
+            close(socket_fd_);
+            socket_fd_ = -1;
+        }
+        throw std::runtime_error("Failed to bind Raft address " + std::string(inet_ntoa(bind_address.sin_addr)) + ":" +
+                                 std::to_string(ntohs(bind_address.sin_port)) + ": " + reason);
+    }
+
+    RoomDirectory::getInstance().setLocalNode(node_id_);
+    LOG_INFO("[Raft] Node ", node_id_, " of ", peers_.size() + 1, " on ", inet_ntoa(bind_address.sin_addr), ":",
+             ntohs(bind_address.sin_port), " (term ", current_term_, ", ", lastIndex(), " log entries, advertising ",
+             advertise_, secret_.empty() ? ", unauthenticated)" : ")");
+    thread_ = std::thread([this] { run(); });
+}
+
+void RaftNode::stop() {
+    should_stop_.store(true, std::memory_order_release);
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+    if (socket_fd_ >= 0) {
+        close(socket_fd_);
+        socket_fd_ = -1;
+    }
+}
+
+bool RaftNode::propose(const DirectoryCommand& command, const std::string& address) {
+    if (!isEnabled()) {
+        return false;
+    }
+    std::lock_guard<std::mutex> lock(proposals_mutex_);
+    proposals_.push_back(RoomDirectory::encode(command, address));
+    return true;
+}
+
+void RaftNode::run() {
+    resetElectionTimer(steadyMillis());
+    while (!should_stop_.load(std::memory_order_acquire)) {
+        pollfd waiting{socket_fd_, POLLIN, 0};
+        poll(&waiting, 1, TICK_MS);
+        const int64_t now_ms = steadyMillis();
+        receive(now_ms);
+        tick(now_ms);
+    }
+}
+
+void RaftNode::tick(int64_t now_ms) {
+    // 자기 클라이언트 주소가 디렉터리에 없으면 (재)등록을 제안한다
+    if (!advertise_.empty() && leader_id_ != 0 && now_ms - last_advertise_ms_ >= ADVERTISE_RETRY_MS &&
+        state_.nodeAddress(node_id_) != advertise_) {
+        last_advertise_ms_ = now_ms;
+        DirectoryCommand command{DirectoryOp::SET_NODE, 0, node_id_, 0, 0};
+        propose(command, advertise_);
+    }
+    drainProposals(now_ms);
+
+    if (role_ == Role::LEADER) {
+        if (replicate_now_ || now_ms - last_heartbeat_ms_ >= HEARTBEAT_MS) {
+            for (Peer& peer : peers_) {
+                sendAppend(peer);
+            }
+            last_heartbeat_ms_ = now_ms;
+            replicate_now_ = false;
+        }
+        advanceCommit();
+    } else if (now_ms >= election_deadline_ms_) {
+        becomeCandidate(now_ms);
+    }
+    applyCommitted();
+
+    std::ostringstream status;
+    status << "node=" << node_id_ << " role=" << roleName(role_) << " term=" << current_term_
+           << " leader=" << leader_id_ << " log=" << lastIndex() << " commit=" << commit_index_
+           << " applied=" << last_applied_ << " forwarding=" << forwarded_.size()
+           << " proposals_failed=" << proposals_failed_ << " rejected=" << messages_rejected_;
+    std::lock_guard<std::mutex> lock(status_mutex_);
+    status_ = status.str();
+}
+
+void RaftNode::drainProposals(int64_t now_ms) {
+    std::vector<std::string> proposals;
+    {
+        std::lock_guard<std::mutex> lock(proposals_mutex_);
+        proposals.swap(proposals_);
+    }
+    for (auto& command : proposals) {
+        if (role_ != Role::LEADER) {
+            forwarded_.push_back(ForwardedProposal{next_proposal_id_++, std::move(command), 0, 0});
+        } else if (!appendLocal(std::move(command))) {
+            ++proposals_failed_;
+        }
+    }
+    forwardProposals(now_ms);
+}
+
+void RaftNode::forwardProposals(int64_t now_ms) {
+    if (forwarded_.empty()) {
+        return;
+    }
+    if (role_ == Role::LEADER) {
+        // 기다리는 사이 이 노드가 리더가 됨: 직접 붙인다
+        for (auto& proposal : forwarded_) {
+            if (!appendLocal(std::move(proposal.command))) {
+                ++proposals_failed_;
+            }
+        }
+        forwarded_.clear();
+        return;
+    }
+
+    auto leader = std::find_if(peers_.begin(), peers_.end(), [this](const Peer& peer) { return peer.id == leader_id_; });
+    if (leader == peers_.end()) {
+        return;     // 리더가 정해질 때까지 보관
+    }
+    // 응답이 유실돼 같은 제안이 두 번 붙을 수 있지만 디렉터리 명령은 다시 적용해도 결과가 같다
+    for (auto it = forwarded_.begin(); it != forwarded_.end();) {
+        if (it->attempts > 0 && now_ms - it->sent_ms < PROPOSAL_TIMEOUT_MS) {
+            ++it;
+            continue;
+        }
+        if (it->attempts >= MAX_PROPOSAL_ATTEMPTS) {
+            LOG_WARN("[Raft] Dropping directory proposal ", it->id, " after ", it->attempts,
+                     " attempts (leader ", leader_id_, ")");
+            ++proposals_failed_;
+            it = forwarded_.erase(it);
+            continue;
+        }
+        RaftProposal proposal{it->id};
+        sendTo(*leader, makeHeader(RaftMessageType::PROPOSAL) +
+                        std::string(reinterpret_cast<const char*>(&proposal), sizeof(proposal)) + it->command);
+        it->sent_ms = now_ms;
+        ++it->attempts;
+        ++it;
+    }
+}
+
+void RaftNode::receive(int64_t now_ms) {
+    char buffer[MAX_DATAGRAM + RAFT_MAC_SIZE];
+    while (true) {
+        sockaddr_in source{};
+        socklen_t source_length = sizeof(source);
+        const ssize_t received = recvfrom(socket_fd_, buffer, sizeof(buffer), 0,
+                                          reinterpret_cast<sockaddr*>(&source), &source_length);
+        if (received < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return;
+        }
+        size_t message_length = static_cast<size_t>(received);
+        if (message_length < sizeof(RaftHeader) + (secret_.empty() ? 0 : RAFT_MAC_SIZE)) {
+            continue;
+        }
+
+        RaftHeader header;
+        std::memcpy(&header, buffer, sizeof(header));
+        // from은 보낸 쪽이 적는 값일 뿐이므로 실제 보낸 주소:포트가 그 노드의 설정과 같아야 한다
+        auto peer = std::find_if(peers_.begin(), peers_.end(), [&header](const Peer& p) { return p.id == header.from; });
+        if (peer == peers_.end() || source.sin_family != AF_INET ||
+            source.sin_addr.s_addr != peer->address.sin_addr.s_addr || source.sin_port != peer->address.sin_port) {
+            ++messages_rejected_;
+            LOG_DEBUG("[Raft] Ignoring message claiming node ", header.from, " from ", inet_ntoa(source.sin_addr), ":",
+                      ntohs(source.sin_port));
+            continue;
+        }
+        if (!secret_.empty()) {
+            message_length -= RAFT_MAC_SIZE;
+            const std::string expected = computeMac(buffer, message_length);
+            if (expected.size() != RAFT_MAC_SIZE ||
+                CRYPTO_memcmp(expected.data(), buffer + message_length, RAFT_MAC_SIZE) != 0) {
+                ++messages_rejected_;
+                LOG_DEBUG("[Raft] Ignoring message with bad MAC from node ", header.from);
+                continue;
+            }
+        }
+
+        // 더 높은 임기를 보면 즉시 팔로워로
+        if (header.term > current_term_) {
+            becomeFollower(header.term, now_ms);
+            leader_id_ = 0;
+        }
+
+        const char* body = buffer + sizeof(header);
+        const size_t length = message_length - sizeof(header);
+        switch (header.type) {
+            case RaftMessageType::VOTE_REQUEST:
+                handleVoteRequest(header, body, length, *peer, now_ms);
+                break;
+            case RaftMessageType::VOTE_REPLY:
+                handleVoteReply(header, body, length, *peer);
+                break;
+            case RaftMessageType::APPEND_REQUEST:
+                handleAppendRequest(header, body, length, *peer, now_ms);
+                break;
+            case RaftMessageType::APPEND_REPLY:
+                handleAppendReply(header, body, length, *peer);
+                break;
+            case RaftMessageType::PROPOSAL:
+                handleProposal(body, length, *peer);
+                break;
+            case RaftMessageType::PROPOSAL_REPLY:
+                handleProposalReply(body, length);
+                break;
+            default:
+                LOG_DEBUG("[Raft] Unknown message type ", static_cast<int>(header.type));
+                break;
+        }
+    }
+}
+
+void RaftNode::handleVoteRequest(const RaftHeader& header, const char* body, size_t length, Peer& peer,
+                                 int64_t now_ms) {
+    if (length < sizeof(RaftVoteRequest)) {
+        return;
+    }
+    RaftVoteRequest request;
+    std::memcpy(&request, body, sizeof(request));
+
+    RaftVoteReply reply{0};
+    if (header.term == current_term_ && (voted_for_ == 0 || voted_for_ == peer.id) &&
+        log_.isUpToDate(request.last_log_index, request.last_log_term)) {
+        const uint32_t previous_vote = voted_for_;
+        voted_for_ = peer.id;
+        if (persistMeta()) {
+            resetElectionTimer(now_ms);
+            reply.granted = 1;
+        } else {
+            // 기록되지 않은 투표는 재시작하면 잊혀 같은 임기에 두 번 투표할 수 있다
+            voted_for_ = previous_vote;
+        }
+    }
+    sendTo(peer, makeHeader(RaftMessageType::VOTE_REPLY) +
+                 std::string(reinterpret_cast<const char*>(&reply), sizeof(reply)));
+}
+
+void RaftNode::handleVoteReply(const RaftHeader& header, const char* body, size_t length, Peer& peer) {
+    if (length < sizeof(RaftVoteReply) || role_ != Role::CANDIDATE || header.term != current_term_ || !body[0]) {
+        return;
+    }
+    peer.vote_granted = true;
+    const size_t votes = 1 + static_cast<size_t>(std::count_if(peers_.begin(), peers_.end(),
+                                                               [](const Peer& p) { return p.vote_granted; }));
+    if (votes >= majority()) {
+        becomeLeader();
+    }
+}
+
+void RaftNode::handleAppendRequest(const RaftHeader& header, const char* body, size_t length, Peer& peer,
+                                   int64_t now_ms) {
+    RaftAppendReply reply{0, lastIndex()};
+    auto respond = [this, &peer, &reply]() {
+        sendTo(peer, makeHeader(RaftMessageType::APPEND_REPLY) +
+                     std::string(reinterpret_cast<const char*>(&reply), sizeof(reply)));
+    };
+
+    if (length < sizeof(RaftAppendRequest) || header.term < current_term_) {
+        respond();
+        return;
+    }
+    role_ = Role::FOLLOWER;
+    leader_id_ = peer.id;
+    resetElectionTimer(now_ms);
+
+    RaftAppendRequest request;
+    std::memcpy(&request, body, sizeof(request));
+    if (!log_.matches(request.prev_log_index, request.prev_log_term)) {
+        // 일치하지 않는 지점 앞까지 되감도록 힌트를 준다
+        reply.match_index = std::min(lastIndex(), request.prev_log_index > 0 ? request.prev_log_index - 1 : 0);
+        respond();
+        return;
+    }
+
+    std::vector<RaftLog::Entry> entries;
+    size_t offset = sizeof(request);
+    for (uint16_t i = 0; i < request.count; ++i) {
+        RaftEntryHeader entry;
+        if (length - offset < sizeof(entry)) {
+            break;
+        }
+        std::memcpy(&entry, body + offset, sizeof(entry));
+        offset += sizeof(entry);
+        if (length - offset < entry.length) {
+            break;
+        }
+        entries.push_back(RaftLog::Entry{entry.term, std::string(body + offset, entry.length)});
+        offset += entry.length;
+    }
+    const RaftLog::MergeResult merged = log_.merge(request.prev_log_index, std::move(entries));
+    const bool persisted = merged.truncated ? persistRewrite() : merged.first_new == 0 || persistAppend(merged.first_new);
+    if (!persisted) {
+        // 저장하지 못한 항목은 받지 않은 것으로 하고 리더가 다시 보내게 한다
+        log_.truncate(merged.first_new - 1);
+        rewrite_log_ = true;
+        reply.match_index = lastIndex();
+        respond();
+        return;
+    }
+
+    // 순서가 바뀌어 늦게 온 요청은 index가 작을 수 있다: 커밋 지점은 앞으로만 옮긴다
+    commit_index_ = std::max(commit_index_, std::min(request.leader_commit, merged.last_index));
+    reply.success = 1;
+    reply.match_index = merged.last_index;
+    respond();
+}
+
+void RaftNode::handleAppendReply(const RaftHeader& header, const char* body, size_t length, Peer& peer) {
+    if (length < sizeof(RaftAppendReply) || role_ != Role::LEADER || header.term != current_term_) {
+        return;
+    }
+    RaftAppendReply reply;
+    std::memcpy(&reply, body, sizeof(reply));
+
+    if (reply.success) {
+        peer.match_index = std::max(peer.match_index, reply.match_index);
+        peer.next_index = peer.match_index + 1;
+        advanceCommit();
+        if (peer.next_index <= lastIndex()) {
+            sendAppend(peer);   // 따라잡는 중: 다음 묶음
+        }
+    } else {
+        peer.next_index = std::max<uint64_t>(1, std::min(peer.next_index - 1, reply.match_index + 1));
+        sendAppend(peer);
+    }
+}
+
+void RaftNode::handleProposal(const char* body, size_t length, Peer& peer) {
+    if (length < sizeof(RaftProposal) + sizeof(DirectoryCommand)) {
+        return;
+    }
+    RaftProposalReply reply{0, 0};
+    std::memcpy(&reply.proposal_id, body, sizeof(reply.proposal_id));
+    // 리더가 아니거나 저장에 실패하면 거절: 보낸 노드가 현재 리더에게 다시 보낸다
+    if (role_ == Role::LEADER &&
+        appendLocal(std::string(body + sizeof(RaftProposal), length - sizeof(RaftProposal)))) {
+        reply.accepted = 1;
+    }
+    sendTo(peer, makeHeader(RaftMessageType::PROPOSAL_REPLY) +
+                 std::string(reinterpret_cast<const char*>(&reply), sizeof(reply)));
+}
+
+void RaftNode::handleProposalReply(const char* body, size_t length) {
+    if (length < sizeof(RaftProposalReply)) {
+        return;
+    }
+    RaftProposalReply reply;
+    std::memcpy(&reply, body, sizeof(reply));
+    auto it = std::find_if(forwarded_.begin(), forwarded_.end(),
+                           [&reply](const ForwardedProposal& proposal) { return proposal.id == reply.proposal_id; });
+    if (it == forwarded_.end()) {
+        return;
+    }
+    if (reply.accepted) {
+        forwarded_.erase(it);
+    } else {
+        it->sent_ms = 0;    // 다음 틱에 (바뀌었을 수 있는) 리더에게 다시 보낸다
+    }
+}
+
+void RaftNode::becomeFollower(uint64_t term, int64_t now_ms) {
+    if (term > current_term_) {
+        current_term_ = term;
+        voted_for_ = 0;
+        persistMeta();
+    }
+    if (role_ != Role::FOLLOWER) {
+        LOG_INFO("[Raft] Node ", node_id_, " stepping down to follower (term ", current_term_, ")");
+        role_ = Role::FOLLOWER;
+        resetElectionTimer(now_ms);
+    }
+}
+
+void RaftNode::becomeCandidate(int64_t now_ms) {
+    leader_id_ = 0;
+    resetElectionTimer(now_ms);
+    ++current_term_;
+    voted_for_ = node_id_;
+    if (!persistMeta()) {
+        // 임기를 기록하지 못하면 선거를 시작하지 않고 다음 타임아웃에 다시 시도
+        --current_term_;
+        voted_for_ = 0;
+        role_ = Role::FOLLOWER;
+        return;
+    }
+    role_ = Role::CANDIDATE;
+    for (Peer& peer : peers_) {
+        peer.vote_granted = false;
+    }
+    LOG_DEBUG("[Raft] Node ", node_id_, " starting election for term ", current_term_);
+
+    if (majority() == 1) {
+        becomeLeader();
+        return;
+    }
+    RaftVoteRequest request{lastIndex(), termAt(lastIndex())};
+    const std::string datagram = makeHeader(RaftMessageType::VOTE_REQUEST) +
+                                 std::string(reinterpret_cast<const char*>(&request), sizeof(request));
+    for (const Peer& peer : peers_) {
+        sendTo(peer, datagram);
+    }
+}
+
+void RaftNode::becomeLeader() {
+    role_ = Role::LEADER;
+    leader_id_ = node_id_;
+    for (Peer& peer : peers_) {
+        peer.next_index = lastIndex() + 1;
+        peer.match_index = 0;
+    }
+    LOG_INFO("[Raft] Node ", node_id_, " elected leader for term ", current_term_);
+
+    // 이전 임기의 항목은 현재 임기 항목이 커밋될 때 함께 커밋된다
+    DirectoryCommand noop{DirectoryOp::NOOP, 0, 0, 0, 0};
+    if (!appendLocal(RoomDirectory::encode(noop))) {
+        // 저장할 수 없는 리더는 커밋을 진행할 수 없다: 물러나 다른 노드에게 맡긴다
+        role_ = Role::FOLLOWER;
+        leader_id_ = 0;
+        resetElectionTimer(steadyMillis());
+    }
+}
+
+bool RaftNode::appendLocal(std::string command) {
+    log_.append(current_term_, std::move(command));
+    if (!persistAppend(lastIndex())) {
+        log_.truncate(lastIndex() - 1);
+        rewrite_log_ = true;
+        return false;
+    }
+    replicate_now_ = true;
+    return true;
+}
+
+void RaftNode::sendAppend(Peer& peer) {
+    const uint64_t prev_index = peer.next_index - 1;
+    RaftAppendRequest request{prev_index, termAt(prev_index), commit_index_, 0};
+    std::string datagram = makeHeader(RaftMessageType::APPEND_REQUEST);
+    const size_t request_offset = datagram.size();
+    datagram.append(reinterpret_cast<const char*>(&request), sizeof(request));
+
+    for (uint64_t index = peer.next_index; index <= lastIndex() && request.count < UINT16_MAX; ++index) {
+        const RaftLog::Entry& entry = log_.at(index);
+        if (datagram.size() + sizeof(RaftEntryHeader) + entry.command.size() > MAX_DATAGRAM) {
+            break;
+        }
+        appendEntryBytes(datagram, entry.term, entry.command);
+        ++request.count;
+    }
+    std::memcpy(&datagram[request_offset], &request, sizeof(request));
+    sendTo(peer, datagram);
+}
+
+void RaftNode::sendTo(const Peer& peer, std::string datagram) {
+    if (!secret_.empty()) {
+        datagram += computeMac(datagram.data(), datagram.size());
+    }
+    if (sendto(socket_fd_, datagram.data(), datagram.size(), 0,
+               reinterpret_cast<const sockaddr*>(&peer.address), sizeof(peer.address)) < 0) {
+        LOG_DEBUG("[Raft] Send to node ", peer.id, " failed: ", strerror(errno));
+    }
+}
+
+std::string RaftNode::makeHeader(RaftMessageType type) const {
+    RaftHeader header{type, node_id_, current_term_};
+    return std::string(reinterpret_cast<const char*>(&header), sizeof(header));
+}
+
+std::string RaftNode::computeMac(const char* data, size_t length) const {
+    unsigned char mac[EVP_MAX_MD_SIZE];
+    unsigned int mac_length = 0;
+    if (!HMAC(EVP_sha256(), secret_.data(), static_cast<int>(secret_.size()),
+              reinterpret_cast<const unsigned char*>(data), length, mac, &mac_length)) {
+        return std::string();
+    }
+    return std::string(reinterpret_cast<const char*>(mac), mac_length);
+}
+
+void RaftNode::advanceCommit() {
+    std::vector<uint64_t> peer_match;
+    peer_match.reserve(peers_.size());
+    for (const Peer& peer : peers_) {
+        peer_match.push_back(peer.match_index);
+    }
+    commit_index_ = log_.majorityCommit(commit_index_, current_term_, peer_match, majority());
+}
+
+void RaftNode::applyCommitted() {
+    if (last_applied_ >= commit_index_) {
+        return;
+    }
+
+    while (last_applied_ < commit_index_) {
+        const std::string& command = log_.at(++last_applied_).command;
+        if (!RoomDirectory::apply(command, state_)) {
+            LOG_ERROR("[Raft] Malformed directory entry at index ", last_applied_);
+            continue;
+        }
+
+        // 이 노드가 소유한 방의 설정은 세션에 바로 반영한다
+        DirectoryCommand header;
+        std::memcpy(&header, command.data(), sizeof(header));
+        if (header.op == DirectoryOp::SET_ROOM && header.node_id == node_id_ &&
+            (header.flags & RoomRecord::HAS_DEADLINE)) {
+            if (auto session = SessionManager::getInstance().getSessionById(header.room_id)) {
+                session->setDeliveryDeadline(header.deadline_ms);
+            }
+        }
+    }
+
+    // 배치 전체를 적용한 뒤 한 번만 교체
+    state_.version = last_applied_;
+    RoomDirectory::getInstance().publish(std::make_shared<const DirectorySnapshot>(state_));
+    LOG_DEBUG("[Raft] Directory version ", last_applied_, ": ", state_.rooms.size(), " rooms");
+}
+
+void RaftNode::resetElectionTimer(int64_t now_ms) {
+    std::uniform_int_distribution<int> timeout(ELECTION_MIN_MS, ELECTION_MAX_MS);
+    election_deadline_ms_ = now_ms + timeout(rng_);
+}
+
+void RaftNode::loadState() {
+    if (data_dir_.empty()) {
+        return;
+    }
+    const std::string prefix = data_dir_ + "/raft-" + std::to_string(node_id_);
+
+    std::ifstream meta(prefix + ".meta");
+    if (meta) {
+        meta >> current_term_ >> voted_for_;
+    }
+
+    std::ifstream log(prefix + ".log", std::ios::binary);
+    RaftEntryHeader entry;
+    while (log.read(reinterpret_cast<char*>(&entry), sizeof(entry))) {
+        std::string command(entry.length, '\0');
+        if (!log.read(&command[0], entry.length)) {
+            LOG_WARN("[Raft] Ignoring truncated log tail after ", lastIndex(), " entries");
+            break;
+        }
+        log_.append(entry.term, std::move(command));
+    }
+}
+
+bool RaftNode::persistMeta() {
+    if (data_dir_.empty()) {
+        return true;
+    }
+    const std::string path = data_dir_ + "/raft-" + std::to_string(node_id_) + ".meta";
+    if (!writeFileAtomically(path, std::to_string(current_term_) + " " + std::to_string(voted_for_) + "\n")) {
+        LOG_ERROR("[Raft] Failed to persist term/vote to ", path, ": ", strerror(errno));
+        return false;
+    }
+    return true;
+}
+
+bool RaftNode::persistAppend(uint64_t from_index) {
+    if (data_dir_.empty()) {
+        return true;
+    }
+    if (rewrite_log_) {
+        return persistRewrite();
+    }
+    std::string bytes;
+    for (uint64_t index = from_index; index <= lastIndex(); ++index) {
+        appendEntryBytes(bytes, log_.at(index).term, log_.at(index).command);
+    }
+
+    const std::string path = data_dir_ + "/raft-" + std::to_string(node_id_) + ".log";
+    FILE* file = fopen(path.c_str(), "ab");
+    const bool written = file && fwrite(bytes.data(), 1, bytes.size(), file) == bytes.size() &&
+                         fflush(file) == 0 && fsync(fileno(file)) == 0;
+    if (file) {
+        fclose(file);
+    }
+    if (!written) {
+        LOG_ERROR("[Raft] Failed to append to ", path, ": ", strerror(errno));
+    }
+    return written;
+}
+
+bool RaftNode::persistRewrite() {
+    if (data_dir_.empty()) {
+        return true;
+    }
+    std::string bytes;
+    for (const RaftLog::Entry& entry : log_.entries()) {
+        appendEntryBytes(bytes, entry.term, entry.command);
+    }
+    const std::string path = data_dir_ + "/raft-" + std::to_string(node_id_) + ".log";
+    if (!writeFileAtomically(path, bytes)) {
+        LOG_ERROR("[Raft] Failed to rewrite ", path, ": ", strerror(errno));
+        return false;
+    }
+    rewrite_log_ = false;
+    return true;
+}
+
+std::string RaftNode::describe() {
+    if (!isEnabled()) {
+        return "directory: disabled";
+    }
+    std::string status;
+    {
+        std::lock_guard<std::mutex> lock(status_mutex_);
+        status = status_;
+    }
+
+    const DirectorySnapshot& directory = RoomDirectory::getInstance().current();
+    std::ostringstream out;
+    out << "directory: " << status << " version=" << directory.version << " nodes=" << directory.nodes.size()
+        << " rooms=" << directory.rooms.size();
+    size_t shown = 0;
+    for (const auto& [room_id, room] : directory.rooms) {
+        if (shown++ == MAX_DESCRIBED_ROOMS) {
+            out << " ...";
+            break;
+        }
+        out << " " << room_id << "->" << room.owner_node;
+        if (room.flags & RoomRecord::HAS_DEADLINE) {
+            out << "(" << room.deadline_ms << "ms)";
+        }
+    }
+    return out.str().substr(0, MAX_DESCRIBE_LENGTH);
+}
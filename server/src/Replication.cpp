@@ -0,0 +1,533 @@
+#include "Replication.h"
+#include "Logger.h"
+#include <algorithm>
+#include <arpa/inet.h>
+#include <cerrno>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sstream>
+#include <stdexcept>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace {
+    constexpr int BACKUP_POLL_MS = 100;     // 연결을 기다리면서 멈춤 요청을 확인하는 주기
+    constexpr int STOP_FLUSH_MS = 1000;     // 종료 시 남은 배치를 보내 보는 시간
+    constexpr size_t RECV_BUFFER = 64 * 1024;
+
+    int64_t steadyMillis() {
+        return std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    size_t envSize(const char* name, size_t fallback) {
+        const char* value = std::getenv(name);
+        return value ? static_cast<size_t>(std::strtoull(value, nullptr, 10)) : fallback;
+    }
+
+    void setNoDelay(int fd) {
+        int one = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    }
+}
+
+Replication::Config Replication::Config::fromEnv() {
+    Config config;
+    if (const char* backup = std::getenv("CHAT_REPLICA_BACKUP")) {
+        const std::string spec(backup);
+        const size_t colon = spec.rfind(':');
+        const unsigned long port = colon == std::string::npos ? 0 : std::strtoul(spec.c_str() + colon + 1, nullptr, 10);
+        if (port == 0 || port > UINT16_MAX) {
+            LOG_ERROR("[Replication] CHAT_REPLICA_BACKUP must be host:port, got '", spec, "'");
+        } else {
+            config.backup_host = spec.substr(0, colon);
+            config.backup_port = static_cast<uint16_t>(port);
+        }
+    }
+    config.listen_port = static_cast<uint16_t>(std::min<size_t>(envSize("CHAT_REPLICA_LISTEN", 0), UINT16_MAX));
+    config.batch_ms = static_cast<uint32_t>(std::max<size_t>(1, envSize("CHAT_REPLICA_BATCH_MS", config.batch_ms)));
+    config.max_buffered = envSize("CHAT_REPLICA_MAX_BUFFERED", config.max_buffered);
+
+    const char* primaries = std::getenv("CHAT_REPLICA_PRIMARY");
+    std::stringstream list(primaries && *primaries ? primaries : "127.0.0.0/8");
+    std::string item;
+    while (std::getline(list, item, ',')) {
+        Cidr cidr;
+        if (Cidr::parse(item, cidr)) {
+            config.primaries.push_back(cidr);
+        } else if (!item.empty()) {
+            LOG_ERROR("[Replication] Ignoring invalid CHAT_REPLICA_PRIMARY entry '", item, "'");
+        }
+    }
+    return config;
+}
+
+Replication::~Replication() {
+    stop();
+}
+
+void Replication::start() {
+    config_ = Config::fromEnv();
+
+    if (config_.listen_port != 0) {
+        listen_fd_ = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        int one = 1;
+        setsockopt(listen_fd_, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(config_.listen_port);
+        addr.sin_addr.s_addr = INADDR_ANY;
+        if (listen_fd_ < 0 || bind(listen_fd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0 ||
+            listen(listen_fd_, 1) < 0) {
+            const std::string reason = strerror(errno);
+            if (listen_fd_ >= 0) {
+                close(listen_fd_);
+                listen_fd_ = -1;
+            }
+            throw std::runtime_error("Failed to listen for replication on port " +
+                                     std::to_string(config_.listen_port) + ": " + reason);
+        }
+        std::string allowed;
+        for (const Cidr& cidr : config_.primaries) {
+            allowed += (allowed.empty() ? "" : ",") + cidr.toString();
+        }
+        LOG_INFO("[Replication] Backup listening on port ", config_.listen_port, ", accepting primary from ",
+                 allowed.empty() ? "nowhere" : allowed);
+        backup_thread_ = std::thread([this] { runBackup(); });
+    }
+
+    if (!config_.backup_host.empty()) {
+        primary_.store(true, std::memory_order_release);
+        LOG_INFO("[Replication] Primary streaming to ", config_.backup_host, ":", config_.backup_port,
+                 " every ", config_.batch_ms, "ms");
+        primary_thread_ = std::thread([this] { runPrimary(); });
+    }
+}
+
+void Replication::stop() {
+    should_stop_.store(true, std::memory_order_release);
+    if (primary_thread_.joinable()) {
+        primary_thread_.join();
+    }
+    if (backup_thread_.joinable()) {
+        backup_thread_.join();
+    }
+    if (listen_fd_ >= 0) {
+        close(listen_fd_);
+        listen_fd_ = -1;
+    }
+    primary_.store(false, std::memory_order_release);
+}
+
+void Replication::publish(JournalRecordPtr record) {
+    std::lock_guard<std::mutex> lock(pending_mutex_);
+    pending_.push_back(std::move(record));
+}
+
+int Replication::connectBackup() {
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(config_.backup_port);
+    if (inet_pton(AF_INET, config_.backup_host.c_str(), &addr.sin_addr) != 1) {
+        LOG_ERROR("[Replication] Invalid backup address: ", config_.backup_host);
+        return -1;
+    }
+
+    // 연결이 늦어져도 종료가 막히지 않도록 비차단 connect + 제한 시간
+    int fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        return -1;
+    }
+    if (connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0) {
+        pollfd waiting{fd, POLLOUT, 0};
+        int error = errno;
+        if (error == EINPROGRESS && poll(&waiting, 1, RECONNECT_MS) == 1) {
+            socklen_t size = sizeof(error);
+            getsockopt(fd, SOL_SOCKET, SO_ERROR, &error, &size);
+        } else if (error == EINPROGRESS) {
+            error = ETIMEDOUT;
+        }
+        if (error != 0) {
+            LOG_DEBUG("[Replication] Backup ", config_.backup_host, ":", config_.backup_port,
+                      " unreachable: ", strerror(error));
+            close(fd);
+            return -1;
+        }
+    }
+    setNoDelay(fd);
+    LOG_INFO("[Replication] Connected to backup ", config_.backup_host, ":", config_.backup_port);
+    return fd;
+}
+
+void Replication::appendEntry(ReplicaEntryKind kind, int32_t room_id, uint64_t seq, int64_t sent_at_ms,
+                              const std::string& text) {
+    if (batch_start_ != std::string::npos && out_.size() - batch_start_ >= MAX_BATCH_BYTES) {
+        closeBatch();
+    }
+    if (batch_start_ == std::string::npos) {
+        batch_start_ = out_.size();
+        out_.resize(out_.size() + sizeof(ReplicaFrameHeader));
+    }
+
+    ReplicaEntryHeader entry{};
+    entry.kind = kind;
+    entry.room_id = room_id;
+    entry.seq = seq;
+    entry.sent_at_ms = sent_at_ms;
+    entry.length = static_cast<uint16_t>(std::min<size_t>(text.size(), UINT16_MAX));
+    out_.append(reinterpret_cast<const char*>(&entry), sizeof(entry));
+    out_.append(text.data(), entry.length);
+}
+
+void Replication::closeBatch() {
+    if (batch_start_ == std::string::npos) {
+        return;
+    }
+    ReplicaFrameHeader header{};
+    header.type = ReplicaFrameType::BATCH;
+    header.batch_id = next_batch_id_++;
+    header.length = static_cast<uint32_t>(out_.size() - batch_start_ - sizeof(header));
+    std::memcpy(&out_[batch_start_], &header, sizeof(header));
+    batch_start_ = std::string::npos;
+
+    last_batch_id_.store(header.batch_id, std::memory_order_relaxed);
+    batches_sent_.fetch_add(1, std::memory_order_relaxed);
+}
+
+void Replication::encodePending(bool snapshot) {
+    std::vector<JournalRecordPtr> records;
+    {
+        std::lock_guard<std::mutex> lock(pending_mutex_);
+        records.swap(pending_);
+    }
+
+    if (snapshot) {
+        // 꺼낸 기록은 이미 방 기록에 들어 있으므로 스냅샷이 덮는다. 스냅샷 이후에 붙은 기록이
+        // 다음 배치에 또 실려도 백업은 이미 가진 순번을 무시한다
+        std::vector<JournalRecordPtr> retained;
+        size_t rooms = 0;
+        for (RoomJournal* room : RoomHistory::getInstance().allRooms()) {
+            const uint64_t next_seq = room->snapshot(retained);
+            appendEntry(ReplicaEntryKind::RESET, room->getRoomId(),
+                        retained.empty() ? next_seq : retained.front()->seq, 0, std::string());
+            for (const auto& record : retained) {
+                appendEntry(ReplicaEntryKind::RECORD, record->room_id, record->seq, record->sent_at_ms, record->text);
+            }
+            records_sent_.fetch_add(retained.size(), std::memory_order_relaxed);
+            ++rooms;
+        }
+        snapshots_.fetch_add(1, std::memory_order_relaxed);
+        LOG_INFO("[Replication] Sent snapshot of ", rooms, " rooms");
+    } else {
+        for (const auto& record : records) {
+            appendEntry(ReplicaEntryKind::RECORD, record->room_id, record->seq, record->sent_at_ms, record->text);
+        }
+        records_sent_.fetch_add(records.size(), std::memory_order_relaxed);
+    }
+    closeBatch();
+}
+
+bool Replication::flushOut(int fd) {
+    while (out_offset_ < out_.size()) {
+        const ssize_t sent = send(fd, out_.data() + out_offset_, out_.size() - out_offset_,
+                                  MSG_DONTWAIT | MSG_NOSIGNAL);
+        if (sent < 0) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                break;
+            }
+            if (errno == EINTR) {
+                continue;
+            }
+            LOG_WARN("[Replication] Send to backup failed: ", strerror(errno));
+            return false;
+        }
+        out_offset_ += static_cast<size_t>(sent);
+        bytes_sent_.fetch_add(static_cast<uint64_t>(sent), std::memory_order_relaxed);
+    }
+
+    if (out_offset_ == out_.size()) {
+        out_.clear();
+        out_offset_ = 0;
+    } else if (out_offset_ >= MAX_BATCH_BYTES) {
+        out_.erase(0, out_offset_);
+        out_offset_ = 0;
+    }
+    return true;
+}
+
+bool Replication::readAcks(int fd) {
+    char buffer[4096];
+    while (true) {
+        const ssize_t received = recv(fd, buffer, sizeof(buffer), MSG_DONTWAIT);
+        if (received == 0) {
+            LOG_WARN("[Replication] Backup closed the connection");
+            return false;
+        }
+        if (received < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return errno == EAGAIN || errno == EWOULDBLOCK;
+        }
+        ack_buffer_.append(buffer, static_cast<size_t>(received));
+
+        size_t offset = 0;
+        while (ack_buffer_.size() - offset >= sizeof(ReplicaFrameHeader)) {
+            ReplicaFrameHeader header;
+            std::memcpy(&header, ack_buffer_.data() + offset, sizeof(header));
+            if (header.type != ReplicaFrameType::ACK || header.length != 0) {
+                LOG_ERROR("[Replication] Unexpected frame from backup (type=", static_cast<int>(header.type), ")");
+                return false;
+            }
+            batches_acked_.store(header.batch_id, std::memory_order_relaxed);
+            offset += sizeof(header);
+        }
+        ack_buffer_.erase(0, offset);
+    }
+}
+
+void Replication::runPrimary() {
+    int fd = -1;
+    int64_t next_connect_ms = 0;
+    int64_t last_batch_ms = steadyMillis();
+
+    while (!should_stop_.load(std::memory_order_acquire)) {
+        int64_t now_ms = steadyMillis();
+        if (fd < 0) {
+            // 연결이 없는 동안의 기록은 버린다 (방 기록에 남아 있어 재접속 스냅샷이 덮음)
+            size_t dropped;
+            {
+                std::lock_guard<std::mutex> lock(pending_mutex_);
+                dropped = pending_.size();
+                pending_.clear();
+            }
+            records_dropped_.fetch_add(dropped, std::memory_order_relaxed);
+
+            if (now_ms >= next_connect_ms) {
+                fd = connectBackup();
+                next_connect_ms = steadyMillis() + RECONNECT_MS;
+            }
+            if (fd < 0) {
+                poll(nullptr, 0, static_cast<int>(config_.batch_ms));
+                continue;
+            }
+            connected_.store(true, std::memory_order_release);
+            encodePending(true);
+            last_batch_ms = steadyMillis();
+        }
+
+        // 다음 배치 시각까지 ACK/송신 가능을 기다린다. ACK를 기다리지 않고 배치를 계속 내보낸다 (파이프라인)
+        const int wait_ms = static_cast<int>(std::max<int64_t>(0, last_batch_ms + config_.batch_ms - now_ms));
+        pollfd waiting{fd, static_cast<short>(POLLIN | (out_offset_ < out_.size() ? POLLOUT : 0)), 0};
+        bool alive = true;
+        if (poll(&waiting, 1, wait_ms) > 0) {
+            if (waiting.revents & (POLLERR | POLLHUP | POLLNVAL)) {
+                LOG_WARN("[Replication] Backup connection lost");
+                alive = false;
+            } else if (waiting.revents & POLLIN) {
+                alive = readAcks(fd);
+            }
+        }
+
+        now_ms = steadyMillis();
+        if (alive && now_ms - last_batch_ms >= config_.batch_ms) {
+            encodePending(false);
+            last_batch_ms = now_ms;
+        }
+        if (alive) {
+            alive = flushOut(fd);
+        }
+        if (alive && out_.size() - out_offset_ > config_.max_buffered) {
+            // 백업이 따라오지 못함: 무한정 쌓지 않고 끊은 뒤 스냅샷으로 다시 맞춘다
+            LOG_WARN("[Replication] Backup fell ", out_.size() - out_offset_, " bytes behind, resynchronizing");
+            resyncs_.fetch_add(1, std::memory_order_relaxed);
+            alive = false;
+            next_connect_ms = 0;
+        }
+
+        if (!alive) {
+            close(fd);
+            fd = -1;
+            connected_.store(false, std::memory_order_release);
+            out_.clear();
+            out_offset_ = 0;
+            batch_start_ = std::string::npos;
+            ack_buffer_.clear();
+        }
+    }
+
+    if (fd >= 0) {
+        // 종료: 드레인 중 마지막으로 쌓인 기록까지 잠시 보내 본다
+        encodePending(false);
+        const int64_t deadline_ms = steadyMillis() + STOP_FLUSH_MS;
+        while (out_offset_ < out_.size() && steadyMillis() < deadline_ms) {
+            pollfd waiting{fd, POLLOUT, 0};
+            if (poll(&waiting, 1, BACKUP_POLL_MS) < 0 || !flushOut(fd)) {
+                break;
+            }
+        }
+        close(fd);
+        connected_.store(false, std::memory_order_release);
+    }
+}
+
+void Replication::runBackup() {
+    int fd = -1;
+    std::string buffer;
+    char chunk[RECV_BUFFER];
+
+    while (!should_stop_.load(std::memory_order_acquire)) {
+        pollfd waiting[2] = {{listen_fd_, POLLIN, 0}, {fd, POLLIN, 0}};
+        if (poll(waiting, fd >= 0 ? 2 : 1, BACKUP_POLL_MS) <= 0) {
+            continue;
+        }
+
+        if (waiting[0].revents & POLLIN) {
+            sockaddr_in peer{};
+            socklen_t peer_len = sizeof(peer);
+            const int accepted = accept4(listen_fd_, reinterpret_cast<sockaddr*>(&peer), &peer_len,
+                                         SOCK_NONBLOCK | SOCK_CLOEXEC);
+            if (accepted >= 0 && (peer.sin_family != AF_INET || !isAllowedPrimary(ntohl(peer.sin_addr.s_addr)))) {
+                // 연결된 프라이머리는 그대로 두고 허용되지 않은 연결만 끊는다
+                char text[INET_ADDRSTRLEN] = {0};
+                inet_ntop(AF_INET, &peer.sin_addr, text, sizeof(text));
+                LOG_WARN("[Replication] Rejected replication stream from ", text, " (not in CHAT_REPLICA_PRIMARY)");
+                primaries_rejected_.fetch_add(1, std::memory_order_relaxed);
+                close(accepted);
+                continue;
+            }
+            if (accepted >= 0) {
+                // 프라이머리가 다시 붙으면 이전 연결은 버리고 새 스냅샷부터 받는다
+                if (fd >= 0) {
+                    close(fd);
+                }
+                fd = accepted;
+                buffer.clear();
+                setNoDelay(fd);
+                primary_attached_.store(true, std::memory_order_release);
+                LOG_INFO("[Replication] Primary attached");
+                continue;
+            }
+        }
+
+        if (fd < 0 || !(waiting[1].revents & (POLLIN | POLLERR | POLLHUP))) {
+            continue;
+        }
+        const ssize_t received = recv(fd, chunk, sizeof(chunk), 0);
+        if (received < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)) {
+            continue;
+        }
+        bool alive = received > 0;
+        if (alive) {
+            buffer.append(chunk, static_cast<size_t>(received));
+            alive = applyFrames(fd, buffer);
+        }
+        if (!alive) {
+            LOG_INFO("[Replication] Primary detached (applied ", batches_applied_.load(), " batches)");
+            close(fd);
+            fd = -1;
+            primary_attached_.store(false, std::memory_order_release);
+        }
+    }
+
+    if (fd >= 0) {
+        close(fd);
+    }
+}
+
+bool Replication::isAllowedPrimary(uint32_t addr) const {
+    return std::any_of(config_.primaries.begin(), config_.primaries.end(),
+                       [addr](const Cidr& cidr) { return cidr.contains(addr); });
+}
+
+bool Replication::applyFrames(int fd, std::string& buffer) {
+    size_t offset = 0;
+    while (buffer.size() - offset >= sizeof(ReplicaFrameHeader)) {
+        ReplicaFrameHeader header;
+        std::memcpy(&header, buffer.data() + offset, sizeof(header));
+        if (header.type != ReplicaFrameType::BATCH || header.length > MAX_FRAME_BYTES) {
+            LOG_ERROR("[Replication] Malformed frame from primary (type=", static_cast<int>(header.type),
+                      ", length=", header.length, ")");
+            return false;
+        }
+        if (buffer.size() - offset - sizeof(header) < header.length) {
+            break;
+        }
+        applyEntries(buffer.data() + offset + sizeof(header), header.length);
+        batches_applied_.fetch_add(1, std::memory_order_relaxed);
+        offset += sizeof(header) + header.length;
+
+        // ACK가 빠져도 프라이머리의 통계만 늦어지므로 기다리지 않는다
+        ReplicaFrameHeader ack{ReplicaFrameType::ACK, header.batch_id, 0};
+        send(fd, &ack, sizeof(ack), MSG_DONTWAIT | MSG_NOSIGNAL);
+    }
+    buffer.erase(0, offset);
+    return true;
+}
+
+void Replication::applyEntries(const char* data, size_t length) {
+    auto& history = RoomHistory::getInstance();
+    size_t offset = 0;
+    while (length - offset >= sizeof(ReplicaEntryHeader)) {
+        ReplicaEntryHeader entry;
+        std::memcpy(&entry, data + offset, sizeof(entry));
+        offset += sizeof(entry);
+        if (length - offset < entry.length) {
+            LOG_ERROR("[Replication] Truncated entry for room ", entry.room_id);
+            return;
+        }
+
+        RoomJournal* room = history.getRoom(entry.room_id);
+        if (entry.kind == ReplicaEntryKind::RESET) {
+            room->reset(entry.seq);
+        } else if (entry.kind == ReplicaEntryKind::RECORD) {
+            auto record = std::make_shared<JournalRecord>();
+            record->room_id = entry.room_id;
+            record->seq = entry.seq;
+            record->sent_at_ms = entry.sent_at_ms;
+            record->text.assign(data + offset, entry.length);
+            if (room->apply(record)) {
+                records_applied_.fetch_add(1, std::memory_order_relaxed);
+            } else {
+                records_duplicate_.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+        offset += entry.length;
+    }
+}
+
+std::string Replication::describe() const {
+    std::ostringstream out;
+    out << "replication:";
+    if (!config_.backup_host.empty()) {
+        const uint64_t last = last_batch_id_.load(std::memory_order_relaxed);
+        const uint64_t acked = batches_acked_.load(std::memory_order_relaxed);
+        out << " primary backup=" << config_.backup_host << ":" << config_.backup_port
+            << " connected=" << (connected_.load(std::memory_order_relaxed) ? 1 : 0)
+            << " batches=" << batches_sent_.load(std::memory_order_relaxed)
+            << " unacked=" << (last > acked ? last - acked : 0)
+            << " records=" << records_sent_.load(std::memory_order_relaxed)
+            << " bytes=" << bytes_sent_.load(std::memory_order_relaxed)
+            << " snapshots=" << snapshots_.load(std::memory_order_relaxed)
+            << " resyncs=" << resyncs_.load(std::memory_order_relaxed)
+            << " dropped=" << records_dropped_.load(std::memory_order_relaxed);
+    }
+    if (config_.listen_port != 0) {
+        out << " backup port=" << config_.listen_port
+            << " attached=" << (primary_attached_.load(std::memory_order_relaxed) ? 1 : 0)
+            << " batches=" << batches_applied_.load(std::memory_order_relaxed)
+            << " records=" << records_applied_.load(std::memory_order_relaxed)
+            << " duplicates=" << records_duplicate_.load(std::memory_order_relaxed)
+            << " rejected=" << primaries_rejected_.load(std::memory_order_relaxed);
+    }
+    if (config_.backup_host.empty() && config_.listen_port == 0) {
+        out << " disabled";
+    }
+    return out.str();
+}
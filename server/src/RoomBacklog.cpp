@@ -0,0 +1,83 @@
+#include "RoomBacklog.h"
+#include "IOUring.h"
+#include "Logger.h"
+#include <algorithm>
+#include <cstdlib>
+
+void RoomBacklog::add(int64_t bytes) {
+    const int64_t pending = pending_bytes_.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+    if (pending >= high_water_ && !throttled_.load(std::memory_order_relaxed) &&
+        !throttled_.exchange(true, std::memory_order_acq_rel)) {
+        LOG_INFO("[Room ", room_id_, "] Backlog ", pending, " bytes over high water, throttling senders");
+    }
+}
+
+void RoomBacklog::release(int64_t bytes) {
+    const int64_t pending = pending_bytes_.fetch_sub(bytes, std::memory_order_relaxed) - bytes;
+    if (pending > low_water_ || !throttled_.load(std::memory_order_relaxed) ||
+        !throttled_.exchange(false, std::memory_order_acq_rel)) {
+        return;
+    }
+
+    // 등록과 같은 잠금 아래에서 꺼내므로 조절 해제 직전에 멈춘 발신자도 놓치지 않는다
+    std::vector<IOUring*> waiters;
+    {
+        std::lock_guard<std::mutex> lock(waiters_mutex_);
+        waiters.swap(waiters_);
+    }
+    LOG_INFO("[Room ", room_id_, "] Backlog ", pending, " bytes under low water, resuming senders");
+    for (IOUring* ring : waiters) {
+        ring->notify();
+    }
+}
+
+bool RoomBacklog::addWaiter(IOUring* ring) {
+    std::lock_guard<std::mutex> lock(waiters_mutex_);
+    if (!throttled_.load(std::memory_order_acquire)) {
+        return false;
+    }
+    if (std::find(waiters_.begin(), waiters_.end(), ring) == waiters_.end()) {
+        waiters_.push_back(ring);
+    }
+    return true;
+}
+
+void RoomBacklog::removeWaiter(IOUring* ring) {
+    std::lock_guard<std::mutex> lock(waiters_mutex_);
+    waiters_.erase(std::remove(waiters_.begin(), waiters_.end(), ring), waiters_.end());
+}
+
+RoomFlowControl::RoomFlowControl() {
+    if (const char* value = std::getenv("CHAT_ROOM_HIGH_WATER")) {
+        high_water_ = std::strtoll(value, nullptr, 10);
+    }
+    low_water_ = high_water_ / 2;
+    if (const char* value = std::getenv("CHAT_ROOM_LOW_WATER")) {
+        low_water_ = std::min<int64_t>(std::strtoll(value, nullptr, 10), high_water_);
+    }
+
+    if (isEnabled()) {
+        LOG_INFO("Room flow control: high water ", high_water_, " bytes, low water ", low_water_, " bytes");
+    } else {
+        LOG_INFO("Room flow control disabled");
+    }
+}
+
+RoomBacklog* RoomFlowControl::getRoom(int32_t room_id) {
+    if (!isEnabled()) {
+        return nullptr;
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto& room = rooms_[room_id];
+    if (!room) {
+        room = std::make_unique<RoomBacklog>(room_id, high_water_, low_water_);
+    }
+    return room.get();
+}
+
+void RoomFlowControl::forgetRing(IOUring* ring) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto& [room_id, room] : rooms_) {
+        room->removeWaiter(ring);
+    }
+}
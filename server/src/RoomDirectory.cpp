@@ -0,0 +1,53 @@
+#include "RoomDirectory.h"
+#include <cstring>
+
+const DirectorySnapshot& RoomDirectory::current() {
+    thread_local std::shared_ptr<const DirectorySnapshot> cached;
+    thread_local uint64_t cached_version = UINT64_MAX;
+
+    const uint64_t version = version_.load(std::memory_order_acquire);
+    if (version != cached_version) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        cached = snapshot_;
+        cached_version = cached->version;
+    }
+    return *cached;
+}
+
+void RoomDirectory::publish(std::shared_ptr<const DirectorySnapshot> snapshot) {
+    const uint64_t version = snapshot->version;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        snapshot_ = std::move(snapshot);
+    }
+    version_.store(version, std::memory_order_release);
+}
+
+std::string RoomDirectory::encode(const DirectoryCommand& command, const std::string& address) {
+    std::string encoded(reinterpret_cast<const char*>(&command), sizeof(command));
+    encoded += address;
+    return encoded;
+}
+
+bool RoomDirectory::apply(const std::string& command, DirectorySnapshot& state) {
+    if (command.size() < sizeof(DirectoryCommand)) {
+        return false;
+    }
+    DirectoryCommand header;
+    std::memcpy(&header, command.data(), sizeof(header));
+
+    switch (header.op) {
+        case DirectoryOp::NOOP:
+            return true;
+        case DirectoryOp::SET_ROOM:
+            state.rooms[header.room_id] = RoomRecord{header.node_id, header.deadline_ms, header.flags};
+            return true;
+        case DirectoryOp::REMOVE_ROOM:
+            state.rooms.erase(header.room_id);
+            return true;
+        case DirectoryOp::SET_NODE:
+            state.nodes[header.node_id] = command.substr(sizeof(header));
+            return true;
+    }
+    return false;
+}
@@ -0,0 +1,90 @@
+#include "RoomJournal.h"
+#include "Logger.h"
+#include "Replication.h"
+#include <algorithm>
+#include <cstdlib>
+
+JournalRecordPtr RoomJournal::append(const char* text, size_t length, int64_t sent_at_ms, bool replicate) {
+    auto record = std::make_shared<JournalRecord>();
+    record->room_id = room_id_;
+    record->sent_at_ms = sent_at_ms;
+    record->text.assign(text, length);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    record->seq = next_seq_++;
+    push(record);
+    if (replicate) {
+        // 복제 쓰레드는 대기열 잠금을 쥔 채 방 잠금을 잡지 않으므로 이 순서로 잡아도 된다
+        Replication::getInstance().publish(record);
+    }
+    return record;
+}
+
+bool RoomJournal::apply(const JournalRecordPtr& record) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (record->seq < next_seq_) {
+        return false;
+    }
+    next_seq_ = record->seq + 1;
+    push(record);
+    return true;
+}
+
+void RoomJournal::reset(uint64_t next_seq) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    records_.clear();
+    next_seq_ = next_seq;
+}
+
+void RoomJournal::push(JournalRecordPtr record) {
+    if (capacity_ == 0) {
+        return;
+    }
+    if (records_.size() >= capacity_) {
+        records_.pop_front();
+    }
+    records_.push_back(std::move(record));
+}
+
+std::vector<JournalRecordPtr> RoomJournal::recent(size_t count) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    const size_t skip = records_.size() - std::min(count, records_.size());
+    return std::vector<JournalRecordPtr>(records_.begin() + static_cast<std::ptrdiff_t>(skip), records_.end());
+}
+
+uint64_t RoomJournal::snapshot(std::vector<JournalRecordPtr>& records) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    records.assign(records_.begin(), records_.end());
+    return next_seq_;
+}
+
+uint64_t RoomJournal::nextSeq() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return next_seq_;
+}
+
+RoomHistory::RoomHistory() {
+    if (const char* value = std::getenv("CHAT_HISTORY_SIZE")) {
+        capacity_ = static_cast<size_t>(std::strtoull(value, nullptr, 10));
+    }
+    LOG_INFO("Room history: keeping ", capacity_, " records per room");
+}
+
+RoomJournal* RoomHistory::getRoom(int32_t room_id) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto& room = rooms_[room_id];
+    if (!room) {
+        room = std::make_unique<RoomJournal>(room_id, capacity_);
+    }
+    return room.get();
+}
+
+std::vector<RoomJournal*> RoomHistory::allRooms() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<RoomJournal*> rooms;
+    rooms.reserve(rooms_.size());
+    for (auto& [room_id, room] : rooms_) {
+        rooms.push_back(room.get());
+    }
+    return rooms;
+}
@@ -1,7 +1,11 @@
 #include "Session.h"
+#include "SessionManager.h"
 #include "Context.h"
 #include "Utils.h"
 #include "Logger.h"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
 
 namespace {
     Operation getContext(io_uring_cqe* cqe) {
@@ -16,10 +20,41 @@ namespace {
         
         return ctx;
     }
+
+    uint32_t defaultDeliveryDeadline() {
+        const char* value = std::getenv("CHAT_DELIVERY_DEADLINE_MS");
+        return value ? static_cast<uint32_t>(std::strtoul(value, nullptr, 10)) : 0;
+    }
+
+    uint32_t envMillis(const char* name, uint32_t fallback) {
+        const char* value = std::getenv(name);
+        return value ? static_cast<uint32_t>(std::strtoul(value, nullptr, 10)) : fallback;
+    }
 }
 
-Session::Session(int32_t id) : session_id_(id) {
+DrainPlan DrainPlan::fromEnv(size_t num_sessions) {
+    DrainPlan plan;
+    plan.wave_interval_ms = std::max<uint32_t>(1, envMillis("CHAT_DRAIN_WAVE_MS", DEFAULT_WAVE_MS));
+    plan.grace_ms = envMillis("CHAT_DRAIN_GRACE_MS", DEFAULT_GRACE_MS);
+    plan.retry_after_ms = envMillis("CHAT_DRAIN_RETRY_MS", DEFAULT_RETRY_MS);
+    if (const char* redirect = std::getenv("CHAT_DRAIN_REDIRECT")) {
+        plan.redirect = redirect;
+    }
+
+    // 서버 전체 초당 종료 수를 웨이브 간격과 세션 수로 나눈다 (세션마다 최소 1개)
+    const uint64_t rate = envMillis("CHAT_DRAIN_RATE", DEFAULT_RATE);
+    const uint64_t per_wave = rate * plan.wave_interval_ms / 1000;
+    plan.wave_size = static_cast<uint32_t>(std::max<uint64_t>(1, per_wave / std::max<size_t>(1, num_sessions)));
+    return plan;
+}
+
+Session::Session(int32_t id)
+    : session_id_(id), journal_(RoomHistory::getInstance().getRoom(id)),
+      delivery_deadline_ms_(defaultDeliveryDeadline()),
+      drain_rng_(std::random_device{}() ^ static_cast<uint32_t>(id)) {
     io_ring_ = std::make_unique<IOUring>();
+    io_ring_->setWorkerName("session " + std::to_string(id));
+    io_ring_->setAdoptHandler([this](int client_fd, bool pending) { handleAdopted(client_fd, pending); });
     LOG_INFO("[Session ", id, "] Created with dedicated IOUring");
 }
 
@@ -29,24 +64,28 @@ void Session::processEvent(io_uring_cqe* cqe) {
     if (!cqe) return;
     
     const auto ctx = getContext(cqe);
+    io_ring_->recordEvent(cqe);
     LOG_TRACE("[Session ", session_id_, "] Event: type=", static_cast<int>(ctx.op_type), 
               ", client=", ctx.client_fd, ", buffer=", ctx.buffer_idx);
     
     switch (ctx.op_type) {
         case OperationType::READ:
-            if (cqe->res <= 0) {
+            if (cqe->res == -ECANCELED && io_ring_->isReceivePaused(ctx.client_fd)) {
+                LOG_DEBUG("[Session ", session_id_, "] Receive paused (client=", ctx.client_fd, ")");
+                io_ring_->onReceiveStopped(ctx.client_fd);
+            } else if (cqe->res == -ENOBUFS) {
+                // 버퍼 링이 잠시 바닥남 (과부하): 연결은 살아 있으므로 multishot recv를 다시 건다
+                LOG_DEBUG("[Session ", session_id_, "] Receive buffers exhausted (client=", ctx.client_fd, ")");
+                io_ring_->prepareRead(ctx.client_fd);
+            } else if (cqe->res <= 0) {
                 LOG_INFO("[Session ", session_id_, "] Client ", ctx.client_fd, 
                         " disconnected (res=", cqe->res, ")");
                 handleClose(ctx.client_fd);
             } else {
                 LOG_DEBUG("[Session ", session_id_, "] Read complete: ", cqe->res, 
                          " bytes (client=", ctx.client_fd, ", buffer=", ctx.buffer_idx, ")");
+                // multishot recv가 끝났을 때(F_MORE 없음)만 IOUring이 다시 건다
                 io_ring_->handleRead(cqe, ctx.client_fd);
-                
-                if (clients_.find(ctx.client_fd) != clients_.end()) {
-                    io_ring_->prepareRead(ctx.client_fd);
-                    LOG_TRACE("[Session ", session_id_, "] Prepared next read (client=", ctx.client_fd, ")");
-                }
             }
             break;
             
@@ -65,6 +104,38 @@ void Session::processEvent(io_uring_cqe* cqe) {
             LOG_DEBUG("[Session ", session_id_, "] Processing close (client=", ctx.client_fd, ")");
             break;
             
+        case OperationType::AUTH:
+            io_ring_->handleAuthComplete(cqe);
+            break;
+            
+        case OperationType::TIMER:
+            io_ring_->handleTuningTimer(cqe);
+            break;
+            
+        case OperationType::SOCKOPT:
+            io_ring_->handleTcpInfo(cqe, ctx.client_fd);
+            break;
+            
+        case OperationType::SPLICE:
+            io_ring_->handleSplice(cqe, ctx.client_fd, ctx.buffer_idx);
+            break;
+            
+        case OperationType::SEND_ZC:
+            io_ring_->handleSendZc(cqe, ctx.client_fd);
+            break;
+            
+        case OperationType::UPLOAD:
+            io_ring_->handleUpload(cqe, ctx.client_fd, ctx.buffer_idx);
+            break;
+            
+        case OperationType::DRAIN:
+            handleDrain(cqe, ctx.buffer_idx);
+            break;
+            
+        case OperationType::THROTTLE:
+            io_ring_->handleThrottle(cqe, ctx.client_fd);
+            break;
+            
         case OperationType::ACCEPT:
             LOG_DEBUG("[Session ", session_id_, "] Ignoring ACCEPT event (handled by Listener)");
             break;
@@ -77,22 +148,141 @@ void Session::processEvent(io_uring_cqe* cqe) {
 }
 
 void Session::handleClose(int client_fd) {
+    // fd 번호가 재사용되므로 SessionManager의 배정도 함께 정리
+    SessionManager::getInstance().removeSession(client_fd);
     removeClient(client_fd);
+    io_ring_->untrackSocket(client_fd);
+    io_ring_->dropConnection(client_fd);
     io_ring_->prepareClose(client_fd);
     LOG_INFO("[Session ", session_id_, "] Closed client ", client_fd);
+
+    if (draining_ && !drained_ && clients_.empty() && drain_next_ >= drain_order_.size()) {
+        finishDrain();
+    }
 }
 
-void Session::addClient(int32_t client_fd) {
+void Session::requestDrain(const DrainPlan& plan) {
+    drain_plan_ = plan;
+    drain_requested_.store(true, std::memory_order_release);
+    io_ring_->notify();
+}
+
+void Session::handleDrain(io_uring_cqe* cqe, uint16_t step) {
+    switch (step) {
+        case IOUring::DRAIN_STEP_NOTIFY:
+            io_ring_->handleControl(cqe);
+            if (!draining_ && drain_requested_.load(std::memory_order_acquire)) {
+                startDrain();
+            }
+            break;
+
+        case IOUring::DRAIN_STEP_WAVE:
+            drainWave();
+            break;
+
+        case IOUring::DRAIN_STEP_GRACE:
+            if (drained_) {
+                break;
+            }
+            // 안내를 받고도 끊지 않은 연결은 강제로 닫는다
+            if (!clients_.empty()) {
+                LOG_WARN("[Session ", session_id_, "] Drain grace expired, closing ", clients_.size(),
+                         " remaining clients");
+            }
+            for (int32_t client_fd : std::vector<int32_t>(clients_.begin(), clients_.end())) {
+                handleClose(client_fd);
+            }
+            if (!drained_) {
+                finishDrain();
+            }
+            break;
+    }
+}
+
+void Session::startDrain() {
+    draining_ = true;
+    drain_order_.assign(clients_.begin(), clients_.end());
+    std::shuffle(drain_order_.begin(), drain_order_.end(), drain_rng_);
+    drain_next_ = 0;
+
+    LOG_INFO("[Session ", session_id_, "] Draining ", drain_order_.size(), " clients (",
+             drain_plan_.wave_size, " every ", drain_plan_.wave_interval_ms, "ms)");
+    if (drain_order_.empty()) {
+        finishDrain();
+        return;
+    }
+
+    // 세션마다 첫 웨이브를 간격 안에서 어긋나게 시작해 서버 전체의 종료가 고르게 퍼지도록
+    std::uniform_int_distribution<uint32_t> offset(0, drain_plan_.wave_interval_ms);
+    io_ring_->prepareDrainTimer(IOUring::DRAIN_STEP_WAVE, offset(drain_rng_));
+}
+
+void Session::drainWave() {
+    std::uniform_int_distribution<uint32_t> retry_after(0, drain_plan_.retry_after_ms);
+    ReconnectHint hint{};
+    strncpy(hint.address, drain_plan_.redirect.c_str(), sizeof(hint.address) - 1);
+
+    uint32_t closed = 0;
+    while (drain_next_ < drain_order_.size() && closed < drain_plan_.wave_size) {
+        const int32_t client_fd = drain_order_[drain_next_++];
+        if (clients_.find(client_fd) == clients_.end()) {
+            continue;   // 이미 끊긴 연결
+        }
+
+        hint.retry_after_ms = retry_after(drain_rng_);
+        io_ring_->sendMessage(client_fd, MessageType::SERVER_RECONNECT, &hint, sizeof(hint), UringBuffer::NO_BUFFER);
+        io_ring_->closeAfterFlush(client_fd);
+        ++closed;
+    }
+
+    if (drain_next_ < drain_order_.size()) {
+        io_ring_->prepareDrainTimer(IOUring::DRAIN_STEP_WAVE, drain_plan_.wave_interval_ms);
+    } else {
+        io_ring_->prepareDrainTimer(IOUring::DRAIN_STEP_GRACE, drain_plan_.grace_ms);
+    }
+}
+
+void Session::finishDrain() {
+    drained_ = true;
+    LOG_INFO("[Session ", session_id_, "] Drain complete");
+    SessionManager::getInstance().onSessionDrained(session_id_);
+}
+
+void Session::removeMember(int32_t client_fd) {
+    members_.erase(std::remove_if(members_.begin(), members_.end(),
+                                  [client_fd](const RoomMember& member) { return member.client_fd == client_fd; }),
+                   members_.end());
+}
+
+void Session::setMemberTagged(int32_t client_fd, bool tagged) {
+    for (RoomMember& member : members_) {
+        if (member.client_fd == client_fd) {
+            member.tagged = tagged;
+        }
+    }
+}
+
+void Session::addClient(int32_t client_fd, uint64_t connection_id, WireFormat format, bool pending) {
+    io_ring_->adoptConnection(client_fd, connection_id, format, pending);
+}
+
+void Session::handleAdopted(int client_fd, bool pending) {
     clients_.insert(client_fd);
-    std::string session_msg = "joined session:" + std::to_string(session_id_);
-    io_ring_->prepareRead(client_fd);   
-    io_ring_->sendMessage(client_fd, MessageType::SERVER_NOTIFICATION, 
-                         session_msg.c_str(), session_msg.length(), 0);
-    io_ring_->submit();
-    
+    client_count_.store(clients_.size(), std::memory_order_relaxed);
+    if (!pending) {
+        std::string session_msg = "joined session:" + std::to_string(session_id_);
+        io_ring_->sendMessage(client_fd, MessageType::SERVER_NOTIFICATION,
+                             session_msg.c_str(), session_msg.length(), UringBuffer::NO_BUFFER);
+    }
+
     LOG_INFO("[Session ", session_id_, "] Added client ", client_fd, " and submitted read request");
 }
 
+void Session::removeClient(int32_t client_fd) {
+    clients_.erase(client_fd);
+    client_count_.store(clients_.size(), std::memory_order_relaxed);
+}
+
 void Session::setListeningSocket(int socket_fd) {
     io_ring_->prepareAccept(socket_fd);
     LOG_INFO("[Session ", session_id_, "] Started listening on socket ", socket_fd);
@@ -1,13 +1,22 @@
 #include "SessionManager.h"
+#include "Clock.h"
 #include "Utils.h"
 #include "Logger.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
 #include <stdexcept>
 #include <thread>
 #include <sstream>
+#include <unordered_set>
 #include <iomanip>
 
 SessionManager::SessionManager() {
     num_worker_threads_ = getOptimalThreadCount();
+    // CHAT_SESSIONS: 세션(방) 수를 코어 수와 무관하게 지정 (세션마다 워커 쓰레드 하나)
+    if (const char* value = std::getenv("CHAT_SESSIONS")) {
+        num_worker_threads_ = std::max<size_t>(1, std::strtoul(value, nullptr, 10));
+    }
 }
 
 SessionManager::~SessionManager() {
@@ -16,12 +25,12 @@ SessionManager::~SessionManager() {
 
 size_t SessionManager::getOptimalThreadCount() const {
     size_t hw_threads = std::thread::hardware_concurrency();
-    if (hw_threads == 0) hw_threads = 2;
+    if (hw_threads <= 1) return 1;  // 단일 코어에서도 워커 하나는 유지
     return hw_threads - 1;
 }
 
 void SessionManager::initialize() {
-    std::lock_guard<std::mutex> lock(mutex_);
+    ProbedLockGuard<std::mutex> lock(mutex_, "SessionManager");
     
     LOG_INFO("[SessionManager] Initializing with ", num_worker_threads_, 
              " sessions (one per worker thread)");
@@ -59,6 +68,16 @@ void SessionManager::start() {
 
 void SessionManager::stop() {
     should_stop_ = true;
+
+    // submitAndWait에서 잠든 워커를 깨워 정지 플래그를 보게 한다
+    {
+        ProbedLockGuard<std::mutex> lock(mutex_, "SessionManager");
+        for (const auto& [session_id, session] : sessions_) {
+            if (session && session->getIOUring()) {
+                session->getIOUring()->notify();
+            }
+        }
+    }
     
     for (auto& thread : worker_threads_) {
         if (thread.joinable()) {
@@ -69,7 +88,9 @@ void SessionManager::stop() {
     worker_threads_.clear();
     thread_sessions_.clear();
     sessions_.clear();
-    client_sessions_.clear();
+    client_rooms_.clear();
+    user_clients_.clear();
+    pending_count_.store(0, std::memory_order_release);
     
     LOG_INFO("[SessionManager] All threads stopped");
 }
@@ -80,9 +101,10 @@ void SessionManager::workerThread(size_t thread_id) {
     while (!should_stop_) {
         for (auto& session : thread_sessions_[thread_id]) {
             if (!session || !session->getIOUring()) continue;
+            session->getIOUring()->countLoopIteration();
 
             io_uring_cqe* cqes[Session::CQE_BATCH_SIZE];
-            unsigned num_cqes = session->getIOUring()->peekCQE(cqes);
+            unsigned num_cqes = session->getIOUring()->peekCQE(cqes, Session::CQE_BATCH_SIZE);
             
             if (num_cqes == 0) {
                 const int result = session->getIOUring()->submitAndWait();
@@ -92,7 +114,7 @@ void SessionManager::workerThread(size_t thread_id) {
                              "] io_uring_submit_and_wait failed: ", result);
                     continue;
                 }
-                num_cqes = session->getIOUring()->peekCQE(cqes);
+                num_cqes = session->getIOUring()->peekCQE(cqes, Session::CQE_BATCH_SIZE);
             }
             
             for (unsigned i = 0; i < num_cqes; ++i) {
@@ -113,16 +135,21 @@ void SessionManager::workerThread(size_t thread_id) {
 }
 
 int32_t SessionManager::getNextAvailableSession() {
-    std::lock_guard<std::mutex> lock(mutex_);
+    ProbedLockGuard<std::mutex> lock(mutex_, "SessionManager");
     
     int32_t selected_session = -1;
-    size_t min_clients = SIZE_MAX;
+    uint64_t min_cost = UINT64_MAX;
+    const int64_t now_ns = Clock::getInstance().now();
     
-    // 가장 적은 클라이언트를 가진 세션 선택
+    // 새 클라이언트는 방의 모든 메시지를 받으므로 (클라이언트 수 + 1) x (최근 메시지 수 + 1)이 가장 작은 세션 선택.
+    // 조용한 방끼리는 클라이언트 수로 고르게 나뉜다
     for (const auto& [session_id, session] : sessions_) {
-        size_t client_count = session->getClientCount();
-        if (client_count < min_clients) {
-            min_clients = client_count;
+        const uint64_t client_count = session->getClientCount();
+        const uint64_t messages = session->getIOUring()->getLoadSketch().estimate(
+            LoadKey::ROOM, LoadMetric::MESSAGES, static_cast<uint64_t>(session_id), now_ns);
+        const uint64_t cost = (client_count + 1) * (messages + 1);
+        if (cost < min_cost) {
+            min_cost = cost;
             selected_session = session_id;
         }
     }
@@ -134,57 +161,166 @@ int32_t SessionManager::getNextAvailableSession() {
     return selected_session;
 }
 
-void SessionManager::joinSession(int32_t client_fd, int32_t session_id) {
-    std::lock_guard<std::mutex> lock(mutex_);
+void SessionManager::joinSession(int32_t client_fd, int32_t session_id, WireFormat format) {
+    ProbedLockGuard<std::mutex> lock(mutex_, "SessionManager");
     
-    if (client_sessions_.find(client_fd) != client_sessions_.end()) {
-        throw std::runtime_error("Client already in a session");
+    auto session_it = sessions_.find(session_id);
+    if (session_it == sessions_.end()) {
+        throw std::runtime_error("Invalid session ID");
     }
-    
+    auto& session = session_it->second;
+
+    auto client_it = client_rooms_.find(client_fd);
+    if (client_it == client_rooms_.end()) {
+        // 첫 참가: 이 세션 링이 연결의 I/O를 맡는다
+        ClientRooms& client = client_rooms_[client_fd];
+        client.home = session_id;
+        client.connection_id = next_connection_id_++;
+        client.rooms.push_back(session_id);
+        session->addMember(RoomMember{client_fd, client.connection_id, session->getIOUring(), false});
+        session->addClient(client_fd, client.connection_id, format);
+
+        LOG_INFO("[SessionManager] Client ", client_fd, " joined session ", session_id,
+                 " (current clients: ", session->getClientCount(), ")");
+        return;
+    }
+
+    ClientRooms& client = client_it->second;
+    auto position = std::lower_bound(client.rooms.begin(), client.rooms.end(), session_id);
+    if (position != client.rooms.end() && *position == session_id) {
+        throw std::runtime_error("Client already in this room");
+    }
+    if (client.rooms.size() >= MAX_ROOMS_PER_CONNECTION) {
+        throw std::runtime_error("Too many rooms for one connection");
+    }
+    auto home_it = sessions_.find(client.home);
+    if (home_it == sessions_.end()) {
+        throw std::runtime_error("Client has no home session");
+    }
+
+    // 둘 이상의 방에 속하면 어느 방의 채팅인지 알 수 있게 모든 방에서 태그된 프레임을 받는다
+    if (client.pending) {
+        client.pending = false;
+        pending_count_.fetch_sub(1, std::memory_order_release);
+    }
+    client.rooms.insert(position, session_id);
+    const bool tagged = client.rooms.size() > 1;
+    if (tagged) {
+        for (int32_t room_id : client.rooms) {
+            auto room_it = sessions_.find(room_id);
+            if (room_it != sessions_.end()) {
+                room_it->second->setMemberTagged(client_fd, true);
+            }
+        }
+    }
+    session->addMember(RoomMember{client_fd, client.connection_id, home_it->second->getIOUring(), tagged});
+
+    LOG_INFO("[SessionManager] Client ", client_fd, " also joined room ", session_id,
+             " (", client.rooms.size(), " rooms, I/O on session ", client.home, ")");
+}
+
+void SessionManager::assignSession(int32_t client_fd, int32_t session_id, WireFormat format) {
+    ProbedLockGuard<std::mutex> lock(mutex_, "SessionManager");
+
     auto session_it = sessions_.find(session_id);
     if (session_it == sessions_.end()) {
         throw std::runtime_error("Invalid session ID");
     }
-    
-    session_it->second->addClient(client_fd);
-    client_sessions_[client_fd] = session_id;
-    
-    LOG_INFO("[SessionManager] Client ", client_fd, " joined session ", session_id,
-             " (current clients: ", session_it->second->getClientCount(), ")");
+    if (client_rooms_.find(client_fd) != client_rooms_.end()) {
+        throw std::runtime_error("Client already assigned");
+    }
+
+    ClientRooms& client = client_rooms_[client_fd];
+    client.home = session_id;
+    client.connection_id = next_connection_id_++;
+    client.pending = true;
+    pending_count_.fetch_add(1, std::memory_order_release);
+    session_it->second->addClient(client_fd, client.connection_id, format, true);
+
+    LOG_INFO("[SessionManager] Client ", client_fd, " assigned to session ", session_id, " pending join");
+}
+
+bool SessionManager::isPending(int32_t client_fd) {
+    if (pending_count_.load(std::memory_order_acquire) == 0) {
+        return false;
+    }
+    ProbedLockGuard<std::mutex> lock(mutex_, "SessionManager");
+
+    auto it = client_rooms_.find(client_fd);
+    return it != client_rooms_.end() && it->second.pending;
+}
+
+bool SessionManager::leaveRoom(int32_t client_fd, int32_t session_id) {
+    ProbedLockGuard<std::mutex> lock(mutex_, "SessionManager");
+
+    auto client_it = client_rooms_.find(client_fd);
+    if (client_it == client_rooms_.end()) {
+        return false;
+    }
+    ClientRooms& client = client_it->second;
+    auto position = std::lower_bound(client.rooms.begin(), client.rooms.end(), session_id);
+    if (position == client.rooms.end() || *position != session_id) {
+        return false;
+    }
+    client.rooms.erase(position);
+
+    auto session_it = sessions_.find(session_id);
+    if (session_it != sessions_.end()) {
+        session_it->second->removeMember(client_fd);
+    }
+    LOG_INFO("[SessionManager] Client ", client_fd, " left room ", session_id, " (", client.rooms.size(), " rooms left)");
+    return true;
 }
 
 void SessionManager::removeSession(int32_t client_fd) {
-    std::lock_guard<std::mutex> lock(mutex_);
+    ProbedLockGuard<std::mutex> lock(mutex_, "SessionManager");
     
-    auto it = client_sessions_.find(client_fd);
-    if (it == client_sessions_.end()) {
+    auto it = client_rooms_.find(client_fd);
+    if (it == client_rooms_.end()) {
         return;
     }
     
-    int32_t session_id = it->second;
-    auto session_it = sessions_.find(session_id);
-    if (session_it != sessions_.end()) {
-        session_it->second->removeClient(client_fd);
-        
-        if (session_it->second->getClientCount() == 0) {
-            LOG_DEBUG("[SessionManager] Removing empty session ", session_id);
-            sessions_.erase(session_it);
+    const ClientRooms& client = it->second;
+    for (int32_t room_id : client.rooms) {
+        auto session_it = sessions_.find(room_id);
+        if (session_it != sessions_.end()) {
+            session_it->second->removeMember(client_fd);
+        }
+    }
+    auto home_it = sessions_.find(client.home);
+    if (home_it != sessions_.end()) {
+        // 세션은 워커 쓰레드에 고정되어 있으므로 비어도 유지
+        home_it->second->removeClient(client_fd);
+    }
+    
+    if (client.pending) {
+        pending_count_.fetch_sub(1, std::memory_order_release);
+    }
+    if (!client.user.empty()) {
+        auto user_it = user_clients_.find(client.user);
+        if (user_it != user_clients_.end()) {
+            auto& fds = user_it->second;
+            fds.erase(std::remove(fds.begin(), fds.end(), client_fd), fds.end());
+            if (fds.empty()) {
+                user_clients_.erase(user_it);
+            }
         }
     }
     
-    client_sessions_.erase(it);
-    LOG_INFO("[SessionManager] Removed client ", client_fd, " from session ", session_id);
+    LOG_INFO("[SessionManager] Removed client ", client_fd, " from session ", client.home,
+             " (", client.rooms.size(), " rooms)");
+    client_rooms_.erase(it);
 }
 
 std::shared_ptr<Session> SessionManager::getSession(int32_t client_fd) {
-    std::lock_guard<std::mutex> lock(mutex_);
+    ProbedLockGuard<std::mutex> lock(mutex_, "SessionManager");
     
-    auto it = client_sessions_.find(client_fd);
-    if (it == client_sessions_.end()) {
+    auto it = client_rooms_.find(client_fd);
+    if (it == client_rooms_.end()) {
         return nullptr;
     }
     
-    auto session_it = sessions_.find(it->second);
+    auto session_it = sessions_.find(it->second.home);
     if (session_it == sessions_.end()) {
         return nullptr;
     }
@@ -192,20 +328,109 @@ std::shared_ptr<Session> SessionManager::getSession(int32_t client_fd) {
     return session_it->second;
 }
 
-const std::set<int32_t>& SessionManager::getSessionClients(int32_t session_id) {
-    std::lock_guard<std::mutex> lock(mutex_);
-    
+std::shared_ptr<Session> SessionManager::getRoomForClient(int32_t client_fd, int32_t session_id) {
+    ProbedLockGuard<std::mutex> lock(mutex_, "SessionManager");
+
+    auto it = client_rooms_.find(client_fd);
+    if (it == client_rooms_.end()) {
+        return nullptr;
+    }
+    const ClientRooms& client = it->second;
+    const int32_t room_id = session_id < 0 ? client.home : session_id;
+    if (!std::binary_search(client.rooms.begin(), client.rooms.end(), room_id)) {
+        return nullptr;
+    }
+
+    auto session_it = sessions_.find(room_id);
+    return session_it != sessions_.end() ? session_it->second : nullptr;
+}
+
+bool SessionManager::isMember(int32_t client_fd, int32_t session_id) {
+    ProbedLockGuard<std::mutex> lock(mutex_, "SessionManager");
+
+    auto it = client_rooms_.find(client_fd);
+    return it != client_rooms_.end() &&
+           std::binary_search(it->second.rooms.begin(), it->second.rooms.end(), session_id);
+}
+
+std::vector<int32_t> SessionManager::getClientRooms(int32_t client_fd) {
+    ProbedLockGuard<std::mutex> lock(mutex_, "SessionManager");
+
+    auto it = client_rooms_.find(client_fd);
+    return it != client_rooms_.end() ? it->second.rooms : std::vector<int32_t>();
+}
+
+std::vector<RoomMember> SessionManager::getRoomMembers(int32_t session_id) {
+    ProbedLockGuard<std::mutex> lock(mutex_, "SessionManager");
+
     auto it = sessions_.find(session_id);
-    if (it == sessions_.end()) {
-        static const std::set<int32_t> empty_set;
-        return empty_set;
+    return it != sessions_.end() ? it->second->getMembers() : std::vector<RoomMember>();
+}
+
+void SessionManager::setClientUser(int32_t client_fd, const std::string& user) {
+    ProbedLockGuard<std::mutex> lock(mutex_, "SessionManager");
+
+    auto it = client_rooms_.find(client_fd);
+    // 연결 하나는 사용자 하나 (토큰은 JOIN마다 다시 검증되지만 첫 사용자로 고정)
+    if (it == client_rooms_.end() || user.empty() || !it->second.user.empty()) {
+        return;
     }
-    
-    return it->second->getClients();
+    it->second.user = user;
+    user_clients_[user].push_back(client_fd);
+}
+
+std::string SessionManager::getClientUser(int32_t client_fd) {
+    ProbedLockGuard<std::mutex> lock(mutex_, "SessionManager");
+
+    auto it = client_rooms_.find(client_fd);
+    return it != client_rooms_.end() ? it->second.user : std::string();
+}
+
+std::vector<RoomMember> SessionManager::collectRecipients(const std::vector<int32_t>& rooms,
+                                                          const std::vector<std::string>& users,
+                                                          size_t& duplicates) {
+    ProbedLockGuard<std::mutex> lock(mutex_, "SessionManager");
+
+    std::vector<RoomMember> recipients;
+    std::unordered_set<int32_t> seen;
+    duplicates = 0;
+    auto add = [&](const RoomMember& member) {
+        if (seen.insert(member.client_fd).second) {
+            // 한 번만 보내므로 방 태그 없이 일반 채팅으로
+            recipients.push_back(RoomMember{member.client_fd, member.connection_id, member.home, false});
+        } else {
+            ++duplicates;
+        }
+    };
+
+    for (int32_t room_id : rooms) {
+        auto session_it = sessions_.find(room_id);
+        if (session_it == sessions_.end()) {
+            continue;
+        }
+        for (const RoomMember& member : session_it->second->getMembers()) {
+            add(member);
+        }
+    }
+    for (const std::string& user : users) {
+        auto user_it = user_clients_.find(user);
+        if (user_it == user_clients_.end()) {
+            continue;
+        }
+        for (int32_t client_fd : user_it->second) {
+            auto client_it = client_rooms_.find(client_fd);
+            auto home_it = client_it != client_rooms_.end() ? sessions_.find(client_it->second.home) : sessions_.end();
+            if (home_it == sessions_.end()) {
+                continue;
+            }
+            add(RoomMember{client_fd, client_it->second.connection_id, home_it->second->getIOUring(), false});
+        }
+    }
+    return recipients;
 }
 
 IOUring* SessionManager::getSessionIOUring(int32_t session_id) {
-    std::lock_guard<std::mutex> lock(mutex_);
+    ProbedLockGuard<std::mutex> lock(mutex_, "SessionManager");
     
     auto it = sessions_.find(session_id);
     if (it == sessions_.end()) {
@@ -216,7 +441,7 @@ IOUring* SessionManager::getSessionIOUring(int32_t session_id) {
 }
 
 std::shared_ptr<Session> SessionManager::getSessionByIndex(size_t index) {
-    std::lock_guard<std::mutex> lock(mutex_);
+    ProbedLockGuard<std::mutex> lock(mutex_, "SessionManager");
     
     if (index >= sessions_.size()) {
         return nullptr;
@@ -225,4 +450,87 @@ std::shared_ptr<Session> SessionManager::getSessionByIndex(size_t index) {
     auto it = sessions_.begin();
     std::advance(it, index);
     return it->second;
-} 
\ No newline at end of file
+}
+
+std::shared_ptr<Session> SessionManager::getSessionById(int32_t session_id) {
+    ProbedLockGuard<std::mutex> lock(mutex_, "SessionManager");
+
+    auto it = sessions_.find(session_id);
+    return it != sessions_.end() ? it->second : nullptr;
+}
+
+RingStatsSnapshot SessionManager::collectStats() {
+    ProbedLockGuard<std::mutex> lock(mutex_, "SessionManager");
+
+    RingStatsSnapshot snapshot;
+    for (const auto& [session_id, session] : sessions_) {
+        if (session && session->getIOUring()) {
+            snapshot.add(session->getIOUring()->getStats());
+        }
+    }
+    return snapshot;
+}
+
+std::vector<HeavyHitter> SessionManager::collectTopLoad(LoadKey key_type, LoadMetric metric, size_t k) {
+    ProbedLockGuard<std::mutex> lock(mutex_, "SessionManager");
+
+    const int64_t now_ns = Clock::getInstance().now();
+    std::unordered_map<uint64_t, HeavyHitter> merged;
+    for (const auto& [session_id, session] : sessions_) {
+        if (session && session->getIOUring()) {
+            session->getIOUring()->getLoadSketch().collectTop(key_type, metric, now_ns, merged);
+        }
+    }
+    return LoadSketch::selectTop(merged, k);
+}
+
+bool SessionManager::drain() {
+    std::vector<std::shared_ptr<Session>> sessions;
+    size_t total_clients = 0;
+    size_t max_clients = 0;
+    {
+        ProbedLockGuard<std::mutex> lock(mutex_, "SessionManager");
+        for (const auto& [session_id, session] : sessions_) {
+            sessions.push_back(session);
+            total_clients += session->getClientCount();
+            max_clients = std::max(max_clients, session->getClientCount());
+        }
+    }
+    if (sessions.empty()) {
+        return true;
+    }
+
+    const DrainPlan plan = DrainPlan::fromEnv(sessions.size());
+    {
+        std::lock_guard<std::mutex> lock(drain_mutex_);
+        drained_sessions_ = 0;
+    }
+    LOG_INFO("[SessionManager] Draining ", total_clients, " clients: ", plan.wave_size * sessions.size(),
+             " per ", plan.wave_interval_ms, "ms wave, grace ", plan.grace_ms, "ms");
+
+    for (auto& session : sessions) {
+        session->requestDrain(plan);
+    }
+
+    // 가장 붐비는 세션의 웨이브 수 + 첫 웨이브 지연 + 유예 + 여유
+    const size_t waves = (max_clients + plan.wave_size - 1) / plan.wave_size;
+    const auto timeout = std::chrono::milliseconds((waves + 1) * plan.wave_interval_ms + plan.grace_ms + DRAIN_SLACK_MS);
+
+    std::unique_lock<std::mutex> lock(drain_mutex_);
+    const bool done = drain_cv_.wait_for(lock, timeout, [&] { return drained_sessions_ >= sessions.size(); });
+    if (!done) {
+        LOG_WARN("[SessionManager] Drain timed out (", drained_sessions_, "/", sessions.size(), " sessions drained)");
+    } else {
+        LOG_INFO("[SessionManager] Drain complete");
+    }
+    return done;
+}
+
+void SessionManager::onSessionDrained(int32_t session_id) {
+    {
+        std::lock_guard<std::mutex> lock(drain_mutex_);
+        ++drained_sessions_;
+    }
+    drain_cv_.notify_all();
+    LOG_DEBUG("[SessionManager] Session ", session_id, " drained");
+}
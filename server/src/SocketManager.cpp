@@ -1,6 +1,7 @@
 #include "SocketManager.h"
 #include "Logger.h"
 #include <cstring>
+#include <netinet/tcp.h>
 
 SocketManager::SocketManager() : listening_socket_(-1), client_addr_len_(sizeof(client_addr_)) {
     memset(&client_addr_, 0, sizeof(client_addr_));
@@ -25,6 +26,18 @@ int SocketManager::createListeningSocket(int port) {
         return -1;
     }
 
+    // SYN에 실린 CLIENT_JOIN을 받기 위한 TCP Fast Open
+    int qlen = FAST_OPEN_QUEUE_LEN;
+    if (setsockopt(listening_socket_, IPPROTO_TCP, TCP_FASTOPEN, &qlen, sizeof(qlen)) < 0) {
+        LOG_WARN("setsockopt(TCP_FASTOPEN) failed, continuing without fast open");
+    }
+
+    // 첫 프레임이 도착해야 accept 완료 -> accept 완료 시점에 JOIN 프레임이 이미 수신 큐에 있음
+    int defer_sec = DEFER_ACCEPT_SEC;
+    if (setsockopt(listening_socket_, IPPROTO_TCP, TCP_DEFER_ACCEPT, &defer_sec, sizeof(defer_sec)) < 0) {
+        LOG_WARN("setsockopt(TCP_DEFER_ACCEPT) failed");
+    }
+
     sockaddr_in addr{};
     addr.sin_family = AF_INET;
     addr.sin_port = htons(port);
@@ -44,6 +57,16 @@ int SocketManager::createListeningSocket(int port) {
     return listening_socket_;
 }
 
+void SocketManager::closeListeningSocket() {
+    if (listening_socket_ >= 0) {
+        // 링 정리가 끝나기 전까지 accept 요청이 소켓을 붙잡고 있을 수 있으므로 LISTEN 상태를 먼저 끝낸다
+        // (대기열의 미수락 연결과 이후 접속은 RST)
+        shutdown(listening_socket_, SHUT_RDWR);
+        closeSocket(listening_socket_);
+        listening_socket_ = -1;
+    }
+}
+
 void SocketManager::closeSocket(int fd) {
     close(fd);
     LOG_DEBUG("Closed socket fd=", fd);
@@ -0,0 +1,87 @@
+#include "SocketTuner.h"
+#include "Logger.h"
+#include <algorithm>
+#include <cstdlib>
+
+namespace {
+    // 기존 값 대비 25% 이상 변할 때만 재설정 (불필요한 syscall 방지)
+    bool significantChange(int current, int target) {
+        if (current == 0) return true;
+        return std::abs(target - current) * 4 > current;
+    }
+}
+
+void SocketTuner::applyProfile(int client_fd, const SocketProfile& profile) {
+    int enable = profile.no_delay ? 1 : 0;
+    if (setsockopt(client_fd, IPPROTO_TCP, TCP_NODELAY, &enable, sizeof(enable)) < 0) {
+        LOG_WARN("[SocketTuner] setsockopt(TCP_NODELAY) failed on fd ", client_fd);
+    }
+
+    if (profile.notsent_lowat > 0 &&
+        setsockopt(client_fd, IPPROTO_TCP, TCP_NOTSENT_LOWAT,
+                   &profile.notsent_lowat, sizeof(profile.notsent_lowat)) < 0) {
+        LOG_WARN("[SocketTuner] setsockopt(TCP_NOTSENT_LOWAT) failed on fd ", client_fd);
+    }
+
+    if (profile.send_buffer > 0 &&
+        setsockopt(client_fd, SOL_SOCKET, SO_SNDBUF,
+                   &profile.send_buffer, sizeof(profile.send_buffer)) < 0) {
+        LOG_WARN("[SocketTuner] setsockopt(SO_SNDBUF) failed on fd ", client_fd);
+    }
+}
+
+void SocketTuner::track(int client_fd) {
+    ConnTuning& tuning = connections_[client_fd];
+    tuning = ConnTuning{};
+    tuning.notsent_lowat = SocketProfile{}.notsent_lowat;
+}
+
+ConnTuning* SocketTuner::getTuning(int client_fd) {
+    auto it = connections_.find(client_fd);
+    return it != connections_.end() ? &it->second : nullptr;
+}
+
+bool SocketTuner::sampleSync(int client_fd) {
+    ConnTuning* tuning = getTuning(client_fd);
+    if (!tuning) return false;
+
+    socklen_t len = sizeof(tuning->info);
+    if (getsockopt(client_fd, IPPROTO_TCP, TCP_INFO, &tuning->info, &len) < 0) {
+        return false;
+    }
+    onSample(client_fd);
+    return true;
+}
+
+void SocketTuner::onSample(int client_fd) {
+    ConnTuning* tuning = getTuning(client_fd);
+    if (!tuning) return;
+
+    const tcp_info& info = tuning->info;
+    tuning->rtt_us = info.tcpi_rtt;
+    tuning->cwnd = info.tcpi_snd_cwnd;
+    tuning->unacked = info.tcpi_unacked;
+
+    // BDP = cwnd * mss. 먼 클라이언트는 파이프를 채울 만큼, 가까운 클라이언트는 얕게 유지
+    const int64_t bdp = static_cast<int64_t>(info.tcpi_snd_cwnd) * std::max<uint32_t>(info.tcpi_snd_mss, 536);
+    const int target_lowat = static_cast<int>(std::clamp<int64_t>(bdp / 2, MIN_NOTSENT_LOWAT, MAX_NOTSENT_LOWAT));
+    const int target_sndbuf = static_cast<int>(std::clamp<int64_t>(bdp * 2, MIN_SEND_BUFFER, MAX_SEND_BUFFER));
+
+    if (significantChange(tuning->notsent_lowat, target_lowat)) {
+        if (setsockopt(client_fd, IPPROTO_TCP, TCP_NOTSENT_LOWAT, &target_lowat, sizeof(target_lowat)) == 0) {
+            tuning->notsent_lowat = target_lowat;
+            adjustments_++;
+        }
+    }
+
+    if (significantChange(tuning->send_buffer, target_sndbuf)) {
+        if (setsockopt(client_fd, SOL_SOCKET, SO_SNDBUF, &target_sndbuf, sizeof(target_sndbuf)) == 0) {
+            tuning->send_buffer = target_sndbuf;
+            adjustments_++;
+        }
+    }
+
+    LOG_TRACE("[SocketTuner] fd ", client_fd, " rtt=", tuning->rtt_us, "us cwnd=", tuning->cwnd,
+              " unacked=", tuning->unacked, " lowat=", tuning->notsent_lowat,
+              " sndbuf=", tuning->send_buffer);
+}
@@ -0,0 +1,157 @@
+#include "SpamFilter.h"
+#include "Context.h"
+#include "Logger.h"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+namespace {
+    uint64_t mix(uint64_t x) {
+        x ^= x >> 30;
+        x *= 0xbf58476d1ce4e5b9ULL;
+        x ^= x >> 27;
+        x *= 0x94d049bb133111ebULL;
+        x ^= x >> 31;
+        return x;
+    }
+
+    // 바이트 b의 비트 k를 k번째 바이트 칸(0/1)으로 펼친 값: 해시 한 바이트의 8개 비트 카운터를 한 번에 더한다
+    struct ByteBits {
+        uint64_t lanes[256];
+        ByteBits() {
+            for (unsigned b = 0; b < 256; ++b) {
+                lanes[b] = 0;
+                for (unsigned k = 0; k < 8; ++k) {
+                    lanes[b] |= static_cast<uint64_t>((b >> k) & 1) << (8 * k);
+                }
+            }
+        }
+    };
+    const ByteBits BYTE_BITS;
+
+    uint32_t envValue(const char* name, uint32_t fallback) {
+        const char* value = std::getenv(name);
+        return value ? static_cast<uint32_t>(std::strtoul(value, nullptr, 10)) : fallback;
+    }
+}
+
+SpamFilter::SpamFilter() {
+    threshold_ = envValue("CHAT_SPAM_THRESHOLD", 0);
+    max_distance_ = std::min<uint32_t>(envValue("CHAT_SPAM_DISTANCE", max_distance_), NUM_BANDS - 1);
+    window_ns_ = static_cast<int64_t>(envValue("CHAT_SPAM_WINDOW_MS", 10000)) * 1000000;
+
+    if (!isEnabled()) {
+        LOG_INFO("Spam filter disabled");
+        return;
+    }
+    tables_ = std::make_unique<std::array<std::array<Bucket, BUCKETS_PER_BAND>, NUM_BANDS>>();
+    LOG_INFO("Spam filter: drop after ", threshold_, " near-duplicates within ", window_ns_ / 1000000,
+             "ms (distance ", max_distance_, ")");
+}
+
+uint64_t SpamFilter::fingerprint(const char* data, size_t length) {
+    // 정규화: ASCII 소문자, 공백 문자 연속은 공백 하나
+    char text[sizeof(ChatMessage::data)];
+    size_t n = 0;
+    bool space = true;
+    for (size_t i = 0; i < length && n < sizeof(text); ++i) {
+        char c = data[i];
+        if (c == ' ' || c == '\t' || c == '\r' || c == '\n') {
+            if (space) {
+                continue;
+            }
+            c = ' ';
+            space = true;
+        } else {
+            space = false;
+            if (c >= 'A' && c <= 'Z') {
+                c = static_cast<char>(c - 'A' + 'a');
+            }
+        }
+        text[n++] = c;
+    }
+    if (n < SHINGLE_BYTES) {
+        return mix(n);
+    }
+
+    // shingle 해시를 먼저 모두 구하고 (독립 곱셈, 벡터화 가능),
+    // 비트 카운터 64개를 바이트 칸 8개짜리 uint64 8개로 더한다 (SWAR, 255개마다 넓은 카운터로 옮김)
+    const size_t shingles = n - SHINGLE_BYTES + 1;
+    uint64_t hashes[sizeof(text)];
+    for (size_t i = 0; i < shingles; ++i) {
+        uint32_t window;
+        memcpy(&window, text + i, sizeof(window));
+        hashes[i] = mix(window);
+    }
+
+    uint32_t counts[64] = {0};
+    for (size_t start = 0; start < shingles; start += 255) {
+        const size_t end = std::min(shingles, start + 255);
+        uint64_t lanes[8] = {0};
+        for (size_t i = start; i < end; ++i) {
+            const uint64_t hash = hashes[i];
+            for (unsigned j = 0; j < 8; ++j) {
+                lanes[j] += BYTE_BITS.lanes[(hash >> (8 * j)) & 0xff];
+            }
+        }
+        for (unsigned j = 0; j < 8; ++j) {
+            for (unsigned k = 0; k < 8; ++k) {
+                counts[8 * j + k] += (lanes[j] >> (8 * k)) & 0xff;
+            }
+        }
+    }
+
+    uint64_t result = 0;
+    for (unsigned bit = 0; bit < 64; ++bit) {
+        if (2 * counts[bit] > shingles) {
+            result |= uint64_t{1} << bit;
+        }
+    }
+    return result;
+}
+
+bool SpamFilter::isSpam(const char* data, size_t length, int64_t now_ns) {
+    if (!isEnabled() || length < MIN_LENGTH) {
+        return false;
+    }
+
+    const uint64_t print = fingerprint(data, length);
+    size_t bucket_index[NUM_BANDS];
+    bool matched[NUM_BANDS] = {false};
+    uint32_t copies = 1;
+
+    // 1) band마다 같은 버킷에서 가까운 지문 무리를 찾아 센다
+    for (unsigned band = 0; band < NUM_BANDS; ++band) {
+        bucket_index[band] = (print >> (BAND_BITS * band)) & (BUCKETS_PER_BAND - 1);
+        Bucket& bucket = (*tables_)[band][bucket_index[band]];
+
+        std::lock_guard<std::mutex> lock(locks_[(band * BUCKETS_PER_BAND + bucket_index[band]) % NUM_LOCKS]);
+        for (Entry& entry : bucket) {
+            if (entry.last_seen_ns != 0 && now_ns - entry.last_seen_ns <= window_ns_ &&
+                static_cast<unsigned>(__builtin_popcountll(entry.fingerprint ^ print)) <= max_distance_) {
+                entry.copies++;
+                entry.last_seen_ns = now_ns;
+                copies = std::max(copies, entry.copies);
+                matched[band] = true;
+                break;
+            }
+        }
+    }
+
+    // 2) 무리가 없던 band에는 이 지문을 가장 오래된(또는 만료된) 자리에 넣는다
+    for (unsigned band = 0; band < NUM_BANDS; ++band) {
+        if (matched[band]) {
+            continue;
+        }
+        Bucket& bucket = (*tables_)[band][bucket_index[band]];
+        std::lock_guard<std::mutex> lock(locks_[(band * BUCKETS_PER_BAND + bucket_index[band]) % NUM_LOCKS]);
+        Entry* oldest = &bucket[0];
+        for (Entry& entry : bucket) {
+            if (entry.last_seen_ns < oldest->last_seen_ns) {
+                oldest = &entry;
+            }
+        }
+        *oldest = Entry{print, now_ns, copies};
+    }
+    return copies > threshold_;
+}
@@ -0,0 +1,310 @@
+#include "SyntheticLoad.h"
+#include "Clock.h"
+#include "CommandCodec.h"
+#include "Logger.h"
+#include "SessionManager.h"
+#include "TokenAuth.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <poll.h>
+#include <sstream>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace {
+    constexpr size_t DEFAULT_THREADS = 4;
+    constexpr int64_t MAX_WAIT_NS = 100 * 1000000LL;   // 보낼 차례가 없어도 멈춤 요청을 확인하는 주기
+    constexpr size_t RECV_BUFFER = 64 * 1024;
+
+    size_t envSize(const char* name, size_t fallback) {
+        const char* value = std::getenv(name);
+        return value ? static_cast<size_t>(std::strtoull(value, nullptr, 10)) : fallback;
+    }
+
+    // "t=" 뒤 16자리 16진수 (본문은 printable 문자만 통과하므로 시각을 글자로 싣는다)
+    bool parseSentAt(const ChatMessage& message, int64_t& sent_ns) {
+        if (message.length < SyntheticLoad::MIN_PAYLOAD || message.data[0] != 't' || message.data[1] != '=' ||
+            message.data[18] != ' ' || message.data[19] != 'c') {
+            return false;
+        }
+        uint64_t value = 0;
+        for (size_t i = 2; i < 18; ++i) {
+            const char c = message.data[i];
+            const int digit = c >= '0' && c <= '9' ? c - '0' : c >= 'a' && c <= 'f' ? c - 'a' + 10 : -1;
+            if (digit < 0) {
+                return false;
+            }
+            value = value << 4 | static_cast<uint64_t>(digit);
+        }
+        sent_ns = static_cast<int64_t>(value);
+        return true;
+    }
+}
+
+SyntheticLoad::Config SyntheticLoad::Config::fromEnv() {
+    Config config;
+    config.clients = envSize("CHAT_SYNTHETIC_CLIENTS", 0);
+    config.rate = static_cast<uint32_t>(envSize("CHAT_SYNTHETIC_RATE", config.rate));
+    config.payload = std::clamp(envSize("CHAT_SYNTHETIC_SIZE", config.payload), MIN_PAYLOAD, sizeof(ChatMessage::data));
+    config.threads = envSize("CHAT_SYNTHETIC_THREADS", 0);
+    config.rooms = envSize("CHAT_SYNTHETIC_ROOMS", 0);
+    return config;
+}
+
+SyntheticLoad::~SyntheticLoad() {
+    stop();
+}
+
+void SyntheticLoad::start(const std::function<bool(int)>& admit) {
+    config_ = Config::fromEnv();
+    if (config_.clients == 0) {
+        return;
+    }
+    if (TokenAuth::getInstance().isEnabled()) {
+        LOG_WARN("[Synthetic] Join authentication is enabled (CHAT_AUTH_SECRET), synthetic clients disabled");
+        return;
+    }
+
+    const size_t threads = std::min(config_.threads ? config_.threads : DEFAULT_THREADS, config_.clients);
+    for (size_t i = 0; i < threads; ++i) {
+        drivers_.push_back(std::make_unique<Driver>());
+    }
+
+    const int64_t now_ns = Clock::getInstance().now();
+    const int64_t interval_ns = config_.rate ? 1000000000LL / config_.rate : 0;
+    size_t admitted = 0;
+    for (size_t i = 0; i < config_.clients; ++i) {
+        int pair[2];
+        if (socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, pair) < 0) {
+            LOG_ERROR("[Synthetic] socketpair failed after ", admitted, " clients: ", strerror(errno));
+            break;
+        }
+
+        // 실제 클라이언트처럼 JOIN을 먼저 실어 두면 Listener가 peek으로 방을 고르고 세션 링이 읽어 ACK한다
+        const int32_t session_id = config_.rooms > 0 ? static_cast<int32_t>(i % config_.rooms)
+                                                     : SessionManager::getInstance().getNextAvailableSession();
+        ChatMessage join{};
+        command::JoinRequestBuilder(join, MessageType::CLIENT_JOIN).session_id(session_id).finish();
+        if (send(pair[0], &join, sizeof(join), MSG_NOSIGNAL) != static_cast<ssize_t>(sizeof(join)) || !admit(pair[1])) {
+            close(pair[0]);
+            continue;
+        }
+
+        auto client = std::make_unique<Client>();
+        client->fd = pair[0];
+        client->id = static_cast<uint32_t>(i);
+        // 보내는 시점을 간격 안에 고르게 흩는다
+        client->next_send_ns = now_ns + (interval_ns ? static_cast<int64_t>(i) * interval_ns / static_cast<int64_t>(config_.clients) : 0);
+        drivers_[i % threads]->clients.push_back(std::move(client));
+        ++admitted;
+    }
+
+    started_ns_ = Clock::getInstance().now();
+    should_stop_.store(false, std::memory_order_release);
+    for (auto& driver : drivers_) {
+        driver->thread = std::thread(&SyntheticLoad::run, this, std::ref(*driver));
+    }
+    running_.store(true, std::memory_order_release);
+    LOG_INFO("[Synthetic] ", admitted, " in-process clients on ", threads, " threads (",
+             config_.rate ? std::to_string(config_.rate) + " msg/s each" : std::string("unthrottled"), ", ",
+             config_.payload, " byte payload)");
+}
+
+void SyntheticLoad::stop() {
+    if (drivers_.empty()) {
+        return;
+    }
+    should_stop_.store(true, std::memory_order_release);
+    for (auto& driver : drivers_) {
+        if (driver->thread.joinable()) {
+            driver->thread.join();
+        }
+    }
+    LOG_INFO("[Synthetic] ", describe());
+    running_.store(false, std::memory_order_release);
+    for (auto& driver : drivers_) {
+        for (auto& client : driver->clients) {
+            disconnect(*client);
+        }
+    }
+    drivers_.clear();
+}
+
+void SyntheticLoad::run(Driver& driver) {
+    std::vector<pollfd> fds(driver.clients.size());
+    std::vector<char> buffer(RECV_BUFFER);
+    const int64_t interval_ns = config_.rate ? 1000000000LL / config_.rate : 0;
+    int64_t next_merge_ns = Clock::getInstance().now() + MERGE_INTERVAL_NS;
+
+    while (!should_stop_.load(std::memory_order_acquire)) {
+        const int64_t now_ns = Clock::getInstance().now();
+        int64_t wake_ns = now_ns + MAX_WAIT_NS;
+
+        for (size_t i = 0; i < driver.clients.size(); ++i) {
+            Client& client = *driver.clients[i];
+            fds[i] = pollfd{client.fd, 0, 0};   // 음수 fd는 poll이 건너뜀
+            if (client.fd < 0) {
+                continue;
+            }
+            fds[i].events = POLLIN;
+
+            bool idle = flush(client);
+            if (interval_ns == 0) {
+                if (idle) {
+                    prepareChat(client, now_ns);
+                    idle = flush(client);
+                }
+            } else if (client.next_send_ns <= now_ns) {
+                // 소켓이 차서 놓친 차례는 몰아 보내지 않고 건너뛴다
+                if (idle) {
+                    prepareChat(client, now_ns);
+                    idle = flush(client);
+                } else {
+                    send_blocked_.fetch_add(1, std::memory_order_relaxed);
+                }
+                const int64_t missed = (now_ns - client.next_send_ns) / interval_ns;
+                send_blocked_.fetch_add(static_cast<uint64_t>(missed), std::memory_order_relaxed);
+                client.next_send_ns += (missed + 1) * interval_ns;
+            }
+            if (interval_ns > 0) {
+                wake_ns = std::min(wake_ns, client.next_send_ns);
+            }
+            fds[i].fd = client.fd;
+            if (client.fd >= 0 && (!idle || interval_ns == 0)) {
+                fds[i].events |= POLLOUT;
+            }
+        }
+
+        const int64_t wait_ns = std::max<int64_t>(0, wake_ns - Clock::getInstance().now());
+        const int ready = poll(fds.data(), fds.size(), static_cast<int>((wait_ns + 999999) / 1000000));
+        if (ready > 0) {
+            for (size_t i = 0; i < driver.clients.size(); ++i) {
+                if (fds[i].fd >= 0 && (fds[i].revents & (POLLIN | POLLHUP | POLLERR))) {
+                    receive(driver, *driver.clients[i], buffer.data(), buffer.size());
+                }
+            }
+        }
+
+        if (Clock::getInstance().now() >= next_merge_ns) {
+            mergeLatency(driver);
+            next_merge_ns += MERGE_INTERVAL_NS;
+        }
+    }
+    mergeLatency(driver);
+}
+
+bool SyntheticLoad::flush(Client& client) {
+    while (client.out_offset < client.out_length) {
+        const ssize_t n = send(client.fd, reinterpret_cast<const char*>(&client.out) + client.out_offset,
+                               client.out_length - client.out_offset, MSG_DONTWAIT | MSG_NOSIGNAL);
+        if (n > 0) {
+            client.out_offset += static_cast<size_t>(n);
+            continue;
+        }
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            return false;
+        }
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        disconnect(client);
+        return false;
+    }
+    if (client.out_length > 0) {
+        sent_.fetch_add(1, std::memory_order_relaxed);
+        client.out_length = 0;
+        client.out_offset = 0;
+    }
+    return client.fd >= 0;
+}
+
+void SyntheticLoad::prepareChat(Client& client, int64_t now_ns) {
+    ChatMessage& out = client.out;
+    out.type = MessageType::CLIENT_CHAT;
+    out.length = static_cast<uint16_t>(config_.payload);
+
+    char header[MIN_PAYLOAD + 1];
+    snprintf(header, sizeof(header), "t=%016llx c=%08x s=%08x ", static_cast<unsigned long long>(now_ns),
+             client.id, static_cast<uint32_t>(client.seq++));
+    memcpy(out.data, header, MIN_PAYLOAD);
+    for (size_t i = MIN_PAYLOAD; i < config_.payload; ++i) {
+        out.data[i] = static_cast<char>('a' + (i + client.seq) % 26);
+    }
+    client.out_offset = 0;
+    client.out_length = sizeof(ChatMessage);   // 서버는 고정 크기 프레임을 읽는다
+}
+
+void SyntheticLoad::receive(Driver& driver, Client& client, char* buffer, size_t size) {
+    while (client.fd >= 0) {
+        const ssize_t n = recv(client.fd, buffer, size, MSG_DONTWAIT);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            return;
+        }
+        if (n <= 0) {
+            // 서버가 닫음 (드레인, 오류)
+            disconnect(client);
+            return;
+        }
+
+        const int64_t now_ns = Clock::getInstance().now();
+        client.assembler.feed(reinterpret_cast<const uint8_t*>(buffer), static_cast<size_t>(n),
+            [&](const ChatMessage& message) {
+                int64_t sent_ns = 0;
+                if (message.type == MessageType::SERVER_CHAT) {
+                    received_.fetch_add(1, std::memory_order_relaxed);
+                    if (parseSentAt(message, sent_ns) && now_ns >= sent_ns) {
+                        driver.local.record(static_cast<uint64_t>(now_ns - sent_ns) / 1000);
+                    }
+                }
+                return true;
+            });
+    }
+}
+
+void SyntheticLoad::disconnect(Client& client) {
+    if (client.fd < 0) {
+        return;
+    }
+    close(client.fd);
+    client.fd = -1;
+    client.out_length = 0;
+    client.assembler.reset();
+    if (!should_stop_.load(std::memory_order_acquire)) {
+        disconnected_.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void SyntheticLoad::mergeLatency(Driver& driver) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    merged_.merge(driver.local);
+    driver.local = LatencyHistogram{};
+}
+
+std::string SyntheticLoad::describe() const {
+    if (!running_.load(std::memory_order_acquire)) {
+        return "synthetic: disabled";
+    }
+    const double elapsed_s = static_cast<double>(Clock::getInstance().now() - started_ns_) / 1e9;
+    const uint64_t sent = sent_.load(std::memory_order_relaxed);
+    const uint64_t received = received_.load(std::memory_order_relaxed);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::ostringstream ss;
+    ss << "synthetic: clients=" << config_.clients
+       << " sent=" << sent
+       << " received=" << received
+       << " blocked=" << send_blocked_.load(std::memory_order_relaxed)
+       << " disconnected=" << disconnected_.load(std::memory_order_relaxed)
+       << " sent_per_s=" << static_cast<uint64_t>(elapsed_s > 0 ? sent / elapsed_s : 0)
+       << " received_per_s=" << static_cast<uint64_t>(elapsed_s > 0 ? received / elapsed_s : 0)
+       << " p50_us=" << merged_.percentile(0.50)
+       << " p99_us=" << merged_.percentile(0.99)
+       << " max_us=" << merged_.max();
+    return ss.str();
+}
@@ -0,0 +1,211 @@
+#include "TokenAuth.h"
+#include "Logger.h"
+#include <openssl/hmac.h>
+#include <openssl/evp.h>
+#include <openssl/crypto.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+
+AuthCompletionQueue::AuthCompletionQueue() {
+    event_fd_ = eventfd(0, EFD_CLOEXEC);
+    if (event_fd_ < 0) {
+        throw std::runtime_error("Failed to create auth eventfd");
+    }
+}
+
+AuthCompletionQueue::~AuthCompletionQueue() {
+    if (event_fd_ >= 0) {
+        close(event_fd_);
+    }
+}
+
+void AuthCompletionQueue::push(AuthResult&& result) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        results_.push_back(std::move(result));
+    }
+    uint64_t one = 1;
+    if (write(event_fd_, &one, sizeof(one)) != sizeof(one)) {
+        LOG_ERROR("[TokenAuth] eventfd write failed");
+    }
+}
+
+std::vector<AuthResult> AuthCompletionQueue::drain() {
+    std::vector<AuthResult> out;
+    std::lock_guard<std::mutex> lock(mutex_);
+    out.swap(results_);
+    return out;
+}
+
+bool TokenCache::lookup(const ParsedToken& token, int64_t now) {
+    auto it = entries_.find(token.mac);
+    if (it == entries_.end() || it->second.payload != token.payload) {
+        misses_++;
+        return false;
+    }
+    if (it->second.expires_at <= now) {
+        entries_.erase(it);
+        misses_++;
+        return false;
+    }
+    hits_++;
+    return true;
+}
+
+void TokenCache::insert(const ParsedToken& token, int64_t now) {
+    if (entries_.size() >= MAX_ENTRIES) {
+        evictExpired(now);
+        if (entries_.size() >= MAX_ENTRIES) {
+            entries_.erase(entries_.begin());
+        }
+    }
+    int64_t expires_at = std::min(token.expires_at, now + CACHE_TTL_SEC);
+    entries_[token.mac] = Entry{token.payload, expires_at};
+}
+
+void TokenCache::evictExpired(int64_t now) {
+    for (auto it = entries_.begin(); it != entries_.end();) {
+        if (it->second.expires_at <= now) {
+            it = entries_.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+TokenAuth::~TokenAuth() {
+    stop();
+}
+
+void TokenAuth::initialize() {
+    const char* secret = std::getenv("CHAT_AUTH_SECRET");
+    if (!secret || !*secret) {
+        LOG_INFO("[TokenAuth] CHAT_AUTH_SECRET not set, join authentication disabled");
+        return;
+    }
+    secret_ = secret;
+
+    size_t num_helpers = DEFAULT_HELPER_THREADS;
+    if (const char* env = std::getenv("CHAT_AUTH_THREADS")) {
+        num_helpers = std::max(1, std::atoi(env));
+    }
+    if (const char* env = std::getenv("CHAT_AUTH_QUEUE")) {
+        max_queued_ = static_cast<size_t>(std::max(1, std::atoi(env)));
+    }
+    if (const char* env = std::getenv("CHAT_ADMIN_USERS")) {
+        std::string users(env);
+        size_t start = 0;
+        while (start <= users.size()) {
+            size_t end = users.find(',', start);
+            if (end == std::string::npos) {
+                end = users.size();
+            }
+            if (end > start) {
+                admin_users_.insert(users.substr(start, end - start));
+            }
+            start = end + 1;
+        }
+    }
+
+    should_stop_ = false;
+    for (size_t i = 0; i < num_helpers; ++i) {
+        helpers_.emplace_back(&TokenAuth::helperThread, this);
+    }
+    LOG_INFO("[TokenAuth] Join authentication enabled with ", num_helpers, " helper threads, up to ",
+             max_queued_, " queued verifications, ", admin_users_.size(), " admin users");
+}
+
+void TokenAuth::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        should_stop_ = true;
+    }
+    cv_.notify_all();
+    for (auto& thread : helpers_) {
+        if (thread.joinable()) {
+            thread.join();
+        }
+    }
+    helpers_.clear();
+}
+
+bool TokenAuth::parse(const char* data, size_t length, ParsedToken& out) {
+    std::string token(data, length);
+    size_t first = token.find(':');
+    size_t last = token.rfind(':');
+    if (first == std::string::npos || first == last || first == 0) {
+        return false;
+    }
+
+    out.payload = token.substr(0, last);
+    out.user = token.substr(0, first);
+    out.mac = token.substr(last + 1);
+    if (out.mac.size() != 64) {  // SHA-256 hex
+        return false;
+    }
+
+    char* end = nullptr;
+    std::string expires = token.substr(first + 1, last - first - 1);
+    out.expires_at = std::strtoll(expires.c_str(), &end, 10);
+    return end && *end == '\0' && !expires.empty();
+}
+
+bool TokenAuth::verify(const ParsedToken& token) const {
+    if (token.expires_at <= nowSeconds()) {
+        return false;
+    }
+
+    unsigned char digest[EVP_MAX_MD_SIZE];
+    unsigned int digest_len = 0;
+    if (!HMAC(EVP_sha256(), secret_.data(), static_cast<int>(secret_.size()),
+              reinterpret_cast<const unsigned char*>(token.payload.data()), token.payload.size(),
+              digest, &digest_len)) {
+        return false;
+    }
+
+    static const char hex[] = "0123456789abcdef";
+    char expected[EVP_MAX_MD_SIZE * 2];
+    for (unsigned int i = 0; i < digest_len; ++i) {
+        expected[i * 2] = hex[digest[i] >> 4];
+        expected[i * 2 + 1] = hex[digest[i] & 0x0F];
+    }
+
+    return token.mac.size() == digest_len * 2 &&
+           CRYPTO_memcmp(expected, token.mac.data(), token.mac.size()) == 0;
+}
+
+bool TokenAuth::submit(AuthResult&& request, AuthCompletionQueue* target) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (jobs_.size() >= max_queued_) {
+            return false;
+        }
+        jobs_.push_back(Job{std::move(request), target});
+    }
+    cv_.notify_one();
+    return true;
+}
+
+void TokenAuth::helperThread() {
+    while (true) {
+        Job job;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            cv_.wait(lock, [this] { return should_stop_ || !jobs_.empty(); });
+            if (should_stop_ && jobs_.empty()) {
+                return;
+            }
+            job = std::move(jobs_.front());
+            jobs_.pop_front();
+        }
+
+        job.request.verified = verify(job.request.token);
+        LOG_DEBUG("[TokenAuth] Token for client ", job.request.client_fd,
+                  (job.request.verified ? " verified" : " rejected"));
+        job.target->push(std::move(job.request));
+    }
+}
@@ -10,6 +10,7 @@
 #include <mutex>
 #include <iostream>
 #include "Utils.h"
+#include "Clock.h"
 
 template <unsigned N> constexpr bool is_power_of_two() {
     static_assert(N <= 32768, "N must be N <= 32768");
@@ -40,8 +41,8 @@ uint8_t* UringBuffer::getBufferAddr(uint16_t idx, uint8_t* buf_base_addr) {
     return buf_base_addr + (idx << log2<UringBuffer::IO_BUFFER_SIZE>());
 }
 
-UringBuffer::UringBuffer(io_uring* ring) 
-    : ring_(ring), buf_ring_(nullptr), buffer_base_addr_(nullptr), ring_size_(buffer_ring_size()),
+UringBuffer::UringBuffer(Reactor* reactor) 
+    : reactor_(reactor), buf_ring_(nullptr), buffer_base_addr_(nullptr), ring_size_(buffer_ring_size()),
       buffers_(NUM_IO_BUFFERS) {
     initBufferRing();
 }
@@ -66,7 +67,7 @@ void UringBuffer::initBufferRing() {
     reg.ring_entries = NUM_IO_BUFFERS;
     reg.bgid = 1;  // Buffer group ID
 
-    if (io_uring_register_buf_ring(ring_, &reg, 0) < 0) {
+    if (reactor_->registerBufRing(&reg) < 0) {
         munmap(ring_addr, ring_size_);
         throw std::runtime_error("Failed to register buffer ring");
     }
@@ -80,7 +81,7 @@ void UringBuffer::initBufferRing() {
     for (uint16_t i = 0; i < NUM_IO_BUFFERS; ++i) {
         buffers_[i].in_use = false;
         buffers_[i].client_fd = 0;
-        buffers_[i].allocation_time = std::chrono::steady_clock::now();
+        buffers_[i].allocation_ns = 0;
         buffers_[i].bytes_used = 0;
         buffers_[i].total_uses = 0;
         buffers_[i].ref_count = 0;
@@ -103,7 +104,7 @@ void UringBuffer::markBufferInUse(uint16_t idx, uint16_t client_fd) {
     
     buffers_[idx].in_use = true;
     buffers_[idx].client_fd = client_fd;
-    buffers_[idx].allocation_time = std::chrono::steady_clock::now();
+    buffers_[idx].allocation_ns = LoopClock::now();
     buffers_[idx].total_uses++;
     
     LOG_DEBUG("[Buffer] Session buffer #", idx, " allocated -> client ", client_fd,
@@ -131,9 +132,7 @@ void UringBuffer::releaseBuffer(uint16_t idx, uint8_t* buf_base_addr) {
     }
     
     uint16_t client_fd = buffers_[idx].client_fd;
-    auto usage_time = std::chrono::duration_cast<std::chrono::milliseconds>(
-        std::chrono::steady_clock::now() - buffers_[idx].allocation_time
-    ).count();
+    auto usage_time = (LoopClock::now() - buffers_[idx].allocation_ns) / 1000000;
 
     LOG_DEBUG("[Buffer] Session buffer #", idx, " released <- client ", client_fd,
              "\n\tBytes used: ", buffers_[idx].bytes_used,
@@ -0,0 +1,29 @@
+#include "UringReactor.h"
+#include "Logger.h"
+#include <stdexcept>
+#include <cstring>
+
+UringReactor::UringReactor(unsigned entries) {
+    io_uring_params params{};
+    memset(&params, 0, sizeof(params));
+    int ret = io_uring_queue_init_params(entries, &ring_, &params);
+    if (ret < 0) {
+        LOG_FATAL("Failed to initialize io_uring: ", ret);
+        throw std::runtime_error("Failed to initialize io_uring");
+    }
+    LOG_INFO("io_uring initialized successfully");
+}
+
+UringReactor::~UringReactor() {
+    io_uring_queue_exit(&ring_);
+}
+
+bool UringReactor::supportsOpcode(int opcode) {
+    io_uring_probe* probe = io_uring_get_probe_ring(&ring_);
+    if (!probe) {
+        return false;
+    }
+    bool supported = io_uring_opcode_supported(probe, opcode);
+    io_uring_free_probe(probe);
+    return supported;
+}
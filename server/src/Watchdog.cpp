@@ -0,0 +1,165 @@
+#include "Watchdog.h"
+#include "Clock.h"
+#include "Context.h"
+#include "Logger.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <sstream>
+#include <unistd.h>
+
+namespace {
+    const char* operationName(uint8_t op) {
+        switch (static_cast<OperationType>(op)) {
+            case OperationType::ACCEPT: return "ACCEPT";
+            case OperationType::READ: return "READ";
+            case OperationType::WRITE: return "WRITE";
+            case OperationType::CLOSE: return "CLOSE";
+            case OperationType::AUTH: return "AUTH";
+            case OperationType::TIMER: return "TIMER";
+            case OperationType::SOCKOPT: return "SOCKOPT";
+            case OperationType::SPLICE: return "SPLICE";
+            case OperationType::SEND_ZC: return "SEND_ZC";
+            case OperationType::UPLOAD: return "UPLOAD";
+            case OperationType::DRAIN: return "DRAIN";
+            case OperationType::THROTTLE: return "THROTTLE";
+            default: return "?";
+        }
+    }
+
+    // Logger 잠금을 피해 한 번의 write로 출력
+    void writeStderr(const std::string& text) {
+        const char* data = text.data();
+        size_t left = text.size();
+        while (left > 0) {
+            ssize_t n = write(STDERR_FILENO, data, left);
+            if (n <= 0) {
+                return;
+            }
+            data += n;
+            left -= static_cast<size_t>(n);
+        }
+    }
+}
+
+Watchdog::~Watchdog() {
+    stop();
+}
+
+void Watchdog::start() {
+    if (const char* env = std::getenv("CHAT_STALL_MS")) {
+        threshold_ns_ = std::strtoll(env, nullptr, 10) * 1000000;
+    }
+    if (threshold_ns_ <= 0) {
+        LOG_INFO("[Watchdog] Stall detection disabled");
+        return;
+    }
+    if (thread_.joinable()) {
+        return;
+    }
+
+    should_stop_ = false;
+    thread_ = std::thread(&Watchdog::run, this);
+    LOG_INFO("[Watchdog] Stall threshold ", threshold_ns_ / 1000000, "ms");
+}
+
+void Watchdog::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        should_stop_ = true;
+    }
+    cv_.notify_all();
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+}
+
+void Watchdog::watch(WorkerHeartbeat* heartbeat) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    workers_.push_back(heartbeat);
+}
+
+void Watchdog::unwatch(WorkerHeartbeat* heartbeat) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    workers_.erase(std::remove(workers_.begin(), workers_.end(), heartbeat), workers_.end());
+}
+
+void Watchdog::run() {
+    // 기준 시간의 1/4 주기로 훑는다 (감지 지연은 기준의 125% 이내)
+    const auto interval = std::chrono::nanoseconds(threshold_ns_ / 4);
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (!should_stop_) {
+        cv_.wait_for(lock, interval, [this] { return should_stop_; });
+        if (should_stop_) {
+            break;
+        }
+        const int64_t now_ns = Clock::getInstance().now();
+        for (WorkerHeartbeat* heartbeat : workers_) {
+            check(*heartbeat, now_ns);
+        }
+    }
+}
+
+void Watchdog::check(WorkerHeartbeat& heartbeat, int64_t now_ns) {
+    const uint64_t beats = heartbeat.getBeats();
+    const bool reported = heartbeat.reported_beats != UINT64_MAX;
+
+    if (reported && (beats != heartbeat.reported_beats || heartbeat.isIdle())) {
+        // 보고한 정지에서 빠져나옴
+        const int64_t stalled_ns = now_ns - heartbeat.stalled_since_ns;
+        writeStderr("[STALL] " + heartbeat.getName() + " recovered after ~" +
+                    std::to_string(stalled_ns / 1000000) + "ms\n");
+        heartbeat.reported_beats = UINT64_MAX;
+        return;
+    }
+    if (reported || heartbeat.isIdle()) {
+        return;
+    }
+
+    const int64_t last_beat = heartbeat.getLastBeat();
+    const int64_t stalled_ns = now_ns - last_beat;
+    if (last_beat == 0 || stalled_ns < threshold_ns_) {
+        return;
+    }
+
+    heartbeat.reported_beats = beats;
+    heartbeat.stalled_since_ns = last_beat;
+    heartbeat.countStall();
+    stalls_.fetch_add(1, std::memory_order_relaxed);
+    writeStderr(describe(heartbeat, now_ns, stalled_ns));
+}
+
+std::string Watchdog::describe(const WorkerHeartbeat& heartbeat, int64_t now_ns, int64_t stalled_ns) const {
+    std::ostringstream ss;
+    ss << "[STALL] " << heartbeat.getName() << " has not advanced for " << stalled_ns / 1000000 << "ms";
+    if (const char* lock_name = heartbeat.getLockWait()) {
+        ss << ", waiting on lock '" << lock_name << "'";
+    }
+    ss << "\n";
+
+    const uint64_t head = heartbeat.getHead();
+    if (head == 0) {
+        ss << "  (no completions recorded)\n";
+        return ss.str();
+    }
+
+    auto format = [&](const WorkerHeartbeat::FlightEvent& event) {
+        ss << operationName(event.op.load(std::memory_order_relaxed))
+           << " fd=" << event.fd.load(std::memory_order_relaxed)
+           << " res=" << event.res.load(std::memory_order_relaxed)
+           << " (" << (now_ns - event.ns.load(std::memory_order_relaxed)) / 1000000 << "ms ago)\n";
+    };
+
+    // 가장 최근 이벤트가 처리 중이던 완료
+    ss << "  current: ";
+    format(heartbeat.getEvent(head - 1));
+
+    const uint64_t count = std::min<uint64_t>({head, REPORT_EVENTS, WorkerHeartbeat::FLIGHT_RECORDER_SIZE});
+    ss << "  last " << count << " completions (oldest first):\n";
+    for (uint64_t slot = head - count; slot < head; ++slot) {
+        ss << "    ";
+        format(heartbeat.getEvent(slot));
+    }
+    return ss.str();
+}
@@ -0,0 +1,120 @@
+#include "IpBlocklist.h"
+#include "TestUtil.h"
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+    Cidr cidr(const std::string& text) {
+        Cidr range;
+        CHECK(Cidr::parse(text, range));
+        return range;
+    }
+
+    uint32_t ip(const std::string& text) {
+        return cidr(text).addr;
+    }
+
+    // 가장 긴 일치 접두사 길이를 전수 검사로 (없으면 -1)
+    int bruteForceLength(const std::vector<Cidr>& ranges, uint32_t addr) {
+        int best = -1;
+        for (const Cidr& range : ranges) {
+            if (range.contains(addr) && static_cast<int>(range.length) > best) {
+                best = range.length;
+            }
+        }
+        return best;
+    }
+
+    int lookupLength(const IpBlocklist& list, uint32_t addr) {
+        const uint32_t match = list.lookup(addr);
+        if (match == IpBlocklist::NO_MATCH) {
+            return -1;
+        }
+        CHECK(list.getRange(match).contains(addr));
+        return list.getRange(match).length;
+    }
+
+    void testParse() {
+        Cidr range;
+        CHECK(Cidr::parse("10.1.2.3/8", range));
+        CHECK_EQ(range.toString(), std::string("10.0.0.0/8"));   // prefix 밖 비트는 지운다
+        CHECK(Cidr::parse("192.0.2.1", range));
+        CHECK_EQ(static_cast<int>(range.length), 32);
+        CHECK(Cidr::parse("0.0.0.0/0", range));
+        CHECK(range.contains(ip("255.255.255.255")));
+
+        CHECK(!Cidr::parse("10.0.0.0/33", range));
+        CHECK(!Cidr::parse("10.0.0.0/", range));
+        CHECK(!Cidr::parse("10.0.0.0/8x", range));
+        CHECK(!Cidr::parse("10.0.0", range));
+        CHECK(!Cidr::parse("", range));
+    }
+
+    void testLongestPrefix() {
+        // 직접 인덱스(/16)와 stride 경계(/22, /28, /32)에 걸친 중첩 범위
+        IpBlocklist list({cidr("10.0.0.0/8"), cidr("10.1.0.0/16"), cidr("10.1.4.0/22"),
+                          cidr("10.1.5.16/28"), cidr("10.1.5.17/32"), cidr("192.168.0.0/31")});
+
+        CHECK_EQ(lookupLength(list, ip("10.200.0.1")), 8);
+        CHECK_EQ(lookupLength(list, ip("10.1.0.1")), 16);
+        CHECK_EQ(lookupLength(list, ip("10.1.4.0")), 22);
+        CHECK_EQ(lookupLength(list, ip("10.1.7.255")), 22);
+        CHECK_EQ(lookupLength(list, ip("10.1.8.0")), 16);
+        CHECK_EQ(lookupLength(list, ip("10.1.5.16")), 28);
+        CHECK_EQ(lookupLength(list, ip("10.1.5.17")), 32);
+        CHECK_EQ(lookupLength(list, ip("10.1.5.18")), 28);
+        CHECK_EQ(lookupLength(list, ip("10.1.5.32")), 22);
+        CHECK_EQ(lookupLength(list, ip("192.168.0.1")), 31);
+        CHECK_EQ(lookupLength(list, ip("192.168.0.2")), -1);
+        CHECK_EQ(lookupLength(list, ip("9.255.255.255")), -1);
+        CHECK_EQ(lookupLength(list, ip("11.0.0.0")), -1);
+    }
+
+    void testDefaultRoute() {
+        IpBlocklist list({cidr("0.0.0.0/0"), cidr("203.0.113.7/32")});
+        CHECK_EQ(lookupLength(list, ip("0.0.0.0")), 0);
+        CHECK_EQ(lookupLength(list, ip("203.0.113.7")), 32);
+        CHECK_EQ(lookupLength(list, ip("203.0.113.8")), 0);
+
+        IpBlocklist empty({});
+        CHECK_EQ(empty.lookup(ip("1.2.3.4")), IpBlocklist::NO_MATCH);
+    }
+
+    void testRandomAgainstBruteForce() {
+        std::mt19937 rng(12345);
+        // 접두사가 서로 겹치도록 좁은 주소 공간에서 뽑는다
+        std::uniform_int_distribution<uint32_t> base(0, 0xFFFF);
+        std::uniform_int_distribution<int> length(0, 32);
+        std::vector<Cidr> ranges;
+        for (int i = 0; i < 300; ++i) {
+            Cidr range;
+            range.length = static_cast<uint8_t>(length(rng));
+            const uint32_t addr = 0x0A000000u | (base(rng) << 8) | (rng() & 0xFF);
+            range.addr = range.length == 0 ? 0 : addr & (~0u << (32 - range.length));
+            ranges.push_back(range);
+        }
+        IpBlocklist list(ranges);
+
+        for (int i = 0; i < 200000; ++i) {
+            uint32_t addr = rng();
+            if (i % 2 == 0) {
+                addr = 0x0A000000u | (addr & 0x00FFFFFFu);      // 절반은 범위가 몰린 10/8 안에서
+            }
+            const int expected = bruteForceLength(ranges, addr);
+            const int actual = lookupLength(list, addr);
+            if (expected != actual) {
+                CHECK_EQ(actual, expected);
+                break;
+            }
+        }
+    }
+}
+
+int main() {
+    testParse();
+    testLongestPrefix();
+    testDefaultRoute();
+    testRandomAgainstBruteForce();
+    return test::testResult();
+}
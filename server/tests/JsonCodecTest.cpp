@@ -0,0 +1,236 @@
+#include "JsonCodec.h"
+#include "CommandCodec.h"
+#include "TestUtil.h"
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+    bool isStructural(char c) {
+        return c == '{' || c == '}' || c == '[' || c == ':' || c == ']' || c == ',';
+    }
+
+    // 바이트 단위 기준 구현: 역슬래시 다음 바이트는 이스케이프, 이스케이프되지 않은 따옴표가 문자열을 여닫는다
+    bool referenceIndex(const std::string& text, std::vector<uint32_t>& positions) {
+        positions.clear();
+        bool in_string = false;
+        bool escaped = false;
+        for (size_t i = 0; i < text.size(); ++i) {
+            const char c = text[i];
+            const bool is_escaped = escaped;
+            escaped = !is_escaped && c == '\\';
+            if (c == '"' && !is_escaped) {
+                positions.push_back(static_cast<uint32_t>(i));
+                in_string = !in_string;
+            } else if (!in_string && isStructural(c)) {
+                positions.push_back(static_cast<uint32_t>(i));
+            }
+        }
+        return !in_string;
+    }
+
+    void checkIndex(const std::string& text) {
+        json::StructuralIndex index;
+        std::vector<uint32_t> expected;
+        const bool expected_closed = referenceIndex(text, expected);
+        const bool closed = index.build(text.data(), text.size());
+        if (closed != expected_closed || index.positions() != expected) {
+            std::cerr << "index mismatch for: " << text << std::endl;
+            CHECK_EQ(closed, expected_closed);
+            CHECK_EQ(index.positions().size(), expected.size());
+        }
+    }
+
+    bool decode(const std::string& line, ChatMessage& message, std::string& error) {
+        message = ChatMessage{};
+        error.clear();
+        return json::decode(line.data(), line.size(), message, error);
+    }
+
+    std::string decodeError(const std::string& line) {
+        ChatMessage message;
+        std::string error;
+        CHECK(!decode(line, message, error));
+        return error;
+    }
+
+    std::string body(const ChatMessage& message) {
+        return std::string(message.data, message.length);
+    }
+
+    void testIndexEscapesAcrossBlocks() {
+        // 이스케이프 판단이 16바이트 블록 경계를 넘는 경우: 역슬래시가 블록 끝, 따옴표가 다음 블록 첫 바이트
+        for (size_t pad = 0; pad < 40; ++pad) {
+            const std::string prefix = "{\"t\":\"" + std::string(pad, 'a');
+            checkIndex(prefix + "\\\"x\"}");          // \"  이스케이프된 따옴표
+            checkIndex(prefix + "\\\\\"}");           // \\" 역슬래시 뒤에 닫는 따옴표
+            checkIndex(prefix + "\\\\\\\"x\"}");      // \\\" 다시 이스케이프된 따옴표
+            checkIndex(prefix + "{}[],:\"}");         // 문자열 안의 구조 문자
+            checkIndex(prefix + "\\");                // 역슬래시로 끝나는 닫히지 않은 문자열
+        }
+    }
+
+    void testIndexRandomAgainstReference() {
+        static const char ALPHABET[] = "\"\\{}[]:,a ";
+        std::mt19937 rng(2024);
+        std::uniform_int_distribution<size_t> pick(0, sizeof(ALPHABET) - 2);
+        std::uniform_int_distribution<size_t> length(0, 80);
+        for (int i = 0; i < 20000; ++i) {
+            std::string text(length(rng), ' ');
+            for (char& c : text) {
+                c = ALPHABET[pick(rng)];
+            }
+            checkIndex(text);
+        }
+    }
+
+    void testDecodeChatAndCommand() {
+        ChatMessage message;
+        std::string error;
+
+        CHECK(decode("{\"type\":\"chat\",\"text\":\"hello\"}", message, error));
+        CHECK(message.type == MessageType::CLIENT_CHAT);
+        CHECK_EQ(body(message), std::string("hello"));
+
+        // 이스케이프: \" \\ \/ \n \t, \u 한 글자, 서로게이트 쌍
+        CHECK(decode("{\"type\":\"chat\",\"text\":\"a\\\"b\\\\c\\/d\\n\\t\\u00e9\\ud83d\\ude00\"}", message, error));
+        CHECK_EQ(body(message), std::string("a\"b\\c/d\n\t\xc3\xa9\xf0\x9f\x98\x80"));
+
+        // 공백과 키 순서, 모르는 키 (중첩 값 안의 구조 문자와 따옴표는 건너뛴다)
+        CHECK(decode("  { \"x\" : {\"a\":[1,{\"b\":\"}]\\\"\"}]} , \"text\" : \"stats\" ,\"type\":\"command\" }  ",
+                     message, error));
+        CHECK(message.type == MessageType::CLIENT_COMMAND);
+        CHECK_EQ(body(message), std::string("stats"));
+
+        CHECK(decode("{\"type\":\"chat\",\"room\":-3,\"text\":\"hi\"}", message, error));
+        CHECK(message.type == MessageType::CLIENT_ROOM_CHAT);
+        command::RoomChat chat;
+        CHECK(chat.parse(message.data, message.length));
+        CHECK_EQ(chat.room_id(), -3);
+        CHECK(chat.text() == "hi");
+    }
+
+    void testDecodeAcrossBlockOffsets() {
+        // 같은 요청을 앞 공백만 바꿔 가며: 토큰이 블록 경계의 모든 위치에 걸친다
+        for (size_t pad = 0; pad < 34; ++pad) {
+            ChatMessage message;
+            std::string error;
+            const std::string line = std::string(pad, ' ') + "{\"type\":\"chat\",\"text\":\"q\\\"uote\\\\\"}";
+            CHECK(decode(line, message, error));
+            CHECK_EQ(body(message), std::string("q\"uote\\"));
+        }
+    }
+
+    void testDecodeJoinLeaveMulticast() {
+        ChatMessage message;
+        std::string error;
+
+        CHECK(decode("{\"type\":\"join\",\"room\":7,\"token\":\"abc\"}", message, error));
+        CHECK(message.type == MessageType::CLIENT_JOIN);
+        command::JoinRequest join;
+        CHECK(join.parse(message.data, message.length));
+        CHECK_EQ(join.session_id(), 7);
+        CHECK(join.token() == "abc");
+
+        CHECK(decode("{\"type\":\"leave\"}", message, error));
+        CHECK(message.type == MessageType::CLIENT_LEAVE);
+        CHECK_EQ(message.length, 0);
+
+        CHECK(decode("{\"type\":\"multicast\",\"rooms\":[0, 2],\"users\":[\"a\",\"b\"],\"text\":\"m\"}", message, error));
+        command::Multicast multicast;
+        CHECK(multicast.parse(message.data, message.length));
+        CHECK_EQ(multicast.rooms().size(), 2u);
+        CHECK_EQ(multicast.rooms()[1].room_id(), 2);
+        CHECK(multicast.users() == "a,b");
+        CHECK(multicast.text() == "m");
+
+        CHECK(decode("{\"type\":\"multicast\",\"rooms\":[],\"text\":\"m\"}", message, error));
+    }
+
+    void testDecodeErrors() {
+        CHECK_EQ(decodeError("{\"type\":\"chat\",\"text\":\"abc}"), std::string("unterminated string"));
+        CHECK_EQ(decodeError("{\"type\":\"chat\",\"text\":\"abc\\\"}"), std::string("unterminated string"));
+        CHECK_EQ(decodeError("{\"type\":\"chat\",\"text\":\"a\"} x"), std::string("trailing data after object"));
+        CHECK_EQ(decodeError("{\"type\":\"chat\",\"text\":\"a\"}{}"), std::string("trailing data after object"));
+        CHECK_EQ(decodeError("[1]"), std::string("expected an object"));
+        CHECK_EQ(decodeError("x{\"type\":\"chat\"}"), std::string("expected an object"));
+        CHECK_EQ(decodeError("{\"text\":\"a\"}"), std::string("missing \"type\""));
+        CHECK_EQ(decodeError("{\"type\":\"dance\"}"), std::string("unknown type"));
+        CHECK_EQ(decodeError("{\"type\":\"chat\"}"), std::string("missing \"text\""));
+        CHECK_EQ(decodeError("{\"type\":\"join\"}"), std::string("join needs \"room\""));
+        CHECK_EQ(decodeError("{\"type\":\"chat\",\"text\":\"\\q\"}"), std::string("bad value for \"text\""));
+        CHECK_EQ(decodeError("{\"type\":\"chat\",\"text\":\"\\u12\"}"), std::string("bad value for \"text\""));
+        CHECK_EQ(decodeError("{\"type\":\"chat\",\"text\":\"\\ud83d\"}"), std::string("bad value for \"text\""));
+        CHECK_EQ(decodeError("{\"type\":\"chat\",\"room\":\"1\",\"text\":\"a\"}"), std::string("bad value for \"room\""));
+        CHECK_EQ(decodeError("{\"type\":\"chat\",\"room\":99999999999,\"text\":\"a\"}"),
+                 std::string("bad value for \"room\""));
+        CHECK_EQ(decodeError("{\"type\" \"chat\"}"), std::string("expected ':' after \"type\""));
+        CHECK_EQ(decodeError("{\"type\":\"command\",\"text\":\"\\u0001x\"}"),
+                 std::string("binary commands are not available over JSON"));
+        CHECK_EQ(decodeError("{\"type\":\"chat\",\"text\":\"" + std::string(513, 'a') + "\"}"),
+                 std::string("text too long"));
+        CHECK_EQ(decodeError("{\"type\":\"multicast\",\"users\":[\"a,b\"],\"text\":\"m\"}"), std::string("bad user id"));
+    }
+
+    void testEncodeRoundTrip() {
+        std::string text = "plain \"quoted\" back\\slash\n\t";
+        text += '\x01';
+        text += '\x1f';
+        text += "\xc3\xa9";
+
+        ChatMessage reply{};
+        reply.type = MessageType::SERVER_CHAT;
+        reply.length = static_cast<uint16_t>(text.size());
+        memcpy(reply.data, text.data(), text.size());
+        const std::string line = json::encode(reply);
+        CHECK(!line.empty() && line.back() == '\n');
+
+        // 인코딩한 줄을 같은 파서로 다시 읽으면 본문이 그대로 나온다
+        const std::string request = "{\"type\":\"chat\"," + line.substr(line.find("\"text\""), std::string::npos);
+        ChatMessage message;
+        std::string error;
+        CHECK(decode(request.substr(0, request.size() - 1), message, error));
+        CHECK_EQ(body(message), text);
+
+        std::string escaped;
+        json::appendEscaped(escaped, "\x00", 1);
+        CHECK_EQ(escaped, std::string("\\u0000"));
+    }
+
+    void testLineAssembler() {
+        JsonLineAssembler assembler;
+        std::vector<std::string> bodies;
+        std::vector<std::string> errors;
+        auto on_frame = [&](const ChatMessage& message) {
+            bodies.push_back(body(message));
+            return true;
+        };
+        auto on_error = [&](const std::string& error) { errors.push_back(error); };
+
+        const std::string stream = "{\"type\":\"chat\",\"text\":\"one\"}\r\n\n{\"type\":\"chat\",\"te"
+                                   "xt\":\"two\"}\nnot json\n{\"type\":\"chat\",\"text\":\"three\"}\n";
+        // 한 바이트씩 넣어도 줄 경계를 잃지 않는다
+        for (char c : stream) {
+            CHECK(assembler.feed(reinterpret_cast<const uint8_t*>(&c), 1, on_frame, on_error));
+        }
+        CHECK_EQ(bodies.size(), 3u);
+        CHECK(bodies == (std::vector<std::string>{"one", "two", "three"}));
+        CHECK_EQ(errors.size(), 1u);
+        CHECK_EQ(assembler.buffered(), 0u);
+
+        const std::string huge(JsonLineAssembler::MAX_LINE + 1, 'a');
+        CHECK(!assembler.feed(reinterpret_cast<const uint8_t*>(huge.data()), huge.size(), on_frame, on_error));
+    }
+}
+
+int main() {
+    testIndexEscapesAcrossBlocks();
+    testIndexRandomAgainstReference();
+    testDecodeChatAndCommand();
+    testDecodeAcrossBlockOffsets();
+    testDecodeJoinLeaveMulticast();
+    testDecodeErrors();
+    testEncodeRoundTrip();
+    testLineAssembler();
+    return test::testResult();
+}
@@ -0,0 +1,169 @@
+#include "RaftLog.h"
+#include "TestUtil.h"
+#include <algorithm>
+#include <string>
+#include <vector>
+
+namespace {
+    // 임기 목록으로 로그를 만든다 (명령은 "인덱스@임기")
+    RaftLog makeLog(const std::vector<uint64_t>& terms) {
+        RaftLog log;
+        for (uint64_t term : terms) {
+            log.append(term, std::to_string(log.lastIndex() + 1) + "@" + std::to_string(term));
+        }
+        return log;
+    }
+
+    std::vector<RaftLog::Entry> slice(const RaftLog& log, uint64_t from, uint64_t to) {
+        std::vector<RaftLog::Entry> entries;
+        for (uint64_t index = from; index <= to && index <= log.lastIndex(); ++index) {
+            entries.push_back(log.at(index));
+        }
+        return entries;
+    }
+
+    std::vector<uint64_t> terms(const RaftLog& log) {
+        std::vector<uint64_t> result;
+        for (const auto& entry : log.entries()) {
+            result.push_back(entry.term);
+        }
+        return result;
+    }
+
+    void testMatches() {
+        const RaftLog log = makeLog({1, 1, 2});
+        CHECK(log.matches(0, 0));
+        CHECK(log.matches(2, 1));
+        CHECK(log.matches(3, 2));
+        CHECK(!log.matches(3, 1));
+        CHECK(!log.matches(4, 2));      // 팔로워 로그가 짧다
+
+        CHECK(makeLog({}).matches(0, 0));
+        CHECK_EQ(log.termAt(0), 0u);
+        CHECK_EQ(log.termAt(9), 0u);
+    }
+
+    void testIsUpToDate() {
+        const RaftLog log = makeLog({1, 2, 2});
+        CHECK(log.isUpToDate(3, 2));
+        CHECK(log.isUpToDate(5, 2));
+        CHECK(log.isUpToDate(1, 3));    // 마지막 임기가 높으면 짧아도 최신
+        CHECK(!log.isUpToDate(2, 2));
+        CHECK(!log.isUpToDate(9, 1));
+    }
+
+    void testMergeAppendsAndIsIdempotent() {
+        const RaftLog leader = makeLog({1, 1, 2, 2});
+        RaftLog follower = makeLog({1});
+
+        auto result = follower.merge(1, slice(leader, 2, 4));
+        CHECK_EQ(result.last_index, 4u);
+        CHECK_EQ(result.first_new, 2u);
+        CHECK(!result.truncated);
+        CHECK(terms(follower) == terms(leader));
+
+        // 같은 요청이 다시 오면 아무것도 바뀌지 않는다
+        result = follower.merge(1, slice(leader, 2, 4));
+        CHECK_EQ(result.first_new, 0u);
+        CHECK(!result.truncated);
+        CHECK_EQ(follower.lastIndex(), 4u);
+
+        // 순서가 바뀌어 늦게 온 짧은 요청이 뒤쪽 항목을 지우면 안 된다
+        result = follower.merge(1, slice(leader, 2, 2));
+        CHECK_EQ(result.last_index, 2u);
+        CHECK(!result.truncated);
+        CHECK_EQ(follower.lastIndex(), 4u);
+
+        // 빈 하트비트
+        result = follower.merge(4, {});
+        CHECK_EQ(result.last_index, 4u);
+        CHECK_EQ(result.first_new, 0u);
+    }
+
+    void testMergeTruncatesConflicts() {
+        const RaftLog leader = makeLog({1, 1, 3, 3});
+        RaftLog follower = makeLog({1, 1, 2, 2, 2});    // 이전 리더의 커밋되지 않은 항목
+
+        CHECK(follower.matches(2, 1));
+        const auto result = follower.merge(2, slice(leader, 3, 4));
+        CHECK(result.truncated);
+        CHECK_EQ(result.first_new, 3u);
+        CHECK_EQ(result.last_index, 4u);
+        CHECK(terms(follower) == terms(leader));
+        CHECK_EQ(follower.at(3).command, std::string("3@3"));
+    }
+
+    // 리더가 next_index를 되감으며 보내는 과정을 그대로 따라가 팔로워 로그가 리더와 같아지는지 (Raft 그림 7)
+    void testBackoffConverges() {
+        const RaftLog leader = makeLog({1, 1, 1, 4, 4, 5, 5, 6, 6, 6});
+        const std::vector<std::vector<uint64_t>> followers = {
+            {1, 1, 1, 4, 4, 5, 5, 6, 6},
+            {1, 1, 1, 4},
+            {1, 1, 1, 4, 4, 5, 5, 6, 6, 6, 6},
+            {1, 1, 1, 4, 4, 5, 5, 6, 6, 6, 7, 7},
+            {1, 1, 1, 4, 4, 4, 4},
+            {1, 1, 1, 2, 2, 2, 3, 3, 3, 3, 3},
+        };
+        for (const auto& follower_terms : followers) {
+            RaftLog follower = makeLog(follower_terms);
+            uint64_t next_index = leader.lastIndex() + 1;
+            int rounds = 0;
+            while (rounds++ < 32) {
+                const uint64_t prev_index = next_index - 1;
+                if (!follower.matches(prev_index, leader.termAt(prev_index))) {
+                    next_index = std::min(next_index - 1, follower.lastIndex() + 1);
+                    continue;
+                }
+                follower.merge(prev_index, slice(leader, next_index, leader.lastIndex()));
+                break;
+            }
+            CHECK(rounds <= 32);
+            // 리더의 모든 항목을 갖는다 (리더 뒤에 남은 더 긴 꼬리는 같은 임기일 때만 남을 수 있다)
+            for (uint64_t index = 1; index <= leader.lastIndex(); ++index) {
+                CHECK_EQ(follower.termAt(index), leader.termAt(index));
+            }
+        }
+    }
+
+    void testMajorityCommit() {
+        // 5개 노드 (자기 + 피어 4), 과반 3
+        const RaftLog log = makeLog({1, 1, 2, 2});
+        CHECK_EQ(log.majorityCommit(0, 2, {0, 0, 0, 0}, 3), 0u);
+        CHECK_EQ(log.majorityCommit(0, 2, {3, 0, 0, 0}, 3), 0u);
+        CHECK_EQ(log.majorityCommit(0, 2, {3, 3, 0, 0}, 3), 3u);
+        CHECK_EQ(log.majorityCommit(0, 2, {4, 3, 1, 0}, 3), 3u);
+        CHECK_EQ(log.majorityCommit(0, 2, {4, 4, 1, 0}, 3), 4u);
+        CHECK_EQ(log.majorityCommit(4, 2, {0, 0, 0, 0}, 3), 4u);   // 커밋 지점은 뒤로 가지 않는다
+
+        // 이전 임기 항목은 과반이 가져도 복제 수로 커밋하지 않는다 (Raft 그림 8)
+        RaftLog stale = makeLog({1, 2});
+        CHECK_EQ(stale.majorityCommit(0, 3, {2, 2, 2, 2}, 3), 0u);
+        stale.append(3, "noop");
+        CHECK_EQ(stale.majorityCommit(0, 3, {2, 2, 2, 2}, 3), 0u);
+        CHECK_EQ(stale.majorityCommit(0, 3, {3, 3, 2, 2}, 3), 3u);  // 현재 임기 항목과 함께 커밋
+
+        // 노드 하나짜리 클러스터
+        CHECK_EQ(log.majorityCommit(0, 2, {}, 1), 4u);
+    }
+
+    void testTruncate() {
+        RaftLog log = makeLog({1, 1, 2});
+        log.truncate(5);
+        CHECK_EQ(log.lastIndex(), 3u);
+        log.truncate(1);
+        CHECK_EQ(log.lastIndex(), 1u);
+        log.truncate(0);
+        CHECK_EQ(log.lastIndex(), 0u);
+    }
+}
+
+int main() {
+    testMatches();
+    testIsUpToDate();
+    testMergeAppendsAndIsIdempotent();
+    testMergeTruncatesConflicts();
+    testBackoffConverges();
+    testMajorityCommit();
+    testTruncate();
+    return test::testResult();
+}
@@ -0,0 +1,114 @@
+#include "RoomJournal.h"
+#include "TestUtil.h"
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+    JournalRecordPtr record(int32_t room_id, uint64_t seq, const std::string& text) {
+        auto entry = std::make_shared<JournalRecord>();
+        entry->room_id = room_id;
+        entry->seq = seq;
+        entry->sent_at_ms = static_cast<int64_t>(seq) * 10;
+        entry->text = text;
+        return entry;
+    }
+
+    void testAppendNumbersAndEvicts() {
+        RoomJournal journal(1, 3);
+        for (int i = 0; i < 5; ++i) {
+            const std::string text = "m" + std::to_string(i);
+            CHECK_EQ(journal.append(text.data(), text.size(), i)->seq, static_cast<uint64_t>(i + 1));
+        }
+        CHECK_EQ(journal.nextSeq(), 6u);
+
+        const auto recent = journal.recent(10);
+        CHECK_EQ(recent.size(), 3u);
+        CHECK_EQ(recent.front()->seq, 3u);      // 용량을 넘으면 오래된 것부터 밀려난다
+        CHECK_EQ(recent.back()->text, std::string("m4"));
+        CHECK_EQ(journal.recent(1).front()->seq, 5u);
+    }
+
+    void testApplyIgnoresDuplicatesAndSkipsGaps() {
+        RoomJournal journal(2, 8);
+        CHECK(journal.apply(record(2, 1, "a")));
+        CHECK(journal.apply(record(2, 2, "b")));
+        CHECK(!journal.apply(record(2, 2, "b again")));     // 중복
+        CHECK(!journal.apply(record(2, 1, "late")));        // 늦게 온 옛 기록
+        CHECK(journal.apply(record(2, 5, "e")));            // 빠진 3, 4는 건너뛴다
+        CHECK(!journal.apply(record(2, 4, "d")));
+        CHECK_EQ(journal.nextSeq(), 6u);
+
+        std::vector<JournalRecordPtr> records;
+        CHECK_EQ(journal.snapshot(records), 6u);
+        CHECK_EQ(records.size(), 3u);
+        CHECK_EQ(records[0]->text, std::string("a"));
+        CHECK_EQ(records[1]->text, std::string("b"));
+        CHECK_EQ(records[2]->seq, 5u);
+
+        // 백업에서 승격된 뒤에는 복제된 순번 다음부터 매긴다
+        const std::string text = "local";
+        CHECK_EQ(journal.append(text.data(), text.size(), 0)->seq, 6u);
+    }
+
+    void testResetResynchronizes() {
+        RoomJournal journal(3, 8);
+        for (uint64_t seq = 1; seq <= 4; ++seq) {
+            journal.apply(record(3, seq, "old"));
+        }
+        // 재동기화 스냅샷: 비우고 프라이머리의 첫 보관 순번부터 다시 받는다
+        journal.reset(10);
+        CHECK_EQ(journal.recent(10).size(), 0u);
+        CHECK(!journal.apply(record(3, 9, "before reset point")));
+        CHECK(journal.apply(record(3, 10, "x")));
+        CHECK(journal.apply(record(3, 11, "y")));
+        CHECK_EQ(journal.nextSeq(), 12u);
+        CHECK_EQ(journal.recent(10).size(), 2u);
+    }
+
+    void testZeroCapacityKeepsNumbering() {
+        RoomJournal journal(4, 0);
+        const std::string text = "t";
+        journal.append(text.data(), text.size(), 0);
+        CHECK(journal.apply(record(4, 7, "r")));
+        CHECK_EQ(journal.nextSeq(), 8u);
+        CHECK_EQ(journal.recent(10).size(), 0u);
+    }
+
+    void testConcurrentAppendsStayOrdered() {
+        constexpr int THREADS = 4;
+        constexpr int PER_THREAD = 5000;
+        RoomJournal journal(5, THREADS * PER_THREAD);
+        std::vector<std::thread> writers;
+        for (int t = 0; t < THREADS; ++t) {
+            writers.emplace_back([&journal] {
+                const std::string text = "x";
+                for (int i = 0; i < PER_THREAD; ++i) {
+                    journal.append(text.data(), text.size(), 0);
+                }
+            });
+        }
+        for (auto& writer : writers) {
+            writer.join();
+        }
+
+        // 여러 워커가 한 방에 써도 보관 순서는 순번 순서이고 빠짐이 없다
+        const auto records = journal.recent(THREADS * PER_THREAD);
+        CHECK_EQ(records.size(), static_cast<size_t>(THREADS * PER_THREAD));
+        for (size_t i = 0; i < records.size(); ++i) {
+            if (records[i]->seq != i + 1) {
+                CHECK_EQ(records[i]->seq, i + 1);
+                break;
+            }
+        }
+    }
+}
+
+int main() {
+    testAppendNumbersAndEvicts();
+    testApplyIgnoresDuplicatesAndSkipsGaps();
+    testResetResynchronizes();
+    testZeroCapacityKeepsNumbering();
+    testConcurrentAppendsStayOrdered();
+    return test::testResult();
+}
@@ -0,0 +1,39 @@
+#pragma once
+#include <iostream>
+
+// 단위 테스트용 최소 검사 매크로 (외부 프레임워크 없이 ctest로 실행).
+// 실패해도 계속 진행하고, main은 testResult()를 돌려준다 (실패가 있으면 1)
+namespace test {
+    inline int& failures() {
+        static int count = 0;
+        return count;
+    }
+
+    inline int testResult() {
+        if (failures() != 0) {
+            std::cerr << failures() << " check(s) failed" << std::endl;
+            return 1;
+        }
+        return 0;
+    }
+}
+
+#define CHECK(condition)                                                                  \
+    do {                                                                                  \
+        if (!(condition)) {                                                               \
+            std::cerr << __FILE__ << ":" << __LINE__ << ": CHECK(" #condition ") failed" \
+                      << std::endl;                                                       \
+            ++test::failures();                                                           \
+        }                                                                                 \
+    } while (0)
+
+#define CHECK_EQ(actual, expected)                                                        \
+    do {                                                                                  \
+        const auto& actual_value = (actual);                                              \
+        const auto& expected_value = (expected);                                          \
+        if (!(actual_value == expected_value)) {                                          \
+            std::cerr << __FILE__ << ":" << __LINE__ << ": CHECK_EQ(" #actual ", " #expected \
+                      << ") failed: " << actual_value << " != " << expected_value << std::endl; \
+            ++test::failures();                                                           \
+        }                                                                                 \
+    } while (0)